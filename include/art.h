@@ -280,6 +280,10 @@ int art_fuzzy_search(art_tree *t, const unsigned char *term, const int term_len,
                      const uint32_t *filter_ids, size_t filter_ids_length,
                      std::vector<art_leaf *> &results, const std::set<std::string>& exclude_leaves = {});
 
+bool compare_art_leaf_frequency(const art_leaf *a, const art_leaf *b);
+
+bool compare_art_leaf_score(const art_leaf *a, const art_leaf *b);
+
 void encode_int32(int32_t n, unsigned char *chars);
 
 void encode_int64(int64_t n, unsigned char *chars);
@@ -10,6 +10,15 @@
 
 class BatchedIndexer {
 private:
+    // body of a request chunk as replicated in its raft log entry, along with the position of the chunk
+    struct req_chunk_t {
+        std::string body;
+        int64_t log_index = 0;
+        uint32_t log_slot = 0;
+        bool first_chunk_aggregate = true;
+        bool last_chunk_aggregate = false;
+    };
+
     struct req_res_t {
         uint64_t start_ts;
         std::string prev_req_body;  // used to handle partial JSON documents caused by chunking
@@ -19,7 +28,10 @@ private:
 
         uint32_t num_chunks;
         uint32_t next_chunk_index;   // index where next read must begin
-        bool is_complete;           //  whether the req has been written to store fully
+        bool is_complete;           //  whether all the chunks of the req have been applied
+
+        // chunks from `next_chunk_index` onwards that are yet to be indexed
+        std::deque<req_chunk_t> chunks;
 
         req_res_t(uint64_t start_ts, const std::string& prev_req_body,
                   const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res,
@@ -62,7 +74,8 @@ private:
     std::atomic<bool> quit;
     std::shared_mutex pause_mutex;
 
-    // Used to skip over a bad raft log entry which previously triggered a crash
+    // Used to skip over a bad write which previously triggered a crash: holds the write's position, since the writes
+    // of a group-committed raft log entry share its log index
     const static int64_t UNSET_SKIP_INDEX = -9999;
     std::atomic<int64_t> skip_index = UNSET_SKIP_INDEX;
     rocksdb::Iterator* skip_index_iter = nullptr;
@@ -71,6 +84,14 @@ private:
     std::string skip_index_upper_bound_key = std::string(SKIP_INDICES_PREFIX) + "`";  // cannot inline this
     rocksdb::Slice* skip_index_iter_upper_bound = nullptr;
 
+    // A crash while indexing merged writes cannot be pinned on one of them, so writes up to the last log index of
+    // such a batch are indexed one at a time after a restart: a repeated crash then skips just the bad write.
+    static constexpr const char* MERGE_BARRIER_INDEX_KEY = "$XM";
+    std::atomic<int64_t> merge_barrier_index = 0;
+
+    // last log index of the merged writes that each indexer thread is indexing, 0 when there are none
+    std::unique_ptr<std::atomic<int64_t>[]> merged_log_indices;
+
     // When set, all writes (both live and log serialized) are skipped with 422 response
     const std::atomic<bool>& skip_writes;
 
@@ -79,14 +100,39 @@ private:
     static const size_t GC_INTERVAL_SECONDS = 60;
     static const size_t GC_PRUNE_MAX_SECONDS = 3600;
 
+    // upper bound on the number of consecutive single document writes that are indexed together
+    static const size_t MAX_MERGED_WRITES = 1000;
+
     static std::string get_req_prefix_key(uint64_t req_id);
 
     static std::string get_req_suffix_key(uint64_t req_id);
 
+    // snapshots taken by older versions hold the chunks of in-flight requests in the store instead of the state
+    void load_stored_chunks(uint64_t req_id, req_res_t& req_res);
+
+    // Single document writes that can be indexed together share the same key, which is empty for requests that must
+    // be indexed on their own. Requires `mutex` to be held.
+    std::string get_merge_key(uint64_t req_id);
+
+    void index_merged_writes(size_t thread_id, const std::vector<uint64_t>& req_ids);
+
 public:
 
+    // used only by older versions, which persisted request chunks to the store before indexing them
     static const constexpr char* RAFT_REQ_LOG_PREFIX = "$RL_";
 
+    // A write's position is the log index of its raft log entry followed by its slot in the entry, so that writes
+    // which are group committed together can be told apart. The slot must fit within `LOG_SLOT_BITS`.
+    static constexpr size_t LOG_SLOT_BITS = 16;
+
+    static int64_t get_write_position(int64_t log_index, uint32_t log_slot);
+
+    // Positions are persisted as "<log_index>" for slot 0, which is how older versions persist log indices, and as
+    // "<log_index>_<log_slot>" otherwise.
+    static std::string serialize_write_position(int64_t position);
+
+    static bool parse_write_position(const std::string& value, int64_t& position);
+
     BatchedIndexer(HttpServer* server, Store* store, Store* meta_store, size_t num_threads,
                    const Config& config, const std::atomic<bool>& skip_writes);
 
@@ -100,8 +146,13 @@ public:
 
     void stop();
 
+    // loads the positions of writes to skip and the merge barrier persisted before a crash
+    void load_skip_indices();
+
     void populate_skip_index();
 
+    int64_t get_skip_index() const;
+
     void persist_applying_index();
 
     void clear_skip_indices();
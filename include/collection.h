@@ -20,6 +20,7 @@
 #include <tsl/htrie_map.h>
 #include "tokenizer.h"
 #include "synonym_index.h"
+#include "lru/lru.hpp"
 
 struct doc_seq_id_t {
     uint32_t seq_id;
@@ -84,6 +85,49 @@ private:
         }
     };
 
+    // document and highlights of a single hit, computed in parallel with the other hits of the page
+    struct hit_highlight_t {
+        bool found = false;
+        nlohmann::json document;
+        nlohmann::json highlight_res;
+        std::vector<highlight_t> highlights;
+    };
+
+    const size_t HIGHLIGHT_CONCURRENCY = 4;
+
+    // Resolution of the search parameters that do not depend on the query text, which is reused by searches that
+    // have the same parameters until the schema changes.
+    struct search_plan_t {
+        std::vector<search_field_t> weighted_search_fields;
+        std::vector<std::string> search_fields;
+        std::vector<std::string> group_by_fields;
+
+        tsl::htrie_set<char> include_fields_full;
+        tsl::htrie_set<char> exclude_fields_full;
+
+        // cloned by every search, since overrides can extend it
+        filter_node_t* filter_tree_root = nullptr;
+
+        // absent when sorting by an `_eval` expression or when the sort fields are invalid
+        bool has_sort_fields_std = false;
+        std::vector<sort_by> sort_fields_std;
+
+        search_plan_t() = default;
+
+        // owns `filter_tree_root`
+        search_plan_t(const search_plan_t&) = delete;
+        search_plan_t& operator=(const search_plan_t&) = delete;
+
+        ~search_plan_t() {
+            delete filter_tree_root;
+        }
+    };
+
+    static const size_t SEARCH_PLAN_CACHE_CAPACITY = 256;
+
+    mutable std::mutex search_plans_mutex;
+    mutable LRU::Cache<std::string, std::shared_ptr<const search_plan_t>> search_plans;
+
     const std::string name;
 
     const std::atomic<uint32_t> collection_id;
@@ -92,6 +136,12 @@ private:
 
     std::atomic<size_t> num_documents;
 
+    // Changes after every write to the documents, overrides, synonyms or schema. Values are drawn from a process
+    // wide counter so that a re-created collection of the same name never repeats an earlier generation.
+    std::atomic<uint64_t> write_generation;
+
+    static std::atomic<uint64_t> write_generation_counter;
+
     // Auto incrementing record ID used internally for indexing - not exposed to the client
     std::atomic<uint32_t> next_seq_id;
 
@@ -186,6 +236,15 @@ private:
     static Option<bool> parse_pinned_hits(const std::string& pinned_hits_str,
                                    std::map<size_t, std::vector<std::string>>& pinned_hits);
 
+    // parses a `facet_by` value like `price(0-10,10-50,50+)` into the field name and its ranges, if any
+    static Option<bool> parse_facet(const std::string& facet_by, std::string& field_name,
+                                    std::vector<facet_range_t>& ranges);
+
+    // a `search_after` cursor is opaque to clients
+    static Option<bool> parse_search_after(const std::string& search_after_str, search_cursor_t& search_after);
+
+    static std::string get_search_after_str(const search_cursor_t& search_after);
+
     Index* init_index();
 
     static std::vector<char> to_char_array(const std::vector<std::string>& strs);
@@ -223,7 +282,8 @@ private:
                                const size_t prefix_token_num_chars, bool highlight_fully, const size_t snippet_threshold,
                                bool is_infix_search, std::vector<std::string>& raw_query_tokens, size_t last_valid_offset,
                                const std::string& highlight_start_tag, const std::string& highlight_end_tag,
-                               const uint8_t* index_symbols, const match_index_t& match_index) const;
+                               const uint8_t* index_symbols, const match_index_t& match_index,
+                               size_t start_token_index = 0, size_t start_offset = 0) const;
 
     static Option<bool> extract_field_name(const std::string& field_name,
                                            const tsl::htrie_map<char, field>& search_schema,
@@ -254,6 +314,39 @@ private:
                                                  tsl::htrie_set<char>& include_fields_full,
                                                  tsl::htrie_set<char>& exclude_fields_full) const;
 
+    static std::string get_search_plan_key(const std::vector<std::string>& raw_search_fields,
+                                           const std::vector<uint32_t>& raw_query_by_weights,
+                                           const std::vector<std::string>& raw_group_by_fields,
+                                           const spp::sparse_hash_set<std::string>& include_fields,
+                                           const spp::sparse_hash_set<std::string>& exclude_fields,
+                                           const std::string& filter_query,
+                                           const std::vector<std::string>& facet_fields,
+                                           const std::vector<sort_by>& sort_fields,
+                                           bool is_wildcard_query);
+
+    Option<bool> build_search_plan(const std::vector<std::string>& raw_search_fields,
+                                   const std::vector<uint32_t>& raw_query_by_weights,
+                                   const std::vector<std::string>& raw_group_by_fields,
+                                   const spp::sparse_hash_set<std::string>& include_fields,
+                                   const spp::sparse_hash_set<std::string>& exclude_fields,
+                                   const std::string& filter_query,
+                                   const std::vector<std::string>& facet_fields,
+                                   const std::vector<sort_by>& sort_fields,
+                                   bool is_wildcard_query,
+                                   search_plan_t& plan,
+                                   bool& cacheable) const;
+
+    // requires a shared lock on `mutex`, since plans are discarded while the schema is changed
+    Option<std::shared_ptr<const search_plan_t>> get_search_plan(const std::vector<std::string>& raw_search_fields,
+                                                                 const std::vector<uint32_t>& raw_query_by_weights,
+                                                                 const std::vector<std::string>& raw_group_by_fields,
+                                                                 const spp::sparse_hash_set<std::string>& include_fields,
+                                                                 const spp::sparse_hash_set<std::string>& exclude_fields,
+                                                                 const std::string& filter_query,
+                                                                 const std::vector<std::string>& facet_fields,
+                                                                 const std::vector<sort_by>& sort_fields,
+                                                                 bool is_wildcard_query) const;
+
 public:
 
     enum {MAX_ARRAY_MATCHES = 5};
@@ -366,6 +459,21 @@ public:
 
     nlohmann::json get_summary_json() const;
 
+    void get_token_expansion_cache_stats(uint64_t& hits, uint64_t& narrowed_hits, uint64_t& misses) const;
+
+    void get_filter_result_cache_stats(uint64_t& hits, uint64_t& misses, uint64_t& evictions,
+                                       uint64_t& invalidations, size_t& num_bytes) const;
+
+    void save_vector_indices(const std::string& dir_path, nlohmann::json& saved_indices) const;
+
+    void restore_vector_indices(const std::string& dir_path, const nlohmann::json& saved_indices, bool fresh);
+
+    void finish_vector_index_restore();
+
+    void defer_vector_index_tuning(bool defer);
+
+    void set_lazy_filter_min_ids(size_t min_ids);
+
     size_t batch_index_in_memory(std::vector<index_record>& index_records);
 
     Option<nlohmann::json> add(const std::string & json_str,
@@ -423,11 +531,15 @@ public:
                                   const std::string& vector_query_str = "",
                                   const bool enable_highlight_v1 = true,
                                   const uint64_t search_time_start_us = 0,
-                                  const text_match_type_t match_type = max_score) const;
+                                  const text_match_type_t match_type = max_score,
+                                  const std::string& search_after_str = "") const;
 
     Option<bool> get_filter_ids(const std::string & simple_filter_query,
                                 std::vector<std::pair<size_t, uint32_t*>>& index_ids);
 
+    // order, strategy and estimated matches of the clauses of the filter query, as they would be evaluated
+    Option<bool> explain_filter(const std::string& simple_filter_query, nlohmann::json& plan) const;
+
     Option<nlohmann::json> get(const std::string & id) const;
 
     Option<std::string> remove(const std::string & id, bool remove_from_store = true);
@@ -436,6 +548,12 @@ public:
 
     size_t get_num_documents() const;
 
+    uint64_t get_write_generation() const;
+
+    void advance_write_generation();
+
+    void clear_search_plans();
+
     DIRTY_VALUES parse_dirty_values_option(std::string& dirty_values) const;
 
     std::vector<char> get_symbols_to_index();
@@ -80,6 +80,11 @@ private:
 
     BatchedIndexer* batch_indexer;
 
+    // vector graphs saved with the snapshot that is being loaded, restored instead of being rebuilt
+    std::string vector_index_snapshot_dir;
+    nlohmann::json vector_index_snapshot_manifest;
+    bool vector_index_snapshot_fresh = false;
+
     CollectionManager();
 
     ~CollectionManager() = default;
@@ -102,6 +107,8 @@ public:
     static constexpr const char* PRESET_PREFIX = "$PS";
     static constexpr const char* BATCHED_INDEXER_STATE_KEY = "$BI";
 
+    static constexpr const char* VECTOR_INDEX_MANIFEST_FILE = "manifest.json";
+
     static CollectionManager & get_instance() {
         static CollectionManager instance;
         return instance;
@@ -138,6 +145,12 @@ public:
 
     Option<bool> load(const size_t collection_batch_size, const size_t document_batch_size);
 
+    // saves the vector graphs of all collections into `dir_path`, tagged with the log index they correspond to
+    Option<bool> save_vector_indices(const std::string& dir_path, int64_t applied_index) const;
+
+    // graphs saved by `save_vector_indices()` in `dir_path` are restored by the next `load()`
+    void set_vector_index_snapshot(const std::string& dir_path, int64_t applied_index);
+
     // frees in-memory data structures when server is shutdown - helps us run a memory leak detector properly
     void dispose();
 
@@ -163,6 +176,10 @@ public:
 
     nlohmann::json get_collection_summaries() const;
 
+    void get_token_expansion_cache_stats(nlohmann::json& result) const;
+
+    void get_filter_result_cache_stats(nlohmann::json& result) const;
+
     Option<nlohmann::json> drop_collection(const std::string& collection_name, const bool remove_from_store = true);
 
     uint32_t get_next_collection_id() const;
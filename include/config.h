@@ -61,6 +61,16 @@ private:
 
     std::atomic<int> log_slow_searches_time_ms;
 
+    uint32_t raft_write_batch_delay_us;
+    uint32_t raft_write_batch_max_size;
+    uint32_t raft_write_batch_max_bytes;
+
+    uint32_t raft_forward_batch_delay_us;
+
+    uint32_t snapshot_max_bytes_per_second;
+
+    size_t search_cache_max_bytes;
+
 protected:
 
     Config() {
@@ -83,6 +93,15 @@ protected:
         this->memory_used_max_percentage = 100;
         this->skip_writes = false;
         this->log_slow_searches_time_ms = 30 * 1000;
+        this->raft_write_batch_delay_us = 0;
+        this->raft_write_batch_max_size = 64;
+        this->raft_write_batch_max_bytes = 1024 * 1024;
+
+        this->raft_forward_batch_delay_us = 0;
+
+        this->snapshot_max_bytes_per_second = 0;
+
+        this->search_cache_max_bytes = 64 * 1024 * 1024;
     }
 
     Config(Config const&) {
@@ -296,6 +315,30 @@ public:
         return skip_writes;
     }
 
+    size_t get_raft_write_batch_delay_us() const {
+        return this->raft_write_batch_delay_us;
+    }
+
+    size_t get_raft_write_batch_max_size() const {
+        return this->raft_write_batch_max_size;
+    }
+
+    size_t get_raft_write_batch_max_bytes() const {
+        return this->raft_write_batch_max_bytes;
+    }
+
+    size_t get_raft_forward_batch_delay_us() const {
+        return this->raft_forward_batch_delay_us;
+    }
+
+    size_t get_snapshot_max_bytes_per_second() const {
+        return this->snapshot_max_bytes_per_second;
+    }
+
+    size_t get_search_cache_max_bytes() const {
+        return this->search_cache_max_bytes;
+    }
+
     // loaders
 
     std::string get_env(const char *name) {
@@ -410,6 +453,30 @@ public:
         }
 
         this->skip_writes = ("TRUE" == get_env("TYPESENSE_SKIP_WRITES"));
+
+        if(!get_env("TYPESENSE_RAFT_WRITE_BATCH_DELAY_US").empty()) {
+            this->raft_write_batch_delay_us = std::stoi(get_env("TYPESENSE_RAFT_WRITE_BATCH_DELAY_US"));
+        }
+
+        if(!get_env("TYPESENSE_RAFT_WRITE_BATCH_MAX_SIZE").empty()) {
+            this->raft_write_batch_max_size = std::stoi(get_env("TYPESENSE_RAFT_WRITE_BATCH_MAX_SIZE"));
+        }
+
+        if(!get_env("TYPESENSE_RAFT_WRITE_BATCH_MAX_BYTES").empty()) {
+            this->raft_write_batch_max_bytes = std::stoi(get_env("TYPESENSE_RAFT_WRITE_BATCH_MAX_BYTES"));
+        }
+
+        if(!get_env("TYPESENSE_RAFT_FORWARD_BATCH_DELAY_US").empty()) {
+            this->raft_forward_batch_delay_us = std::stoi(get_env("TYPESENSE_RAFT_FORWARD_BATCH_DELAY_US"));
+        }
+
+        if(!get_env("TYPESENSE_SNAPSHOT_MAX_BYTES_PER_SECOND").empty()) {
+            this->snapshot_max_bytes_per_second = std::stoul(get_env("TYPESENSE_SNAPSHOT_MAX_BYTES_PER_SECOND"));
+        }
+
+        if(!get_env("TYPESENSE_SEARCH_CACHE_MAX_BYTES").empty()) {
+            this->search_cache_max_bytes = std::stoull(get_env("TYPESENSE_SEARCH_CACHE_MAX_BYTES"));
+        }
     }
 
     void load_config_file(cmdline::parser & options) {
@@ -565,6 +632,33 @@ public:
             auto skip_writes_str = reader.Get("server", "skip-writes", "false");
             this->skip_writes = (skip_writes_str == "true");
         }
+
+        if(reader.Exists("server", "raft-write-batch-delay-us")) {
+            this->raft_write_batch_delay_us = (int) reader.GetInteger("server", "raft-write-batch-delay-us", 0);
+        }
+
+        if(reader.Exists("server", "raft-write-batch-max-size")) {
+            this->raft_write_batch_max_size = (int) reader.GetInteger("server", "raft-write-batch-max-size", 64);
+        }
+
+        if(reader.Exists("server", "raft-write-batch-max-bytes")) {
+            this->raft_write_batch_max_bytes = (int) reader.GetInteger("server", "raft-write-batch-max-bytes",
+                                                                       1024 * 1024);
+        }
+
+        if(reader.Exists("server", "raft-forward-batch-delay-us")) {
+            this->raft_forward_batch_delay_us = (int) reader.GetInteger("server", "raft-forward-batch-delay-us", 0);
+        }
+
+        if(reader.Exists("server", "snapshot-max-bytes-per-second")) {
+            this->snapshot_max_bytes_per_second = (uint32_t) reader.GetInteger("server",
+                                                                               "snapshot-max-bytes-per-second", 0);
+        }
+
+        if(reader.Exists("server", "search-cache-max-bytes")) {
+            this->search_cache_max_bytes = (size_t) reader.GetInteger("server", "search-cache-max-bytes",
+                                                                      64 * 1024 * 1024);
+        }
     }
 
     void load_config_cmd_args(cmdline::parser & options) {
@@ -697,6 +791,30 @@ public:
         if(options.exist("skip-writes")) {
             this->skip_writes = options.get<bool>("skip-writes");
         }
+
+        if(options.exist("raft-write-batch-delay-us")) {
+            this->raft_write_batch_delay_us = options.get<uint32_t>("raft-write-batch-delay-us");
+        }
+
+        if(options.exist("raft-write-batch-max-size")) {
+            this->raft_write_batch_max_size = options.get<uint32_t>("raft-write-batch-max-size");
+        }
+
+        if(options.exist("raft-write-batch-max-bytes")) {
+            this->raft_write_batch_max_bytes = options.get<uint32_t>("raft-write-batch-max-bytes");
+        }
+
+        if(options.exist("raft-forward-batch-delay-us")) {
+            this->raft_forward_batch_delay_us = options.get<uint32_t>("raft-forward-batch-delay-us");
+        }
+
+        if(options.exist("snapshot-max-bytes-per-second")) {
+            this->snapshot_max_bytes_per_second = options.get<uint32_t>("snapshot-max-bytes-per-second");
+        }
+
+        if(options.exist("search-cache-max-bytes")) {
+            this->search_cache_max_bytes = options.get<size_t>("search-cache-max-bytes");
+        }
     }
 
     void set_cors_domains(std::string& cors_domains_value) {
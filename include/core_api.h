@@ -27,10 +27,17 @@ bool get_search(const std::shared_ptr<http_req>& req, const std::shared_ptr<http
 
 bool post_multi_search(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res);
 
+void set_search_cache_max_bytes(size_t max_bytes);
+
 bool get_export_documents(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res);
 
 bool post_add_document(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res);
 
+// Indexes consecutive single document writes to a collection as one batch, responding to each of them the way
+// `post_add_document` would.
+void batch_add_documents(const std::vector<std::shared_ptr<http_req>>& reqs,
+                         const std::vector<std::shared_ptr<http_res>>& ress);
+
 bool patch_update_document(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res);
 
 bool post_import_documents(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res);
@@ -9,6 +9,8 @@
 #include <sparsepp.h>
 #include <tsl/htrie_map.h>
 #include "json.hpp"
+#include "magic_enum.hpp"
+#include "vector_quantizer.h"
 
 namespace field_types {
     // first field value indexed will determine the type
@@ -47,6 +49,11 @@ namespace fields {
     static const std::string nested_array = "nested_array";
     static const std::string num_dim = "num_dim";
     static const std::string vec_dist = "vec_dist";
+    static const std::string vec_quantization = "vec_quantization";
+    static const std::string vec_rerank = "vec_rerank";
+    static const std::string hnsw_params = "hnsw_params";
+    static const std::string typo_index_max_len = "typo_index_max_len";
+    static const std::string store_token_offsets = "store_token_offsets";
 }
 
 enum vector_distance_type_t {
@@ -54,6 +61,24 @@ enum vector_distance_type_t {
     cosine
 };
 
+struct hnsw_params_t {
+    // neighbours per node: more improves recall at the cost of memory and build time
+    size_t M = 16;
+    size_t ef_construction = 200;
+
+    // size of the search beam, unless overridden by the query
+    size_t ef = 10;
+
+    // when non-zero, `ef` is tuned to the smallest beam that reaches this recall on a sample of the vectors
+    float target_recall = 0;
+
+    bool is_default() const;
+
+    nlohmann::json to_json() const;
+
+    static Option<bool> parse(const nlohmann::json& hnsw_params_json, hnsw_params_t& hnsw_params);
+};
+
 struct field {
     std::string name;
     std::string type;
@@ -74,15 +99,35 @@ struct field {
     size_t num_dim;
     vector_distance_type_t vec_dist;
 
+    // tokens up to this length are resolved through a deletion neighbourhood index during typo correction
+    size_t typo_index_max_len = 0;
+
+    // byte offsets of tokens are stored at index time so that highlighting can skip to the matched tokens
+    bool store_token_offsets = false;
+
+    static constexpr size_t DEFAULT_VEC_RERANK = 100;
+
+    // vectors are held in the HNSW graph as quantized codes, and the closest `vec_rerank` are re-ranked exactly:
+    // every re-ranked candidate costs a read of its document from the store
+    vector_quantization_t vec_quantization = vector_quantization_t::none;
+    size_t vec_rerank = DEFAULT_VEC_RERANK;
+
+    hnsw_params_t hnsw_params;
+
     static constexpr int VAL_UNKNOWN = 2;
 
     field() {}
 
     field(const std::string &name, const std::string &type, const bool facet, const bool optional = false,
           bool index = true, std::string locale = "", int sort = -1, int infix = -1, bool nested = false,
-          int nested_array = 0, size_t num_dim = 0, vector_distance_type_t vec_dist = cosine) :
+          int nested_array = 0, size_t num_dim = 0, vector_distance_type_t vec_dist = cosine,
+          size_t typo_index_max_len = 0, bool store_token_offsets = false,
+          vector_quantization_t vec_quantization = vector_quantization_t::none,
+          size_t vec_rerank = DEFAULT_VEC_RERANK, const hnsw_params_t& hnsw_params = hnsw_params_t()) :
             name(name), type(type), facet(facet), optional(optional), index(index), locale(locale),
-            nested(nested), nested_array(nested_array), num_dim(num_dim), vec_dist(vec_dist) {
+            nested(nested), nested_array(nested_array), num_dim(num_dim), vec_dist(vec_dist),
+            typo_index_max_len(typo_index_max_len), store_token_offsets(store_token_offsets),
+            vec_quantization(vec_quantization), vec_rerank(vec_rerank), hnsw_params(hnsw_params) {
 
         set_computed_defaults(sort, infix);
     }
@@ -220,10 +265,6 @@ struct field {
         return true;
     }
 
-    std::string faceted_name() const {
-        return (facet && !is_string()) ? "_fstr_" + name : name;
-    }
-
     static bool get_type(const nlohmann::json& obj, std::string& field_type) {
         if(obj.is_array()) {
             if(obj.empty()) {
@@ -305,6 +346,23 @@ struct field {
             if(field.num_dim > 0) {
                 field_val[fields::num_dim] = field.num_dim;
                 field_val[fields::vec_dist] = field.vec_dist == ip ? "ip" : "cosine";
+
+                if(field.vec_quantization != vector_quantization_t::none) {
+                    field_val[fields::vec_quantization] = magic_enum::enum_name(field.vec_quantization);
+                    field_val[fields::vec_rerank] = field.vec_rerank;
+                }
+
+                if(!field.hnsw_params.is_default()) {
+                    field_val[fields::hnsw_params] = field.hnsw_params.to_json();
+                }
+            }
+
+            if(field.typo_index_max_len > 0) {
+                field_val[fields::typo_index_max_len] = field.typo_index_max_len;
+            }
+
+            if(field.store_token_offsets) {
+                field_val[fields::store_token_offsets] = true;
             }
 
             fields_json.push_back(field_val);
@@ -537,6 +595,16 @@ struct filter_node_t {
         delete left;
         delete right;
     }
+
+    filter_node_t* clone() const {
+        if(!isOperator) {
+            return new filter_node_t(filter_exp);
+        }
+
+        return new filter_node_t(filter_operator,
+                                 left == nullptr ? nullptr : left->clone(),
+                                 right == nullptr ? nullptr : right->clone());
+    }
 };
 
 namespace sort_field_const {
@@ -651,8 +719,19 @@ struct facet_stats_t {
             fvsum = 0;
 };
 
+// bucket of a numerical facet that holds the values within [lower, upper)
+struct facet_range_t {
+    std::string label;
+    double lower = std::numeric_limits<double>::lowest();
+    double upper = std::numeric_limits<double>::max();
+};
+
 struct facet {
     const std::string field_name;
+
+    // when given, values are counted per range, keyed by the index of the range
+    std::vector<facet_range_t> ranges;
+
     spp::sparse_hash_map<uint64_t, facet_count_t> result_map;
 
     // used for facet value query
@@ -663,17 +742,29 @@ struct facet {
 
     facet_stats_t stats;
 
-    explicit facet(const std::string& field_name): field_name(field_name) {
+    explicit facet(const std::string& field_name, const std::vector<facet_range_t>& ranges = {}):
+            field_name(field_name), ranges(ranges) {
 
     }
 };
 
+enum class facet_num_type_t {
+    none,
+    int32,
+    int64,
+    float32,
+    boolean
+};
+
 struct facet_info_t {
     // facet hash => resolved tokens
     std::unordered_map<uint64_t, std::vector<std::string>> hashes;
     bool use_facet_query = false;
     bool should_compute_stats = false;
     field facet_field{"", "", false};
+
+    // resolved once, so that the values of non-string facets are decoded without looking at the field type
+    facet_num_type_t num_type = facet_num_type_t::none;
 };
 
 struct facet_query_t {
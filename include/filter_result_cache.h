@@ -0,0 +1,102 @@
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "field.h"
+#include "sorted_array.h"
+
+/*
+ * Bounded cache of normalized filter expression => matching ids, shared across queries of an index.
+ *
+ * The ids are held compressed. Every write to a field bumps its generation, which makes the results computed from
+ * that field before the write stale: those are dropped when they are next looked up or when they are evicted.
+ */
+class filter_result_cache_t {
+private:
+    struct entry_t {
+        std::string key;
+
+        // a write to any of these fields makes the result stale
+        std::vector<std::string> field_names;
+
+        // cache generation the result was computed at
+        uint64_t generation = 0;
+
+        sorted_array ids;
+
+        size_t num_bytes = 0;
+    };
+
+    std::mutex mutex;
+
+    // most recently used first
+    std::list<entry_t> entries;
+    std::unordered_map<std::string, std::list<entry_t>::iterator> entry_map;
+
+    // field => generation of its last write
+    std::unordered_map<std::string, uint64_t> field_write_generations;
+
+    std::atomic<uint64_t> generation = 0;
+
+    size_t num_bytes = 0;
+    size_t max_bytes;
+
+    std::atomic<uint64_t> num_hits = 0;
+    std::atomic<uint64_t> num_misses = 0;
+    std::atomic<uint64_t> num_evictions = 0;
+    std::atomic<uint64_t> num_invalidations = 0;
+
+    // requires `mutex` to be held
+    bool is_stale(const std::vector<std::string>& field_names, uint64_t computed_generation) const;
+
+    void erase_entry(std::list<entry_t>::iterator entry_it);
+
+public:
+
+    static constexpr size_t DEFAULT_MAX_BYTES = 32 * 1024 * 1024;
+
+    // results of cheap filters are cached only when they are at least this large
+    static constexpr size_t MIN_LARGE_RESULT_IDS = 10000;
+
+    // field that stands for the ids of all the documents
+    static constexpr const char* ALL_IDS_FIELD = "id";
+
+    explicit filter_result_cache_t(size_t max_bytes = DEFAULT_MAX_BYTES);
+
+    // returns false for filters whose results are not cached, e.g. on `id`
+    static bool get_key(const filter& a_filter, std::string& key);
+
+    // range, geo and negated boolean filters are expensive to evaluate regardless of the size of their results
+    static bool is_expensive(const field& a_field, const filter& a_filter);
+
+    // must be taken before the filter is evaluated, so that a concurrent write makes the result stale
+    uint64_t get_generation() const;
+
+    void invalidate(const std::string& field_name);
+
+    // `ids` is allocated on a hit and is owned by the caller
+    bool get(const std::string& key, uint32_t*& ids, uint32_t& ids_length);
+
+    void put(const std::string& key, const std::vector<std::string>& field_names, uint64_t computed_generation,
+             const uint32_t* ids, uint32_t ids_length);
+
+    void clear();
+
+    uint64_t hits() const;
+
+    uint64_t misses() const;
+
+    uint64_t evictions() const;
+
+    uint64_t invalidations() const;
+
+    size_t size();
+
+    size_t get_num_bytes();
+
+    size_t get_max_bytes() const;
+};
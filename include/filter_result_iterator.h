@@ -0,0 +1,103 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "id_list.h"
+#include "posting_list.h"
+
+/*
+ * Lazily evaluates a filter tree, yielding the matching ids in ascending order.
+ *
+ * String clauses walk the posting lists of their tokens and operators leapfrog over their children, so a filter
+ * that is only probed for the matches of a selective query never has all of its matches materialized. Other
+ * clauses are materialized by the index upfront, one clause at a time.
+ */
+class filter_result_iterator_t {
+public:
+    enum class op_t {
+        AND,
+        OR,
+        // ids of the left iterator that are not in the right iterator
+        AND_NOT
+    };
+
+private:
+    enum class node_t {
+        ids_leaf,
+        id_list_leaf,
+        posting_leaf,
+        op
+    };
+
+    node_t node_type;
+    op_t op = op_t::AND;
+
+    bool is_valid = false;
+
+    // largest id the iterator was skipped to since the last reset: smaller ids may have been skipped over
+    uint32_t last_skipped_id = 0;
+
+    // ids_leaf
+    uint32_t* ids = nullptr;
+    uint32_t ids_length = 0;
+    uint32_t ids_index = 0;
+
+    // id_list_leaf
+    id_list_t* id_list = nullptr;
+    std::unique_ptr<id_list_t::iterator_t> id_list_it;
+
+    // posting_leaf: values are ORed, while the tokens of each value are ANDed
+    std::vector<std::vector<posting_list_t*>> value_plists;
+    std::vector<std::vector<posting_list_t::iterator_t>> value_its;
+    std::vector<uint32_t> value_seq_ids;
+    std::vector<posting_list_t*> expanded_plists;
+    bool exact_match = false;
+    bool field_is_array = false;
+
+    // op
+    std::unique_ptr<filter_result_iterator_t> left;
+    std::unique_ptr<filter_result_iterator_t> right;
+
+    void advance_value(size_t value_index);
+
+    void advance_posting_leaf();
+
+    void advance_op();
+
+public:
+
+    uint32_t seq_id = 0;
+
+    // leaf over the ids of a clause that are materialized upfront, which are owned by the iterator
+    filter_result_iterator_t(uint32_t* ids, uint32_t ids_length);
+
+    // leaf over every id of the list
+    explicit filter_result_iterator_t(id_list_t* id_list);
+
+    // leaf over string values, each of which is given by the posting lists of its tokens
+    filter_result_iterator_t(const std::vector<std::vector<void*>>& value_posting_lists, bool exact_match,
+                             bool field_is_array);
+
+    // the children are owned by the iterator
+    filter_result_iterator_t(op_t op, filter_result_iterator_t* left, filter_result_iterator_t* right);
+
+    filter_result_iterator_t(const filter_result_iterator_t&) = delete;
+    filter_result_iterator_t& operator=(const filter_result_iterator_t&) = delete;
+
+    ~filter_result_iterator_t();
+
+    [[nodiscard]] bool valid() const;
+
+    void next();
+
+    // moves to the first match that is >= `id`
+    void skip_to(uint32_t id);
+
+    // ids are expected in ascending order, which is cheapest, but a smaller id restarts the iteration
+    bool contains(uint32_t id);
+
+    void reset();
+
+    // materializes the matches, e.g. for faceting, and leaves the iterator reset
+    uint32_t to_filter_id_array(uint32_t*& filter_ids);
+};
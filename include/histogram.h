@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include "json.hpp"
+
+/*
+ * Lock free histogram of non-negative values, over buckets whose bounds are powers of two: bucket `i` holds the
+ * values in [2^(i-1), 2^i), while bucket 0 holds zeroes. Percentiles are reported as the upper bound of the bucket
+ * they fall into, so they are accurate to within a factor of 2.
+ */
+class histogram_t {
+private:
+    static constexpr size_t NUM_BUCKETS = 40;
+
+    std::array<std::atomic<uint64_t>, NUM_BUCKETS> buckets{};
+    std::atomic<uint64_t> count = 0;
+    std::atomic<uint64_t> sum = 0;
+    std::atomic<uint64_t> max = 0;
+
+    static size_t get_bucket(uint64_t value) {
+        if(value == 0) {
+            return 0;
+        }
+
+        const size_t bucket = 64 - __builtin_clzll(value);
+        return bucket < NUM_BUCKETS ? bucket : NUM_BUCKETS - 1;
+    }
+
+    static uint64_t get_bucket_upper_bound(size_t bucket) {
+        if(bucket == NUM_BUCKETS - 1) {
+            // the last bucket also holds everything larger
+            return UINT64_MAX;
+        }
+
+        return bucket == 0 ? 0 : (uint64_t(1) << bucket) - 1;
+    }
+
+public:
+
+    void record(uint64_t value) {
+        buckets[get_bucket(value)].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(value, std::memory_order_relaxed);
+
+        uint64_t current_max = max.load(std::memory_order_relaxed);
+        while(value > current_max && !max.compare_exchange_weak(current_max, value, std::memory_order_relaxed)) {
+
+        }
+    }
+
+    uint64_t get_count() const {
+        return count.load(std::memory_order_relaxed);
+    }
+
+    // `p` is a fraction in [0, 1]
+    uint64_t percentile(double p) const {
+        const uint64_t total = get_count();
+        if(total == 0) {
+            return 0;
+        }
+
+        const uint64_t rank = std::max<uint64_t>(1, uint64_t(p * total + 0.5));
+        uint64_t seen = 0;
+
+        for(size_t i = 0; i < NUM_BUCKETS; i++) {
+            seen += buckets[i].load(std::memory_order_relaxed);
+            if(seen >= rank) {
+                return std::min(get_bucket_upper_bound(i), max.load(std::memory_order_relaxed));
+            }
+        }
+
+        return max.load(std::memory_order_relaxed);
+    }
+
+    nlohmann::json to_json() const {
+        nlohmann::json histogram;
+        const uint64_t total = get_count();
+
+        histogram["count"] = total;
+        histogram["mean"] = total == 0 ? 0.0 : double(sum.load(std::memory_order_relaxed)) / total;
+        histogram["p50"] = percentile(0.5);
+        histogram["p90"] = percentile(0.9);
+        histogram["p99"] = percentile(0.99);
+        histogram["max"] = max.load(std::memory_order_relaxed);
+
+        // non-empty buckets, keyed by their upper bound
+        histogram["buckets"] = nlohmann::json::object();
+        for(size_t i = 0; i < NUM_BUCKETS; i++) {
+            const uint64_t bucket_count = buckets[i].load(std::memory_order_relaxed);
+            if(bucket_count != 0) {
+                histogram["buckets"][std::to_string(get_bucket_upper_bound(i))] = bucket_count;
+            }
+        }
+
+        return histogram;
+    }
+};
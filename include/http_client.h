@@ -2,6 +2,9 @@
 
 #include <string>
 #include <map>
+#include <mutex>
+#include <vector>
+#include <atomic>
 #include <curl/curl.h>
 #include "http_data.h"
 #include "http_server.h"
@@ -14,6 +17,15 @@ private:
     static std::string api_key;
     static std::string ca_cert_path;
 
+    // Easy handles are reused across requests, since a handle keeps its connections alive: requests to the same
+    // node (e.g. writes forwarded to the leader) then skip the connection and TLS setup.
+    static std::mutex curl_pool_mutex;
+    static std::vector<CURL*> curl_pool;
+    static const size_t MAX_POOLED_CURL_HANDLES = 64;
+
+    static std::atomic<uint64_t> num_requests;
+    static std::atomic<uint64_t> num_new_connections;
+
     HttpClient() = default;
 
     ~HttpClient() = default;
@@ -26,6 +38,10 @@ private:
 
     static CURL* init_curl(const std::string& url, std::string& response);
 
+    static CURL* acquire_curl();
+
+    static void release_curl(CURL* curl);
+
     static CURL* init_curl_async(const std::string& url, deferred_req_res_t* req_res, curl_slist*& chunk);
 
     static size_t curl_req_send_callback(char* buffer, size_t size, size_t nitems, void *userdata);
@@ -63,4 +79,7 @@ public:
                              std::map<std::string, std::string>& res_headers, long timeout_ms=4000);
 
     static void extract_response_headers(CURL* curl, std::map<std::string, std::string> &res_headers);
+
+    // number of requests sent through pooled handles and of the connections they had to open
+    static void get_stats(nlohmann::json& stats);
 };
@@ -107,6 +107,11 @@ struct http_res {
         body = res_body;
     }
 
+    void set_200(std::string && res_body) {
+        status_code = 200;
+        body = std::move(res_body);
+    }
+
     void set_201(const std::string & res_body) {
         status_code = 201;
         body = res_body;
@@ -244,14 +249,17 @@ struct http_req {
 
     int64_t log_index;
 
+    // slot of the request within a group-committed raft log entry, 0 for a request replicated on its own
+    uint32_t log_slot;
+
     std::atomic<bool> is_http_v1;
     std::atomic<bool> is_diposed;
     std::string client_ip = "0.0.0.0";
 
     http_req(): _req(nullptr), route_hash(1),
                 first_chunk_aggregate(true), last_chunk_aggregate(false),
-                chunk_len(0), body_index(0), data(nullptr), ready(false), log_index(0), is_http_v1(true),
-                is_diposed(false) {
+                chunk_len(0), body_index(0), data(nullptr), ready(false), log_index(0), log_slot(0),
+                is_http_v1(true), is_diposed(false) {
 
         start_ts = std::chrono::duration_cast<std::chrono::microseconds>(
                 std::chrono::system_clock::now().time_since_epoch()).count();
@@ -267,7 +275,7 @@ struct http_req {
             params(params), embedded_params_vec(embedded_params_vec), api_auth_key(api_auth_key),
             first_chunk_aggregate(true), last_chunk_aggregate(false),
             chunk_len(0), body(body), body_index(0), data(nullptr), ready(false),
-            log_index(0), is_diposed(false), client_ip(client_ip) {
+            log_index(0), log_slot(0), is_diposed(false), client_ip(client_ip) {
 
         if(_req != nullptr) {
             const auto& tv = _req->processed_at.at;
@@ -355,6 +363,10 @@ struct http_req {
 
     void load_from_json(const std::string& serialized_content) {
         nlohmann::json content = nlohmann::json::parse(serialized_content);
+        load_from_json(content);
+    }
+
+    void load_from_json(nlohmann::json& content) {
         route_hash = content["route_hash"];
 
         if(start_ts == 0) {
@@ -373,10 +385,16 @@ struct http_req {
         last_chunk_aggregate = content.count("last_chunk_aggregate") != 0 ? content["last_chunk_aggregate"].get<bool>() : false;
         start_ts = content.count("start_ts") != 0 ? content["start_ts"].get<uint64_t>() : 0;
         log_index = content.count("log_index") != 0 ? content["log_index"].get<int64_t>() : 0;
+        log_slot = content.count("log_slot") != 0 ? content["log_slot"].get<uint32_t>() : 0;
     }
 
     std::string to_json() const {
         nlohmann::json content;
+        to_json(content);
+        return content.dump(-1, ' ', false, nlohmann::detail::error_handler_t::ignore);
+    }
+
+    void to_json(nlohmann::json& content) const {
         content["route_hash"] = route_hash;
         content["params"] = params;
         content["first_chunk_aggregate"] = first_chunk_aggregate;
@@ -385,8 +403,7 @@ struct http_req {
         content["metadata"] = metadata;
         content["start_ts"] = start_ts;
         content["log_index"] = log_index;
-
-        return content.dump(-1, ' ', false, nlohmann::detail::error_handler_t::ignore);
+        content["log_slot"] = log_slot;
     }
 
     static ip_addr_str_t get_ip_addr(h2o_req_t* h2o_req) {
@@ -329,4 +329,8 @@ public:
     void persist_applying_index();
 
     int64_t get_num_queued_writes();
+
+    void get_group_commit_stats(nlohmann::json& stats);
+
+    void get_forward_stats(nlohmann::json& stats);
 };
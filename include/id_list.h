@@ -52,6 +52,8 @@ public:
         void next();
         void previous();
         void skip_to(uint32_t id);
+        // for a reverse iterator: moves back to the largest id that is not greater than `id`
+        void skip_back_to(uint32_t id);
         [[nodiscard]] uint32_t id() const;
         [[nodiscard]] inline uint32_t index() const;
         [[nodiscard]] inline block_t* block() const;
@@ -6,6 +6,10 @@
 #include <mutex>
 #include <shared_mutex>
 #include <condition_variable>
+#include <map>
+#include <unordered_set>
+#include <atomic>
+#include <functional>
 #include <art.h>
 #include <number.h>
 #include <sparsepp.h>
@@ -28,6 +32,14 @@
 #include "synonym_index.h"
 #include "override.h"
 #include "vector_query_ops.h"
+#include "typo_index.h"
+#include "token_expansion_cache.h"
+#include "filter_result_cache.h"
+#include "filter_result_iterator.h"
+#include "token_offset_index.h"
+#include "vector_scan.h"
+#include "quantized_space.h"
+#include "vector_search_planner.h"
 #include "hnswlib/hnswlib.h"
 
 static constexpr size_t ARRAY_FACET_DIM = 4;
@@ -93,6 +105,18 @@ enum text_match_type_t {
     max_weight
 };
 
+// position after the last hit of a page, from where the next page is fetched
+struct search_cursor_t {
+    // number of hits that were returned up to the cursor, of which `num_curated` were curated
+    size_t offset = 0;
+    size_t num_curated = 0;
+
+    // sort key tuple and seq id of the last ranked hit: pages of only curated hits have none
+    bool has_kv = false;
+    int64_t scores[3] = {0};
+    uint64_t key = 0;
+};
+
 struct search_args {
     std::vector<query_tokens_t> field_query_tokens;
     std::vector<search_field_t> search_fields;
@@ -139,6 +163,7 @@ struct search_args {
     std::vector<std::vector<KV*>> override_result_kvs;
 
     vector_query_t& vector_query;
+    vector_search_info_t vector_search_info;
 
     search_args(std::vector<query_tokens_t> field_query_tokens, std::vector<search_field_t> search_fields,
                 const text_match_type_t match_type,
@@ -153,7 +178,8 @@ struct search_args {
                 size_t concurrency, size_t search_cutoff_ms,
                 size_t min_len_1typo, size_t min_len_2typo, size_t max_candidates, const std::vector<enable_t>& infixes,
                 const size_t max_extra_prefix, const size_t max_extra_suffix, const size_t facet_query_num_typos,
-                const bool filter_curated_hits, const enable_t split_join_tokens, vector_query_t& vector_query) :
+                const bool filter_curated_hits, const enable_t split_join_tokens, vector_query_t& vector_query,
+                const search_cursor_t& search_after) :
             field_query_tokens(field_query_tokens),
             search_fields(search_fields), match_type(match_type), filter_tree_root(filter_tree_root), facets(facets),
             included_ids(included_ids), excluded_ids(excluded_ids), sort_fields_std(sort_fields_std),
@@ -171,7 +197,13 @@ struct search_args {
 
         const size_t topster_size = std::max((size_t)1, max_hits);  // needs to be atleast 1 since scoring is mandatory
         topster = new Topster(topster_size, group_limit);
-        curated_topster = new Topster(topster_size, group_limit);
+
+        // curated hits are counted towards `found`, so all of them must fit even when no hits are requested
+        curated_topster = new Topster(std::max(topster_size, included_ids.size()), group_limit);
+
+        if(search_after.has_kv) {
+            topster->set_cursor(search_after.scores, search_after.key);
+        }
     }
 
     ~search_args() {
@@ -198,6 +230,9 @@ enum class DIRTY_VALUES {
 struct offsets_facet_hashes_t {
     std::unordered_map<std::string, std::vector<uint32_t>> offsets;
     std::vector<uint64_t> facet_hashes;
+
+    // byte offset checkpoints of every value, populated only for fields that store token offsets
+    std::vector<std::vector<uint32_t>> token_checkpoints;
 };
 
 struct index_record {
@@ -241,36 +276,97 @@ struct index_record {
 };
 
 class VectorFilterFunctor: public hnswlib::FilterFunctor {
-    const uint32_t* filter_ids = nullptr;
-    const uint32_t filter_ids_length = 0;
+    // membership is checked for every node that the graph search visits, so the sorted filter ids are
+    // expanded into a bitmap once per query
+    std::vector<uint64_t> filter_bitmap;
+    bool filtered = false;
 
 public:
     explicit VectorFilterFunctor(const uint32_t* filter_ids, const uint32_t filter_ids_length) :
-            filter_ids(filter_ids), filter_ids_length(filter_ids_length) {}
+            filtered(filter_ids_length != 0) {
+        if(!filtered) {
+            return;
+        }
+
+        filter_bitmap.resize((filter_ids[filter_ids_length - 1] >> 6) + 1);
+        for(uint32_t i = 0; i < filter_ids_length; i++) {
+            filter_bitmap[filter_ids[i] >> 6] |= (uint64_t(1) << (filter_ids[i] & 63));
+        }
+    }
 
     bool operator()(unsigned int id) {
-        if(filter_ids_length == 0) {
+        if(!filtered) {
             return true;
         }
 
-        return std::binary_search(filter_ids, filter_ids + filter_ids_length, id);
+        const size_t word = id >> 6;
+        return word < filter_bitmap.size() && (filter_bitmap[word] >> (id & 63)) & 1;
     }
 };
 
 struct hnsw_index_t {
-    hnswlib::InnerProductSpace* space;
+    hnswlib::SpaceInterface<float>* space;
     hnswlib::HierarchicalNSW<float, VectorFilterFunctor>* vecdex;
     size_t num_dim;
     vector_distance_type_t distance_type;
 
-    hnsw_index_t(size_t num_dim, size_t init_size, vector_distance_type_t distance_type):
-        space(new hnswlib::InnerProductSpace(num_dim)),
-        vecdex(new hnswlib::HierarchicalNSW<float, VectorFilterFunctor>(space, init_size, 16, 200, 100, true)),
-        num_dim(num_dim), distance_type(distance_type) {
+    hnsw_params_t hnsw_params;
+
+    // search beam used when the query does not specify one: either configured or tuned
+    std::atomic<size_t> ef;
+
+    // `ef` is tuned in the background: guards the tuning in progress and the graph size it was started at
+    std::mutex ef_tuning_mutex;
+    std::future<void> ef_tuning;
+    size_t num_elements_at_tuning = 0;
+
+    // set while the documents of a collection are loaded, so that `ef` is tuned once they all are
+    std::atomic<bool> defer_ef_tuning = false;
+
+    // when quantized, the graph holds codes and the exact distances of the top `rerank` candidates are recomputed
+    vector_quantization_t quantization;
+    quantized_space_t* quantized_space;
+    size_t rerank;
+    std::atomic<bool> quantizer_trained;
+
+    // vectors of a PQ field are held back until enough of them are available to train the codebook
+    std::mutex pending_mutex;
+    std::map<uint32_t, std::vector<float>> pending_vectors;
+
+    static constexpr size_t PQ_TRAINING_SIZE = 4 * pq_codebook_t::MAX_CENTROIDS;
+
+    // `ef` is tuned once the graph has this many elements and again every time it doubles
+    static constexpr size_t MIN_TUNING_ELEMENTS = 1000;
+    static constexpr size_t NUM_TUNING_QUERIES = 50;
+    static constexpr size_t TUNING_K = 10;
+    static constexpr size_t MAX_TUNED_EF = 1024;
+    static constexpr size_t MAX_TUNING_VECTORS = 10000;
+
+    // while a graph restored from a snapshot is reconciled with the stored documents, these are the labels that
+    // have not been seen yet: inserts of unchanged vectors are skipped and labels never seen are deleted
+    std::atomic<bool> restoring = false;
+    bool restored_fresh = false;
+    std::mutex restore_mutex;
+    std::unordered_set<uint32_t> restored_labels;
+
+    hnsw_index_t(size_t num_dim, size_t init_size, vector_distance_type_t distance_type,
+                 vector_quantization_t quantization = vector_quantization_t::none, size_t rerank = 0,
+                 const hnsw_params_t& hnsw_params = hnsw_params_t()):
+        space(create_space(num_dim, quantization)),
+        vecdex(new hnswlib::HierarchicalNSW<float, VectorFilterFunctor>(space, init_size, hnsw_params.M,
+                                                                        hnsw_params.ef_construction, 100, true)),
+        num_dim(num_dim), distance_type(distance_type), hnsw_params(hnsw_params), ef(hnsw_params.ef),
+        quantization(quantization),
+        quantized_space(dynamic_cast<quantized_space_t*>(space)), rerank(rerank),
+        quantizer_trained(quantized_space == nullptr || quantized_space->trained()) {
 
     }
 
     ~hnsw_index_t() {
+        if(ef_tuning.valid()) {
+            ef_tuning.wait();
+        }
+
         delete vecdex;
         delete space;
     }
@@ -286,6 +382,68 @@ struct hnsw_index_t {
             norm_dest[i] = src[i] * norm;
         }
     }
+
+    static hnswlib::SpaceInterface<float>* create_space(size_t num_dim, vector_quantization_t quantization);
+
+    // grows the graph ahead of inserting `num_new_elements`, since it cannot be resized during concurrent inserts
+    void reserve(size_t num_new_elements);
+
+    // `values` must already be normalized when the field uses cosine distance: safe to call concurrently
+    void insert(const float* values, size_t seq_id);
+
+    void remove(size_t seq_id);
+
+    bool needs_rerank() const;
+
+    // number of candidates to fetch for the top `k`, including those that are only needed for the re-rank
+    size_t get_num_candidates(size_t k) const;
+
+    // approximate search through the graph, closest first: `query` must be normalized like in `insert()`
+    void search(const float* query, size_t k, VectorFilterFunctor& filter_functor,
+                std::vector<std::pair<float, size_t>>& dist_labels);
+
+    // exhaustive search over the vectors of the given labels, closest first: `query` must already be normalized
+    // when the field uses cosine distance
+    void flat_search(const float* query, const uint32_t* labels, size_t num_labels, size_t k,
+                     ThreadPool* thread_pool, size_t concurrency,
+                     std::vector<std::pair<float, size_t>>& dist_labels);
+
+    // runs a vector query as planned, closest first: `filter_functor` must hold the same ids as `filter_ids`, and
+    // graph searches use a beam of at least `ef`
+    void planned_search(const float* query, const vector_search_plan_t& plan, size_t k, size_t ef,
+                        const uint32_t* filter_ids, size_t filter_ids_length, VectorFilterFunctor& filter_functor,
+                        ThreadPool* thread_pool, size_t concurrency,
+                        std::vector<std::pair<float, size_t>>& dist_labels);
+
+    // replaces the distances of quantized candidates with exact distances and keeps the closest `k`:
+    // `get_vector` returns the original (unnormalized) values of a label, and candidates without them are dropped
+    void rerank_candidates(const float* query, size_t k,
+                           const std::function<bool(uint32_t, std::vector<float>&)>& get_vector,
+                           std::vector<std::pair<float, size_t>>& dist_labels) const;
+
+    // memory held by the vectors or their codes, excluding the graph links
+    size_t vectors_memory_used();
+
+    // writes the graph (and the quantizer's trained state) to files starting with `path_prefix`
+    bool save(const std::string& path_prefix);
+
+    // replaces the graph with one saved by `save()`: `fresh` when it was saved at the same log index as the
+    // documents that are going to be indexed, which then need not be compared against the graph
+    bool restore(const std::string& path_prefix, bool fresh);
+
+    // deletes restored labels whose documents were not indexed since `restore()`
+    void finish_restore();
+
+    // tunes `ef` on the thread pool when the graph has grown enough since it was last tuned
+    void schedule_ef_tuning(ThreadPool* thread_pool);
+
+    // picks the smallest `ef` whose recall@TUNING_K reaches the target recall on a graph built with the same
+    // parameters from `sample`, against exact results for some of its vectors used as queries: 0 when the sample
+    // is too small
+    static size_t tune_ef(const std::vector<float>& sample, size_t num_dim, const hnsw_params_t& hnsw_params);
+
+private:
+    bool skip_restored_insert(const float* values, size_t seq_id);
 };
 
 class Index {
@@ -330,6 +488,21 @@ private:
     // vector field => vector index
     spp::sparse_hash_map<std::string, hnsw_index_t*> vector_index;
 
+    // string field => deletion neighbourhood index of short tokens
+    spp::sparse_hash_map<std::string, typo_index_t*> typo_index;
+
+    // string field => token expansions shared across queries
+    spp::sparse_hash_map<std::string, token_expansion_cache_t*> token_expansion_caches;
+
+    // threshold of `LAZY_FILTER_MIN_IDS`, which can be lowered to exercise lazy filtering on small collections
+    size_t lazy_filter_min_ids = LAZY_FILTER_MIN_IDS;
+
+    // string field => byte offsets of tokens, used for highlighting
+    spp::sparse_hash_map<std::string, token_offset_index_t*> token_offset_index;
+
+    // results of expensive filter expressions shared across queries
+    filter_result_cache_t* filter_result_cache;
+
     // this is used for wildcard queries
     id_list_t* seq_ids;
 
@@ -417,6 +590,7 @@ private:
                                const text_match_type_t match_type,
                                const std::vector<search_field_t>& the_fields,
                                const uint32_t* filter_ids, size_t filter_ids_length,
+                               filter_result_iterator_t* const filter_iterator,
                                const uint32_t* exclude_token_ids, size_t exclude_token_ids_size,
                                const std::vector<sort_by>& sort_fields,
                                std::vector<tok_candidates>& token_candidates_vec,
@@ -478,6 +652,35 @@ private:
                           filter_node_t const* const root,
                           const bool enable_short_circuit) const;
 
+    // same as `do_filtering`, but reuses and populates the filter result cache
+    void do_cached_filtering(uint32_t*& filter_ids,
+                             uint32_t& filter_ids_length,
+                             filter_node_t const* const root) const;
+
+    // approximate number of ids matched by the filter tree, derived from the statistics of the filtered fields
+    size_t estimate_filter_ids(const filter_node_t* root) const;
+
+    // whether the filter can be evaluated by checking the value of each candidate id against it
+    bool can_probe_filter(const filter_node_t* root) const;
+
+    void probe_filter(const uint32_t* ids, const uint32_t ids_length, const filter_node_t* root,
+                      uint32_t*& filter_ids, uint32_t& filter_ids_length) const;
+
+    // evaluates the cheaper side of an AND first, and probes the other side when the candidates are few
+    void and_filter(uint32_t*& filter_ids,
+                    uint32_t& filter_ids_length,
+                    filter_node_t const* const root,
+                    const bool enable_short_circuit) const;
+
+    void explain_filter(const filter_node_t* root, const std::string& strategy, nlohmann::json& plan) const;
+
+    // string clauses and operators are evaluated lazily, while the other clauses are materialized upfront
+    filter_result_iterator_t* new_filter_iterator(const filter_node_t* root) const;
+
+    bool use_lazy_filter(const filter_node_t* filter_tree_root, const std::vector<query_tokens_t>& field_query_tokens,
+                         const std::vector<std::pair<uint32_t, uint32_t>>& included_ids,
+                         bool filter_curated_hits, const vector_query_t& vector_query) const;
+
     void insert_doc(const int64_t score, art_tree *t, uint32_t seq_id,
                     const std::unordered_map<std::string, std::vector<uint32_t>> &token_to_offsets) const;
 
@@ -485,14 +688,16 @@ private:
                                             const std::vector<char>& symbols_to_index,
                                             const std::vector<char>& token_separators,
                                             std::unordered_map<std::string, std::vector<uint32_t>>& token_to_offsets,
-                                            std::vector<uint64_t>& facet_hashes);
+                                            std::vector<uint64_t>& facet_hashes,
+                                            std::vector<std::vector<uint32_t>>* token_checkpoints = nullptr);
 
     static void tokenize_string_array_with_facets(const std::vector<std::string>& strings, bool is_facet,
                                            const field& a_field,
                                            const std::vector<char>& symbols_to_index,
                                            const std::vector<char>& token_separators,
                                            std::unordered_map<std::string, std::vector<uint32_t>>& token_to_offsets,
-                                           std::vector<uint64_t>& facet_hashes);
+                                           std::vector<uint64_t>& facet_hashes,
+                                           std::vector<std::vector<uint32_t>>* token_checkpoints = nullptr);
 
     void collate_included_ids(const std::vector<token_t>& q_included_tokens,
                               const std::map<size_t, std::map<size_t, uint32_t>> & included_ids_map,
@@ -500,7 +705,17 @@ private:
 
     static uint64_t facet_token_hash(const field & a_field, const std::string &token);
 
-    static void compute_facet_stats(facet &a_facet, uint64_t raw_value, const std::string & field_type);
+    static facet_num_type_t get_facet_num_type(const field& a_field);
+
+    // facet values of non-string fields are held natively in their hashes
+    static double facet_hash_to_num(uint64_t raw_value, facet_num_type_t num_type);
+
+    static std::string facet_hash_to_str(uint64_t raw_value, facet_num_type_t num_type);
+
+    static void compute_facet_stats(facet &a_facet, double value);
+
+    // returns `ranges.size()` when the value does not fall within any of the ranges
+    static size_t get_facet_range_index(const std::vector<facet_range_t>& ranges, double value);
 
     static void get_doc_changes(const index_operation_t op, nlohmann::json &update_doc,
                                 const nlohmann::json &old_doc, nlohmann::json &new_doc, nlohmann::json &del_doc);
@@ -534,9 +749,6 @@ private:
 
     bool common_results_exist(std::vector<art_leaf*>& leaves, bool must_match_phrase) const;
 
-    static void remove_facet_token(const field& search_field, spp::sparse_hash_map<std::string, art_tree*>& search_index,
-                                   const std::string& token, uint32_t seq_id);
-
 public:
     // for limiting number of results on multiple candidates / query rewrites
     enum {TYPO_TOKENS_THRESHOLD = 1};
@@ -557,6 +769,14 @@ public:
     // in the query that have the least individual hits one by one until enough results are found.
     static const int DROP_TOKENS_THRESHOLD = 1;
 
+    // An AND filter probes its costlier side with the ids matched by its cheaper side when those are fewer than
+    // the estimated ids of the costlier side by this factor, since probing an id costs more than materializing it.
+    static constexpr size_t FILTER_PROBE_COST_RATIO = 4;
+
+    // A text query checks a string filter matching at least these many ids, and half of all the ids, lazily against
+    // its matches, since materializing such a filter upfront can cost more than the query itself.
+    static constexpr size_t LAZY_FILTER_MIN_IDS = 100000;
+
     Index() = delete;
 
     Index(const std::string& name,
@@ -607,6 +827,20 @@ public:
 
     const spp::sparse_hash_map<std::string, hnsw_index_t*>& _get_vector_index() const;
 
+    const spp::sparse_hash_map<std::string, typo_index_t*>& _get_typo_index() const;
+
+    nlohmann::json get_typo_index_stats() const;
+
+    void get_token_expansion_cache_stats(uint64_t& hits, uint64_t& narrowed_hits, uint64_t& misses) const;
+
+    void get_filter_result_cache_stats(uint64_t& hits, uint64_t& misses, uint64_t& evictions,
+                                       uint64_t& invalidations, size_t& num_bytes) const;
+
+    const spp::sparse_hash_map<std::string, token_offset_index_t*>& _get_token_offset_index() const;
+
+    bool seek_token_offset(const std::string& field_name, uint32_t seq_id, size_t array_index, size_t token_index,
+                           size_t& checkpoint_token_index, size_t& checkpoint_offset) const;
+
     static int get_bounded_typo_cost(const size_t max_cost, const size_t token_len,
                                      size_t min_len_1typo, size_t min_len_2typo);
 
@@ -655,10 +889,27 @@ public:
                 size_t max_candidates, const std::vector<enable_t>& infixes, const size_t max_extra_prefix,
                 const size_t max_extra_suffix, const size_t facet_query_num_typos,
                 const bool filter_curated_hits, enable_t split_join_tokens,
-                const vector_query_t& vector_query) const;
+                const vector_query_t& vector_query, vector_search_info_t& vector_search_info) const;
 
     void remove_field(uint32_t seq_id, const nlohmann::json& document, const std::string& field_name);
 
+    // reads the original values of a vector field from the stored document, used to re-rank quantized vectors:
+    // only the values of the field are parsed, and a nested field is looked up by its path
+    bool get_stored_vector(const std::string& field_name, uint32_t seq_id, std::vector<float>& values) const;
+
+    // saves the graphs of vector fields into `dir_path`, appending an entry per saved graph to `saved_indices`
+    void save_vector_indices(const std::string& dir_path, nlohmann::json& saved_indices) const;
+
+    // restores graphs saved by `save_vector_indices()` that still match the schema, before documents are indexed
+    void restore_vector_indices(const std::string& dir_path, const nlohmann::json& saved_indices, bool fresh);
+
+    void finish_vector_index_restore();
+
+    // while deferred, `ef` of vector fields is not tuned: it is tuned when the deferral ends
+    void defer_vector_index_tuning(bool defer);
+
+    void set_lazy_filter_min_ids(size_t min_ids);
+
     Option<uint32_t> remove(const uint32_t seq_id, const nlohmann::json & document,
                             const std::vector<field>& del_fields, const bool is_update);
 
@@ -698,6 +949,9 @@ public:
             uint32_t& filter_ids_length,
             filter_node_t const* const& filter_tree_root) const;
 
+    // describes the order and the strategy in which the filter tree is evaluated, along with the estimates
+    void explain_filter_with_lock(filter_node_t const* const& filter_tree_root, nlohmann::json& plan) const;
+
     void refresh_schemas(const std::vector<field>& new_fields, const std::vector<field>& del_fields);
 
     // the following methods are not synchronized because their parent calls are synchronized or they are const/static
@@ -787,7 +1041,8 @@ public:
                            spp::sparse_hash_set<uint64_t>& groups_processed,
                            std::vector<std::vector<art_leaf*>>& searched_queries,
                            uint32_t*& all_result_ids, size_t& all_result_ids_len,
-                           const uint32_t* filter_ids, uint32_t filter_ids_length, 
+                           const uint32_t* filter_ids, uint32_t filter_ids_length,
+                           filter_result_iterator_t* const filter_iterator,
                            std::set<uint64>& query_hashes,
                            const int* sort_order,
                            std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3>& field_values,
@@ -805,6 +1060,7 @@ public:
                              const uint32_t* exclude_token_ids,
                              size_t exclude_token_ids_size,
                              const uint32_t* filter_ids, size_t filter_ids_length,
+                             filter_result_iterator_t* const filter_iterator,
                              const std::vector<uint32_t>& curated_ids,
                              const std::vector<sort_by>& sort_fields,
                              const std::vector<uint32_t>& num_typos,
@@ -828,11 +1084,24 @@ public:
                              std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3>& field_values,
                              const std::vector<size_t>& geopoint_indices) const;
 
+    static void expand_token_leaves(art_tree* t, const typo_index_t* field_typo_index, const std::string& token,
+                                    const size_t token_len, const int cost, const int max_words,
+                                    const token_ordering token_order, const bool prefix_search,
+                                    const uint32_t* filter_ids, const size_t filter_ids_length,
+                                    std::vector<art_leaf*>& field_leaves, const std::set<std::string>& exclude_leaves);
+
+    void fuzzy_search_leaves(const std::string& field_name, const std::string& token, const size_t token_len,
+                             const int cost, const int max_words, const token_ordering token_order,
+                             const bool prefix_search, const uint32_t* filter_ids, const size_t filter_ids_length,
+                             std::vector<art_leaf*>& field_leaves,
+                             const std::set<std::string>& exclude_leaves) const;
+
     void find_across_fields(const token_t& previous_token,
                             const std::string& previous_token_str,
                             const std::vector<search_field_t>& the_fields,
                             const size_t num_search_fields,
                             const uint32_t* filter_ids, uint32_t filter_ids_length,
+                            filter_result_iterator_t* const filter_iterator,
                             const uint32_t* exclude_token_ids,
                             size_t exclude_token_ids_size,
                             std::vector<uint32_t>& prev_token_doc_ids,
@@ -854,6 +1123,7 @@ public:
                               bool prioritize_exact_match,
                               const bool search_all_candidates,
                               const uint32_t* filter_ids, uint32_t filter_ids_length,
+                              filter_result_iterator_t* const filter_iterator,
                               const uint32_t total_cost,
                               const int syn_orig_num_tokens,
                               const uint32_t* exclude_token_ids,
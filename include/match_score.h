@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <vector>
+#include <memory_resource>
 #include <queue>
 #include <algorithm>
 #include <cstdlib>
@@ -127,6 +128,18 @@ struct Match {
 
     Match(uint32_t doc_id, const std::vector<token_positions_t>& token_offsets,
           bool populate_window=true, bool check_exact_match=false) {
+        score(token_offsets, populate_window, check_exact_match);
+    }
+
+    Match(uint32_t doc_id, const std::pmr::vector<token_positions_t>& token_offsets,
+          bool populate_window=true, bool check_exact_match=false) {
+        score(token_offsets, populate_window, check_exact_match);
+    }
+
+private:
+
+    template<class T>
+    void score(const T& token_offsets, bool populate_window, bool check_exact_match) {
         // in case if number of tokens in query is greater than max window
         const size_t tokens_size = std::min(token_offsets.size(), WINDOW_SIZE);
 
@@ -136,8 +149,10 @@ struct Match {
         }
 
         std::vector<TokenOffset> best_window;
+        std::vector<TokenOffset> this_window;
         if(populate_window) {
             best_window = window;
+            this_window.resize(tokens_size);
         }
 
         size_t best_num_match = 1;
@@ -169,7 +184,11 @@ struct Match {
 
             size_t this_displacement = 0;
             size_t this_num_match = 0;
-            std::vector<TokenOffset> this_window(tokens_size);
+
+            if(populate_window) {
+                // reuses the storage of the previous iteration
+                this_window.assign(tokens_size, TokenOffset{});
+            }
 
             uint16_t prev_offset = window[0].offset;
             bool all_offsets_are_same = true;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <map>
+#include <mutex>
 #include "sparsepp.h"
 #include "sorted_array.h"
 #include "array_utils.h"
@@ -11,8 +12,34 @@ class num_tree_t {
 private:
     std::map<int64_t, void*> int64map;
 
+    // number of (value, id) pairs, which can exceed the number of ids for array fields
+    size_t num_ids = 0;
+
+    struct bucket_t {
+        int64_t min_value;
+        int64_t max_value;
+        size_t num_ids;
+    };
+
+    // equi-depth histogram of the ids over the values, used to estimate the selectivity of range filters
+    std::mutex histogram_mutex;
+    std::vector<bucket_t> histogram;
+
+    // (value, id) pairs inserted or removed since the histogram was built
+    size_t num_histogram_updates = 0;
+
+    // requires `histogram_mutex` to be held
+    void refresh_histogram();
+
+    size_t estimate_histogram_range(int64_t start, int64_t end);
+
 public:
 
+    static constexpr size_t NUM_HISTOGRAM_BUCKETS = 64;
+
+    // the histogram is rebuilt once this fraction of the (value, id) pairs has changed since it was built
+    static constexpr double HISTOGRAM_STALE_RATIO = 0.1;
+
     ~num_tree_t();
 
     void insert(int64_t value, uint32_t id);
@@ -26,4 +53,11 @@ public:
     void remove(uint64_t value, uint32_t id);
 
     size_t size();
+
+    size_t get_num_ids() const;
+
+    // approximate number of ids matched by `search()` and `range_inclusive_search()`: exact for equality
+    size_t estimate(NUM_COMPARATOR comparator, int64_t value);
+
+    size_t estimate_range_inclusive(int64_t start, int64_t end);
 };
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 #include <stdint.h>
+#include <string>
+#include <utility>
 
 template <typename T=uint32_t>
 class Option {
@@ -19,6 +21,10 @@ public:
 
     }
 
+    explicit Option(T && value): value(std::move(value)), is_ok(true) {
+
+    }
+
     Option(const uint32_t code, const std::string & error_msg): is_ok(false), error_msg(error_msg), error_code(code) {
 
     }
@@ -38,6 +44,11 @@ public:
         return value;
     }
 
+    // moves the value out, for values which are expensive to copy
+    T take() {
+        return std::move(value);
+    }
+
     std::string error() const {
         return error_msg;
     }
@@ -2,6 +2,7 @@
 
 #include <map>
 #include <unordered_map>
+#include <memory_resource>
 #include "sorted_array.h"
 #include "array.h"
 #include "match_score.h"
@@ -9,6 +10,8 @@
 
 typedef uint32_t last_id_t;
 
+class filter_result_iterator_t;
+
 struct result_iter_state_t {
     const uint32_t* excluded_result_ids = nullptr;
     const size_t excluded_result_ids_size = 0;
@@ -16,6 +19,9 @@ struct result_iter_state_t {
     const uint32_t* filter_ids = nullptr;
     const size_t filter_ids_length = 0;
 
+    // checked instead of `filter_ids` when the filter is evaluated lazily
+    filter_result_iterator_t* filter_iterator = nullptr;
+
     size_t excluded_result_ids_index = 0;
     size_t filter_ids_index = 0;
 
@@ -178,6 +184,12 @@ public:
         std::map<size_t, std::vector<token_positions_t>>& array_token_pos
     );
 
+    // same as above, but the positions are collected into scratch containers, e.g. of a `search_arena_t`
+    static bool get_offsets(
+        const std::vector<iterator_t>& its,
+        std::pmr::map<size_t, std::pmr::vector<token_positions_t>>& array_token_pos
+    );
+
     static bool is_single_token_verbatim_match(const posting_list_t::iterator_t& it, bool field_is_array);
 
     static void get_exact_matches(std::vector<iterator_t>& its, bool field_is_array,
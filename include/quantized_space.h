@@ -0,0 +1,106 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include "hnswlib/hnswlib.h"
+#include "vector_quantizer.h"
+
+/*
+ * hnswlib spaces over quantized codes, so that the graph stores and traverses codes instead of float vectors.
+ *
+ * Both spaces use the same `1 - <a, b>` distance as `hnswlib::InnerProductSpace`, computed over the decoded values.
+ * Vectors must be encoded with `encode()` before insertion and queries with `encode_query()` before search.
+ */
+class quantized_space_t: public hnswlib::SpaceInterface<float> {
+public:
+    virtual ~quantized_space_t() = default;
+
+    // `code` must have space for `get_data_size()` bytes
+    virtual void encode(const float* src, char* code) const = 0;
+
+    // `query_code` is valid only for as long as `query_buffer` is not modified
+    virtual void encode_query(const float* query, std::vector<char>& query_code,
+                              std::vector<float>& query_buffer) const = 0;
+
+    virtual bool trained() const = 0;
+
+    virtual void train(const float* vectors, size_t num_vectors) = 0;
+
+    virtual size_t memory_used() const = 0;
+
+    // persists the trained state, if any, alongside the graph
+    virtual void serialize(std::ostream& out) const = 0;
+
+    virtual bool deserialize(std::istream& in) = 0;
+};
+
+class int8_space_t: public quantized_space_t {
+private:
+    size_t num_dim;
+
+    static float distance(const void* code_a, const void* code_b, const void* param);
+
+public:
+    explicit int8_space_t(size_t num_dim);
+
+    size_t get_data_size() override;
+
+    hnswlib::DISTFUNC<float> get_dist_func() override;
+
+    void* get_dist_func_param() override;
+
+    void encode(const float* src, char* code) const override;
+
+    void encode_query(const float* query, std::vector<char>& query_code,
+                      std::vector<float>& query_buffer) const override;
+
+    bool trained() const override;
+
+    void train(const float* vectors, size_t num_vectors) override;
+
+    size_t memory_used() const override;
+
+    void serialize(std::ostream& out) const override;
+
+    bool deserialize(std::istream& in) override;
+};
+
+/*
+ * Stored codes are laid out as [STORED_MARKER][num_subspaces centroid ids]. Queries are laid out as
+ * [QUERY_MARKER][pointer to the query's inner product table] instead, so that the graph traversal compares the
+ * query asymmetrically against the stored codes while codes are compared symmetrically during insertion.
+ */
+class pq_space_t: public quantized_space_t {
+private:
+    pq_codebook_t codebook;
+    size_t data_size;
+
+    static float distance(const void* code_a, const void* code_b, const void* param);
+
+public:
+    static constexpr uint8_t STORED_MARKER = 0;
+    static constexpr uint8_t QUERY_MARKER = 1;
+
+    explicit pq_space_t(size_t num_dim);
+
+    size_t get_data_size() override;
+
+    hnswlib::DISTFUNC<float> get_dist_func() override;
+
+    void* get_dist_func_param() override;
+
+    void encode(const float* src, char* code) const override;
+
+    void encode_query(const float* query, std::vector<char>& query_code,
+                      std::vector<float>& query_buffer) const override;
+
+    bool trained() const override;
+
+    void train(const float* vectors, size_t num_vectors) override;
+
+    size_t memory_used() const override;
+
+    void serialize(std::ostream& out) const override;
+
+    bool deserialize(std::istream& in) override;
+};
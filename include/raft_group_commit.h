@@ -0,0 +1,95 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+#include "http_data.h"
+#include "histogram.h"
+
+struct group_commit_write_t {
+    std::shared_ptr<http_req> req;
+    std::shared_ptr<http_res> res;
+
+    // when the write was queued, for the commit latency
+    uint64_t queued_us = 0;
+};
+
+/*
+ * Coalesces concurrent writes on the leader into a single raft log entry, so that a burst of small writes pays for
+ * one log append, replication round trip and fsync instead of one each.
+ *
+ * A batch is proposed once it reaches `max_batch_size` writes or `max_batch_bytes` of request bodies, or when its
+ * oldest write has waited for `max_delay_us`. The batched entry is a JSON object whose `batch` array holds the
+ * serialized requests in their original order, which are fanned back out when the entry is applied.
+ *
+ * Only writes whose whole body is already available are batched: streamed imports need their chunks to be proposed
+ * as they arrive.
+ *
+ * Followers use the same batching to coalesce the writes that they forward to the leader, in which case the
+ * "commit latency" is the time until the leader's response arrives.
+ */
+class RaftGroupCommit {
+public:
+    typedef std::function<void(std::vector<group_commit_write_t>& writes)> propose_t;
+
+private:
+    const uint64_t max_delay_us;
+    const size_t max_batch_size;
+    const size_t max_batch_bytes;
+
+    propose_t propose;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    // serializes proposals, so that batches enter the log in the order in which they were cut
+    std::mutex propose_mutex;
+
+    std::vector<group_commit_write_t> pending;
+    size_t pending_bytes = 0;
+    bool quit = false;
+
+    std::thread flush_thread;
+
+    histogram_t batch_size_histogram;
+    histogram_t batch_bytes_histogram;
+    histogram_t commit_latency_us_histogram;
+
+    void run();
+
+    // requires `mutex` to be held
+    void take_pending(std::vector<group_commit_write_t>& writes);
+
+    void propose_writes(std::vector<group_commit_write_t>& writes);
+
+public:
+    static constexpr const char* BATCH_KEY = "batch";
+
+    // writes are identified by their slot in the batch when indexed, see `BatchedIndexer::get_write_position`
+    static constexpr size_t MAX_BATCH_SIZE = 1 << 16;
+
+    // `max_delay_us` of 0 disables batching
+    RaftGroupCommit(uint64_t max_delay_us, size_t max_batch_size, size_t max_batch_bytes, propose_t propose);
+
+    ~RaftGroupCommit();
+
+    bool enabled() const;
+
+    static bool can_batch(const std::shared_ptr<http_req>& req);
+
+    void add(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res);
+
+    // proposes whatever is pending and stops the flush thread
+    void stop();
+
+    // called when a batch is applied on the leader
+    void on_commit(const std::vector<group_commit_write_t>& writes);
+
+    void get_stats(nlohmann::json& stats) const;
+
+    static std::string serialize(const std::vector<group_commit_write_t>& writes);
+
+    static bool is_batch(const nlohmann::json& content);
+};
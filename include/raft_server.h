@@ -6,6 +6,7 @@
 #include <braft/storage.h>               // braft::SnapshotWriter
 #include <braft/util.h>                  // braft::AsyncClosureGuard
 #include <braft/protobuf_file.h>         // braft::ProtoBufFile
+#include <braft/snapshot_throttle.h>     // braft::ThrottleSnapshotThrottle
 #include <rocksdb/db.h>
 #include <future>
 
@@ -14,6 +15,8 @@
 #include "http_server.h"
 #include "batched_indexer.h"
 #include "cached_resource_stat.h"
+#include "raft_group_commit.h"
+#include "snapshot_file_checksums.h"
 
 class Store;
 class ReplicationState;
@@ -44,6 +47,23 @@ public:
     void Run();
 };
 
+// Callback for a log entry that carries a batch of writes
+class GroupCommitClosure : public braft::Closure {
+private:
+    const std::vector<group_commit_write_t> writes;
+
+public:
+    explicit GroupCommitClosure(std::vector<group_commit_write_t>&& writes): writes(std::move(writes)) {
+
+    }
+
+    const std::vector<group_commit_write_t>& get_writes() const {
+        return writes;
+    }
+
+    void Run();
+};
+
 // Closure that fires when refresh nodes operation finishes
 class RefreshNodesClosure : public braft::Closure {
 public:
@@ -99,6 +119,7 @@ public:
 class ReplicationState : public braft::StateMachine {
 private:
     static constexpr const char* db_snapshot_name = "db_snapshot";
+    static constexpr const char* vector_index_snapshot_name = "vector_index";
 
     mutable std::shared_mutex node_mutex;
 
@@ -136,6 +157,23 @@ private:
     std::atomic<bool> shutting_down;
     std::atomic<size_t> pending_writes;
 
+    // log index of the last entry applied to the state machine, which is what a snapshot saved now includes
+    std::atomic<int64_t> last_applied_index = 0;
+
+    RaftGroupCommit group_commit;
+
+    // on a follower, coalesces concurrent single document writes into imports forwarded to the leader
+    RaftGroupCommit forward_batcher;
+
+    // round trips to the leader of writes forwarded on their own and of coalesced imports
+    histogram_t forward_latency_us;
+    histogram_t forward_batch_latency_us;
+
+    // lets followers reuse the SST files that they already have when installing a snapshot
+    SnapshotFileChecksums snapshot_file_checksums;
+
+    scoped_refptr<braft::SnapshotThrottle> snapshot_throttle;
+
     const uint64_t snapshot_interval_s;     // frequency of actual snapshotting
     uint64_t last_snapshot_ts;              // when last snapshot ran
 
@@ -229,6 +267,10 @@ public:
 
     nlohmann::json get_status();
 
+    void get_group_commit_stats(nlohmann::json& stats) const;
+
+    void get_forward_stats(nlohmann::json& stats) const;
+
 private:
 
     friend class ReplicationClosure;
@@ -241,6 +283,7 @@ private:
         braft::SnapshotWriter* writer;
         std::string state_dir_path;
         std::string db_snapshot_path;
+        std::string vector_index_snapshot_path;
         std::string ext_snapshot_path;
         braft::Closure* done;
     };
@@ -284,6 +327,18 @@ private:
 
     void write_to_leader(const std::shared_ptr<http_req>& request, const std::shared_ptr<http_res>& response);
 
+    // proposes the writes batched by `group_commit` as a single log entry
+    void propose_write_batch(std::vector<group_commit_write_t>& writes);
+
+    void apply_write_batch(nlohmann::json& content, int64_t log_index);
+
+    bool can_forward_in_batch(const std::shared_ptr<http_req>& request) const;
+
+    // hands the writes coalesced by `forward_batcher` over to the thread pool, grouped by their target
+    void forward_write_batch(std::vector<group_commit_write_t>& writes);
+
+    void forward_writes(std::vector<group_commit_write_t>& writes);
+
     void do_dummy_write();
 
     std::string get_node_url_path(const std::string& node_addr, const std::string& path,
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <optional>
+#include <memory_resource>
+
+/*
+ * Scoped arena for the short lived scratch containers of a search request.
+ *
+ * Constructing an arena installs it as the current memory resource of the calling thread until it goes out of
+ * scope. Scoring code allocates its per candidate scratch state via `search_arena_t::resource()`, which is served
+ * from the arena when one is installed and from the default heap otherwise. Memory handed back to the arena is
+ * recycled within the request and is released in one go when the arena is destroyed.
+ *
+ * An arena must only be used from the thread that created it: worker threads of a search install their own.
+ * Arenas created while another one is installed on the same thread are no-ops, so that the outermost scope owns
+ * the lifetime of all the scratch memory.
+ */
+class search_arena_t {
+private:
+    std::optional<std::pmr::monotonic_buffer_resource> monotonic_resource;
+    std::optional<std::pmr::unsynchronized_pool_resource> pool_resource;
+
+    static thread_local search_arena_t* current;
+
+public:
+
+    // size of the reusable per thread buffer that serves the first allocations of an arena
+    static constexpr size_t INITIAL_BUFFER_SIZE = 64 * 1024;
+
+    // allows comparing against the default heap, e.g. from benchmarks
+    static std::atomic<bool> enabled;
+
+    search_arena_t();
+
+    ~search_arena_t();
+
+    search_arena_t(const search_arena_t&) = delete;
+
+    search_arena_t& operator=(const search_arena_t&) = delete;
+
+    bool active() const;
+
+    static std::pmr::memory_resource* resource();
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <list>
+#include <atomic>
+#include <chrono>
+#include <array>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include "http_data.h"
+
+/*
+ * Cache of search responses, keyed by the hash of the request.
+ *
+ * Besides expiring by TTL, an entry is valid only while the write generations of the collections that were searched
+ * are the same as when the search began: any write to one of the collections makes the entry stale, so that long
+ * TTLs can be used without serving outdated results.
+ *
+ * Entries are spread across shards that are locked independently, and every shard evicts its least recently used
+ * entries beyond its share of `max_bytes`. A response larger than a shard's share (`max_bytes / NUM_SHARDS`) is
+ * not cached at all, so `max_bytes` also caps the size of the responses that can be cached.
+ */
+class SearchResultCache {
+public:
+    typedef std::vector<std::pair<std::string, uint64_t>> generations_t;
+
+    // current write generation of a collection, 0 when it does not exist
+    typedef std::function<uint64_t(const std::string& collection_name)> generation_fn_t;
+
+    static const size_t DEFAULT_MAX_BYTES = 64 * 1024 * 1024;
+    static const size_t NUM_SHARDS = 16;
+
+private:
+
+    struct entry_t {
+        uint64_t hash;
+        cached_res_t res;
+        generations_t generations;
+        size_t num_bytes;
+    };
+
+    struct shard_t {
+        std::mutex mutex;
+
+        // most recently used first
+        std::list<entry_t> entries;
+        std::unordered_map<uint64_t, std::list<entry_t>::iterator> entry_map;
+
+        size_t num_bytes = 0;
+    };
+
+    struct collection_stats_t {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t invalidations = 0;
+        uint64_t expirations = 0;
+    };
+
+    std::array<shard_t, NUM_SHARDS> shards;
+
+    std::atomic<size_t> max_bytes;
+
+    // across all collections, since the collections of a request are not known when its lookup fails
+    std::atomic<uint64_t> num_hits = 0;
+    std::atomic<uint64_t> num_misses = 0;
+
+    generation_fn_t get_generation;
+
+    std::mutex stats_mutex;
+    std::unordered_map<std::string, collection_stats_t> collection_stats;
+
+    shard_t& get_shard(uint64_t hash);
+
+    // requires the shard's lock to be held
+    void erase_entry(shard_t& shard, std::list<entry_t>::iterator entry_it);
+
+    void record(const generations_t& generations, uint64_t collection_stats_t::* counter);
+
+    static size_t get_num_bytes(const entry_t& entry);
+
+public:
+
+    SearchResultCache(size_t max_bytes, generation_fn_t get_generation);
+
+    // generations of the given collections, which must be taken before searching them
+    generations_t get_generations(const std::vector<std::string>& collection_names) const;
+
+    bool lookup(uint64_t hash, cached_res_t& res);
+
+    // counts a failed lookup against the collections that are then searched
+    void record_miss(const generations_t& generations);
+
+    // a response larger than `max_bytes / NUM_SHARDS` is not cached
+    void insert(uint64_t hash, const cached_res_t& res, const generations_t& generations);
+
+    // stats of a dropped collection
+    void remove_collection_stats(const std::string& collection_name);
+
+    void set_max_bytes(size_t max_bytes);
+
+    void clear();
+
+    size_t size();
+
+    size_t get_num_bytes();
+
+    void get_stats(nlohmann::json& stats);
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+/*
+ * Checksums of the files of a DB checkpoint. A follower which installs a snapshot keeps the files whose name and
+ * checksum match a file of its own last snapshot (or of an interrupted install) instead of downloading them again,
+ * so that only the files that changed since are copied.
+ *
+ * SST files are immutable and are hard linked into a checkpoint, so their checksums are computed once and cached by
+ * file name, size and inode. Other files (MANIFEST, OPTIONS etc.) are small and are not given a checksum, which
+ * makes them always copied.
+ */
+class SnapshotFileChecksums {
+private:
+    std::mutex mutex;
+    std::unordered_map<std::string, std::string> checksums;
+
+    // cache keys looked up since the last `prune()`
+    std::unordered_set<std::string> used_keys;
+
+    static const size_t READ_BUFFER_SIZE = 1024 * 1024;
+
+public:
+
+    static bool is_immutable(const std::string& file_path);
+
+    // SHA-256 of the file's contents followed by its size: a follower trusts a matching checksum to mean that its
+    // file is identical, so a checksum that is prone to collisions would silently corrupt its copy of the DB
+    static bool compute(const std::string& file_path, std::string& checksum);
+
+    // returns false when the file must not be given a checksum
+    bool get(const std::string& file_path, std::string& checksum);
+
+    // forgets the checksums of files that were not looked up since the previous call
+    void prune();
+
+    size_t size();
+};
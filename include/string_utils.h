@@ -74,6 +74,9 @@ struct StringUtils {
 
     static void split_to_values(const std::string& vals_str, std::vector<std::string>& filter_values);
 
+    // splits on the commas that are not within parentheses, e.g. `price(0-10,10+),brand` has 2 values
+    static void split_facet_by(const std::string& facet_by, std::vector<std::string>& facet_fields);
+
     // Adapted from: http://stackoverflow.com/a/36000453/131050
     static std::string & trim(std::string & str) {
         // right trim
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <set>
+#include <mutex>
+#include <memory>
+#include <atomic>
+#include "art.h"
+#include "lru/lru.hpp"
+
+struct token_expansion_t {
+    // index write generation the expansion was computed against
+    uint64_t generation = 0;
+
+    // leaf of the token itself: only present for zero cost expansions
+    art_leaf* exact_leaf = nullptr;
+
+    // expanded leaves (excluding `exact_leaf`) in the order produced by `art_fuzzy_search`
+    std::vector<art_leaf*> leaves;
+};
+
+/*
+ * Bounded cache of token => candidate leaf expansions of a single field, shared across queries.
+ *
+ * Expansions are computed without any filter or exclusion so that they can be reused by any query: those are
+ * applied when the expansion is read. Every write to the field bumps the generation, which makes all the
+ * expansions computed so far stale, since the cached leaves could have been deleted or re-ordered.
+ */
+class token_expansion_cache_t {
+private:
+    std::mutex mutex;
+    LRU::Cache<std::string, std::shared_ptr<const token_expansion_t>> cache;
+
+    std::atomic<uint64_t> generation = 0;
+
+    std::atomic<uint64_t> num_hits = 0;
+    std::atomic<uint64_t> num_narrowed_hits = 0;
+    std::atomic<uint64_t> num_misses = 0;
+
+    static std::string get_key(const std::string& token, int cost, bool prefix,
+                               token_ordering token_order, size_t max_words);
+
+    std::shared_ptr<const token_expansion_t> find(const std::string& key, uint64_t current_generation);
+
+    void insert(const std::string& key, const std::shared_ptr<const token_expansion_t>& expansion);
+
+    std::shared_ptr<const token_expansion_t> narrow_parent(const std::string& token, token_ordering token_order,
+                                                           size_t max_words, uint64_t current_generation);
+
+public:
+
+    static constexpr size_t DEFAULT_CAPACITY = 512;
+
+    // large expansions are cheap to recompute relative to the memory they hold
+    static constexpr size_t MAX_CACHED_LEAVES = 4096;
+
+    explicit token_expansion_cache_t(size_t capacity = DEFAULT_CAPACITY);
+
+    uint64_t get_generation() const;
+
+    void invalidate();
+
+    std::shared_ptr<const token_expansion_t> get(const std::string& token, int cost, bool prefix,
+                                                 token_ordering token_order, size_t max_words);
+
+    // `leaves` must be the unfiltered output of `art_fuzzy_search` for the given parameters
+    std::shared_ptr<const token_expansion_t> put(const std::string& token, int cost, bool prefix,
+                                                 token_ordering token_order, size_t max_words,
+                                                 uint64_t computed_generation, art_leaf* exact_leaf,
+                                                 std::vector<art_leaf*>&& leaves);
+
+    static void apply(const token_expansion_t& expansion, size_t max_words,
+                      const uint32_t* filter_ids, size_t filter_ids_length,
+                      const std::set<std::string>& exclude_leaves, std::vector<art_leaf*>& results);
+
+    uint64_t hits() const;
+
+    uint64_t narrowed_hits() const;
+
+    uint64_t misses() const;
+
+    size_t size();
+};
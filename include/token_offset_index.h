@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "sparsepp.h"
+
+/*
+ * Byte offsets of every `CHECKPOINT_INTERVAL`-th token of the values of a string field, recorded at index time.
+ *
+ * Highlighting uses them to resume tokenization of a stored value close to the first matched token, instead of
+ * tokenizing the value from the start. Values with fewer tokens than the interval have no checkpoints.
+ */
+class token_offset_index_t {
+private:
+    // seq_id => array index => byte offsets of the tokens at positions INTERVAL, 2 * INTERVAL, ...
+    spp::sparse_hash_map<uint32_t, std::vector<std::vector<uint32_t>>> checkpoints;
+
+    size_t num_checkpoints = 0;
+
+public:
+
+    static constexpr size_t CHECKPOINT_INTERVAL = 16;
+
+    // `value_checkpoints` holds the checkpoints of every value of the field, in array order
+    void insert(uint32_t seq_id, const std::vector<std::vector<uint32_t>>& value_checkpoints);
+
+    void remove(uint32_t seq_id);
+
+    // finds the closest checkpoint at or before the token at `token_index`
+    bool seek(uint32_t seq_id, size_t array_index, size_t token_index,
+              size_t& checkpoint_token_index, size_t& checkpoint_offset) const;
+
+    size_t num_docs() const;
+
+    size_t memory_used() const;
+};
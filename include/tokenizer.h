@@ -2,6 +2,7 @@
 
 #include <string>
 #include <vector>
+#include <memory>
 #include <iconv.h>
 #include <unicode/brkiter.h>
 #include <unicode/normalizer2.h>
@@ -9,6 +10,17 @@
 #include "japanese_localizer.h"
 #include "logger.h"
 
+class Tokenizer;
+
+// returns a pooled tokenizer to the pool of the releasing thread
+struct tokenizer_releaser_t {
+    std::string pool_key;
+
+    void operator()(Tokenizer* tokenizer) const;
+};
+
+using pooled_tokenizer_t = std::unique_ptr<Tokenizer, tokenizer_releaser_t>;
+
 class Tokenizer {
 private:
     std::string_view text;
@@ -17,7 +29,12 @@ private:
     const bool no_op;
 
     size_t token_counter = 0;
-    iconv_t cd;
+
+    // opened lazily, since it is not needed for pure ASCII text
+    iconv_t cd = (iconv_t)(-1);
+
+    // whether `text` has no byte >= 0x80, which allows tokenization without unicode handling
+    bool ascii_text = false;
 
     static const size_t INDEX = 0;
     static const size_t SEPARATE = 1;
@@ -47,12 +64,21 @@ private:
 
     icu::Transliterator* transliterator = nullptr;
 
+    // stream mode of every ASCII character, pre-computed from the symbols and separators
+    uint8_t ascii_stream_modes[128] = {};
+
+    static constexpr size_t MAX_POOLED_PER_CONFIG = 8;
+
     inline size_t get_stream_mode(char c) {
         return (std::isalnum(c) || index_symbols[uint8_t(c)] == 1) ? INDEX : (
             (c == ' ' || c == '\n' || separator_symbols[uint8_t(c)] == 1) ? SEPARATE : SKIP
         );
     }
 
+    bool next_ascii(std::string& token, size_t& token_index, size_t& start_index, size_t& end_index);
+
+    friend struct tokenizer_releaser_t;
+
 public:
 
     explicit Tokenizer(const std::string& input,
@@ -62,14 +88,32 @@ public:
                        const std::vector<char>& separators = {});
 
     ~Tokenizer() {
-        iconv_close(cd);
+        if(cd != (iconv_t)(-1)) {
+            iconv_close(cd);
+        }
+
         free(normalized_text);
         delete bi;
         delete transliterator;
     }
 
+    // returns a thread local tokenizer of the given configuration that is reset onto `input`
+    static pooled_tokenizer_t acquire(const std::string& input,
+                                      bool normalize=true, bool no_op=false,
+                                      const std::string& locale = "",
+                                      const std::vector<char>& symbols_to_index = {},
+                                      const std::vector<char>& separators = {});
+
     void init(const std::string& input);
 
+    // re-initializes the tokenizer on a new input, retaining the converters and break iterator
+    void reset(const std::string& input);
+
+    static bool is_ascii(const char* text, size_t len);
+
+    // resumes tokenization from the start of a token at the given byte offset: supported only for the default locale
+    void seek(size_t offset, size_t token_index);
+
     bool next(std::string& token, size_t& token_index, size_t& start_index, size_t& end_index);
 
     bool next(std::string& token, size_t& token_index);
@@ -5,6 +5,7 @@
 #include <cstdio>
 #include <algorithm>
 #include <unordered_map>
+#include <unordered_set>
 
 struct KV {
     int8_t match_score_index{};
@@ -102,6 +103,15 @@ struct Topster {
     spp::sparse_hash_map<uint64_t, Topster*> group_kv_map;
     size_t distinct;
 
+    // when set, only KVs that rank after the cursor are kept, i.e. the hits of the pages that follow the cursor
+    bool has_cursor = false;
+    KV cursor_kv;
+
+    // a key that is added more than once can rank before the cursor with one score and after it with another:
+    // such keys are remembered, so that the key is not kept for a page that follows the one it was returned in
+    bool track_cursor_keys = false;
+    std::unordered_set<uint64_t> cursor_keys;
+
     explicit Topster(size_t capacity): Topster(capacity, 0) {
     }
 
@@ -144,12 +154,35 @@ struct Topster {
         (*b)->array_index = a_index;
     }
 
+    void set_cursor(const int64_t* scores, uint64_t key) {
+        has_cursor = true;
+        cursor_kv.key = key;
+        cursor_kv.scores[0] = scores[0];
+        cursor_kv.scores[1] = scores[1];
+        cursor_kv.scores[2] = scores[2];
+    }
+
     bool add(KV* kv) {
         /*LOG(INFO) << "kv_map size: " << kv_map.size() << " -- kvs[0]: " << kvs[0]->scores[kvs[0]->match_score_index];
         for(auto& mkv: kv_map) {
             LOG(INFO) << "kv key: " << mkv.first << " => " << mkv.second->scores[mkv.second->match_score_index];
         }*/
 
+        if(has_cursor) {
+            if(!is_smaller(kv, &cursor_kv)) {
+                if(track_cursor_keys) {
+                    cursor_keys.insert(kv->key);
+                    remove(kv->key);
+                }
+
+                return false;
+            }
+
+            if(track_cursor_keys && cursor_keys.count(kv->key) != 0) {
+                return false;
+            }
+        }
+
         bool less_than_min_heap = (size >= MAX_SIZE) && is_smaller(kv, kvs[0]);
         size_t heap_op_index = 0;
 
@@ -228,35 +261,63 @@ struct Topster {
         // sift up/down to maintain heap property
 
         if(SIFT_DOWN) {
-            while ((2 * heap_op_index + 1) < size) {
-                uint32_t next = (2 * heap_op_index + 1);  // left child
-                if (next+1 < size && is_greater(kvs[next], kvs[next + 1])) {
-                    // for min heap we compare with the minimum of children
-                    next++;  // right child (2n + 2)
-                }
+            sift_down(heap_op_index);
+        } else {
+            sift_up(heap_op_index);
+        }
 
-                if (is_greater(kvs[heap_op_index], kvs[next])) {
-                    swapMe(&kvs[heap_op_index], &kvs[next]);
-                } else {
-                    break;
-                }
+        return true;
+    }
 
-                heap_op_index = next;
+    void sift_down(size_t heap_op_index) {
+        while ((2 * heap_op_index + 1) < size) {
+            uint32_t next = (2 * heap_op_index + 1);  // left child
+            if (next+1 < size && is_greater(kvs[next], kvs[next + 1])) {
+                // for min heap we compare with the minimum of children
+                next++;  // right child (2n + 2)
             }
-        } else {
-            // SIFT UP
-            while(heap_op_index > 0) {
-                uint32_t parent = (heap_op_index - 1) / 2;
-                if (is_greater(kvs[parent], kvs[heap_op_index])) {
-                    swapMe(&kvs[heap_op_index], &kvs[parent]);
-                    heap_op_index = parent;
-                } else {
-                    break;
-                }
+
+            if (is_greater(kvs[heap_op_index], kvs[next])) {
+                swapMe(&kvs[heap_op_index], &kvs[next]);
+            } else {
+                break;
             }
+
+            heap_op_index = next;
         }
+    }
 
-        return true;
+    void sift_up(size_t heap_op_index) {
+        while(heap_op_index > 0) {
+            uint32_t parent = (heap_op_index - 1) / 2;
+            if (is_greater(kvs[parent], kvs[heap_op_index])) {
+                swapMe(&kvs[heap_op_index], &kvs[parent]);
+                heap_op_index = parent;
+            } else {
+                break;
+            }
+        }
+    }
+
+    // removes the KV of a key from a non-distinct topster
+    void remove(uint64_t key) {
+        const auto& found_it = kv_map.find(key);
+        if(found_it == kv_map.end()) {
+            return;
+        }
+
+        const size_t heap_op_index = found_it->second->array_index;
+        kv_map.erase(found_it);
+        size--;
+
+        if(heap_op_index == size) {
+            return;
+        }
+
+        // the last element takes the place of the removed one
+        swapMe(&kvs[heap_op_index], &kvs[size]);
+        sift_down(heap_op_index);
+        sift_up(heap_op_index);
     }
 
     static bool is_greater(const struct KV* i, const struct KV* j) {
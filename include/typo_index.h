@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <set>
+#include "art.h"
+#include "sparsepp.h"
+
+/*
+ * Deletion neighbourhood (SymSpell style) index for short tokens of a field.
+ *
+ * Every indexed token is expanded into the strings obtained by removing up to `MAX_COST` characters from it
+ * and each such variant is mapped back to the originating tokens. Typo candidates of a short query token can then
+ * be resolved by a handful of hash lookups on the deletion variants of the query token instead of walking the
+ * field's ART with a levenshtein matrix.
+ */
+class typo_index_t {
+private:
+
+    const size_t max_token_len;
+
+    // hash of deletion variant => ids of tokens which produce the variant: colliding variants only add candidates,
+    // which are verified by their distance from the query token
+    spp::sparse_hash_map<uint64_t, std::vector<uint32_t>> variants;
+
+    // tokens are keyed by themselves, since tokens with colliding hashes must still be told apart
+    spp::sparse_hash_map<std::string, uint32_t> token_ids;
+
+    // id => token: ids of removed tokens are reused
+    std::vector<std::string> tokens;
+    std::vector<uint32_t> free_token_ids;
+
+    size_t num_variant_refs = 0;
+
+    static void compute_deletes(const std::string& token, size_t max_deletes, std::set<std::string>& deletes);
+
+public:
+
+    static constexpr size_t MAX_COST = 2;
+
+    static constexpr size_t MAX_TOKEN_LEN = 16;
+
+    explicit typo_index_t(size_t max_token_len);
+
+    size_t get_max_token_len() const;
+
+    // tokens longer than the query limit are still indexed, since they can be reached by insertions
+    bool indexable(const std::string& token) const;
+
+    bool searchable(const std::string& token) const;
+
+    void insert(const std::string& token);
+
+    void remove(const std::string& token);
+
+    void search(art_tree* t, const std::string& term, int cost, size_t max_words, token_ordering token_order,
+                const uint32_t* filter_ids, size_t filter_ids_length,
+                std::vector<art_leaf*>& results, const std::set<std::string>& exclude_leaves) const;
+
+    static int osa_distance(const std::string& a, const std::string& b);
+
+    size_t num_tokens() const;
+
+    size_t num_variants() const;
+
+    size_t memory_used() const;
+};
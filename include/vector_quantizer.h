@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <iosfwd>
+
+enum class vector_quantization_t {
+    none,
+    int8,
+    pq
+};
+
+/*
+ * Scalar quantization of a vector to signed 8-bit integers with a per vector scale.
+ *
+ * Code layout: [float scale][int8_t x num_dim], where value[i] ~= scale * code[i].
+ */
+struct scalar_quantizer_t {
+    static size_t code_size(size_t num_dim);
+
+    static void encode(const float* src, size_t num_dim, char* code);
+
+    static float inner_product(const char* code_a, const char* code_b, size_t num_dim);
+};
+
+/*
+ * Product quantization codebook: a vector is split into `num_subspaces` sub-vectors of `sub_dim` dimensions each
+ * and every sub-vector is encoded as the index of its nearest centroid in that subspace.
+ *
+ * Queries are compared against codes through a per query table of query / centroid inner products (asymmetric),
+ * while codes are compared against each other via their centroids (symmetric).
+ */
+class pq_codebook_t {
+private:
+    size_t num_dim;
+    size_t sub_dim;
+    size_t num_subspaces;
+    size_t num_centroids = 0;
+
+    // [subspace][centroid][sub_dim]
+    std::vector<float> centroids;
+
+    const float* centroid(size_t subspace, size_t centroid_id) const;
+
+    size_t nearest_centroid(size_t subspace, const float* sub_vector) const;
+
+public:
+
+    static constexpr size_t MAX_CENTROIDS = 256;
+
+    explicit pq_codebook_t(size_t num_dim);
+
+    bool trained() const;
+
+    // k-means over each subspace: needs at least a few times `MAX_CENTROIDS` vectors for good codes
+    void train(const float* vectors, size_t num_vectors, size_t num_iterations = 8);
+
+    size_t get_num_subspaces() const;
+
+    // `codes` must have space for `num_subspaces` bytes
+    void encode(const float* src, uint8_t* codes) const;
+
+    // `table` must have space for `table_size()` floats
+    size_t table_size() const;
+
+    void compute_inner_product_table(const float* query, float* table) const;
+
+    float table_inner_product(const float* table, const uint8_t* codes) const;
+
+    float code_inner_product(const uint8_t* codes_a, const uint8_t* codes_b) const;
+
+    size_t memory_used() const;
+
+    void serialize(std::ostream& out) const;
+
+    bool deserialize(std::istream& in);
+};
@@ -12,6 +12,12 @@ struct vector_query_t {
     size_t flat_search_cutoff = 0;
     std::vector<float> values;
 
+    // overrides the `ef` of the field's graph for this query when non-zero
+    size_t ef = 0;
+
+    // compares the results against an exhaustive scan and reports the recall with the response
+    bool measure_recall = false;
+
     uint32_t seq_id = 0;
     bool query_doc_given = false;
 
@@ -20,6 +26,8 @@ struct vector_query_t {
         field_name.clear();
         k = 0;
         values.clear();
+        ef = 0;
+        measure_recall = false;
         seq_id = 0;
         query_doc_given = false;
     }
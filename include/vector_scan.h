@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <utility>
+
+/*
+ * Exhaustive (flat) nearest neighbour scan used for vector queries with a small set of filtered candidates,
+ * where walking the HNSW graph would visit far more nodes than there are candidates.
+ *
+ * Distances are the same as those of `hnswlib::InnerProductSpace`, i.e. `1 - <query, vector>`, so that results
+ * of the flat scan and of the graph search can be used interchangeably. Inner products are computed a batch of
+ * vectors at a time, with AVX-512 or AVX2 FMA kernels picked at runtime when the CPU supports them.
+ */
+class vector_scan_t {
+public:
+
+    // number of vectors whose inner products are computed in a single pass over the query
+    static constexpr size_t BATCH_SIZE = 4;
+
+    // candidates are scanned in blocks of this size so that the distances of a block stay in the cache
+    static constexpr size_t BLOCK_SIZE = 256;
+
+    // the scan is split across threads only beyond this many candidates per thread
+    static constexpr size_t MIN_PARALLEL_CANDIDATES = 8192;
+
+    static float inner_product(const float* a, const float* b, size_t num_dim);
+
+    static int32_t int8_inner_product(const int8_t* a, const int8_t* b, size_t num_dim);
+
+    // writes <query, vectors[i]> into out[i]
+    static void inner_products(const float* query, const float* const* vectors, size_t num_vectors,
+                               size_t num_dim, float* out);
+
+    // `dist_labels` gets the (distance, label) pairs of the `k` closest vectors, closest first
+    static void top_k(const float* query, const float* const* vectors, const uint32_t* labels,
+                      size_t num_vectors, size_t num_dim, size_t k,
+                      std::vector<std::pair<float, size_t>>& dist_labels);
+
+    // merges the top k results of disjoint sets of candidates, closest first
+    static void merge_top_k(const std::vector<std::vector<std::pair<float, size_t>>>& partial_dist_labels,
+                            size_t k, std::vector<std::pair<float, size_t>>& dist_labels);
+
+    // name of the kernel chosen for this CPU: "avx512", "avx2" or "scalar"
+    static const char* kernel_name();
+};
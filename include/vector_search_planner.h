@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include "json.hpp"
+
+enum class vector_search_strategy_t {
+    // unfiltered graph search
+    hnsw,
+    // exhaustive scan over the filtered ids
+    flat,
+    // graph search restricted to the filtered ids, with a raised `ef` to make up for the skipped nodes
+    filtered_hnsw,
+    // unfiltered graph search over an oversampled candidate set, whose results are then filtered
+    post_filtered_hnsw
+};
+
+struct vector_search_plan_t {
+    vector_search_strategy_t strategy = vector_search_strategy_t::hnsw;
+
+    // number of candidates fetched from the graph (acts as `ef`) or kept by the flat scan
+    size_t num_candidates = 0;
+
+    // fraction of the indexed vectors that pass the filter
+    float selectivity = 1.0f;
+};
+
+// details of how a vector query was executed, returned with the search response
+struct vector_search_info_t {
+    bool executed = false;
+    vector_search_plan_t plan;
+    size_t num_filtered = 0;
+    size_t num_elements = 0;
+    uint64_t search_time_us = 0;
+
+    // fraction of the exact top k that was found, only when the query asks for it to be measured
+    bool recall_measured = false;
+    float recall = 0;
+
+    nlohmann::json to_json() const;
+};
+
+/*
+ * Picks how a (possibly filtered) vector query is executed, from the selectivity of the filter and the number of
+ * indexed vectors.
+ *
+ * The costs of the strategies are compared in distance computations: a flat scan computes one per filtered id,
+ * while a filtered graph search expands about `ef / selectivity` nodes, computing a distance to each of their
+ * `graph_degree` (the graph's `M`) neighbours.
+ */
+class vector_search_planner_t {
+public:
+
+    // filters that let through at least this fraction of the vectors are applied after the graph search
+    static constexpr float POST_FILTER_MIN_SELECTIVITY = 0.5f;
+
+    // extra candidates fetched when post filtering, on top of those expected to pass the filter
+    static constexpr float POST_FILTER_OVERSAMPLING = 1.5f;
+
+    // upper bound on the raised `ef` of a filtered graph search, as a multiple of `k`
+    static constexpr size_t MAX_EF_FACTOR = 10;
+
+    // `flat_search_cutoff` forces a flat scan for filters matching fewer ids, regardless of the costs
+    static vector_search_plan_t plan(bool filtered, size_t num_filtered, size_t num_elements, size_t k,
+                                     size_t graph_degree, size_t flat_search_cutoff);
+
+    static const char* strategy_name(vector_search_strategy_t strategy);
+};
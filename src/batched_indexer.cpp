@@ -2,6 +2,10 @@
 #include "core_api.h"
 #include "thread_local_vars.h"
 #include "cached_resource_stat.h"
+#include "raft_group_commit.h"
+
+static_assert(RaftGroupCommit::MAX_BATCH_SIZE <= (size_t(1) << BatchedIndexer::LOG_SLOT_BITS),
+              "slots of a group-committed log entry must fit in a write position");
 
 BatchedIndexer::BatchedIndexer(HttpServer* server, Store* store, Store* meta_store, const size_t num_threads,
                                const Config& config, const std::atomic<bool>& skip_writes):
@@ -10,6 +14,11 @@ BatchedIndexer::BatchedIndexer(HttpServer* server, Store* store, Store* meta_sto
                                config(config), skip_writes(skip_writes) {
     queues.resize(num_threads);
     qmutuxes = new await_t[num_threads];
+    merged_log_indices.reset(new std::atomic<int64_t>[num_threads]);
+    for(size_t i = 0; i < num_threads; i++) {
+        merged_log_indices[i] = 0;
+    }
+
     skip_index_iter_upper_bound = new rocksdb::Slice(skip_index_upper_bound_key);
 }
 
@@ -21,6 +30,19 @@ void BatchedIndexer::enqueue(const std::shared_ptr<http_req>& req, const std::sh
     //LOG(INFO) << "BatchedIndexer::enqueue";
     uint32_t chunk_sequence = 0;
 
+    // must be read before the body is handed over, since a collection's name is part of its creation request
+    const std::string coll_name = req->last_chunk_aggregate ? get_collection_name(req) : "";
+
+    // The chunk is held in memory until it is indexed, instead of being persisted to the store first: on a restart,
+    // entries after the last snapshot are applied again, while chunks still pending at the time of a snapshot are
+    // saved with the snapshot's state.
+    req_chunk_t chunk;
+    chunk.body = std::move(req->body);
+    chunk.log_index = req->log_index;
+    chunk.log_slot = req->log_slot;
+    chunk.first_chunk_aggregate = req->first_chunk_aggregate;
+    chunk.last_chunk_aggregate = req->last_chunk_aggregate;
+
     {
         uint64_t now = std::chrono::duration_cast<std::chrono::seconds>(
                 std::chrono::system_clock::now().time_since_epoch()).count();
@@ -31,20 +53,17 @@ void BatchedIndexer::enqueue(const std::shared_ptr<http_req>& req, const std::sh
         if(req_res_map_it == req_res_map.end()) {
             // first chunk
             req_res_t req_res(req->start_ts, "", req, res, now, 1, 0, false);
-            req_res_map.emplace(req->start_ts, req_res);
+            req_res_map_it = req_res_map.emplace(req->start_ts, req_res).first;
         } else {
             chunk_sequence = req_res_map_it->second.num_chunks;
             req_res_map_it->second.num_chunks += 1;
             req_res_map_it->second.last_updated = now;
         }
-    }
 
-    const std::string& req_key_prefix = get_req_prefix_key(req->start_ts);
-    const std::string& request_chunk_key = req_key_prefix + StringUtils::serialize_uint32_t(chunk_sequence);
-
-    //LOG(INFO) << "request_chunk_key: " << req->start_ts << "_" << chunk_sequence << ", req body: " << req->body;
+        req_res_map_it->second.chunks.push_back(std::move(chunk));
+    }
 
-    store->insert(request_chunk_key, req->to_json());
+    //LOG(INFO) << "request chunk: " << req->start_ts << "_" << chunk_sequence;
 
     bool is_old_serialized_request = (req->start_ts == 0);
     bool read_more_input = (req->_req != nullptr && req->_req->proceed_req);
@@ -54,7 +73,6 @@ void BatchedIndexer::enqueue(const std::shared_ptr<http_req>& req, const std::sh
         queued_writes += (chunk_sequence + 1);
 
         {
-            const std::string& coll_name = get_collection_name(req);
             uint64_t queue_id = StringUtils::hash_wy(coll_name.c_str(), coll_name.size()) % num_threads;
             req->body = "";
 
@@ -120,13 +138,163 @@ std::string BatchedIndexer::get_collection_name(const std::shared_ptr<http_req>&
     return coll_name;
 }
 
+std::string BatchedIndexer::get_merge_key(uint64_t req_id) {
+    auto req_res_map_it = req_res_map.find(req_id);
+    if(req_res_map_it == req_res_map.end()) {
+        return "";
+    }
+
+    const req_res_t& req_res = req_res_map_it->second;
+
+    if(req_res.start_ts == 0 || !req_res.is_complete || req_res.num_chunks != 1 || req_res.chunks.size() != 1) {
+        return "";
+    }
+
+    // after a crash, writes are indexed one at a time until the write that crashed is known and skipped
+    if(skip_index != UNSET_SKIP_INDEX || req_res.chunks.front().log_index <= merge_barrier_index) {
+        return "";
+    }
+
+    const auto& params = req_res.req->params;
+    route_path* rpath = nullptr;
+
+    if(!server->get_route(req_res.req->route_hash, &rpath) || rpath->handler != post_add_document) {
+        return "";
+    }
+
+    auto coll_it = params.find("collection");
+    if(coll_it == params.end() || coll_it->second.empty()) {
+        return "";
+    }
+
+    auto action_it = params.find("action");
+    const std::string& action = (action_it == params.end()) ? "create" : action_it->second;
+
+    if(action != "create" && action != "update" && action != "upsert" && action != "emplace") {
+        // rejected by the handler
+        return "";
+    }
+
+    auto dirty_values_it = params.find("dirty_values");
+    const std::string& dirty_values = (dirty_values_it == params.end()) ? "" : dirty_values_it->second;
+
+    return coll_it->second + "\n" + action + "\n" + dirty_values;
+}
+
+void BatchedIndexer::index_merged_writes(const size_t thread_id, const std::vector<uint64_t>& req_ids) {
+    std::vector<req_res_t*> req_reses;
+
+    {
+        std::unique_lock lk(mutex);
+        for(auto req_id: req_ids) {
+            auto req_res_map_it = req_res_map.find(req_id);
+            if(req_res_map_it == req_res_map.end()) {
+                LOG(ERROR) << "Req ID " << req_id << " not found in req_res_map.";
+                continue;
+            }
+
+            req_reses.push_back(&req_res_map_it->second);
+        }
+    }
+
+    std::shared_lock slk(pause_mutex); // used for snapshot
+
+    std::vector<std::shared_ptr<http_req>> reqs;
+    std::vector<std::shared_ptr<http_res>> ress;
+
+    for(req_res_t* req_res: req_reses) {
+        req_chunk_t chunk;
+
+        {
+            std::unique_lock clk(mutex);
+            chunk = std::move(req_res->chunks.front());
+            req_res->chunks.pop_front();
+        }
+
+        const std::shared_ptr<http_req>& req = req_res->req;
+        req->body = std::move(chunk.body);
+        req->log_index = chunk.log_index;
+        req->log_slot = chunk.log_slot;
+        req->first_chunk_aggregate = chunk.first_chunk_aggregate;
+        req->last_chunk_aggregate = chunk.last_chunk_aggregate;
+
+        if(get_write_position(req->log_index, req->log_slot) == skip_index) {
+            LOG(ERROR) << "Skipping write log index " << req->log_index << ", slot " << req->log_slot
+                       << " which seems to have triggered a crash previously.";
+            populate_skip_index();
+            continue;
+        }
+
+        reqs.push_back(req);
+        ress.push_back(req_res->res);
+    }
+
+    if(!reqs.empty()) {
+        // rejected writes are responded to even when the request is no longer live, like in the serial path
+        bool rejected = true;
+
+        auto resource_check = cached_resource_stat_t::get_instance()
+                              .has_enough_resources(config.get_data_dir(),
+                                                    config.get_disk_used_max_percentage(),
+                                                    config.get_memory_used_max_percentage());
+
+        if(resource_check != cached_resource_stat_t::OK) {
+            const std::string& err_msg = "Rejecting write: running out of resource type: " +
+                                         std::string(magic_enum::enum_name(resource_check));
+            LOG(ERROR) << err_msg;
+            for(const auto& res: ress) {
+                res->set_422(err_msg);
+            }
+        } else if(skip_writes) {
+            for(const auto& res: ress) {
+                res->set(422, "Skipping write.");
+            }
+        } else {
+            rejected = false;
+
+            // Update thread local for reference during a crash: since the write that crashed is not known, the
+            // writes of the batch are indexed one at a time on a restart instead of any of them being skipped.
+            write_log_index = get_write_position(reqs.back()->log_index, reqs.back()->log_slot);
+            merged_log_indices[thread_id] = write_log_index;
+
+            try {
+                batch_add_documents(reqs, ress);
+            } catch(const std::exception& e) {
+                LOG(ERROR) << "Exception while indexing " << reqs.size() << " merged writes.";
+                LOG(ERROR) << "Raw error: " << e.what();
+                for(const auto& res: ress) {
+                    res->set_400("Bad request.");
+                }
+            }
+
+            merged_log_indices[thread_id] = 0;
+        }
+
+        for(size_t i = 0; i < reqs.size(); i++) {
+            if(rejected || ress[i]->is_alive) {
+                async_req_res_t* async_req_res = new async_req_res_t(reqs[i], ress[i], true);
+                server->get_message_dispatcher()->send_message(HttpServer::STREAM_RESPONSE_MESSAGE, async_req_res);
+            }
+        }
+    }
+
+    for(req_res_t* req_res: req_reses) {
+        queued_writes--;
+        req_res->next_chunk_index++;
+    }
+
+    slk.unlock();
+
+    std::unique_lock lk(mutex);
+    for(auto req_id: req_ids) {
+        req_res_map.erase(req_id);
+    }
+}
+
 void BatchedIndexer::run() {
     LOG(INFO) << "Starting batch indexer with " << num_threads << " threads.";
     ThreadPool* thread_pool = new ThreadPool(num_threads);
-    skip_index_iter = meta_store->scan(SKIP_INDICES_PREFIX, skip_index_iter_upper_bound);
-    populate_skip_index();
-
-    LOG(INFO) << "BatchedIndexer skip_index: " << skip_index;
+    load_skip_indices();
 
     for(size_t i = 0; i < num_threads; i++) {
         std::deque<uint64_t>& queue = queues[i];
@@ -143,8 +311,34 @@ void BatchedIndexer::run() {
 
                 uint64_t req_id = queue.front();
                 queue.pop_front();
+
+                // A backlog of single document writes to a collection is indexed as one batch, so that the
+                // documents are indexed in parallel instead of one request at a time. The writes are still taken
+                // off the queue in order, and only consecutive ones are merged.
+                std::vector<uint64_t> merged_req_ids;
+
+                if(!queue.empty()) {
+                    std::unique_lock mlk(mutex);
+                    const std::string& merge_key = get_merge_key(req_id);
+
+                    if(!merge_key.empty()) {
+                        merged_req_ids.push_back(req_id);
+
+                        while(!queue.empty() && merged_req_ids.size() < MAX_MERGED_WRITES &&
+                              get_merge_key(queue.front()) == merge_key) {
+                            merged_req_ids.push_back(queue.front());
+                            queue.pop_front();
+                        }
+                    }
+                }
+
                 qlk.unlock();
 
+                if(merged_req_ids.size() > 1) {
+                    index_merged_writes(i, merged_req_ids);
+                    continue;
+                }
+
                 std::unique_lock mlk(mutex);
                 auto req_res_map_it = req_res_map.find(req_id);
                 if(req_res_map_it == req_res_map.end()) {
@@ -155,19 +349,6 @@ void BatchedIndexer::run() {
                 req_res_t& orig_req_res = req_res_map_it->second;
                 mlk.unlock();
 
-                // scan db for all logs associated with request
-                const std::string& req_key_prefix = get_req_prefix_key(req_id);
-
-                /*  Format of the key: $RL_reqId_chunkId
-                    NOTE: we use an explicit `next_chunk_index` so that the reads can resume from a partially request.
-                */
-                const std::string& req_key_start_prefix = req_key_prefix + StringUtils::serialize_uint32_t(
-                                                                  orig_req_res.next_chunk_index);
-
-                const std::string& req_key_upper_bound = get_req_suffix_key(req_id);  // cannot inline this
-                rocksdb::Slice upper_bound(req_key_upper_bound);
-                rocksdb::Iterator* iter = store->scan(req_key_start_prefix, &upper_bound);
-
                 // used to handle partial JSON documents caused by chunking
                 std::string& prev_body = orig_req_res.prev_req_body;
 
@@ -179,17 +360,40 @@ void BatchedIndexer::run() {
                 bool route_found = server->get_route(orig_req->route_hash, &found_rpath);
                 bool async_res = false;
 
-                while(iter->Valid() && iter->key().starts_with(req_key_prefix)) {
+                while(true) {
                     std::shared_lock slk(pause_mutex); // used for snapshot
-                    orig_req->body = prev_body;
-                    orig_req->load_from_json(iter->value().ToString());
+                    req_chunk_t chunk;
+
+                    {
+                        // NOTE: `next_chunk_index` is advanced along with the chunks so that a snapshot can resume
+                        // a partially indexed request
+                        std::unique_lock clk(mutex);
+                        if(orig_req_res.chunks.empty()) {
+                            break;
+                        }
+
+                        chunk = std::move(orig_req_res.chunks.front());
+                        orig_req_res.chunks.pop_front();
+                    }
+
+                    if(orig_req->start_ts == 0) {
+                        // request from a version (v0.21 and below) which replicated the whole body at once
+                        orig_req->body = std::move(chunk.body);
+                    } else {
+                        orig_req->body = prev_body + chunk.body;
+                    }
+
+                    orig_req->log_index = chunk.log_index;
+                    orig_req->log_slot = chunk.log_slot;
+                    orig_req->first_chunk_aggregate = chunk.first_chunk_aggregate;
+                    orig_req->last_chunk_aggregate = chunk.last_chunk_aggregate;
 
                     // update thread local for reference during a crash
-                    write_log_index = orig_req->log_index;
+                    write_log_index = get_write_position(orig_req->log_index, orig_req->log_slot);
 
                     if(write_log_index == skip_index) {
-                        LOG(ERROR) << "Skipping write log index " << write_log_index
-                                   << " which seems to have triggered a crash previously.";
+                        LOG(ERROR) << "Skipping write log index " << orig_req->log_index << ", slot "
+                                   << orig_req->log_slot << " which seems to have triggered a crash previously.";
                         populate_skip_index();
                     }
 
@@ -246,19 +450,13 @@ void BatchedIndexer::run() {
 
                     queued_writes--;
                     orig_req_res.next_chunk_index++;
-                    iter->Next();
 
                     if(quit) {
                         break;
                     }
                 }
 
-                delete iter;
-
-                //LOG(INFO) << "Erasing request data from disk and memory for request " << req_id;
-
-                // we can delete the buffered request content
-                store->delete_range(req_key_prefix, req_key_prefix + StringUtils::serialize_uint32_t(UINT32_MAX));
+                //LOG(INFO) << "Erasing request data from memory for request " << req_id;
 
                 std::unique_lock lk(mutex);
                 req_res_map.erase(req_id);
@@ -289,9 +487,6 @@ void BatchedIndexer::run() {
                 if(!it->second.is_complete && seconds_since_batch_update > GC_PRUNE_MAX_SECONDS) {
                     LOG(INFO) << "Deleting partial upload for req id " << it->second.start_ts;
 
-                    const std::string& req_key_prefix = get_req_prefix_key(it->second.start_ts);
-                    store->delete_range(req_key_prefix, req_key_prefix + StringUtils::serialize_uint32_t(UINT32_MAX));
-
                     if(it->second.res->is_alive) {
                         it->second.res->final = true;
                         async_req_res_t* async_req_res = new async_req_res_t(it->second.req, it->second.res, true);
@@ -345,11 +540,55 @@ int64_t BatchedIndexer::get_queued_writes() {
     return queued_writes;
 }
 
+int64_t BatchedIndexer::get_write_position(int64_t log_index, uint32_t log_slot) {
+    return (log_index << LOG_SLOT_BITS) | log_slot;
+}
+
+std::string BatchedIndexer::serialize_write_position(int64_t position) {
+    const int64_t log_index = position >> LOG_SLOT_BITS;
+    const int64_t log_slot = position & ((int64_t(1) << LOG_SLOT_BITS) - 1);
+
+    if(log_slot == 0) {
+        return std::to_string(log_index);
+    }
+
+    return std::to_string(log_index) + "_" + std::to_string(log_slot);
+}
+
+bool BatchedIndexer::parse_write_position(const std::string& value, int64_t& position) {
+    const size_t slot_pos = value.find('_');
+    const std::string& index_str = value.substr(0, slot_pos);
+    const std::string& slot_str = (slot_pos == std::string::npos) ? "0" : value.substr(slot_pos + 1);
+
+    if(!StringUtils::is_int64_t(index_str) || !StringUtils::is_uint32_t(slot_str) ||
+       std::stoull(slot_str) >= (uint64_t(1) << LOG_SLOT_BITS)) {
+        return false;
+    }
+
+    position = get_write_position(std::stoll(index_str), std::stoul(slot_str));
+    return true;
+}
+
+void BatchedIndexer::load_skip_indices() {
+    delete skip_index_iter;
+    skip_index_iter = meta_store->scan(SKIP_INDICES_PREFIX, skip_index_iter_upper_bound);
+    populate_skip_index();
+
+    std::string merge_barrier_index_str;
+    if(meta_store->get(MERGE_BARRIER_INDEX_KEY, merge_barrier_index_str) == StoreStatus::FOUND &&
+       StringUtils::is_int64_t(merge_barrier_index_str)) {
+        merge_barrier_index = std::stoll(merge_barrier_index_str);
+    }
+
+    LOG(INFO) << "BatchedIndexer skip_index: " << skip_index << ", merge_barrier_index: " << merge_barrier_index;
+}
+
 void BatchedIndexer::populate_skip_index() {
     if(skip_index_iter->Valid() && skip_index_iter->key().starts_with(SKIP_INDICES_PREFIX)) {
         const std::string& index_value = skip_index_iter->value().ToString();
-        if(StringUtils::is_int64_t(index_value)) {
-            skip_index = std::stoll(index_value);
+        int64_t position;
+        if(parse_write_position(index_value, position)) {
+            skip_index = position;
         }
 
         skip_index_iter->Next();
@@ -358,10 +597,25 @@ void BatchedIndexer::populate_skip_index() {
     }
 }
 
+int64_t BatchedIndexer::get_skip_index() const {
+    return skip_index;
+}
+
 void BatchedIndexer::persist_applying_index() {
-    LOG(INFO) << "Saving currently applying index: " << write_log_index;
-    std::string key = SKIP_INDICES_PREFIX + std::to_string(write_log_index);
-    meta_store->insert(key, std::to_string(write_log_index));
+    for(size_t i = 0; i < num_threads; i++) {
+        if(write_log_index != 0 && merged_log_indices[i] == write_log_index) {
+            // merged writes are held back up to the log index of the last one, including all of its entry's slots
+            const int64_t log_index = write_log_index >> LOG_SLOT_BITS;
+            LOG(INFO) << "Saving currently applying index of merged writes: " << log_index;
+            meta_store->insert(MERGE_BARRIER_INDEX_KEY, std::to_string(log_index));
+            return;
+        }
+    }
+
+    const std::string& position = serialize_write_position(write_log_index);
+    LOG(INFO) << "Saving currently applying index: " << position;
+    std::string key = SKIP_INDICES_PREFIX + position;
+    meta_store->insert(key, position);
 }
 
 void BatchedIndexer::serialize_state(nlohmann::json& state) {
@@ -383,6 +637,18 @@ void BatchedIndexer::serialize_state(nlohmann::json& state) {
         req_res["is_complete"] = kv.second.is_complete;
         req_res["req"] = kv.second.req->to_json();
         req_res["prev_req_body"] = kv.second.prev_req_body;
+
+        req_res["chunks"] = nlohmann::json::array();
+        for(const auto& chunk: kv.second.chunks) {
+            nlohmann::json chunk_json;
+            chunk_json["body"] = chunk.body;
+            chunk_json["log_index"] = chunk.log_index;
+            chunk_json["log_slot"] = chunk.log_slot;
+            chunk_json["first_chunk_aggregate"] = chunk.first_chunk_aggregate;
+            chunk_json["last_chunk_aggregate"] = chunk.last_chunk_aggregate;
+            req_res["chunks"].push_back(std::move(chunk_json));
+        }
+
         num_reqs_stored++;
 
         //LOG(INFO) << "req_key: " << req_key << ", next_chunk_index: " << kv.second.next_chunk_index;
@@ -409,6 +675,20 @@ void BatchedIndexer::load_state(const nlohmann::json& state) {
                           kv.value()["next_chunk_index"].get<uint32_t>(),
                           kv.value()["is_complete"].get<bool>());
 
+        if(kv.value().count("chunks") != 0) {
+            for(const auto& chunk_json: kv.value()["chunks"]) {
+                req_chunk_t chunk;
+                chunk.body = chunk_json["body"].get<std::string>();
+                chunk.log_index = chunk_json["log_index"].get<int64_t>();
+                chunk.log_slot = chunk_json.count("log_slot") != 0 ? chunk_json["log_slot"].get<uint32_t>() : 0;
+                chunk.first_chunk_aggregate = chunk_json["first_chunk_aggregate"].get<bool>();
+                chunk.last_chunk_aggregate = chunk_json["last_chunk_aggregate"].get<bool>();
+                req_res.chunks.push_back(std::move(chunk));
+            }
+        } else {
+            load_stored_chunks(std::stoull(kv.key()), req_res);
+        }
+
         {
             std::unique_lock mlk(mutex);
             req_res_map.emplace(std::stoull(kv.key()), req_res);
@@ -441,6 +721,35 @@ void BatchedIndexer::load_state(const nlohmann::json& state) {
     LOG(INFO) << "Restored " << num_reqs_restored << " in-flight requests from snapshot.";
 }
 
+void BatchedIndexer::load_stored_chunks(uint64_t req_id, req_res_t& req_res) {
+    const std::string& req_key_prefix = get_req_prefix_key(req_id);
+    const std::string& req_key_start_prefix = req_key_prefix +
+                                              StringUtils::serialize_uint32_t(req_res.next_chunk_index);
+
+    const std::string& req_key_upper_bound = get_req_suffix_key(req_id);  // cannot inline this
+    rocksdb::Slice upper_bound(req_key_upper_bound);
+    rocksdb::Iterator* iter = store->scan(req_key_start_prefix, &upper_bound);
+
+    while(iter->Valid() && iter->key().starts_with(req_key_prefix)) {
+        http_req chunk_req;
+        chunk_req.load_from_json(iter->value().ToString());
+
+        req_chunk_t chunk;
+        chunk.body = std::move(chunk_req.body);
+        chunk.log_index = chunk_req.log_index;
+        chunk.log_slot = chunk_req.log_slot;
+        chunk.first_chunk_aggregate = chunk_req.first_chunk_aggregate;
+        chunk.last_chunk_aggregate = chunk_req.last_chunk_aggregate;
+        req_res.chunks.push_back(std::move(chunk));
+
+        iter->Next();
+    }
+
+    delete iter;
+
+    store->delete_range(req_key_prefix, req_key_prefix + StringUtils::serialize_uint32_t(UINT32_MAX));
+}
+
 std::shared_mutex& BatchedIndexer::get_pause_mutex() {
     return pause_mutex;
 }
@@ -454,5 +763,7 @@ void BatchedIndexer::clear_skip_indices() {
         skip_index_iter->Next();
     }
 
+    meta_store->remove(MERGE_BARRIER_INDEX_KEY);
+    merge_barrier_index = 0;
     meta_store->flush();
 }
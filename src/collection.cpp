@@ -20,6 +20,8 @@
 const std::string override_t::MATCH_EXACT = "exact";
 const std::string override_t::MATCH_CONTAINS = "contains";
 
+std::atomic<uint64_t> Collection::write_generation_counter{0};
+
 struct sort_fields_guard_t {
     std::vector<sort_by> sort_fields_std;
 
@@ -34,6 +36,18 @@ struct sort_fields_guard_t {
     }
 };
 
+static bool has_id_filter(const filter_node_t* filter_tree_root) {
+    if(filter_tree_root == nullptr) {
+        return false;
+    }
+
+    if(!filter_tree_root->isOperator) {
+        return filter_tree_root->filter_exp.field_name == "id";
+    }
+
+    return has_id_filter(filter_tree_root->left) || has_id_filter(filter_tree_root->right);
+}
+
 Collection::Collection(const std::string& name, const uint32_t collection_id, const uint64_t created_at,
                        const uint32_t next_seq_id, Store *store, const std::vector<field> &fields,
                        const std::string& default_sorting_field,
@@ -41,6 +55,7 @@ Collection::Collection(const std::string& name, const uint32_t collection_id, co
                        const std::vector<std::string>& symbols_to_index,
                        const std::vector<std::string>& token_separators,
                        const bool enable_nested_fields):
+        search_plans(SEARCH_PLAN_CACHE_CAPACITY),
         name(name), collection_id(collection_id), created_at(created_at),
         next_seq_id(next_seq_id), store(store),
         fields(fields), default_sorting_field(default_sorting_field), enable_nested_fields(enable_nested_fields),
@@ -50,6 +65,7 @@ Collection::Collection(const std::string& name, const uint32_t collection_id, co
         index(init_index()) {
 
     this->num_documents = 0;
+    advance_write_generation();
 }
 
 Collection::~Collection() {
@@ -172,12 +188,35 @@ nlohmann::json Collection::get_summary_json() const {
 
         if(coll_field.num_dim > 0) {
             field_json[fields::num_dim] = coll_field.num_dim;
+
+            if(coll_field.vec_quantization != vector_quantization_t::none) {
+                field_json[fields::vec_quantization] = magic_enum::enum_name(coll_field.vec_quantization);
+                field_json[fields::vec_rerank] = coll_field.vec_rerank;
+            }
+
+            if(!coll_field.hnsw_params.is_default()) {
+                field_json[fields::hnsw_params] = coll_field.hnsw_params.to_json();
+            }
+        }
+
+        if(coll_field.typo_index_max_len > 0) {
+            field_json[fields::typo_index_max_len] = coll_field.typo_index_max_len;
+        }
+
+        if(coll_field.store_token_offsets) {
+            field_json[fields::store_token_offsets] = true;
         }
 
         fields_arr.push_back(field_json);
     }
 
     json_response["fields"] = fields_arr;
+
+    nlohmann::json typo_index_stats = index->get_typo_index_stats();
+    if(!typo_index_stats.empty()) {
+        json_response["typo_index"] = typo_index_stats;
+    }
+
     json_response["default_sorting_field"] = default_sorting_field;
     return json_response;
 }
@@ -280,6 +319,7 @@ nlohmann::json Collection::add_many(std::vector<std::string>& json_lines, nlohma
                     }
 
                     if(found_new_field) {
+                        clear_search_plans();
                         auto persist_op = persist_collection_meta();
                         if(!persist_op.ok()) {
                             record.index_failure(persist_op.code(), persist_op.error());
@@ -392,6 +432,8 @@ void Collection::batch_index(std::vector<index_record>& index_records, std::vect
         json_out[index_record.position] = res.dump(-1, ' ', false,
                                                    nlohmann::detail::error_handler_t::ignore);
     }
+
+    advance_write_generation();
 }
 
 Option<uint32_t> Collection::index_in_memory(nlohmann::json &document, uint32_t seq_id,
@@ -414,6 +456,7 @@ Option<uint32_t> Collection::index_in_memory(nlohmann::json &document, uint32_t
                               fallback_field_type, token_separators, symbols_to_index, true);
 
     num_documents += 1;
+    advance_write_generation();
     return Option<>(200);
 }
 
@@ -822,6 +865,252 @@ Option<bool> Collection::extract_field_name(const std::string& field_name,
     return Option<bool>(true);
 }
 
+std::string Collection::get_search_plan_key(const std::vector<std::string>& raw_search_fields,
+                                            const std::vector<uint32_t>& raw_query_by_weights,
+                                            const std::vector<std::string>& raw_group_by_fields,
+                                            const spp::sparse_hash_set<std::string>& include_fields,
+                                            const spp::sparse_hash_set<std::string>& exclude_fields,
+                                            const std::string& filter_query,
+                                            const std::vector<std::string>& facet_fields,
+                                            const std::vector<sort_by>& sort_fields,
+                                            const bool is_wildcard_query) {
+    std::string key;
+
+    auto append_values = [&key](const std::vector<std::string>& values) {
+        for(const auto& value: values) {
+            key += value;
+            key += '\x1f';
+        }
+        key += '\x1e';
+    };
+
+    // field sets are unordered
+    auto append_set = [&append_values](const spp::sparse_hash_set<std::string>& values) {
+        std::vector<std::string> sorted_values(values.begin(), values.end());
+        std::sort(sorted_values.begin(), sorted_values.end());
+        append_values(sorted_values);
+    };
+
+    append_values(raw_search_fields);
+
+    for(auto weight: raw_query_by_weights) {
+        key += std::to_string(weight);
+        key += '\x1f';
+    }
+    key += '\x1e';
+
+    append_values(raw_group_by_fields);
+    append_set(include_fields);
+    append_set(exclude_fields);
+    append_values(facet_fields);
+
+    for(const auto& sort_field: sort_fields) {
+        key += sort_field.name;
+        key += '\x1f';
+        key += sort_field.order;
+        key += '\x1f';
+    }
+    key += '\x1e';
+
+    key += is_wildcard_query ? '1' : '0';
+    key += '\x1e';
+    key += filter_query;
+
+    return key;
+}
+
+Option<bool> Collection::build_search_plan(const std::vector<std::string>& raw_search_fields,
+                                           const std::vector<uint32_t>& raw_query_by_weights,
+                                           const std::vector<std::string>& raw_group_by_fields,
+                                           const spp::sparse_hash_set<std::string>& include_fields,
+                                           const spp::sparse_hash_set<std::string>& exclude_fields,
+                                           const std::string& filter_query,
+                                           const std::vector<std::string>& facet_fields,
+                                           const std::vector<sort_by>& sort_fields,
+                                           const bool is_wildcard_query,
+                                           search_plan_t& plan,
+                                           bool& cacheable) const {
+    // validate search fields
+    std::vector<std::string> processed_search_fields;
+    std::vector<uint32_t> query_by_weights;
+
+    for(size_t i = 0; i < raw_search_fields.size(); i++) {
+        const std::string& field_name = raw_search_fields[i];
+        if(field_name == "id") {
+            // `id` field needs to be handled separately, we will not handle for now
+            std::string error = "Cannot use `id` as a query by field.";
+            return Option<bool>(400, error);
+        }
+
+        std::vector<std::string> expanded_search_fields;
+        auto field_op = extract_field_name(field_name, search_schema, expanded_search_fields, true, enable_nested_fields);
+        if(!field_op.ok()) {
+            return Option<bool>(field_op.code(), field_op.error());
+        }
+
+        for(const auto& expanded_search_field: expanded_search_fields) {
+            processed_search_fields.push_back(expanded_search_field);
+            if(!raw_query_by_weights.empty()) {
+                query_by_weights.push_back(raw_query_by_weights[i]);
+            }
+        }
+    }
+
+    if(!query_by_weights.empty() && processed_search_fields.size() != query_by_weights.size()) {
+        std::string error = "Error, query_by_weights.size != query_by.size.";
+        return Option<bool>(400, error);
+    }
+
+    for(const std::string & field_name: processed_search_fields) {
+        field search_field = search_schema.at(field_name);
+
+        if(!search_field.index) {
+            std::string error = "Field `" + field_name + "` is marked as a non-indexed field in the schema.";
+            return Option<bool>(400, error);
+        }
+
+        if(search_field.type != field_types::STRING && search_field.type != field_types::STRING_ARRAY) {
+            std::string error = "Field `" + field_name + "` should be a string or a string array.";
+            return Option<bool>(400, error);
+        }
+    }
+
+    // validate group by fields
+    for(const std::string& field_name: raw_group_by_fields) {
+        auto field_op = extract_field_name(field_name, search_schema, plan.group_by_fields, false, enable_nested_fields);
+        if(!field_op.ok()) {
+            return Option<bool>(404, field_op.error());
+        }
+    }
+
+    for(const std::string& field_name: plan.group_by_fields) {
+        if(field_name == "id") {
+            std::string error = "Cannot use `id` as a group by field.";
+            return Option<bool>(400, error);
+        }
+
+        field search_field = search_schema.at(field_name);
+
+        // must be a facet field
+        if(!search_field.is_facet()) {
+            std::string error = "Group by field `" + field_name + "` should be a facet field.";
+            return Option<bool>(400, error);
+        }
+    }
+
+    auto include_exclude_op = populate_include_exclude_fields(include_fields, exclude_fields,
+                                                              plan.include_fields_full, plan.exclude_fields_full);
+
+    if(!include_exclude_op.ok()) {
+        return Option<bool>(include_exclude_op.code(), include_exclude_op.error());
+    }
+
+    // process weights for search fields
+    std::vector<std::string> reordered_search_fields;
+    process_search_field_weights(processed_search_fields, query_by_weights, plan.weighted_search_fields,
+                                 reordered_search_fields);
+
+    plan.search_fields = reordered_search_fields.empty() ? processed_search_fields : reordered_search_fields;
+
+    const std::string doc_id_prefix = std::to_string(collection_id) + "_" + DOC_ID_PREFIX + "_";
+    Option<bool> parse_filter_op = filter::parse_filter_query(filter_query, search_schema,
+                                                              store, doc_id_prefix, plan.filter_tree_root);
+    if(!parse_filter_op.ok()) {
+        return Option<bool>(parse_filter_op.code(), parse_filter_op.error());
+    }
+
+    // `id` clauses are resolved against the store while parsing, so they can go stale on writes
+    cacheable = !has_id_filter(plan.filter_tree_root);
+
+    // validate facet fields
+    for(const std::string & facet_by: facet_fields) {
+        std::string field_name;
+        std::vector<facet_range_t> ranges;
+
+        auto parse_facet_op = parse_facet(facet_by, field_name, ranges);
+        if(!parse_facet_op.ok()) {
+            return parse_facet_op;
+        }
+
+        if(search_schema.count(field_name) == 0 || !search_schema.at(field_name).facet) {
+            std::string error = "Could not find a facet field named `" + field_name + "` in the schema.";
+            return Option<bool>(404, error);
+        }
+
+        const field& facet_field = search_schema.at(field_name);
+        if(!ranges.empty() && !(facet_field.is_integer() || facet_field.is_float())) {
+            std::string error = "Facet field `" + field_name + "` must be a numerical field to be faceted by ranges.";
+            return Option<bool>(400, error);
+        }
+    }
+
+    // sort fields are validated again by the search when they cannot be reused
+    sort_fields_guard_t sort_fields_guard;
+    auto sort_validation_op = validate_and_standardize_sort_fields(sort_fields, sort_fields_guard.sort_fields_std,
+                                                                   is_wildcard_query);
+    plan.has_sort_fields_std = sort_validation_op.ok();
+
+    for(auto& sort_field_std: sort_fields_guard.sort_fields_std) {
+        if(sort_field_std.name == sort_field_const::eval) {
+            // eval expressions are evaluated per search
+            plan.has_sort_fields_std = false;
+            delete sort_field_std.eval.filter_tree_root;
+            sort_field_std.eval.filter_tree_root = nullptr;
+        }
+    }
+
+    if(plan.has_sort_fields_std) {
+        plan.sort_fields_std = sort_fields_guard.sort_fields_std;
+    }
+
+    return Option<bool>(true);
+}
+
+Option<std::shared_ptr<const Collection::search_plan_t>>
+Collection::get_search_plan(const std::vector<std::string>& raw_search_fields,
+                            const std::vector<uint32_t>& raw_query_by_weights,
+                            const std::vector<std::string>& raw_group_by_fields,
+                            const spp::sparse_hash_set<std::string>& include_fields,
+                            const spp::sparse_hash_set<std::string>& exclude_fields,
+                            const std::string& filter_query,
+                            const std::vector<std::string>& facet_fields,
+                            const std::vector<sort_by>& sort_fields,
+                            const bool is_wildcard_query) const {
+    const std::string& key = get_search_plan_key(raw_search_fields, raw_query_by_weights, raw_group_by_fields,
+                                                 include_fields, exclude_fields, filter_query, facet_fields,
+                                                 sort_fields, is_wildcard_query);
+
+    {
+        std::unique_lock<std::mutex> lock(search_plans_mutex);
+        auto plan_it = search_plans.find(key);
+        if(plan_it != search_plans.end()) {
+            return Option<std::shared_ptr<const search_plan_t>>(plan_it.value());
+        }
+    }
+
+    auto plan = std::make_shared<search_plan_t>();
+    bool cacheable = false;
+
+    auto build_op = build_search_plan(raw_search_fields, raw_query_by_weights, raw_group_by_fields, include_fields,
+                                      exclude_fields, filter_query, facet_fields, sort_fields, is_wildcard_query,
+                                      *plan, cacheable);
+    if(!build_op.ok()) {
+        return Option<std::shared_ptr<const search_plan_t>>(build_op.code(), build_op.error());
+    }
+
+    if(cacheable) {
+        std::unique_lock<std::mutex> lock(search_plans_mutex);
+        search_plans.insert(key, plan);
+    }
+
+    return Option<std::shared_ptr<const search_plan_t>>(plan);
+}
+
+void Collection::clear_search_plans() {
+    std::unique_lock<std::mutex> lock(search_plans_mutex);
+    search_plans.clear();
+}
+
 Option<nlohmann::json> Collection::search(const std::string & raw_query,
                                   const std::vector<std::string>& raw_search_fields,
                                   const std::string & filter_query, const std::vector<std::string>& facet_fields,
@@ -864,7 +1153,8 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
                                   const std::string& vector_query_str,
                                   const bool enable_highlight_v1,
                                   const uint64_t search_time_start_us,
-                                  const text_match_type_t match_type) const {
+                                  const text_match_type_t match_type,
+                                  const std::string& search_after_str) const {
 
     std::shared_lock lock(mutex);
 
@@ -937,110 +1227,30 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
         }
     }
 
-    // validate search fields
-    std::vector<std::string> processed_search_fields;
-    std::vector<uint32_t> query_by_weights;
-
-    for(size_t i = 0; i < raw_search_fields.size(); i++) {
-        const std::string& field_name = raw_search_fields[i];
-        if(field_name == "id") {
-            // `id` field needs to be handled separately, we will not handle for now
-            std::string error = "Cannot use `id` as a query by field.";
-            return Option<nlohmann::json>(400, error);
-        }
-
-        std::vector<std::string> expanded_search_fields;
-        auto field_op = extract_field_name(field_name, search_schema, expanded_search_fields, true, enable_nested_fields);
-        if(!field_op.ok()) {
-            return Option<nlohmann::json>(field_op.code(), field_op.error());
-        }
-
-        for(const auto& expanded_search_field: expanded_search_fields) {
-            processed_search_fields.push_back(expanded_search_field);
-            if(!raw_query_by_weights.empty()) {
-                query_by_weights.push_back(raw_query_by_weights[i]);
-            }
-        }
-    }
-
-    if(!query_by_weights.empty() && processed_search_fields.size() != query_by_weights.size()) {
-        std::string error = "Error, query_by_weights.size != query_by.size.";
-        return Option<nlohmann::json>(400, error);
-    }
-
-    for(const std::string & field_name: processed_search_fields) {
-        field search_field = search_schema.at(field_name);
-
-        if(!search_field.index) {
-            std::string error = "Field `" + field_name + "` is marked as a non-indexed field in the schema.";
-            return Option<nlohmann::json>(400, error);
-        }
-
-        if(search_field.type != field_types::STRING && search_field.type != field_types::STRING_ARRAY) {
-            std::string error = "Field `" + field_name + "` should be a string or a string array.";
-            return Option<nlohmann::json>(400, error);
-        }
-    }
-
-    // validate group by fields
-    std::vector<std::string> group_by_fields;
-
-    for(const std::string& field_name: raw_group_by_fields) {
-        auto field_op = extract_field_name(field_name, search_schema, group_by_fields, false, enable_nested_fields);
-        if(!field_op.ok()) {
-            return Option<nlohmann::json>(404, field_op.error());
-        }
-    }
-
-    for(const std::string& field_name: group_by_fields) {
-        if(field_name == "id") {
-            std::string error = "Cannot use `id` as a group by field.";
-            return Option<nlohmann::json>(400, error);
-        }
-
-        field search_field = search_schema.at(field_name);
-
-        // must be a facet field
-        if(!search_field.is_facet()) {
-            std::string error = "Group by field `" + field_name + "` should be a facet field.";
-            return Option<nlohmann::json>(400, error);
-        }
+    auto plan_op = get_search_plan(raw_search_fields, raw_query_by_weights, raw_group_by_fields, include_fields,
+                                   exclude_fields, filter_query, facet_fields, sort_fields, raw_query == "*");
+    if(!plan_op.ok()) {
+        return Option<nlohmann::json>(plan_op.code(), plan_op.error());
     }
 
-    tsl::htrie_set<char> include_fields_full;
-    tsl::htrie_set<char> exclude_fields_full;
+    const std::shared_ptr<const search_plan_t> plan = plan_op.get();
 
-    auto include_exclude_op = populate_include_exclude_fields(include_fields, exclude_fields,
-                                                              include_fields_full, exclude_fields_full);
+    const std::vector<search_field_t>& weighted_search_fields = plan->weighted_search_fields;
+    const std::vector<std::string>& search_fields = plan->search_fields;
+    const std::vector<std::string>& group_by_fields = plan->group_by_fields;
+    const tsl::htrie_set<char>& include_fields_full = plan->include_fields_full;
+    const tsl::htrie_set<char>& exclude_fields_full = plan->exclude_fields_full;
 
-    if(!include_exclude_op.ok()) {
-        return Option<nlohmann::json>(include_exclude_op.code(), include_exclude_op.error());
-    }
+    filter_node_t* filter_tree_root = (plan->filter_tree_root == nullptr) ? nullptr :
+                                      plan->filter_tree_root->clone();
 
-    // process weights for search fields
-    std::vector<std::string> reordered_search_fields;
-    std::vector<search_field_t> weighted_search_fields;
-    process_search_field_weights(processed_search_fields, query_by_weights, weighted_search_fields, reordered_search_fields);
-
-    const std::vector<std::string>& search_fields = reordered_search_fields.empty() ? processed_search_fields
-                                                                                    : reordered_search_fields;
     std::vector<facet> facets;
-
-    const std::string doc_id_prefix = std::to_string(collection_id) + "_" + DOC_ID_PREFIX + "_";
-    filter_node_t* filter_tree_root = nullptr;
-    Option<bool> parse_filter_op = filter::parse_filter_query(filter_query, search_schema,
-                                                              store, doc_id_prefix, filter_tree_root);
-    if(!parse_filter_op.ok()) {
-        return Option<nlohmann::json>(parse_filter_op.code(), parse_filter_op.error());
-    }
-
-    // validate facet fields
-    for(const std::string & field_name: facet_fields) {
-        if(search_schema.count(field_name) == 0 || !search_schema.at(field_name).facet) {
-            std::string error = "Could not find a facet field named `" + field_name + "` in the schema.";
-            return Option<nlohmann::json>(404, error);
-        }
-        facets.emplace_back(field_name);
+    for(const std::string & facet_by: facet_fields) {
+        // already validated by the search plan
+        std::string field_name;
+        std::vector<facet_range_t> ranges;
+        parse_facet(facet_by, field_name, ranges);
+        facets.emplace_back(field_name, ranges);
     }
 
     // parse facet query
@@ -1071,7 +1281,11 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
         } else {
             // facet query field must be part of facet fields requested
             facet_query = { StringUtils::trim(facet_query_fname), facet_query_value };
-            if(std::find(facet_fields.begin(), facet_fields.end(), facet_query.field_name) == facet_fields.end()) {
+            const auto facet_it = std::find_if(facets.begin(), facets.end(), [&facet_query](const facet& a_facet) {
+                return a_facet.field_name == facet_query.field_name;
+            });
+
+            if(facet_it == facets.end()) {
                 std::string error = "Facet query refers to a facet field `" + facet_query.field_name + "` " +
                                     "that is not part of `facet_by` parameter.";
                 return Option<nlohmann::json>(400, error);
@@ -1101,6 +1315,26 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
         return Option<nlohmann::json>(422, message);
     }
 
+    // a page that is fetched after a cursor only needs the hits that rank after it
+    search_cursor_t search_after;
+
+    if(!search_after_str.empty()) {
+        auto search_after_op = parse_search_after(search_after_str, search_after);
+        if(!search_after_op.ok()) {
+            return Option<nlohmann::json>(search_after_op.code(), search_after_op.error());
+        }
+
+        if(page != 1) {
+            return Option<nlohmann::json>(422, "Parameter `page` cannot be used along with `search_after`.");
+        }
+
+        if(search_after.offset + per_page > limit_hits) {
+            std::string message = "Only upto " + std::to_string(limit_hits) + " hits can be fetched. " +
+                                  "Ensure that `page` and `per_page` parameters are within this range.";
+            return Option<nlohmann::json>(422, message);
+        }
+    }
+
     size_t max_hits = DEFAULT_TOPSTER_SIZE;
 
     // ensure that `max_hits` never exceeds number of documents in collection
@@ -1110,6 +1344,13 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
         max_hits = std::min(std::max((page * per_page), max_hits), get_num_documents());
     }
 
+    if(per_page == 0) {
+        // only `found` and facet counts are returned, so the topsters need not hold any hits
+        max_hits = 0;
+    } else if(!search_after_str.empty()) {
+        max_hits = std::min(per_page, get_num_documents());
+    }
+
     if(token_order == NOT_SET) {
         if(default_sorting_field.empty()) {
             token_order = FREQUENCY;
@@ -1179,7 +1420,9 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
 
     bool is_wildcard_query = (query == "*");
 
-    if(curated_sort_by.empty()) {
+    if(curated_sort_by.empty() && plan->has_sort_fields_std && is_wildcard_query == (raw_query == "*")) {
+        sort_fields_std = plan->sort_fields_std;
+    } else if(curated_sort_by.empty()) {
         auto sort_validation_op = validate_and_standardize_sort_fields(sort_fields, sort_fields_std, is_wildcard_query);
         if(!sort_validation_op.ok()) {
             return Option<nlohmann::json>(sort_validation_op.code(), sort_validation_op.error());
@@ -1207,6 +1450,16 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
         }
     }
 
+    // cursors follow the order of sort key tuples, which groups, vector distances and text match buckets do not
+    const bool search_after_supported = raw_group_by_fields.empty() && vector_query.field_name.empty() &&
+                                        (match_score_index < 0 ||
+                                         sort_fields_std[match_score_index].text_match_buckets <= 1);
+
+    if(!search_after_str.empty() && !search_after_supported) {
+        return Option<nlohmann::json>(400, "Parameter `search_after` cannot be used along with `group_by`, "
+                                           "`vector_query` or text match buckets.");
+    }
+
     //LOG(INFO) << "Num indices used for querying: " << indices.size();
     std::vector<query_tokens_t> field_query_tokens;
     std::vector<std::string> q_tokens;  // used for auxillary highlighting
@@ -1271,7 +1524,8 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
                                                  search_stop_millis,
                                                  min_len_1typo, min_len_2typo, max_candidates, infixes,
                                                  max_extra_prefix, max_extra_suffix, facet_query_num_typos,
-                                                 filter_curated_hits, split_join_tokens, vector_query);
+                                                 filter_curated_hits, split_join_tokens, vector_query,
+                                                 search_after);
 
     index->run_search(search_params);
 
@@ -1347,13 +1601,15 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
     );
 
     std::vector<std::vector<KV*>> result_group_kvs;
-    size_t override_kv_index = 0;
     size_t raw_results_index = 0;
 
+    // curated hits are returned in the order of their positions, so the ones before the cursor come first
+    size_t override_kv_index = std::min(search_after.num_curated, override_result_kvs.size());
+
     // merge raw results and override results
     while(raw_results_index < raw_result_kvs.size()) {
         if(override_kv_index < override_result_kvs.size()) {
-            size_t result_position = result_group_kvs.size() + 1;
+            size_t result_position = search_after.offset + result_group_kvs.size() + 1;
             uint64_t override_position = override_result_kvs[override_kv_index][0]->distinct_key;
             if(result_position == override_position) {
                 override_result_kvs[override_kv_index][0]->match_score_index = CURATED_RECORD_IDENTIFIER;
@@ -1442,114 +1698,173 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
         index_symbols[uint8_t(c)] = 1;
     }
 
-    // construct results array
+    // fetching and highlighting a hit is independent of the other hits, so they are done in parallel since
+    // highlighting has to tokenize the stored text of every hit
+    std::vector<const KV*> hit_kvs;
     for(long result_kvs_index = start_result_index; result_kvs_index <= end_result_index; result_kvs_index++) {
-        const std::vector<KV*> & kv_group = result_group_kvs[result_kvs_index];
-
-        nlohmann::json group_hits;
-        if(group_limit) {
-            group_hits["hits"] = nlohmann::json::array();
+        for(const KV* field_order_kv: result_group_kvs[result_kvs_index]) {
+            hit_kvs.push_back(field_order_kv);
         }
+    }
 
-        nlohmann::json& hits_array = group_limit ? group_hits["hits"] : result["hits"];
-        nlohmann::json group_key = nlohmann::json::array();
+    std::vector<hit_highlight_t> hit_highlights(hit_kvs.size());
 
-        for(const KV* field_order_kv: kv_group) {
-            const std::string& seq_id_key = get_seq_id_key((uint32_t) field_order_kv->key);
+    auto highlight_hit = [&](const KV* field_order_kv, hit_highlight_t& hit_highlight) {
+        const std::string& seq_id_key = get_seq_id_key((uint32_t) field_order_kv->key);
 
-            nlohmann::json document;
-            const Option<bool> & document_op = get_document_from_store(seq_id_key, document);
+        nlohmann::json& document = hit_highlight.document;
+        const Option<bool> & document_op = get_document_from_store(seq_id_key, document);
 
-            if(!document_op.ok()) {
-                LOG(ERROR) << "Document fetch error. " << document_op.error();
-                continue;
-            }
-
-            nlohmann::json highlight_res = nlohmann::json::object();
+        if(!document_op.ok()) {
+            LOG(ERROR) << "Document fetch error. " << document_op.error();
+            return ;
+        }
 
-            if(!highlight_items.empty()) {
-                copy_highlight_doc(highlight_items, document, highlight_res);
-                remove_flat_fields(highlight_res);
-                highlight_res.erase("id");
-            }
+        hit_highlight.found = true;
 
-            nlohmann::json wrapper_doc;
+        nlohmann::json& highlight_res = hit_highlight.highlight_res;
+        highlight_res = nlohmann::json::object();
 
-            if(enable_highlight_v1) {
-                wrapper_doc["highlights"] = nlohmann::json::array();
-            }
+        if(!highlight_items.empty()) {
+            copy_highlight_doc(highlight_items, document, highlight_res);
+            remove_flat_fields(highlight_res);
+            highlight_res.erase("id");
+        }
 
-            std::vector<highlight_t> highlights;
-            StringUtils string_utils;
+        std::vector<highlight_t>& highlights = hit_highlight.highlights;
+        StringUtils string_utils;
 
-            tsl::htrie_set<char> hfield_names;
-            tsl::htrie_set<char> h_full_field_names;
+        tsl::htrie_set<char> hfield_names;
+        tsl::htrie_set<char> h_full_field_names;
 
-            for(size_t i = 0; i < highlight_items.size(); i++) {
-                auto& highlight_item = highlight_items[i];
-                const std::string& field_name = highlight_item.name;
-                if(search_schema.count(field_name) == 0) {
-                    continue;
-                }
+        for(size_t i = 0; i < highlight_items.size(); i++) {
+            auto& highlight_item = highlight_items[i];
+            const std::string& field_name = highlight_item.name;
+            if(search_schema.count(field_name) == 0) {
+                continue;
+            }
 
-                field search_field = search_schema.at(field_name);
+            field search_field = search_schema.at(field_name);
 
-                if(query != "*") {
-                    highlight_t highlight;
-                    highlight.field = search_field.name;
+            if(query != "*") {
+                highlight_t highlight;
+                highlight.field = search_field.name;
 
-                    bool found_highlight = false;
-                    bool found_full_highlight = false;
+                bool found_highlight = false;
+                bool found_full_highlight = false;
 
-                    highlight_result(raw_query, search_field, i, highlight_item.qtoken_leaves, field_order_kv,
-                                     document, highlight_res,
-                                     string_utils, snippet_threshold,
-                                     highlight_affix_num_tokens, highlight_item.fully_highlighted, highlight_item.infix,
-                                     highlight_start_tag, highlight_end_tag, index_symbols, highlight,
-                                     found_highlight, found_full_highlight);
-                    if(!highlight.snippets.empty()) {
-                        highlights.push_back(highlight);
-                    }
+                highlight_result(raw_query, search_field, i, highlight_item.qtoken_leaves, field_order_kv,
+                                 document, highlight_res,
+                                 string_utils, snippet_threshold,
+                                 highlight_affix_num_tokens, highlight_item.fully_highlighted, highlight_item.infix,
+                                 highlight_start_tag, highlight_end_tag, index_symbols, highlight,
+                                 found_highlight, found_full_highlight);
+                if(!highlight.snippets.empty()) {
+                    highlights.push_back(highlight);
+                }
 
-                    if(found_highlight) {
-                        hfield_names.insert(search_field.name);
-                        if(found_full_highlight) {
-                            h_full_field_names.insert(search_field.name);
-                        }
+                if(found_highlight) {
+                    hfield_names.insert(search_field.name);
+                    if(found_full_highlight) {
+                        h_full_field_names.insert(search_field.name);
                     }
                 }
             }
+        }
 
-            // explicit highlight fields could be parent of searched fields, so we will take a pass at that
-            for(auto& hfield_name: highlight_full_field_names) {
-                auto it = h_full_field_names.equal_prefix_range(hfield_name);
-                if(it.first != it.second) {
-                    h_full_field_names.insert(hfield_name);
-                }
+        // explicit highlight fields could be parent of searched fields, so we will take a pass at that
+        for(auto& hfield_name: highlight_full_field_names) {
+            auto it = h_full_field_names.equal_prefix_range(hfield_name);
+            if(it.first != it.second) {
+                h_full_field_names.insert(hfield_name);
             }
+        }
 
-            if(highlight_field_names.empty()) {
-                for(auto& raw_search_field: raw_search_fields) {
-                    auto it = hfield_names.equal_prefix_range(raw_search_field);
-                    if(it.first != it.second) {
-                        hfield_names.insert(raw_search_field);
-                    }
+        if(highlight_field_names.empty()) {
+            for(auto& raw_search_field: raw_search_fields) {
+                auto it = hfield_names.equal_prefix_range(raw_search_field);
+                if(it.first != it.second) {
+                    hfield_names.insert(raw_search_field);
                 }
-            } else {
-                for(auto& hfield_name: highlight_field_names) {
-                    auto it = hfield_names.equal_prefix_range(hfield_name);
-                    if(it.first != it.second) {
-                        hfield_names.insert(hfield_name);
-                    }
+            }
+        } else {
+            for(auto& hfield_name: highlight_field_names) {
+                auto it = hfield_names.equal_prefix_range(hfield_name);
+                if(it.first != it.second) {
+                    hfield_names.insert(hfield_name);
                 }
             }
+        }
+
+        // remove fields from highlight doc that were not highlighted
+        if(!hfield_names.empty()) {
+            prune_doc(highlight_res, hfield_names, tsl::htrie_set<char>(), "");
+        }
+    };
+
+    ThreadPool* thread_pool = CollectionManager::get_instance().get_thread_pool();
+    const bool parallel_highlight = (thread_pool != nullptr && hit_kvs.size() > 1 &&
+                                     query != "*" && !highlight_items.empty());
+
+    if(!parallel_highlight) {
+        for(size_t hit_index = 0; hit_index < hit_kvs.size(); hit_index++) {
+            highlight_hit(hit_kvs[hit_index], hit_highlights[hit_index]);
+        }
+    } else {
+        const size_t num_threads = std::min(HIGHLIGHT_CONCURRENCY, hit_kvs.size());
+        const size_t window_size = (hit_kvs.size() + num_threads - 1) / num_threads;  // rounds up
+        size_t num_processed = 0;
+        size_t num_queued = 0;
+        std::mutex m_process;
+        std::condition_variable cv_process;
+
+        for(size_t hit_index = 0; hit_index < hit_kvs.size(); hit_index += window_size) {
+            const size_t batch_end = std::min(hit_index + window_size, hit_kvs.size());
+            num_queued++;
+
+            thread_pool->enqueue([&, hit_index, batch_end]() {
+                for(size_t i = hit_index; i < batch_end; i++) {
+                    highlight_hit(hit_kvs[i], hit_highlights[i]);
+                }
+
+                std::unique_lock<std::mutex> lock(m_process);
+                num_processed++;
+                cv_process.notify_one();
+            });
+        }
+
+        std::unique_lock<std::mutex> lock_process(m_process);
+        cv_process.wait(lock_process, [&](){ return num_processed == num_queued; });
+    }
+
+    size_t hit_index = 0;
+
+    // construct results array
+    for(long result_kvs_index = start_result_index; result_kvs_index <= end_result_index; result_kvs_index++) {
+        const std::vector<KV*> & kv_group = result_group_kvs[result_kvs_index];
+
+        nlohmann::json group_hits;
+        if(group_limit) {
+            group_hits["hits"] = nlohmann::json::array();
+        }
 
-            // remove fields from highlight doc that were not highlighted
-            if(!hfield_names.empty()) {
-                prune_doc(highlight_res, hfield_names, tsl::htrie_set<char>(), "");
+        nlohmann::json& hits_array = group_limit ? group_hits["hits"] : result["hits"];
+        nlohmann::json group_key = nlohmann::json::array();
+
+        for(const KV* field_order_kv: kv_group) {
+            hit_highlight_t& hit_highlight = hit_highlights[hit_index++];
+            if(!hit_highlight.found) {
+                continue;
             }
 
+            nlohmann::json& document = hit_highlight.document;
+            nlohmann::json& highlight_res = hit_highlight.highlight_res;
+            std::vector<highlight_t>& highlights = hit_highlight.highlights;
+
+            nlohmann::json wrapper_doc;
+
             if(enable_highlight_v1) {
+                wrapper_doc["highlights"] = nlohmann::json::array();
                 std::sort(highlights.begin(), highlights.end());
 
                 for(const auto & highlight: highlights) {
@@ -1577,7 +1892,7 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
                         }
                     }
 
-                    wrapper_doc["highlights"].push_back(h_json);
+                    wrapper_doc["highlights"].push_back(std::move(h_json));
                 }
             }
 
@@ -1594,8 +1909,8 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
             remove_flat_fields(document);
             prune_doc(document, include_fields_full, exclude_fields_full);
 
-            wrapper_doc["document"] = document;
-            wrapper_doc["highlight"] = highlight_res;
+            wrapper_doc["document"] = std::move(document);
+            wrapper_doc["highlight"] = std::move(highlight_res);
 
             if(field_order_kv->match_score_index == CURATED_RECORD_IDENTIFIER) {
                 wrapper_doc["curated"] = true;
@@ -1624,15 +1939,38 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
                 wrapper_doc["vector_distance"] = Index::int64_t_to_float(-field_order_kv->scores[0]);
             }
 
-            hits_array.push_back(wrapper_doc);
+            hits_array.push_back(std::move(wrapper_doc));
         }
 
         if(group_limit) {
             group_hits["group_key"] = group_key;
-            result["grouped_hits"].push_back(group_hits);
+            result["grouped_hits"].push_back(std::move(group_hits));
         }
     }
 
+    if(search_after_supported && end_result_index >= start_result_index &&
+       search_after.offset + end_result_index + 1 < total_found) {
+        // the next page follows the last ranked hit: curated hits are placed by their position instead
+        search_cursor_t next_search_after = search_after;
+        next_search_after.offset += end_result_index + 1;
+
+        bool found_ranked_kv = false;
+
+        for(long result_kvs_index = end_result_index; result_kvs_index >= 0; result_kvs_index--) {
+            const KV* kv = result_group_kvs[result_kvs_index][0];
+            if(kv->match_score_index == CURATED_RECORD_IDENTIFIER) {
+                next_search_after.num_curated++;
+            } else if(!found_ranked_kv) {
+                found_ranked_kv = true;
+                next_search_after.has_kv = true;
+                std::copy(kv->scores, kv->scores + 3, next_search_after.scores);
+                next_search_after.key = kv->key;
+            }
+        }
+
+        result["search_after"] = get_search_after_str(next_search_after);
+    }
+
     result["facet_counts"] = nlohmann::json::array();
 
     // populate facets
@@ -1667,6 +2005,13 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
             auto & kv = facet_hash_counts[fi];
             auto & facet_count = kv.second;
 
+            if(!a_facet.ranges.empty()) {
+                // counts of range facets are keyed by the index of the range
+                const std::string& range_label = a_facet.ranges[kv.first].label;
+                facet_values.push_back({range_label, range_label, facet_count.count});
+                continue;
+            }
+
             // fetch actual facet value from representative doc id
             const std::string& seq_id_key = get_seq_id_key((uint32_t) facet_count.doc_id);
             nlohmann::json document;
@@ -1707,11 +2052,13 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
             bool is_cyrillic = Tokenizer::is_cyrillic(the_field.locale);
             bool normalise = is_cyrillic ? false : true;
 
-            Tokenizer tokenizer(value, normalise, !the_field.is_string(), the_field.locale, symbols_to_index, token_separators);
+            auto tokenizer = Tokenizer::acquire(value, normalise, !the_field.is_string(), the_field.locale,
+                                                symbols_to_index, token_separators);
 
             // secondary tokenizer used for specific languages that requires transliteration
             // we use 2 tokenizers so that the original text offsets are available for highlighting
-            Tokenizer word_tokenizer("", true, false, the_field.locale, symbols_to_index, token_separators);
+            auto word_tokenizer = Tokenizer::acquire("", true, false, the_field.locale, symbols_to_index,
+                                                     token_separators);
 
             std::string raw_token;
             size_t raw_token_index = 0, tok_start = 0, tok_end = 0;
@@ -1720,9 +2067,9 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
             std::map<size_t, size_t> token_offsets;
             size_t prefix_token_start_index = 0;
 
-            while(tokenizer.next(raw_token, raw_token_index, tok_start, tok_end)) {
+            while(tokenizer->next(raw_token, raw_token_index, tok_start, tok_end)) {
                 if(is_cyrillic) {
-                    word_tokenizer.tokenize(raw_token);
+                    word_tokenizer->tokenize(raw_token);
                 }
 
                 auto token_pos_it = ftoken_pos.find(raw_token);
@@ -1799,6 +2146,10 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
         result["facet_counts"].push_back(facet_result);
     }
 
+    if(search_params->vector_search_info.executed) {
+        result["vector_search_info"] = search_params->vector_search_info.to_json();
+    }
+
     // free search params
     delete search_params;
 
@@ -1814,7 +2165,7 @@ Option<nlohmann::json> Collection::search(const std::string & raw_query,
     //long long int timeMillis = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - begin).count();
     //!LOG(INFO) << "Time taken for result calc: " << timeMillis << "us";
     //!store->print_memory_usage();
-    return Option<nlohmann::json>(result);
+    return Option<nlohmann::json>(std::move(result));
 }
 
 void Collection::copy_highlight_doc(std::vector<highlight_field_t>& hightlight_items, const nlohmann::json& src, nlohmann::json& dst) {
@@ -2126,7 +2477,7 @@ void Collection::parse_search_query(const std::string &query, std::vector<std::s
             custom_symbols.push_back('-');
             custom_symbols.push_back('"');
 
-            Tokenizer(query, true, false, locale, custom_symbols, token_separators).tokenize(tokens);
+            Tokenizer::acquire(query, true, false, locale, custom_symbols, token_separators)->tokenize(tokens);
         }
 
         bool exclude_operator_prior = false;
@@ -2163,7 +2514,7 @@ void Collection::parse_search_query(const std::string &query, std::vector<std::s
             if(already_segmented) {
                 StringUtils::split(token, sub_tokens, " ");
             } else {
-                Tokenizer(token, true, false, locale, symbols_to_index, token_separators).tokenize(sub_tokens);
+                Tokenizer::acquire(token, true, false, locale, symbols_to_index, token_separators)->tokenize(sub_tokens);
             }
 
             for(auto& sub_token: sub_tokens) {
@@ -2262,6 +2613,24 @@ Option<bool> Collection::get_filter_ids(const std::string & simple_filter_query,
     return Option<bool>(true);
 }
 
+Option<bool> Collection::explain_filter(const std::string& simple_filter_query, nlohmann::json& plan) const {
+    std::shared_lock lock(mutex);
+
+    const std::string doc_id_prefix = std::to_string(collection_id) + "_" + DOC_ID_PREFIX + "_";
+    filter_node_t* filter_tree_root = nullptr;
+    Option<bool> filter_op = filter::parse_filter_query(simple_filter_query, search_schema,
+                                                        store, doc_id_prefix, filter_tree_root);
+
+    if(!filter_op.ok()) {
+        return filter_op;
+    }
+
+    index->explain_filter_with_lock(filter_tree_root, plan);
+
+    delete filter_tree_root;
+    return Option<bool>(true);
+}
+
 bool Collection::facet_value_to_string(const facet &a_facet, const facet_count_t &facet_count,
                                        const nlohmann::json &document, std::string &value) const {
 
@@ -2369,7 +2738,8 @@ void Collection::highlight_result(const std::string& raw_query, const field &sea
     bool normalise = !use_word_tokenizer;
 
     std::vector<std::string> raw_query_tokens;
-    Tokenizer(raw_query, normalise, false, search_field.locale, symbols_to_index, token_separators).tokenize(raw_query_tokens);
+    Tokenizer::acquire(raw_query, normalise, false, search_field.locale, symbols_to_index,
+                       token_separators)->tokenize(raw_query_tokens);
 
     if(raw_query_tokens.empty()) {
         return ;
@@ -2613,12 +2983,25 @@ void Collection::highlight_result(const std::string& raw_query, const field &sea
             text = document[search_field.name][match_index.index];
         }
 
+        // Tokens before the snippet window of the first match are highlighted only for short texts or when the
+        // field is highlighted fully, so otherwise tokenization can resume from a stored offset close to it.
+        size_t start_token_index = 0, start_offset = 0;
+
+        if(search_field.store_token_offsets && !highlight_fully && !is_infix_search && !use_word_tokenizer &&
+           last_valid_offset_index >= 0 && text.size() >= snippet_threshold * 6) {
+            size_t first_match_offset = match.offsets[0].offset;
+            size_t window_start_index = (first_match_offset > highlight_affix_num_tokens) ?
+                                        (first_match_offset - highlight_affix_num_tokens) : 0;
+            index->seek_token_offset(search_field.name, field_order_kv->key, match_index.index, window_start_index,
+                                     start_token_index, start_offset);
+        }
+
         handle_highlight_text(text, normalise, search_field, symbols_to_index, token_separators,
                               highlight, string_utils, use_word_tokenizer, highlight_affix_num_tokens,
                               qtoken_leaves, last_valid_offset_index, prefix_token_num_chars,
                               highlight_fully, snippet_threshold, is_infix_search, raw_query_tokens,
                               last_valid_offset, highlight_start_tag, highlight_end_tag,
-                              index_symbols, match_index);
+                              index_symbols, match_index, start_token_index, start_offset);
 
         if(!highlight.snippets.empty()) {
             found_highlight = found_highlight || true;
@@ -2650,14 +3033,19 @@ bool Collection::handle_highlight_text(std::string& text, bool normalise, const
                            const size_t prefix_token_num_chars, bool highlight_fully, const size_t snippet_threshold,
                            bool is_infix_search, std::vector<std::string>& raw_query_tokens, size_t last_valid_offset,
                            const std::string& highlight_start_tag, const std::string& highlight_end_tag,
-                           const uint8_t* index_symbols, const match_index_t& match_index) const {
+                           const uint8_t* index_symbols, const match_index_t& match_index,
+                           size_t start_token_index, size_t start_offset) const {
 
     const Match& match = match_index.match;
 
-    Tokenizer tokenizer(text, normalise, false, search_field.locale, symbols_to_index, token_separators);
+    auto tokenizer = Tokenizer::acquire(text, normalise, false, search_field.locale, symbols_to_index, token_separators);
+
+    if(start_offset != 0) {
+        tokenizer->seek(start_offset, start_token_index);
+    }
 
     // word tokenizer is a secondary tokenizer used for specific languages that requires transliteration
-    Tokenizer word_tokenizer("", true, false, search_field.locale, symbols_to_index, token_separators);
+    auto word_tokenizer = Tokenizer::acquire("", true, false, search_field.locale, symbols_to_index, token_separators);
 
     if(search_field.locale == "ko") {
         text = string_utils.unicode_nfkd(text);
@@ -2681,11 +3069,11 @@ bool Collection::handle_highlight_text(std::string& text, bool normalise, const
     std::vector<std::string>& matched_tokens = highlight.matched_tokens.back();
     bool found_first_match = false;
 
-    while(tokenizer.next(raw_token, raw_token_index, tok_start, tok_end)) {
+    while(tokenizer->next(raw_token, raw_token_index, tok_start, tok_end)) {
         if(use_word_tokenizer) {
-            bool found_token = word_tokenizer.tokenize(raw_token);
+            bool found_token = word_tokenizer->tokenize(raw_token);
             if(!found_token) {
-                tokenizer.decr_token_counter();
+                tokenizer->decr_token_counter();
                 continue;
             }
         }
@@ -2934,6 +3322,8 @@ void Collection::remove_document(const nlohmann::json & document, const uint32_t
         num_documents -= 1;
     }
 
+    advance_write_generation();
+
     if(remove_from_store) {
         store->remove(get_doc_id_key(id));
         store->remove(get_seq_id_key(seq_id));
@@ -3009,6 +3399,7 @@ Option<uint32_t> Collection::add_override(const override_t & override) {
 
     std::unique_lock lock(mutex);
     overrides[override.id] = override;
+    advance_write_generation();
     return Option<uint32_t>(200);
 }
 
@@ -3021,6 +3412,7 @@ Option<uint32_t> Collection::remove_override(const std::string & id) {
 
         std::unique_lock lock(mutex);
         overrides.erase(id);
+        advance_write_generation();
         return Option<uint32_t>(200);
     }
 
@@ -3061,6 +3453,51 @@ size_t Collection::get_num_documents() const {
     return num_documents.load();
 }
 
+uint64_t Collection::get_write_generation() const {
+    return write_generation.load();
+}
+
+void Collection::advance_write_generation() {
+    write_generation = ++write_generation_counter;
+}
+
+void Collection::get_token_expansion_cache_stats(uint64_t& hits, uint64_t& narrowed_hits, uint64_t& misses) const {
+    std::shared_lock lock(mutex);
+    index->get_token_expansion_cache_stats(hits, narrowed_hits, misses);
+}
+
+void Collection::get_filter_result_cache_stats(uint64_t& hits, uint64_t& misses, uint64_t& evictions,
+                                               uint64_t& invalidations, size_t& num_bytes) const {
+    std::shared_lock lock(mutex);
+    index->get_filter_result_cache_stats(hits, misses, evictions, invalidations, num_bytes);
+}
+
+void Collection::save_vector_indices(const std::string& dir_path, nlohmann::json& saved_indices) const {
+    std::shared_lock lock(mutex);
+    index->save_vector_indices(dir_path, saved_indices);
+}
+
+void Collection::restore_vector_indices(const std::string& dir_path, const nlohmann::json& saved_indices,
+                                        bool fresh) {
+    std::unique_lock lock(mutex);
+    index->restore_vector_indices(dir_path, saved_indices, fresh);
+}
+
+void Collection::finish_vector_index_restore() {
+    std::unique_lock lock(mutex);
+    index->finish_vector_index_restore();
+}
+
+void Collection::defer_vector_index_tuning(bool defer) {
+    std::unique_lock lock(mutex);
+    index->defer_vector_index_tuning(defer);
+}
+
+void Collection::set_lazy_filter_min_ids(size_t min_ids) {
+    std::unique_lock lock(mutex);
+    index->set_lazy_filter_min_ids(min_ids);
+}
+
 uint32_t Collection::get_collection_id() const {
     return collection_id.load();
 }
@@ -3212,6 +3649,123 @@ Option<bool> Collection::parse_pinned_hits(const std::string& pinned_hits_str,
     return Option<bool>(true);
 }
 
+Option<bool> Collection::parse_facet(const std::string& facet_by, std::string& field_name,
+                                     std::vector<facet_range_t>& ranges) {
+    const size_t range_start_index = facet_by.find('(');
+    if(range_start_index == std::string::npos) {
+        field_name = facet_by;
+        return Option<bool>(true);
+    }
+
+    if(facet_by.back() != ')') {
+        return Option<bool>(400, "Facet ranges of `" + facet_by + "` are not in expected format.");
+    }
+
+    field_name = facet_by.substr(0, range_start_index);
+    StringUtils::trim(field_name);
+
+    std::vector<std::string> range_strs;
+    StringUtils::split(facet_by.substr(range_start_index + 1, facet_by.size() - range_start_index - 2),
+                       range_strs, ",");
+
+    if(range_strs.empty()) {
+        return Option<bool>(400, "Facet ranges of `" + facet_by + "` are not in expected format.");
+    }
+
+    for(const std::string& range_str: range_strs) {
+        facet_range_t range;
+        range.label = range_str;
+
+        // a range is either `lower-upper` or unbounded as `lower+`, where the lower bound can be negative
+        std::string lower_str, upper_str;
+        const size_t separator_index = range_str.find('-', 1);
+
+        if(range_str.back() == '+') {
+            lower_str = range_str.substr(0, range_str.size() - 1);
+        } else if(separator_index != std::string::npos) {
+            lower_str = range_str.substr(0, separator_index);
+            upper_str = range_str.substr(separator_index + 1);
+        }
+
+        StringUtils::trim(lower_str);
+        StringUtils::trim(upper_str);
+
+        if(!StringUtils::is_float(lower_str) || (!upper_str.empty() && !StringUtils::is_float(upper_str)) ||
+           (range_str.back() != '+' && upper_str.empty())) {
+            return Option<bool>(400, "Facet range `" + range_str + "` is not in expected format.");
+        }
+
+        range.lower = std::stod(lower_str);
+        if(!upper_str.empty()) {
+            range.upper = std::stod(upper_str);
+        }
+
+        if(range.lower >= range.upper) {
+            return Option<bool>(400, "Facet range `" + range_str + "` must have a lower bound that is less than "
+                                     "its upper bound.");
+        }
+
+        ranges.push_back(range);
+    }
+
+    return Option<bool>(true);
+}
+
+Option<bool> Collection::parse_search_after(const std::string& search_after_str, search_cursor_t& search_after) {
+    // `offset:num_curated` or `offset:num_curated:score_0:score_1:score_2:key`
+    std::vector<std::string> parts;
+    StringUtils::split(StringUtils::base64_decode(search_after_str), parts, ":");
+
+    if(parts.size() != 2 && parts.size() != 6) {
+        return Option<bool>(400, "Parameter `search_after` is malformed.");
+    }
+
+    for(size_t i = 0; i < 2; i++) {
+        if(!StringUtils::is_positive_integer(parts[i]) || !StringUtils::is_uint32_t(parts[i])) {
+            return Option<bool>(400, "Parameter `search_after` is malformed.");
+        }
+    }
+
+    search_after.offset = std::stoul(parts[0]);
+    search_after.num_curated = std::stoul(parts[1]);
+
+    if(parts.size() == 2) {
+        return Option<bool>(true);
+    }
+
+    for(size_t i = 0; i < 3; i++) {
+        if(!StringUtils::is_int64_t(parts[i + 2])) {
+            return Option<bool>(400, "Parameter `search_after` is malformed.");
+        }
+
+        search_after.scores[i] = std::strtoll(parts[i + 2].c_str(), nullptr, 10);
+    }
+
+    if(!StringUtils::is_positive_integer(parts[5]) || !StringUtils::is_uint64_t(parts[5])) {
+        return Option<bool>(400, "Parameter `search_after` is malformed.");
+    }
+
+    search_after.key = std::strtoull(parts[5].c_str(), nullptr, 10);
+    search_after.has_kv = true;
+
+    return Option<bool>(true);
+}
+
+std::string Collection::get_search_after_str(const search_cursor_t& search_after) {
+    std::string search_after_str = std::to_string(search_after.offset) + ":" +
+                                   std::to_string(search_after.num_curated);
+
+    if(search_after.has_kv) {
+        for(const int64_t score: search_after.scores) {
+            search_after_str += ":" + std::to_string(score);
+        }
+
+        search_after_str += ":" + std::to_string(search_after.key);
+    }
+
+    return StringUtils::base64_encode(search_after_str);
+}
+
 Option<bool> Collection::add_synonym(const nlohmann::json& syn_json) {
     std::shared_lock lock(mutex);
     synonym_t synonym;
@@ -3221,7 +3775,9 @@ Option<bool> Collection::add_synonym(const nlohmann::json& syn_json) {
         return syn_op;
     }
 
-    return synonym_index->add_synonym(name, synonym);
+    auto add_op = synonym_index->add_synonym(name, synonym);
+    advance_write_generation();
+    return add_op;
 }
 
 bool Collection::get_synonym(const std::string& id, synonym_t& synonym) {
@@ -3231,7 +3787,9 @@ bool Collection::get_synonym(const std::string& id, synonym_t& synonym) {
 
 Option<bool> Collection::remove_synonym(const std::string &id) {
     std::shared_lock lock(mutex);
-    return synonym_index->remove_synonym(name, id);
+    auto remove_op = synonym_index->remove_synonym(name, id);
+    advance_write_generation();
+    return remove_op;
 }
 
 void Collection::synonym_reduction(const std::vector<std::string>& tokens,
@@ -3454,7 +4012,11 @@ Option<bool> Collection::alter(nlohmann::json& alter_payload) {
         LOG(INFO) << "Processing field additions and deletions first...";
     }
 
+    // a failed alter can still have changed part of the data
     auto batch_alter_op = batch_alter_data(addition_fields, del_fields, fallback_field_type);
+    advance_write_generation();
+    clear_search_plans();
+
     if(!batch_alter_op.ok()) {
         return batch_alter_op;
     }
@@ -3462,6 +4024,9 @@ Option<bool> Collection::alter(nlohmann::json& alter_payload) {
     if(!reindex_fields.empty()) {
         LOG(INFO) << "Processing field modifications now...";
         batch_alter_op = batch_alter_data(reindex_fields, {}, fallback_field_type);
+        advance_write_generation();
+        clear_search_plans();
+
         if(!batch_alter_op.ok()) {
             return batch_alter_op;
         }
@@ -1,5 +1,6 @@
 #include <string>
 #include <vector>
+#include <fstream>
 #include <json.hpp>
 #include <app_metrics.h>
 #include "collection_manager.h"
@@ -54,6 +55,14 @@ Collection* CollectionManager::init_collection(const nlohmann::json & collection
             field_obj[fields::num_dim] = 0;
         }
 
+        if(field_obj.count(fields::typo_index_max_len) == 0) {
+            field_obj[fields::typo_index_max_len] = 0;
+        }
+
+        if(field_obj.count(fields::store_token_offsets) == 0) {
+            field_obj[fields::store_token_offsets] = false;
+        }
+
         vector_distance_type_t vec_dist_type = vector_distance_type_t::cosine;
 
         if(field_obj.count(fields::vec_dist) != 0) {
@@ -63,10 +72,32 @@ Collection* CollectionManager::init_collection(const nlohmann::json & collection
             }
         }
 
+        vector_quantization_t vec_quantization = vector_quantization_t::none;
+
+        if(field_obj.count(fields::vec_quantization) != 0) {
+            auto vec_quantization_op = magic_enum::enum_cast<vector_quantization_t>(
+                    field_obj[fields::vec_quantization].get<std::string>());
+            if(vec_quantization_op.has_value()) {
+                vec_quantization = vec_quantization_op.value();
+            }
+        }
+
+        if(field_obj.count(fields::vec_rerank) == 0) {
+            field_obj[fields::vec_rerank] = field::DEFAULT_VEC_RERANK;
+        }
+
+        hnsw_params_t hnsw_params;
+
+        if(field_obj.count(fields::hnsw_params) != 0) {
+            hnsw_params_t::parse(field_obj[fields::hnsw_params], hnsw_params);
+        }
+
         field f(field_obj[fields::name], field_obj[fields::type], field_obj[fields::facet],
                 field_obj[fields::optional], field_obj[fields::index], field_obj[fields::locale],
                 -1, field_obj[fields::infix], field_obj[fields::nested], field_obj[fields::nested_array],
-                field_obj[fields::num_dim], vec_dist_type);
+                field_obj[fields::num_dim], vec_dist_type, field_obj[fields::typo_index_max_len],
+                field_obj[fields::store_token_offsets], vec_quantization, field_obj[fields::vec_rerank],
+                hnsw_params);
 
         // value of `sort` depends on field type
         if(field_obj.count(fields::sort) == 0) {
@@ -279,6 +310,9 @@ Option<bool> CollectionManager::load(const size_t collection_batch_size, const s
 
     loading_pool.shutdown();
 
+    vector_index_snapshot_dir.clear();
+    vector_index_snapshot_manifest.clear();
+
     LOG(INFO) << "Initializing batched indexer from snapshot state...";
     if(batch_indexer != nullptr) {
         std::string batched_indexer_state_str;
@@ -292,6 +326,49 @@ Option<bool> CollectionManager::load(const size_t collection_batch_size, const s
     return Option<bool>(true);
 }
 
+Option<bool> CollectionManager::save_vector_indices(const std::string& dir_path, int64_t applied_index) const {
+    std::vector<Collection*> all_collections = get_collections();
+
+    nlohmann::json manifest;
+    manifest["applied_index"] = applied_index;
+    manifest["indices"] = nlohmann::json::array();
+
+    for(Collection* collection: all_collections) {
+        collection->save_vector_indices(dir_path, manifest["indices"]);
+    }
+
+    std::ofstream manifest_file(dir_path + "/" + VECTOR_INDEX_MANIFEST_FILE);
+    manifest_file << manifest.dump();
+    manifest_file.close();
+
+    if(manifest_file.fail()) {
+        return Option<bool>(500, "Unable to write the vector index manifest.");
+    }
+
+    return Option<bool>(true);
+}
+
+void CollectionManager::set_vector_index_snapshot(const std::string& dir_path, int64_t applied_index) {
+    vector_index_snapshot_dir = dir_path;
+    vector_index_snapshot_manifest.clear();
+
+    std::ifstream manifest_file(dir_path + "/" + VECTOR_INDEX_MANIFEST_FILE);
+    if(!manifest_file.good()) {
+        return;
+    }
+
+    nlohmann::json manifest = nlohmann::json::parse(manifest_file, nullptr, false);
+    if(manifest.is_discarded() || !manifest.contains("indices") || !manifest["indices"].is_array()) {
+        LOG(ERROR) << "Ignoring invalid vector index manifest in " << dir_path;
+        return;
+    }
+
+    vector_index_snapshot_fresh = (manifest.value("applied_index", int64_t(-1)) == applied_index);
+    vector_index_snapshot_manifest = manifest;
+
+    LOG(INFO) << "Found " << manifest["indices"].size() << " saved vector index(es), saved at log index "
+              << manifest.value("applied_index", int64_t(-1)) << ", snapshot log index: " << applied_index;
+}
 
 void CollectionManager::dispose() {
     std::unique_lock lock(mutex);
@@ -703,6 +780,11 @@ Option<bool> CollectionManager::do_search(std::map<std::string, std::string>& re
 
     const char *ENABLE_HIGHLIGHT_V1 = "enable_highlight_v1";
 
+    const char *EXPLAIN_FILTER = "explain_filter";
+
+    // cursor to the page that follows the hits of a previous search
+    const char *SEARCH_AFTER = "search_after";
+
     // enrich params with values from embedded params
     for(auto& item: embedded_params.items()) {
         if(item.key() == "expires_at") {
@@ -780,7 +862,9 @@ Option<bool> CollectionManager::do_search(std::map<std::string, std::string>& re
     size_t max_extra_prefix = INT16_MAX;
     size_t max_extra_suffix = INT16_MAX;
     bool enable_highlight_v1 = true;
+    bool explain_filter = false;
     text_match_type_t match_type = max_score;
+    std::string search_after_str;
 
     std::unordered_map<std::string, size_t*> unsigned_int_values = {
         {MIN_LEN_1TYPO, &min_len_1typo},
@@ -812,6 +896,7 @@ Option<bool> CollectionManager::do_search(std::map<std::string, std::string>& re
         {HIGHLIGHT_END_TAG, &highlight_end_tag},
         {PINNED_HITS, &pinned_hits_str},
         {HIDDEN_HITS, &hidden_hits_str},
+        {SEARCH_AFTER, &search_after_str},
     };
 
     std::unordered_map<std::string, bool*> bool_values = {
@@ -821,6 +906,7 @@ Option<bool> CollectionManager::do_search(std::map<std::string, std::string>& re
         {EXHAUSTIVE_SEARCH, &exhaustive_search},
         {ENABLE_OVERRIDES, &enable_overrides},
         {ENABLE_HIGHLIGHT_V1, &enable_highlight_v1},
+        {EXPLAIN_FILTER, &explain_filter},
     };
 
     std::unordered_map<std::string, std::vector<std::string>*> str_list_values = {
@@ -897,6 +983,12 @@ Option<bool> CollectionManager::do_search(std::map<std::string, std::string>& re
             }
 
             auto find_str_list_it = str_list_values.find(key);
+            if(find_str_list_it != str_list_values.end() && key == FACET_BY) {
+                // the ranges of a facet are comma separated too
+                StringUtils::split_facet_by(val, *find_str_list_it->second);
+                continue;
+            }
+
             if(find_str_list_it != str_list_values.end()) {
                 StringUtils::split(val, *find_str_list_it->second, ",");
                 continue;
@@ -997,7 +1089,8 @@ Option<bool> CollectionManager::do_search(std::map<std::string, std::string>& re
                                                           vector_query,
                                                           enable_highlight_v1,
                                                           start_ts,
-                                                          match_type
+                                                          match_type,
+                                                          search_after_str
                                                         );
 
     uint64_t timeMillis = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -1010,13 +1103,22 @@ Option<bool> CollectionManager::do_search(std::map<std::string, std::string>& re
         return Option<bool>(result_op.code(), result_op.error());
     }
 
-    nlohmann::json result = result_op.get();
+    // the results are large for big pages, so they are moved out instead of being copied
+    nlohmann::json result = result_op.take();
 
     if(exclude_fields.count("search_time_ms") == 0) {
         result["search_time_ms"] = timeMillis;
     }
 
     result["page"] = page;
+
+    if(explain_filter && !simple_filter_query.empty()) {
+        auto explain_op = collection->explain_filter(simple_filter_query, result["filter_plan"]);
+        if(!explain_op.ok()) {
+            return explain_op;
+        }
+    }
+
     results_json_str = result.dump(-1, ' ', false, nlohmann::detail::error_handler_t::ignore);
 
     //LOG(INFO) << "Time taken: " << timeMillis << "ms";
@@ -1042,6 +1144,45 @@ nlohmann::json CollectionManager::get_collection_summaries() const {
     return json_summaries;
 }
 
+void CollectionManager::get_token_expansion_cache_stats(nlohmann::json& result) const {
+    std::shared_lock lock(mutex);
+
+    uint64_t hits = 0, narrowed_hits = 0, misses = 0;
+
+    for(const auto& kv: collections) {
+        kv.second->get_token_expansion_cache_stats(hits, narrowed_hits, misses);
+    }
+
+    const uint64_t lookups = hits + narrowed_hits + misses;
+
+    result["token_expansion_cache"]["hits"] = hits;
+    result["token_expansion_cache"]["narrowed_hits"] = narrowed_hits;
+    result["token_expansion_cache"]["misses"] = misses;
+    result["token_expansion_cache"]["hit_rate"] = (lookups == 0) ? 0.0 :
+                                                  double(hits + narrowed_hits) / lookups;
+}
+
+void CollectionManager::get_filter_result_cache_stats(nlohmann::json& result) const {
+    std::shared_lock lock(mutex);
+
+    uint64_t hits = 0, misses = 0, evictions = 0, invalidations = 0;
+    size_t num_bytes = 0;
+
+    for(const auto& kv: collections) {
+        kv.second->get_filter_result_cache_stats(hits, misses, evictions, invalidations, num_bytes);
+    }
+
+    const uint64_t lookups = hits + misses;
+
+    result["filter_result_cache"]["hits"] = hits;
+    result["filter_result_cache"]["misses"] = misses;
+    result["filter_result_cache"]["evictions"] = evictions;
+    result["filter_result_cache"]["invalidations"] = invalidations;
+    result["filter_result_cache"]["num_bytes"] = num_bytes;
+    result["filter_result_cache"]["max_bytes_per_collection"] = filter_result_cache_t::DEFAULT_MAX_BYTES;
+    result["filter_result_cache"]["hit_rate"] = (lookups == 0) ? 0.0 : double(hits) / lookups;
+}
+
 Option<Collection*> CollectionManager::create_collection(nlohmann::json& req_json) {
     const char* NUM_MEMORY_SHARDS = "num_memory_shards";
     const char* SYMBOLS_TO_INDEX = "symbols_to_index";
@@ -1202,6 +1343,16 @@ Option<bool> CollectionManager::load_collection(const nlohmann::json &collection
 
     LOG(INFO) << "Loading collection " << collection->get_name();
 
+    // vector graphs are tuned once all the documents are indexed, instead of every time they double in size
+    collection->defer_vector_index_tuning(true);
+
+    const bool restore_vector_indices = cm.vector_index_snapshot_manifest.contains("indices");
+    if(restore_vector_indices) {
+        collection->restore_vector_indices(cm.vector_index_snapshot_dir,
+                                           cm.vector_index_snapshot_manifest["indices"],
+                                           cm.vector_index_snapshot_fresh);
+    }
+
     // initialize overrides
     std::vector<std::string> collection_override_jsons;
     cm.store->scan_fill(Collection::get_override_key(this_collection_name, ""),
@@ -1315,6 +1466,12 @@ Option<bool> CollectionManager::load_collection(const nlohmann::json &collection
         }
     }
 
+    if(restore_vector_indices) {
+        collection->finish_vector_index_restore();
+    }
+
+    collection->defer_vector_index_tuning(false);
+
     cm.add_to_collections(collection);
 
     LOG(INFO) << "Indexed " << num_indexed_docs << "/" << num_found_docs
@@ -10,13 +10,23 @@
 #include "system_metrics.h"
 #include "logger.h"
 #include "core_api_utils.h"
-#include "lru/lru.hpp"
 #include "ratelimit_manager.h"
+#include "search_result_cache.h"
 
 using namespace std::chrono_literals;
 
-std::shared_mutex mutex;
-LRU::Cache<uint64_t, cached_res_t> res_cache;
+SearchResultCache res_cache(SearchResultCache::DEFAULT_MAX_BYTES, [](const std::string& collection_name) -> uint64_t {
+    auto collection = CollectionManager::get_instance().get_collection(collection_name);
+    return (collection == nullptr) ? 0 : collection->get_write_generation();
+});
+
+// Bounds the number of multi search sub-searches that are run at the same time. It is never destroyed since its
+// threads could still be waiting for work when static objects are destructed on exit.
+static ThreadPool* get_multi_search_thread_pool() {
+    static ThreadPool* multi_search_thread_pool =
+            new ThreadPool(std::max<size_t>(1, std::thread::hardware_concurrency()));
+    return multi_search_thread_pool;
+}
 
 bool handle_authentication(std::map<std::string, std::string>& req_params,
                            std::vector<nlohmann::json>& embedded_params_vec,
@@ -242,6 +252,11 @@ bool del_drop_collection(const std::shared_ptr<http_req>& req, const std::shared
         return false;
     }
 
+    res_cache.remove_collection_stats(req->params["collection"]);
+    if(drop_op.get().count("name") != 0) {
+        res_cache.remove_collection_stats(drop_op.get()["name"].get<std::string>());
+    }
+
     res->set_200(drop_op.get().dump());
     return true;
 }
@@ -302,6 +317,11 @@ bool get_stats_json(const std::shared_ptr<http_req>& req, const std::shared_ptr<
     nlohmann::json result;
     AppMetrics::get_instance().get("requests_per_second", "latency_ms", result);
     result["pending_write_batches"] = server->get_num_queued_writes();
+    server->get_group_commit_stats(result["raft_write_batches"]);
+    server->get_forward_stats(result["raft_forwarded_writes"]);
+    res_cache.get_stats(result["search_cache"]);
+    CollectionManager::get_instance().get_token_expansion_cache_stats(result);
+    CollectionManager::get_instance().get_filter_result_cache_stats(result);
 
     res->set_body(200, result.dump(2));
     return true;
@@ -327,6 +347,10 @@ uint64_t hash_request(const std::shared_ptr<http_req>& req) {
     return StringUtils::hash_wy(req_str.c_str(), req_str.size());
 }
 
+void set_search_cache_max_bytes(size_t max_bytes) {
+    res_cache.set_max_bytes(max_bytes);
+}
+
 bool get_search(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res) {
     const auto use_cache_it = req->params.find("use_cache");
     bool use_cache = (use_cache_it != req->params.end()) && (use_cache_it->second == "1" || use_cache_it->second == "true");
@@ -338,23 +362,12 @@ bool get_search(const std::shared_ptr<http_req>& req, const std::shared_ptr<http
 
         //LOG(INFO) << "req_hash = " << req_hash;
 
-        std::shared_lock lock(mutex);
-        auto hit_it = res_cache.find(req_hash);
-        if(hit_it != res_cache.end()) {
+        // the cached result is discarded when its TTL has lapsed or a searched collection has been written to
+        cached_res_t cached_value;
+        if(res_cache.lookup(req_hash, cached_value)) {
             //LOG(INFO) << "Result found in cache.";
-            const auto& cached_value = hit_it.value();
-
-            // we still need to check that TTL has not expired
-            uint32_t ttl = cached_value.ttl;
-            uint64_t seconds_elapsed = std::chrono::duration_cast<std::chrono::seconds>(
-                    std::chrono::high_resolution_clock::now() - cached_value.created_at).count();
-
-            if(seconds_elapsed < cached_value.ttl) {
-                res->set_content(cached_value.status_code, cached_value.content_type_header, cached_value.body, true);
-                return true;
-            }
-
-            //LOG(INFO) << "Result found in cache but ttl lapsed.";
+            res->set_content(cached_value.status_code, cached_value.content_type_header, cached_value.body, true);
+            return true;
         }
     }
 
@@ -386,6 +399,13 @@ bool get_search(const std::shared_ptr<http_req>& req, const std::shared_ptr<http
         return false;
     }
 
+    // taken before searching, so that a write which lands during the search invalidates the cached result
+    SearchResultCache::generations_t cache_generations;
+    if(use_cache) {
+        cache_generations = res_cache.get_generations({req->params["collection"]});
+        res_cache.record_miss(cache_generations);
+    }
+
     std::string results_json_str;
     Option<bool> search_op = CollectionManager::do_search(req->params, req->embedded_params_vec[0],
                                                           results_json_str, req->conn_ts);
@@ -398,7 +418,7 @@ bool get_search(const std::shared_ptr<http_req>& req, const std::shared_ptr<http
         return false;
     }
 
-    res->set_200(results_json_str);
+    res->set_200(std::move(results_json_str));
 
     // we will cache only successful requests
     if(use_cache) {
@@ -412,9 +432,7 @@ bool get_search(const std::shared_ptr<http_req>& req, const std::shared_ptr<http
 
         cached_res_t cached_res;
         cached_res.load(res->status_code, res->content_type_header, res->body, now, cache_ttl, req_hash);
-
-        std::unique_lock lock(mutex);
-        res_cache.insert(req_hash, cached_res);
+        res_cache.insert(req_hash, cached_res, cache_generations);
     }
 
     return true;
@@ -431,21 +449,12 @@ bool post_multi_search(const std::shared_ptr<http_req>& req, const std::shared_p
 
         //LOG(INFO) << "req_hash = " << req_hash;
 
-        std::shared_lock lock(mutex);
-        auto hit_it = res_cache.find(req_hash);
-        if(hit_it != res_cache.end()) {
+        // the cached result is discarded when its TTL has lapsed or a searched collection has been written to
+        cached_res_t cached_value;
+        if(res_cache.lookup(req_hash, cached_value)) {
             //LOG(INFO) << "Result found in cache.";
-            const auto& cached_value = hit_it.value();
-
-            // we still need to check that TTL has not expired
-            uint32_t ttl = cached_value.ttl;
-            uint64_t seconds_elapsed = std::chrono::duration_cast<std::chrono::seconds>(
-                    std::chrono::high_resolution_clock::now() - cached_value.created_at).count();
-
-            if(seconds_elapsed < cached_value.ttl) {
-                res->set_content(cached_value.status_code, cached_value.content_type_header, cached_value.body, true);
-                return true;
-            }
+            res->set_content(cached_value.status_code, cached_value.content_type_header, cached_value.body, true);
+            return true;
         }
     }
 
@@ -498,9 +507,6 @@ bool post_multi_search(const std::shared_ptr<http_req>& req, const std::shared_p
         return false;
     }
 
-    nlohmann::json response;
-    response["results"] = nlohmann::json::array();
-
     nlohmann::json& searches = req_json["searches"];
 
     if(searches.size() != req->embedded_params_vec.size()) {
@@ -513,6 +519,10 @@ bool post_multi_search(const std::shared_ptr<http_req>& req, const std::shared_p
 
     //LOG(INFO) << "REQ: " << req_json.dump(-1);
 
+    // params of each search, which are resolved up front so that a malformed search fails the request before
+    // any of the searches are run
+    std::vector<std::map<std::string, std::string>> search_req_params(searches.size());
+
     for(size_t i = 0; i < searches.size(); i++) {
         auto& search_params = searches[i];
 
@@ -558,12 +568,108 @@ bool post_multi_search(const std::shared_ptr<http_req>& req, const std::shared_p
             }
         }
 
-        std::string results_json_str;
-        Option<bool> search_op = CollectionManager::do_search(req->params, req->embedded_params_vec[i],
-                                                              results_json_str, req->conn_ts);
+        search_req_params[i] = req->params;
+    }
+
+    // identical searches are run only once: `search_origins[i]` is the search whose results are used for search `i`
+    std::vector<size_t> search_origins(searches.size());
+    std::unordered_map<std::string, size_t> search_keys;
+
+    for(size_t i = 0; i < searches.size(); i++) {
+        std::string search_key = req->embedded_params_vec[i].dump();
+        for(const auto& kv: search_req_params[i]) {
+            search_key += "\n" + kv.first + "=" + kv.second;
+        }
+
+        search_origins[i] = search_keys.emplace(search_key, i).first->second;
+    }
+
+    // taken before searching, so that a write which lands during the searches invalidates the cached result
+    SearchResultCache::generations_t cache_generations;
+    if(use_cache) {
+        std::set<std::string> collection_names;
+        for(auto& params: search_req_params) {
+            collection_names.insert(params["collection"]);
+        }
+
+        cache_generations = res_cache.get_generations({collection_names.begin(), collection_names.end()});
+        res_cache.record_miss(cache_generations);
+    }
+
+    std::vector<std::string> results_json_strs(searches.size());
+    std::vector<Option<bool>> search_ops(searches.size(), Option<bool>(true));
+
+    // once a search times out, the request fails with a 408, so searches which haven't started yet are skipped
+    std::atomic<bool> timed_out = false;
+
+    auto run_search = [&](size_t i) {
+        if(timed_out) {
+            search_ops[i] = Option<bool>(408, "Request Timeout");
+            return;
+        }
+
+        search_ops[i] = CollectionManager::do_search(search_req_params[i], req->embedded_params_vec[i],
+                                                     results_json_strs[i], req->conn_ts);
+
+        if(!search_ops[i].ok() && search_ops[i].code() == 408) {
+            timed_out = true;
+        }
+    };
+
+    std::vector<std::future<void>> search_futures;
+
+    for(size_t i = 0; i < searches.size(); i++) {
+        if(search_origins[i] != i) {
+            continue;
+        }
+
+        if(searches.size() == 1) {
+            run_search(i);
+        } else {
+            search_futures.push_back(get_multi_search_thread_pool()->enqueue(run_search, i));
+        }
+    }
+
+    // every search is waited on, even after one fails, since the queued ones refer to the locals of this function
+    bool searches_run = true;
+
+    for(auto& search_future: search_futures) {
+        try {
+            search_future.get();
+        } catch(const std::exception& e) {
+            // thrown when the pool was shut down before the search could run
+            if(searches_run) {
+                LOG(ERROR) << "Multi search was not run: " << e.what();
+            }
+            searches_run = false;
+        }
+    }
+
+    if(!searches_run) {
+        res->set_503("Not Ready or Lagging");
+        return false;
+    }
+
+    // results are already serialized, so they are spliced into the response instead of being parsed and dumped again
+    size_t response_size = 16;
+    for(size_t i = 0; i < searches.size(); i++) {
+        response_size += results_json_strs[search_origins[i]].size() + 1;
+    }
+
+    std::string response_body;
+    response_body.reserve(response_size);
+    response_body += "{\"results\":[";
+
+    for(size_t i = 0; i < searches.size(); i++) {
+        const size_t origin = search_origins[i];
+        const Option<bool>& search_op = search_ops[origin];
+
+        if(i != 0) {
+            response_body += ",";
+        }
 
         if(search_op.ok()) {
-            response["results"].push_back(nlohmann::json::parse(results_json_str));
+            response_body += results_json_strs[origin];
         } else {
             if(search_op.code() == 408) {
                 res->set(search_op.code(), search_op.error());
@@ -573,11 +679,18 @@ bool post_multi_search(const std::shared_ptr<http_req>& req, const std::shared_p
             nlohmann::json err_res;
             err_res["error"] = search_op.error();
             err_res["code"] = search_op.code();
-            response["results"].push_back(err_res);
+            response_body += err_res.dump();
         }
     }
 
-    res->set_200(response.dump());
+    response_body += "]}";
+
+    if(!searches.empty()) {
+        // the params of the searches are resolved further while searching, e.g. with embedded params
+        req->params = search_req_params[search_origins.back()];
+    }
+
+    res->set_200(std::move(response_body));
 
     // we will cache only successful requests
     if(use_cache) {
@@ -591,9 +704,7 @@ bool post_multi_search(const std::shared_ptr<http_req>& req, const std::shared_p
 
         cached_res_t cached_res;
         cached_res.load(res->status_code, res->content_type_header, res->body, now, cache_ttl, req_hash);
-
-        std::unique_lock lock(mutex);
-        res_cache.insert(req_hash, cached_res);
+        res_cache.insert(req_hash, cached_res, cache_generations);
     }
 
     return true;
@@ -948,6 +1059,48 @@ bool post_add_document(const std::shared_ptr<http_req>& req, const std::shared_p
     return true;
 }
 
+void batch_add_documents(const std::vector<std::shared_ptr<http_req>>& reqs,
+                         const std::vector<std::shared_ptr<http_res>>& ress) {
+    // all the requests target the same collection with the same `action` and `dirty_values`
+    const std::shared_ptr<http_req>& first_req = reqs.front();
+
+    CollectionManager & collectionManager = CollectionManager::get_instance();
+    auto collection = collectionManager.get_collection(first_req->params["collection"]);
+
+    if(collection == nullptr) {
+        for(const auto& res: ress) {
+            res->set_404();
+        }
+        return;
+    }
+
+    const index_operation_t operation = get_index_operation(first_req->params["action"]);
+    const auto& dirty_values = collection->parse_dirty_values_option(first_req->params["dirty_values"]);
+
+    std::vector<std::string> json_lines;
+    json_lines.reserve(reqs.size());
+
+    for(const auto& req: reqs) {
+        json_lines.push_back(req->body);
+    }
+
+    nlohmann::json document;
+    collection->add_many(json_lines, document, operation, "", dirty_values, true, false);
+
+    for(size_t i = 0; i < json_lines.size(); i++) {
+        // same responses as `post_add_document` would have sent for each of the requests
+        nlohmann::json line_res = nlohmann::json::parse(json_lines[i], nullptr, false);
+
+        if(line_res.is_discarded() || !line_res.is_object() || !line_res.contains("success")) {
+            ress[i]->set_500("Could not parse the indexing result.");
+        } else if(line_res["success"].get<bool>()) {
+            ress[i]->set_201(line_res["document"].dump(-1, ' ', false, nlohmann::detail::error_handler_t::ignore));
+        } else {
+            ress[i]->set(line_res["code"].get<size_t>(), line_res["error"].get<std::string>());
+        }
+    }
+}
+
 bool patch_update_document(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res) {
     std::string doc_id = req->params["id"];
 
@@ -1511,10 +1664,7 @@ bool post_config(const std::shared_ptr<http_req>& req, const std::shared_ptr<htt
 }
 
 bool post_clear_cache(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res) {
-    {
-        std::unique_lock lock(mutex);
-        res_cache.clear();
-    }
+    res_cache.clear();
 
     nlohmann::json response;
     response["success"] = true;
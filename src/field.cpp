@@ -1,6 +1,7 @@
 #include <store.h>
 #include "field.h"
 #include "magic_enum.hpp"
+#include "typo_index.h"
 #include <stack>
 
 Option<bool> filter::parse_geopoint_filter_value(std::string& raw_value,
@@ -495,6 +496,49 @@ Option<bool> field::json_field_to_field(bool enable_nested_fields, nlohmann::jso
                                  field_json[fields::name].get<std::string>() + std::string("` should be a boolean."));
     }
 
+    if(field_json.count(fields::typo_index_max_len) != 0) {
+        if(!field_json.at(fields::typo_index_max_len).is_number_unsigned() ||
+           field_json[fields::typo_index_max_len].get<size_t>() > typo_index_t::MAX_TOKEN_LEN) {
+            return Option<bool>(400, std::string("The `typo_index_max_len` property of the field `") +
+                                     field_json[fields::name].get<std::string>() +
+                                     std::string("` should be an integer between 0 and ") +
+                                     std::to_string(typo_index_t::MAX_TOKEN_LEN) + ".");
+        }
+
+        if(field_json[fields::typo_index_max_len].get<size_t>() != 0 &&
+           field_json[fields::type] != field_types::STRING && field_json[fields::type] != field_types::STRING_ARRAY) {
+            return Option<bool>(400, std::string("The `typo_index_max_len` property of the field `") +
+                                     field_json[fields::name].get<std::string>() +
+                                     std::string("` is only allowed on a string field."));
+        }
+    }
+
+    if(field_json.count(fields::store_token_offsets) != 0) {
+        if(!field_json.at(fields::store_token_offsets).is_boolean()) {
+            return Option<bool>(400, std::string("The `store_token_offsets` property of the field `") +
+                                     field_json[fields::name].get<std::string>() +
+                                     std::string("` should be a boolean."));
+        }
+
+        if(field_json[fields::store_token_offsets].get<bool>()) {
+            if(field_json[fields::type] != field_types::STRING &&
+               field_json[fields::type] != field_types::STRING_ARRAY) {
+                return Option<bool>(400, std::string("The `store_token_offsets` property of the field `") +
+                                         field_json[fields::name].get<std::string>() +
+                                         std::string("` is only allowed on a string field."));
+            }
+
+            // token offsets can be resumed from only when the text is not segmented by ICU
+            if(field_json.count(fields::locale) != 0 && field_json[fields::locale].is_string() &&
+               !field_json[fields::locale].get<std::string>().empty() && field_json[fields::locale] != "en") {
+                return Option<bool>(400, std::string("The `store_token_offsets` property of the field `") +
+                                         field_json[fields::name].get<std::string>() +
+                                         std::string("` is not supported with the `") +
+                                         field_json[fields::locale].get<std::string>() + "` locale.");
+            }
+        }
+    }
+
     if(field_json.count(fields::locale) != 0){
         if(!field_json.at(fields::locale).is_string()) {
             return Option<bool>(400, std::string("The `locale` property of the field `") +
@@ -590,6 +634,14 @@ Option<bool> field::json_field_to_field(bool enable_nested_fields, nlohmann::jso
         field_json[fields::infix] = false;
     }
 
+    if(field_json.count(fields::typo_index_max_len) == 0) {
+        field_json[fields::typo_index_max_len] = 0;
+    }
+
+    if(field_json.count(fields::store_token_offsets) == 0) {
+        field_json[fields::store_token_offsets] = false;
+    }
+
     if(field_json[fields::type] == field_types::OBJECT || field_json[fields::type] == field_types::OBJECT_ARRAY) {
         if(!enable_nested_fields) {
             return Option<bool>(400, "Type `object` or `object[]` can be used only when nested fields are enabled by "
@@ -633,6 +685,47 @@ Option<bool> field::json_field_to_field(bool enable_nested_fields, nlohmann::jso
         }
     }
 
+    if(field_json[fields::num_dim] == 0) {
+        for(const auto& vec_property: {fields::vec_quantization, fields::vec_rerank}) {
+            if(field_json.count(vec_property) != 0) {
+                return Option<bool>(400, "Property `" + vec_property + "` is only allowed on a vector field.");
+            }
+        }
+    }
+
+    if(field_json.count(fields::vec_quantization) == 0) {
+        field_json[fields::vec_quantization] = magic_enum::enum_name(vector_quantization_t::none);
+    } else if(!field_json[fields::vec_quantization].is_string() ||
+              !magic_enum::enum_cast<vector_quantization_t>(
+                  field_json[fields::vec_quantization].get<std::string>()).has_value()) {
+        return Option<bool>(400, "Property `" + fields::vec_quantization + "` must be one of `none`, `int8` or `pq`.");
+    }
+
+    if(field_json.count(fields::vec_rerank) == 0) {
+        field_json[fields::vec_rerank] = field::DEFAULT_VEC_RERANK;
+    } else if(!field_json[fields::vec_rerank].is_number_unsigned()) {
+        return Option<bool>(400, "Property `" + fields::vec_rerank + "` must be an unsigned integer.");
+    }
+
+    hnsw_params_t hnsw_params;
+
+    if(field_json.count(fields::hnsw_params) != 0) {
+        if(field_json[fields::num_dim] == 0) {
+            return Option<bool>(400, "Property `" + fields::hnsw_params + "` is only allowed on a vector field.");
+        }
+
+        auto hnsw_params_op = hnsw_params_t::parse(field_json[fields::hnsw_params], hnsw_params);
+        if(!hnsw_params_op.ok()) {
+            return hnsw_params_op;
+        }
+
+        if(hnsw_params.target_recall != 0 &&
+           field_json[fields::vec_quantization].get<std::string>() != "none") {
+            return Option<bool>(400, "Property `target_recall` of `" + fields::hnsw_params +
+                                     "` cannot be used along with `" + fields::vec_quantization + "`.");
+        }
+    }
+
     if(field_json.count(fields::optional) == 0) {
         // dynamic type fields are always optional
         bool is_dynamic = field::is_dynamic(field_json[fields::name], field_json[fields::type]);
@@ -657,12 +750,16 @@ Option<bool> field::json_field_to_field(bool enable_nested_fields, nlohmann::jso
     }
 
     auto vec_dist = magic_enum::enum_cast<vector_distance_type_t>(field_json[fields::vec_dist].get<std::string>()).value();
+    auto vec_quantization = magic_enum::enum_cast<vector_quantization_t>(
+            field_json[fields::vec_quantization].get<std::string>()).value();
 
     the_fields.emplace_back(
             field(field_json[fields::name], field_json[fields::type], field_json[fields::facet],
                   field_json[fields::optional], field_json[fields::index], field_json[fields::locale],
                   field_json[fields::sort], field_json[fields::infix], field_json[fields::nested],
-                  field_json[fields::nested_array], field_json[fields::num_dim], vec_dist)
+                  field_json[fields::nested_array], field_json[fields::num_dim], vec_dist,
+                  field_json[fields::typo_index_max_len], field_json[fields::store_token_offsets],
+                  vec_quantization, field_json[fields::vec_rerank], hnsw_params)
     );
 
     return Option<bool>(true);
@@ -843,3 +940,56 @@ void field::compact_nested_fields(tsl::htrie_map<char, field>& nested_fields) {
         nested_fields.erase_prefix(field_name + ".");
     }
 }
+
+bool hnsw_params_t::is_default() const {
+    const hnsw_params_t defaults;
+    return M == defaults.M && ef_construction == defaults.ef_construction && ef == defaults.ef &&
+           target_recall == defaults.target_recall;
+}
+
+nlohmann::json hnsw_params_t::to_json() const {
+    nlohmann::json hnsw_params_json;
+    hnsw_params_json["M"] = M;
+    hnsw_params_json["ef_construction"] = ef_construction;
+    hnsw_params_json["ef"] = ef;
+
+    if(target_recall != 0) {
+        hnsw_params_json["target_recall"] = target_recall;
+    }
+
+    return hnsw_params_json;
+}
+
+Option<bool> hnsw_params_t::parse(const nlohmann::json& hnsw_params_json, hnsw_params_t& hnsw_params) {
+    if(!hnsw_params_json.is_object()) {
+        return Option<bool>(400, "Property `" + fields::hnsw_params + "` must be an object.");
+    }
+
+    for(const auto& param: {"M", "ef_construction", "ef"}) {
+        if(hnsw_params_json.count(param) != 0 && (!hnsw_params_json[param].is_number_unsigned() ||
+                                                  hnsw_params_json[param].get<size_t>() == 0)) {
+            return Option<bool>(400, "Property `" + std::string(param) + "` of `" + fields::hnsw_params +
+                                     "` must be a positive integer.");
+        }
+    }
+
+    hnsw_params.M = hnsw_params_json.value("M", hnsw_params.M);
+    hnsw_params.ef_construction = hnsw_params_json.value("ef_construction", hnsw_params.ef_construction);
+    hnsw_params.ef = hnsw_params_json.value("ef", hnsw_params.ef);
+
+    if(hnsw_params.M < 2) {
+        return Option<bool>(400, "Property `M` of `" + fields::hnsw_params + "` must be at least 2.");
+    }
+
+    if(hnsw_params_json.count("target_recall") != 0) {
+        if(!hnsw_params_json["target_recall"].is_number() || hnsw_params_json["target_recall"].get<float>() < 0 ||
+           hnsw_params_json["target_recall"].get<float>() >= 1) {
+            return Option<bool>(400, "Property `target_recall` of `" + fields::hnsw_params +
+                                     "` must be a number between 0 and 1.");
+        }
+
+        hnsw_params.target_recall = hnsw_params_json["target_recall"].get<float>();
+    }
+
+    return Option<bool>(true);
+}
@@ -0,0 +1,186 @@
+#include <algorithm>
+#include "filter_result_cache.h"
+
+filter_result_cache_t::filter_result_cache_t(size_t max_bytes): max_bytes(max_bytes) {
+
+}
+
+bool filter_result_cache_t::get_key(const filter& a_filter, std::string& key) {
+    if(a_filter.field_name == "id" || a_filter.values.empty() ||
+       a_filter.comparators.size() != a_filter.values.size()) {
+        return false;
+    }
+
+    std::vector<std::pair<int, std::string>> comparator_values;
+    bool has_range = false;
+
+    for(size_t i = 0; i < a_filter.values.size(); i++) {
+        comparator_values.emplace_back(a_filter.comparators[i], a_filter.values[i]);
+        has_range = has_range || (a_filter.comparators[i] == RANGE_INCLUSIVE);
+    }
+
+    // values are ORed, so their order does not matter unless they hold the bounds of a range
+    if(!has_range) {
+        std::sort(comparator_values.begin(), comparator_values.end());
+    }
+
+    key.clear();
+    key += a_filter.field_name;
+
+    for(const auto& comparator_value: comparator_values) {
+        key += '\0';
+        key += std::to_string(comparator_value.first);
+        key += ':';
+        key += comparator_value.second;
+    }
+
+    return true;
+}
+
+bool filter_result_cache_t::is_expensive(const field& a_field, const filter& a_filter) {
+    if(a_field.is_geopoint()) {
+        return true;
+    }
+
+    for(const auto& comparator: a_filter.comparators) {
+        if(a_field.is_bool() && comparator == NOT_EQUALS) {
+            return true;
+        }
+
+        if((a_field.is_integer() || a_field.is_float()) && comparator != EQUALS) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+uint64_t filter_result_cache_t::get_generation() const {
+    return generation.load();
+}
+
+void filter_result_cache_t::invalidate(const std::string& field_name) {
+    std::unique_lock<std::mutex> lock(mutex);
+    field_write_generations[field_name] = ++generation;
+}
+
+bool filter_result_cache_t::is_stale(const std::vector<std::string>& field_names,
+                                     uint64_t computed_generation) const {
+    for(const auto& field_name: field_names) {
+        auto write_generation_it = field_write_generations.find(field_name);
+        if(write_generation_it != field_write_generations.end() &&
+           write_generation_it->second > computed_generation) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void filter_result_cache_t::erase_entry(std::list<entry_t>::iterator entry_it) {
+    num_bytes -= entry_it->num_bytes;
+    entry_map.erase(entry_it->key);
+    entries.erase(entry_it);
+}
+
+bool filter_result_cache_t::get(const std::string& key, uint32_t*& ids, uint32_t& ids_length) {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    auto entry_map_it = entry_map.find(key);
+    if(entry_map_it == entry_map.end()) {
+        return false;
+    }
+
+    auto entry_it = entry_map_it->second;
+
+    if(is_stale(entry_it->field_names, entry_it->generation)) {
+        erase_entry(entry_it);
+        num_invalidations++;
+        return false;
+    }
+
+    entries.splice(entries.begin(), entries, entry_it);
+
+    // an empty result is handed back the way it is produced by filtering
+    ids_length = entry_it->ids.getLength();
+    ids = (ids_length == 0) ? nullptr : entry_it->ids.uncompress();
+    num_hits++;
+
+    return true;
+}
+
+void filter_result_cache_t::put(const std::string& key, const std::vector<std::string>& field_names,
+                                uint64_t computed_generation, const uint32_t* ids, uint32_t ids_length) {
+    // only results worth caching are counted as misses, since most filters are too cheap to be cached
+    num_misses++;
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    if(is_stale(field_names, computed_generation)) {
+        return;
+    }
+
+    // replaces any stale result stored against the same key
+    auto entry_map_it = entry_map.find(key);
+    if(entry_map_it != entry_map.end()) {
+        erase_entry(entry_map_it->second);
+    }
+
+    entries.emplace_front();
+    entry_t& entry = entries.front();
+    entry.key = key;
+    entry.field_names = field_names;
+    entry.generation = computed_generation;
+    entry.ids.load(ids, ids_length);
+    entry.num_bytes = sizeof(entry_t) + key.size() + entry.ids.getSizeInBytes();
+
+    if(entry.num_bytes > max_bytes) {
+        entries.pop_front();
+        return;
+    }
+
+    entry_map.emplace(key, entries.begin());
+    num_bytes += entry.num_bytes;
+
+    while(num_bytes > max_bytes) {
+        erase_entry(std::prev(entries.end()));
+        num_evictions++;
+    }
+}
+
+void filter_result_cache_t::clear() {
+    std::unique_lock<std::mutex> lock(mutex);
+    entries.clear();
+    entry_map.clear();
+    num_bytes = 0;
+}
+
+uint64_t filter_result_cache_t::hits() const {
+    return num_hits.load();
+}
+
+uint64_t filter_result_cache_t::misses() const {
+    return num_misses.load();
+}
+
+uint64_t filter_result_cache_t::evictions() const {
+    return num_evictions.load();
+}
+
+uint64_t filter_result_cache_t::invalidations() const {
+    return num_invalidations.load();
+}
+
+size_t filter_result_cache_t::size() {
+    std::unique_lock<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+size_t filter_result_cache_t::get_num_bytes() {
+    std::unique_lock<std::mutex> lock(mutex);
+    return num_bytes;
+}
+
+size_t filter_result_cache_t::get_max_bytes() const {
+    return max_bytes;
+}
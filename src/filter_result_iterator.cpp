@@ -0,0 +1,310 @@
+#include "filter_result_iterator.h"
+#include "posting.h"
+
+// a posting list iterator stays on its last id when it is skipped past it
+static bool skip_posting_it(posting_list_t::iterator_t& it, uint32_t id) {
+    it.skip_to(id);
+    return it.valid() && it.id() >= id;
+}
+
+filter_result_iterator_t::filter_result_iterator_t(uint32_t* ids, uint32_t ids_length):
+        node_type(node_t::ids_leaf), ids(ids), ids_length(ids_length) {
+    reset();
+}
+
+filter_result_iterator_t::filter_result_iterator_t(id_list_t* id_list):
+        node_type(node_t::id_list_leaf), id_list(id_list) {
+    reset();
+}
+
+filter_result_iterator_t::filter_result_iterator_t(const std::vector<std::vector<void*>>& value_posting_lists,
+                                                   const bool exact_match, const bool field_is_array):
+        node_type(node_t::posting_leaf), exact_match(exact_match), field_is_array(field_is_array) {
+
+    for(const auto& raw_posting_lists: value_posting_lists) {
+        if(raw_posting_lists.empty()) {
+            continue;
+        }
+
+        std::vector<posting_list_t*> plists;
+        posting_t::to_expanded_plists(raw_posting_lists, plists, expanded_plists);
+        value_plists.push_back(std::move(plists));
+    }
+
+    reset();
+}
+
+filter_result_iterator_t::filter_result_iterator_t(op_t op, filter_result_iterator_t* left,
+                                                   filter_result_iterator_t* right):
+        node_type(node_t::op), op(op), left(left), right(right) {
+    reset();
+}
+
+filter_result_iterator_t::~filter_result_iterator_t() {
+    // iterators must be released before the posting lists they point to
+    value_its.clear();
+
+    for(auto expanded_plist: expanded_plists) {
+        delete expanded_plist;
+    }
+
+    delete [] ids;
+}
+
+bool filter_result_iterator_t::valid() const {
+    return is_valid;
+}
+
+void filter_result_iterator_t::advance_value(size_t value_index) {
+    auto& its = value_its[value_index];
+    uint32_t& value_seq_id = value_seq_ids[value_index];
+
+    while(true) {
+        uint32_t largest_id = 0;
+        bool all_equal = true;
+
+        for(size_t i = 0; i < its.size(); i++) {
+            if(!its[i].valid()) {
+                value_seq_id = UINT32_MAX;
+                return;
+            }
+
+            if(i != 0 && its[i].id() != largest_id) {
+                all_equal = false;
+            }
+
+            largest_id = std::max(largest_id, its[i].id());
+        }
+
+        if(!all_equal) {
+            for(auto& it: its) {
+                if(it.id() < largest_id && !skip_posting_it(it, largest_id)) {
+                    value_seq_id = UINT32_MAX;
+                    return;
+                }
+            }
+
+            continue;
+        }
+
+        if(exact_match) {
+            uint32_t exact_id;
+            uint32_t* exact_ids = &exact_id;
+            size_t num_exact_ids = 0;
+            posting_list_t::get_exact_matches(its, field_is_array, &largest_id, 1, exact_ids, num_exact_ids);
+
+            if(num_exact_ids == 0) {
+                its[0].next();
+                continue;
+            }
+        }
+
+        value_seq_id = largest_id;
+        return;
+    }
+}
+
+void filter_result_iterator_t::advance_posting_leaf() {
+    seq_id = UINT32_MAX;
+    for(auto value_seq_id: value_seq_ids) {
+        seq_id = std::min(seq_id, value_seq_id);
+    }
+
+    is_valid = (seq_id != UINT32_MAX);
+}
+
+void filter_result_iterator_t::advance_op() {
+    if(op == op_t::AND) {
+        while(left->valid() && right->valid()) {
+            if(left->seq_id < right->seq_id) {
+                left->skip_to(right->seq_id);
+            } else if(right->seq_id < left->seq_id) {
+                right->skip_to(left->seq_id);
+            } else {
+                seq_id = left->seq_id;
+                is_valid = true;
+                return;
+            }
+        }
+
+        is_valid = false;
+    } else if(op == op_t::OR) {
+        is_valid = left->valid() || right->valid();
+
+        if(left->valid() && right->valid()) {
+            seq_id = std::min(left->seq_id, right->seq_id);
+        } else if(is_valid) {
+            seq_id = left->valid() ? left->seq_id : right->seq_id;
+        }
+    } else {
+        while(left->valid()) {
+            if(right->valid() && right->seq_id < left->seq_id) {
+                right->skip_to(left->seq_id);
+            }
+
+            if(!right->valid() || right->seq_id != left->seq_id) {
+                seq_id = left->seq_id;
+                is_valid = true;
+                return;
+            }
+
+            left->next();
+        }
+
+        is_valid = false;
+    }
+}
+
+void filter_result_iterator_t::next() {
+    if(!is_valid) {
+        return;
+    }
+
+    switch(node_type) {
+        case node_t::ids_leaf:
+            ids_index++;
+            is_valid = (ids_index < ids_length);
+            seq_id = is_valid ? ids[ids_index] : seq_id;
+            break;
+        case node_t::id_list_leaf:
+            id_list_it->next();
+            is_valid = id_list_it->valid();
+            seq_id = is_valid ? id_list_it->id() : seq_id;
+            break;
+        case node_t::posting_leaf: {
+            const uint32_t curr_seq_id = seq_id;
+            for(size_t i = 0; i < value_its.size(); i++) {
+                if(value_seq_ids[i] == curr_seq_id) {
+                    value_its[i][0].next();
+                    advance_value(i);
+                }
+            }
+
+            advance_posting_leaf();
+            break;
+        }
+        case node_t::op:
+            if(op == op_t::OR) {
+                const uint32_t curr_seq_id = seq_id;
+                if(left->valid() && left->seq_id == curr_seq_id) {
+                    left->next();
+                }
+
+                if(right->valid() && right->seq_id == curr_seq_id) {
+                    right->next();
+                }
+            } else {
+                left->next();
+            }
+
+            advance_op();
+            break;
+    }
+}
+
+void filter_result_iterator_t::skip_to(uint32_t id) {
+    last_skipped_id = std::max(last_skipped_id, id);
+
+    if(!is_valid || seq_id >= id) {
+        return;
+    }
+
+    switch(node_type) {
+        case node_t::ids_leaf:
+            ids_index = std::lower_bound(ids + ids_index, ids + ids_length, id) - ids;
+            is_valid = (ids_index < ids_length);
+            seq_id = is_valid ? ids[ids_index] : seq_id;
+            break;
+        case node_t::id_list_leaf:
+            id_list_it->skip_to(id);
+            is_valid = id_list_it->valid() && id_list_it->id() >= id;
+            seq_id = is_valid ? id_list_it->id() : seq_id;
+            break;
+        case node_t::posting_leaf:
+            for(size_t i = 0; i < value_its.size(); i++) {
+                if(value_seq_ids[i] >= id) {
+                    continue;
+                }
+
+                if(skip_posting_it(value_its[i][0], id)) {
+                    advance_value(i);
+                } else {
+                    value_seq_ids[i] = UINT32_MAX;
+                }
+            }
+
+            advance_posting_leaf();
+            break;
+        case node_t::op:
+            left->skip_to(id);
+            if(op != op_t::AND_NOT) {
+                right->skip_to(id);
+            }
+
+            advance_op();
+            break;
+    }
+}
+
+bool filter_result_iterator_t::contains(uint32_t id) {
+    if(id < last_skipped_id) {
+        reset();
+    }
+
+    skip_to(id);
+
+    return is_valid && seq_id == id;
+}
+
+void filter_result_iterator_t::reset() {
+    last_skipped_id = 0;
+
+    switch(node_type) {
+        case node_t::ids_leaf:
+            ids_index = 0;
+            is_valid = (ids_length != 0);
+            seq_id = is_valid ? ids[0] : 0;
+            break;
+        case node_t::id_list_leaf:
+            id_list_it.reset(new id_list_t::iterator_t(id_list->new_iterator()));
+            is_valid = id_list_it->valid();
+            seq_id = is_valid ? id_list_it->id() : 0;
+            break;
+        case node_t::posting_leaf:
+            value_its.clear();
+            value_seq_ids.assign(value_plists.size(), UINT32_MAX);
+
+            for(size_t i = 0; i < value_plists.size(); i++) {
+                value_its.emplace_back();
+                for(auto plist: value_plists[i]) {
+                    value_its[i].push_back(plist->new_iterator());
+                }
+
+                advance_value(i);
+            }
+
+            advance_posting_leaf();
+            break;
+        case node_t::op:
+            left->reset();
+            right->reset();
+            advance_op();
+            break;
+    }
+}
+
+uint32_t filter_result_iterator_t::to_filter_id_array(uint32_t*& filter_ids) {
+    reset();
+
+    std::vector<uint32_t> matched_ids;
+    while(is_valid) {
+        matched_ids.push_back(seq_id);
+        next();
+    }
+
+    reset();
+
+    filter_ids = new uint32_t[matched_ids.size()];
+    std::copy(matched_ids.begin(), matched_ids.end(), filter_ids);
+    return matched_ids.size();
+}
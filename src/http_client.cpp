@@ -7,6 +7,12 @@
 std::string HttpClient::api_key = "";
 std::string HttpClient::ca_cert_path = "";
 
+std::mutex HttpClient::curl_pool_mutex;
+std::vector<CURL*> HttpClient::curl_pool;
+
+std::atomic<uint64_t> HttpClient::num_requests = 0;
+std::atomic<uint64_t> HttpClient::num_new_connections = 0;
+
 struct client_state_t: public req_state_t {
     CURL* curl;
 
@@ -126,6 +132,7 @@ long HttpClient::perform_curl(CURL *curl, std::map<std::string, std::string>& re
         char* url = nullptr;
         curl_easy_getinfo(curl, CURLINFO_EFFECTIVE_URL, &url);
         LOG(ERROR) << "CURL failed. URL: " << url << ", Code: " << res << ", strerror: " << curl_easy_strerror(res);
+        // don't pool a handle whose connection might be broken
         curl_easy_cleanup(curl);
         curl_slist_free_all(chunk);
         return 500;
@@ -136,7 +143,12 @@ long HttpClient::perform_curl(CURL *curl, std::map<std::string, std::string>& re
 
     extract_response_headers(curl, res_headers);
 
-    curl_easy_cleanup(curl);
+    long num_connects = 0;
+    curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &num_connects);
+    num_requests++;
+    num_new_connections += num_connects;
+
+    release_curl(curl);
     curl_slist_free_all(chunk);
 
     return http_code == 0 ? 500 : http_code;
@@ -318,8 +330,43 @@ CURL *HttpClient::init_curl_async(const std::string& url, deferred_req_res_t* re
     return curl;
 }
 
+CURL* HttpClient::acquire_curl() {
+    {
+        std::unique_lock<std::mutex> lock(curl_pool_mutex);
+        if(!curl_pool.empty()) {
+            CURL* curl = curl_pool.back();
+            curl_pool.pop_back();
+            return curl;
+        }
+    }
+
+    return curl_easy_init();
+}
+
+void HttpClient::release_curl(CURL* curl) {
+    // clears the options set for the request, but keeps the connections of the handle alive
+    curl_easy_reset(curl);
+
+    std::unique_lock<std::mutex> lock(curl_pool_mutex);
+    if(curl_pool.size() < MAX_POOLED_CURL_HANDLES) {
+        curl_pool.push_back(curl);
+        return;
+    }
+
+    lock.unlock();
+    curl_easy_cleanup(curl);
+}
+
+void HttpClient::get_stats(nlohmann::json& stats) {
+    stats["num_requests"] = num_requests.load();
+    stats["num_new_connections"] = num_new_connections.load();
+
+    std::unique_lock<std::mutex> lock(curl_pool_mutex);
+    stats["num_pooled_handles"] = curl_pool.size();
+}
+
 CURL *HttpClient::init_curl(const std::string& url, std::string& response) {
-    CURL *curl = curl_easy_init();
+    CURL *curl = acquire_curl();
 
     if(curl == nullptr) {
         nlohmann::json res;
@@ -338,6 +385,10 @@ CURL *HttpClient::init_curl(const std::string& url, std::string& response) {
     curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, 4000);
     curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE);
 
+    // wait for an existing HTTP/2 connection to be multiplexed on instead of opening another one
+    curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+
     // to allow self-signed certs
     curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
     curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
@@ -1093,6 +1093,14 @@ int64_t HttpServer::get_num_queued_writes() {
     return replication_state->get_num_queued_writes();
 }
 
+void HttpServer::get_group_commit_stats(nlohmann::json& stats) {
+    replication_state->get_group_commit_stats(stats);
+}
+
+void HttpServer::get_forward_stats(nlohmann::json& stats) {
+    replication_state->get_forward_stats(stats);
+}
+
 bool HttpServer::is_leader() const {
     return replication_state->is_leader();
 }
@@ -121,6 +121,26 @@ void id_list_t::iterator_t::skip_to(uint32_t id) {
     }
 }
 
+void id_list_t::iterator_t::skip_back_to(uint32_t id) {
+    if(!valid() || this->id() <= id) {
+        return;
+    }
+
+    // the first block whose last id is not smaller than `id` is the only one that can hold it
+    auto it = id_block_map->lower_bound(id);
+    if(it != id_block_map->end() && it->second != curr_block) {
+        curr_block = it->second;
+        curr_index = curr_block->size()-1;
+
+        delete [] ids;
+        ids = curr_block->ids.uncompress();
+    }
+
+    while(valid() && this->id() > id) {
+        previous();
+    }
+}
+
 id_list_t::iterator_t::~iterator_t() {
     delete [] ids;
     ids = nullptr;
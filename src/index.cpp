@@ -3,6 +3,8 @@
 #include <numeric>
 #include <chrono>
 #include <set>
+#include <fstream>
+#include <random>
 #include <unordered_map>
 #include <array_utils.h>
 #include <match_score.h>
@@ -20,6 +22,7 @@
 #include <thread_local_vars.h>
 #include <unordered_set>
 #include <or_iterator.h>
+#include <search_arena.h>
 #include <timsort.hpp>
 #include "logger.h"
 
@@ -57,6 +60,7 @@ Index::Index(const std::string& name, const uint32_t collection_id, const Store*
              const std::vector<char>& symbols_to_index, const std::vector<char>& token_separators):
         name(name), collection_id(collection_id), store(store), synonym_index(synonym_index), thread_pool(thread_pool),
         search_schema(search_schema),
+        filter_result_cache(new filter_result_cache_t()),
         seq_ids(new id_list_t(256)), symbols_to_index(symbols_to_index), token_separators(token_separators) {
 
     for(const auto& a_field: search_schema) {
@@ -65,7 +69,8 @@ Index::Index(const std::string& name, const uint32_t collection_id, const Store*
         }
 
         if(a_field.num_dim > 0) {
-            auto hnsw_index = new hnsw_index_t(a_field.num_dim, 1024, a_field.vec_dist);
+            auto hnsw_index = new hnsw_index_t(a_field.num_dim, 1024, a_field.vec_dist, a_field.vec_quantization,
+                                               a_field.vec_rerank, a_field.hnsw_params);
             vector_index.emplace(a_field.name, hnsw_index);
             continue;
         }
@@ -74,6 +79,7 @@ Index::Index(const std::string& name, const uint32_t collection_id, const Store*
             art_tree *t = new art_tree;
             art_tree_init(t);
             search_index.emplace(a_field.name, t);
+            token_expansion_caches.emplace(a_field.name, new token_expansion_cache_t());
         } else if(a_field.is_geopoint()) {
             auto field_geo_index = new spp::sparse_hash_map<std::string, std::vector<uint32_t>>();
             geopoint_index.emplace(a_field.name, field_geo_index);
@@ -106,13 +112,6 @@ Index::Index(const std::string& name, const uint32_t collection_id, const Store*
             facet_index_v3.emplace(a_field.name, facet_array);
         }
 
-        // initialize for non-string facet fields
-        if(a_field.facet && !a_field.is_string()) {
-            art_tree *ft = new art_tree;
-            art_tree_init(ft);
-            search_index.emplace(a_field.faceted_name(), ft);
-        }
-
         if(a_field.infix) {
             array_mapped_infix_t infix_sets(ARRAY_INFIX_DIM);
 
@@ -122,6 +121,14 @@ Index::Index(const std::string& name, const uint32_t collection_id, const Store*
 
             infix_index.emplace(a_field.name, infix_sets);
         }
+
+        if(a_field.is_string() && a_field.typo_index_max_len > 0) {
+            typo_index.emplace(a_field.name, new typo_index_t(a_field.typo_index_max_len));
+        }
+
+        if(a_field.is_string() && a_field.store_token_offsets) {
+            token_offset_index.emplace(a_field.name, new token_offset_index_t());
+        }
     }
 
     num_documents = 0;
@@ -179,6 +186,30 @@ Index::~Index() {
 
     infix_index.clear();
 
+    for(auto& name_typo_index: typo_index) {
+        delete name_typo_index.second;
+        name_typo_index.second = nullptr;
+    }
+
+    typo_index.clear();
+
+    for(auto& name_cache: token_expansion_caches) {
+        delete name_cache.second;
+        name_cache.second = nullptr;
+    }
+
+    token_expansion_caches.clear();
+
+    for(auto& name_offset_index: token_offset_index) {
+        delete name_offset_index.second;
+        name_offset_index.second = nullptr;
+    }
+
+    token_offset_index.clear();
+
+    delete filter_result_cache;
+    filter_result_cache = nullptr;
+
     for(auto& name_tree: str_sort_index) {
         delete name_tree.second;
         name_tree.second = nullptr;
@@ -243,6 +274,21 @@ float Index::int64_t_to_float(int64_t n) {
     return f;
 }
 
+// same as the facet hash of the token of a numerical value, see `Index::facet_token_hash()`
+static uint64_t numerical_facet_hash(const field& a_field, const nlohmann::json& value) {
+    uint64_t hash = 0;
+
+    if(a_field.is_float()) {
+        reinterpret_cast<float&>(hash) = value.get<float>();  // store as int without loss of precision
+    } else if(a_field.is_bool()) {
+        hash = value.get<bool>() ? 1 : 0;
+    } else {
+        hash = value.get<int64_t>();
+    }
+
+    return hash;
+}
+
 void Index::compute_token_offsets_facets(index_record& record,
                                          const tsl::htrie_map<char, field>& search_schema,
                                          const std::vector<char>& local_token_separators,
@@ -260,61 +306,30 @@ void Index::compute_token_offsets_facets(index_record& record,
 
         bool is_facet = search_schema.at(field_name).facet;
 
-        // non-string, non-geo faceted field should be indexed as faceted string field as well
+        // non-string, non-geo faceted fields are faceted on their native values
         if(the_field.facet && !the_field.is_string() && !the_field.is_geopoint()) {
             if(the_field.is_array()) {
-                std::vector<std::string> strings;
-
-                if(the_field.type == field_types::INT32_ARRAY) {
-                    for(int32_t value: document[field_name]){
-                        strings.push_back(std::to_string(value));
-                    }
-                } else if(the_field.type == field_types::INT64_ARRAY) {
-                    for(int64_t value: document[field_name]){
-                        strings.push_back(std::to_string(value));
-                    }
-                } else if(the_field.type == field_types::FLOAT_ARRAY) {
-                    for(float value: document[field_name]){
-                        strings.push_back(StringUtils::float_to_str(value));
-                    }
-                } else if(the_field.type == field_types::BOOL_ARRAY) {
-                    for(bool value: document[field_name]){
-                        strings.push_back(std::to_string(value));
-                    }
+                for(const auto& value: document[field_name]) {
+                    offset_facet_hashes.facet_hashes.push_back(numerical_facet_hash(the_field, value));
                 }
-
-                tokenize_string_array_with_facets(strings, is_facet, the_field,
-                                                  local_symbols_to_index, local_token_separators,
-                                                  offset_facet_hashes.offsets, offset_facet_hashes.facet_hashes);
             } else {
-                std::string text;
-
-                if(the_field.type == field_types::INT32) {
-                    text = std::to_string(document[field_name].get<int32_t>());
-                } else if(the_field.type == field_types::INT64) {
-                    text = std::to_string(document[field_name].get<int64_t>());
-                } else if(the_field.type == field_types::FLOAT) {
-                    text = StringUtils::float_to_str(document[field_name].get<float>());
-                } else if(the_field.type == field_types::BOOL) {
-                    text = std::to_string(document[field_name].get<bool>());
-                }
-
-                tokenize_string_with_facets(text, is_facet, the_field,
-                                            local_symbols_to_index, local_token_separators,
-                                            offset_facet_hashes.offsets, offset_facet_hashes.facet_hashes);
+                offset_facet_hashes.facet_hashes.push_back(numerical_facet_hash(the_field, document[field_name]));
             }
         }
 
         if(the_field.is_string()) {
+            auto token_checkpoints = the_field.store_token_offsets ? &offset_facet_hashes.token_checkpoints : nullptr;
 
             if(the_field.type == field_types::STRING) {
                 tokenize_string_with_facets(document[field_name], is_facet, the_field,
                                             local_symbols_to_index, local_token_separators,
-                                            offset_facet_hashes.offsets, offset_facet_hashes.facet_hashes);
+                                            offset_facet_hashes.offsets, offset_facet_hashes.facet_hashes,
+                                            token_checkpoints);
             } else {
                 tokenize_string_array_with_facets(document[field_name], is_facet, the_field,
                                                   local_symbols_to_index, local_token_separators,
-                                                  offset_facet_hashes.offsets, offset_facet_hashes.facet_hashes);
+                                                  offset_facet_hashes.offsets, offset_facet_hashes.facet_hashes,
+                                                  token_checkpoints);
             }
         }
 
@@ -748,6 +763,7 @@ void Index::index_field_in_memory(const field& afield, std::vector<index_record>
             }
         }
 
+        filter_result_cache->invalidate(filter_result_cache_t::ALL_IDS_FIELD);
         return;
     }
 
@@ -755,11 +771,13 @@ void Index::index_field_in_memory(const field& afield, std::vector<index_record>
         return;
     }
 
+    filter_result_cache->invalidate(afield.name);
+
     // We have to handle both these edge cases:
     // a) `afield` might not exist in the document (optional field)
     // b) `afield` value could be empty
 
-    // non-geo faceted field should be indexed as faceted string field as well
+    // non-string, non-geo faceted fields store the facet values computed along with the tokens of string fields
     bool non_string_facet_field = (afield.facet && !afield.is_geopoint());
 
     if(afield.is_string() || non_string_facet_field) {
@@ -805,6 +823,13 @@ void Index::index_field_in_memory(const field& afield, std::vector<index_record>
                 max_score = record.points;
             }
 
+            if(afield.store_token_offsets) {
+                auto offset_index_it = token_offset_index.find(afield.name);
+                if(offset_index_it != token_offset_index.end()) {
+                    offset_index_it->second->insert(seq_id, field_index_it->second.token_checkpoints);
+                }
+            }
+
             for(auto &token_offsets: field_index_it->second.offsets) {
                 token_to_doc_offsets[token_offsets.first].emplace_back(seq_id, record.points, token_offsets.second);
 
@@ -816,22 +841,34 @@ void Index::index_field_in_memory(const field& afield, std::vector<index_record>
             }
         }
 
-        auto tree_it = search_index.find(afield.faceted_name());
-        if(tree_it == search_index.end()) {
-            return;
-        }
+        // faceted non-string fields only store their facet values
+        auto tree_it = afield.is_string() ? search_index.find(afield.name) : search_index.end();
+
+        if(tree_it != search_index.end()) {
+            art_tree *t = tree_it->second;
+
+            auto typo_index_it = typo_index.find(afield.name);
+            typo_index_t* field_typo_index = (typo_index_it != typo_index.end()) ? typo_index_it->second : nullptr;
+
+            auto cache_it = token_expansion_caches.find(afield.name);
+            if(cache_it != token_expansion_caches.end()) {
+                cache_it->second->invalidate();
+            }
 
-        art_tree *t = tree_it->second;
+            for(auto& token_to_doc: token_to_doc_offsets) {
+                const std::string& token = token_to_doc.first;
+                std::vector<art_document>& documents = token_to_doc.second;
 
-        for(auto& token_to_doc: token_to_doc_offsets) {
-            const std::string& token = token_to_doc.first;
-            std::vector<art_document>& documents = token_to_doc.second;
+                const auto *key = (const unsigned char *) token.c_str();
+                int key_len = (int) token.length() + 1;  // for the terminating \0 char
 
-            const auto *key = (const unsigned char *) token.c_str();
-            int key_len = (int) token.length() + 1;  // for the terminating \0 char
+                //LOG(INFO) << "key: " << key << ", art_doc.id: " << art_doc.id;
+                art_inserts(t, key, key_len, max_score, documents);
 
-            //LOG(INFO) << "key: " << key << ", art_doc.id: " << art_doc.id;
-            art_inserts(t, key, key_len, max_score, documents);
+                if(field_typo_index != nullptr) {
+                    field_typo_index->insert(token);
+                }
+            }
         }
     }
 
@@ -920,11 +957,8 @@ void Index::index_field_in_memory(const field& afield, std::vector<index_record>
         } else if(afield.is_array()) {
             // handle vector index first
             if(afield.type == field_types::FLOAT_ARRAY && afield.num_dim > 0) {
-                auto vec_index = vector_index[afield.name]->vecdex;
-                size_t curr_ele_count = vec_index->getCurrentElementCount();
-                if(curr_ele_count + iter_batch.size() > vec_index->getMaxElements()) {
-                    vec_index->resizeIndex((curr_ele_count + iter_batch.size()) * 1.3);
-                }
+                auto vec_index = vector_index[afield.name];
+                vec_index->reserve(iter_batch.size());
 
                 const size_t num_threads = std::min<size_t>(4, iter_batch.size());
                 const size_t window_size = (num_threads == 0) ? 0 :
@@ -962,9 +996,9 @@ void Index::index_field_in_memory(const field& afield, std::vector<index_record>
                                 if(afield.vec_dist == cosine) {
                                     std::vector<float> normalized_vals(afield.num_dim);
                                     hnsw_index_t::normalize_vector(float_vals, normalized_vals);
-                                    vec_index->insertPoint(normalized_vals.data(), (size_t)record.seq_id);
+                                    vec_index->insert(normalized_vals.data(), (size_t)record.seq_id);
                                 } else {
-                                    vec_index->insertPoint(float_vals.data(), (size_t)record.seq_id);
+                                    vec_index->insert(float_vals.data(), (size_t)record.seq_id);
                                 }
                             } catch(const std::exception &e) {
                                 record.index_failure(400, e.what());
@@ -983,6 +1017,9 @@ void Index::index_field_in_memory(const field& afield, std::vector<index_record>
 
                 std::unique_lock<std::mutex> lock_process(m_process);
                 cv_process.wait(lock_process, [&](){ return num_processed == num_queued; });
+
+                vec_index->schedule_ef_tuning(thread_pool);
+
                 return;
             }
 
@@ -1068,8 +1105,8 @@ void Index::index_field_in_memory(const field& afield, std::vector<index_record>
             }
 
             std::string raw_str = document[afield.name].get<std::string>();
-            Tokenizer str_tokenizer("", true, false, "", {' '});
-            str_tokenizer.tokenize(raw_str);
+            auto str_tokenizer = Tokenizer::acquire("", true, false, "", {' '});
+            str_tokenizer->tokenize(raw_str);
 
             if(!raw_str.empty()) {
                 str_tree->index(seq_id, raw_str.substr(0, 2000));
@@ -1099,19 +1136,30 @@ void Index::tokenize_string_with_facets(const std::string& text, bool is_facet,
                                         const std::vector<char>& symbols_to_index,
                                         const std::vector<char>& token_separators,
                                         std::unordered_map<std::string, std::vector<uint32_t>>& token_to_offsets,
-                                        std::vector<uint64_t>& facet_hashes) {
+                                        std::vector<uint64_t>& facet_hashes,
+                                        std::vector<std::vector<uint32_t>>* token_checkpoints) {
 
-    Tokenizer tokenizer(text, true, !a_field.is_string(), a_field.locale, symbols_to_index, token_separators);
+    auto tokenizer = Tokenizer::acquire(text, true, !a_field.is_string(), a_field.locale,
+                                        symbols_to_index, token_separators);
     std::string token;
     std::string last_token;
-    size_t token_index = 0;
+    size_t token_index = 0, tok_start = 0, tok_end = 0;
     uint64_t facet_hash = 1;
 
-    while(tokenizer.next(token, token_index)) {
+    if(token_checkpoints != nullptr) {
+        token_checkpoints->emplace_back();
+    }
+
+    while(tokenizer->next(token, token_index, tok_start, tok_end)) {
         if(token.empty()) {
             continue;
         }
 
+        if(token_checkpoints != nullptr && token_index != 0 &&
+           token_index % token_offset_index_t::CHECKPOINT_INTERVAL == 0) {
+            token_checkpoints->back().push_back(tok_start);
+        }
+
         token_to_offsets[token].push_back(token_index + 1);
         last_token = token;
 
@@ -1140,23 +1188,34 @@ void Index::tokenize_string_array_with_facets(const std::vector<std::string>& st
                                               const std::vector<char>& symbols_to_index,
                                               const std::vector<char>& token_separators,
                                               std::unordered_map<std::string, std::vector<uint32_t>>& token_to_offsets,
-                                              std::vector<uint64_t>& facet_hashes) {
+                                              std::vector<uint64_t>& facet_hashes,
+                                              std::vector<std::vector<uint32_t>>* token_checkpoints) {
 
     for(size_t array_index = 0; array_index < strings.size(); array_index++) {
         const std::string& str = strings[array_index];
         std::set<std::string> token_set;  // required to deal with repeating tokens
 
-        Tokenizer tokenizer(str, true, !a_field.is_string(), a_field.locale, symbols_to_index, token_separators);
+        auto tokenizer = Tokenizer::acquire(str, true, !a_field.is_string(), a_field.locale,
+                                            symbols_to_index, token_separators);
         std::string token, last_token;
-        size_t token_index = 0;
+        size_t token_index = 0, tok_start = 0, tok_end = 0;
         uint64_t facet_hash = 1;
 
+        if(token_checkpoints != nullptr) {
+            token_checkpoints->emplace_back();
+        }
+
         // iterate and append offset positions
-        while(tokenizer.next(token, token_index)) {
+        while(tokenizer->next(token, token_index, tok_start, tok_end)) {
             if(token.empty()) {
                 continue;
             }
 
+            if(token_checkpoints != nullptr && token_index != 0 &&
+               token_index % token_offset_index_t::CHECKPOINT_INTERVAL == 0) {
+                token_checkpoints->back().push_back(tok_start);
+            }
+
             token_to_offsets[token].push_back(token_index + 1);
             token_set.insert(token);
             last_token = token;
@@ -1192,38 +1251,65 @@ void Index::tokenize_string_array_with_facets(const std::vector<std::string>& st
     }
 }
 
-void Index::compute_facet_stats(facet &a_facet, uint64_t raw_value, const std::string & field_type) {
-    if(field_type == field_types::INT32 || field_type == field_types::INT32_ARRAY) {
-        int32_t val = raw_value;
-        if (val < a_facet.stats.fvmin) {
-            a_facet.stats.fvmin = val;
-        }
-        if (val > a_facet.stats.fvmax) {
-            a_facet.stats.fvmax = val;
-        }
-        a_facet.stats.fvsum += val;
-        a_facet.stats.fvcount++;
-    } else if(field_type == field_types::INT64 || field_type == field_types::INT64_ARRAY) {
-        int64_t val = raw_value;
-        if(val < a_facet.stats.fvmin) {
-            a_facet.stats.fvmin = val;
-        }
-        if(val > a_facet.stats.fvmax) {
-            a_facet.stats.fvmax = val;
-        }
-        a_facet.stats.fvsum += val;
-        a_facet.stats.fvcount++;
-    } else if(field_type == field_types::FLOAT || field_type == field_types::FLOAT_ARRAY) {
-        float val = reinterpret_cast<float&>(raw_value);
-        if(val < a_facet.stats.fvmin) {
-            a_facet.stats.fvmin = val;
-        }
-        if(val > a_facet.stats.fvmax) {
-            a_facet.stats.fvmax = val;
+facet_num_type_t Index::get_facet_num_type(const field& a_field) {
+    if(a_field.is_int32()) {
+        return facet_num_type_t::int32;
+    } else if(a_field.is_int64()) {
+        return facet_num_type_t::int64;
+    } else if(a_field.is_float()) {
+        return facet_num_type_t::float32;
+    } else if(a_field.is_bool()) {
+        return facet_num_type_t::boolean;
+    }
+
+    return facet_num_type_t::none;
+}
+
+double Index::facet_hash_to_num(uint64_t raw_value, const facet_num_type_t num_type) {
+    switch(num_type) {
+        case facet_num_type_t::int32:
+            return (int32_t) raw_value;
+        case facet_num_type_t::int64:
+            return (int64_t) raw_value;
+        case facet_num_type_t::float32:
+            return reinterpret_cast<float&>(raw_value);
+        case facet_num_type_t::boolean:
+            return raw_value;
+        default:
+            return 0;
+    }
+}
+
+std::string Index::facet_hash_to_str(uint64_t raw_value, const facet_num_type_t num_type) {
+    switch(num_type) {
+        case facet_num_type_t::int32:
+            return std::to_string((int32_t) raw_value);
+        case facet_num_type_t::int64:
+            return std::to_string((int64_t) raw_value);
+        case facet_num_type_t::float32:
+            return StringUtils::float_to_str(reinterpret_cast<float&>(raw_value));
+        case facet_num_type_t::boolean:
+            return std::to_string(raw_value);
+        default:
+            return "";
+    }
+}
+
+void Index::compute_facet_stats(facet &a_facet, const double value) {
+    a_facet.stats.fvmin = std::min(a_facet.stats.fvmin, value);
+    a_facet.stats.fvmax = std::max(a_facet.stats.fvmax, value);
+    a_facet.stats.fvsum += value;
+    a_facet.stats.fvcount++;
+}
+
+size_t Index::get_facet_range_index(const std::vector<facet_range_t>& ranges, const double value) {
+    for(size_t i = 0; i < ranges.size(); i++) {
+        if(ranges[i].lower <= value && value < ranges[i].upper) {
+            return i;
         }
-        a_facet.stats.fvsum += val;
-        a_facet.stats.fvcount++;
     }
+
+    return ranges.size();
 }
 
 void Index::do_facets(std::vector<facet> & facets, facet_query_t & facet_query,
@@ -1234,10 +1320,11 @@ void Index::do_facets(std::vector<facet> & facets, facet_query_t & facet_query,
     // assumed that facet fields have already been validated upstream
     for(size_t findex=0; findex < facets.size(); findex++) {
         auto& a_facet = facets[findex];
-        const auto& facet_field = facet_infos[findex].facet_field;
         const bool use_facet_query = facet_infos[findex].use_facet_query;
         const auto& fquery_hashes = facet_infos[findex].hashes;
         const bool should_compute_stats = facet_infos[findex].should_compute_stats;
+        const facet_num_type_t num_type = facet_infos[findex].num_type;
+        const bool is_range_facet = !a_facet.ranges.empty();
 
         const auto& field_facet_mapping_it = facet_index_v3.find(a_facet.field_name);
         if(field_facet_mapping_it == facet_index_v3.end()) {
@@ -1246,6 +1333,9 @@ void Index::do_facets(std::vector<facet> & facets, facet_query_t & facet_query,
 
         const auto& field_facet_mapping = field_facet_mapping_it->second;
 
+        // a document is counted once towards a range, however many of its array values fall in it
+        std::vector<bool> doc_ranges_counted(a_facet.ranges.size());
+
         for(size_t i = 0; i < results_size; i++) {
             uint32_t doc_seq_id = result_ids[i];
             const auto& facet_hashes_it = field_facet_mapping[doc_seq_id % ARRAY_FACET_DIM]->find(doc_seq_id);
@@ -1261,14 +1351,40 @@ void Index::do_facets(std::vector<facet> & facets, facet_query_t & facet_query,
                 RETURN_CIRCUIT_BREAKER
             }
 
+            if(is_range_facet) {
+                std::fill(doc_ranges_counted.begin(), doc_ranges_counted.end(), false);
+            }
+
             for(size_t j = 0; j < facet_hashes.size(); j++) {
                 auto fhash = facet_hashes.hashes[j];
 
-                if(should_compute_stats) {
-                    compute_facet_stats(a_facet, fhash, facet_field.type);
+                // the facet query matches the value itself, before it is counted towards its range
+                const auto fquery_hashes_it = use_facet_query ? fquery_hashes.find(fhash) : fquery_hashes.end();
+
+                if(should_compute_stats || is_range_facet) {
+                    const double fvalue = facet_hash_to_num(fhash, num_type);
+
+                    if(should_compute_stats) {
+                        compute_facet_stats(a_facet, fvalue);
+                    }
+
+                    if(is_range_facet) {
+                        fhash = get_facet_range_index(a_facet.ranges, fvalue);
+                        if(fhash == a_facet.ranges.size()) {
+                            continue;
+                        }
+                    }
                 }
 
-                if(!use_facet_query || fquery_hashes.find(fhash) != fquery_hashes.end()) {
+                if(!use_facet_query || fquery_hashes_it != fquery_hashes.end()) {
+                    if(is_range_facet) {
+                        if(doc_ranges_counted[fhash]) {
+                            continue;
+                        }
+
+                        doc_ranges_counted[fhash] = true;
+                    }
+
                     facet_count_t& facet_count = a_facet.result_map[fhash];
 
                     //LOG(INFO) << "field: " << a_facet.field_name << ", doc id: " << doc_seq_id << ", hash: " <<  fhash;
@@ -1283,7 +1399,7 @@ void Index::do_facets(std::vector<facet> & facets, facet_query_t & facet_query,
                     }
 
                     if(use_facet_query) {
-                        a_facet.hash_tokens[fhash] = fquery_hashes.at(fhash);
+                        a_facet.hash_tokens[fhash] = fquery_hashes_it->second;
                     }
                 }
             }
@@ -1310,6 +1426,7 @@ void Index::search_all_candidates(const size_t num_search_fields,
                                   const text_match_type_t match_type,
                                   const std::vector<search_field_t>& the_fields,
                                   const uint32_t* filter_ids, size_t filter_ids_length,
+                                  filter_result_iterator_t* const filter_iterator,
                                   const uint32_t* exclude_token_ids, size_t exclude_token_ids_size,
                                   const std::vector<sort_by>& sort_fields,
                                   std::vector<tok_candidates>& token_candidates_vec,
@@ -1376,7 +1493,7 @@ void Index::search_all_candidates(const size_t num_search_fields,
                              sort_fields, topster,groups_processed,
                              searched_queries, qtoken_set, group_limit, group_by_fields,
                              prioritize_exact_match, prioritize_token_position,
-                             filter_ids, filter_ids_length, total_cost, syn_orig_num_tokens,
+                             filter_ids, filter_ids_length, filter_iterator, total_cost, syn_orig_num_tokens,
                              exclude_token_ids, exclude_token_ids_size,
                              sort_order, field_values, geopoint_indices,
                              id_buff, all_result_ids, all_result_ids_len);
@@ -1760,13 +1877,14 @@ void Index::do_filtering(uint32_t*& filter_ids,
 
             // there could be multiple tokens in a filter value, which we have to treat as ANDs
             // e.g. country: South Africa
-            Tokenizer tokenizer(filter_value, true, false, f.locale, symbols_to_index, token_separators);
+            auto tokenizer = Tokenizer::acquire(filter_value, true, false, f.locale, symbols_to_index,
+                                                token_separators);
 
             std::string str_token;
             size_t token_index = 0;
             std::vector<std::string> str_tokens;
 
-            while (tokenizer.next(str_token, token_index)) {
+            while (tokenizer->next(str_token, token_index)) {
                 str_tokens.push_back(str_token);
 
                 art_leaf* leaf = (art_leaf *) art_search(t, (const unsigned char*) str_token.c_str(),
@@ -1862,78 +1980,1041 @@ void Index::do_filtering(uint32_t*& filter_ids,
                 delete[] result_ids;
             }
 
-            delete[] or_ids;
-            or_ids = excluded_strt_ids;
-            or_ids_size = excluded_strt_size;
+            delete[] or_ids;
+            or_ids = excluded_strt_ids;
+            or_ids_size = excluded_strt_size;
+        }
+
+        result_ids = or_ids;
+        result_ids_len = or_ids_size;
+    }
+
+    filter_ids = result_ids;
+    filter_ids_length = result_ids_len;
+
+    /*long long int timeMillis =
+            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now()
+    - begin).count();
+
+    LOG(INFO) << "Time taken for filtering: " << timeMillis << "ms";*/
+}
+
+void Index::recursive_filter(uint32_t*& filter_ids,
+                             uint32_t& filter_ids_length,
+                             const filter_node_t* root,
+                             const bool enable_short_circuit) const {
+    if (root == nullptr) {
+        return;
+    }
+
+    if (root->isOperator && root->filter_operator == AND) {
+        and_filter(filter_ids, filter_ids_length, root, enable_short_circuit);
+        return;
+    }
+
+    uint32_t* l_filter_ids = nullptr;
+    uint32_t l_filter_ids_length = 0;
+    if (root->left != nullptr) {
+        recursive_filter(l_filter_ids, l_filter_ids_length, root->left,
+                         enable_short_circuit);
+    }
+
+    uint32_t* r_filter_ids = nullptr;
+    uint32_t r_filter_ids_length = 0;
+    if (root->right != nullptr) {
+        recursive_filter(r_filter_ids, r_filter_ids_length, root->right,
+                         enable_short_circuit);
+    }
+
+    if (root->isOperator) {
+        uint32_t* filtered_results = nullptr;
+        filter_ids_length = ArrayUtils::or_scalar(
+            l_filter_ids, l_filter_ids_length, r_filter_ids,
+            r_filter_ids_length, &filtered_results);
+
+        delete[] l_filter_ids;
+        delete[] r_filter_ids;
+
+        filter_ids = filtered_results;
+    } else if (root->left == nullptr && root->right == nullptr) {
+        do_cached_filtering(filter_ids, filter_ids_length, root);
+    } else {
+        // malformed
+    }
+}
+
+void Index::and_filter(uint32_t*& filter_ids,
+                       uint32_t& filter_ids_length,
+                       filter_node_t const* const root,
+                       const bool enable_short_circuit) const {
+    const filter_node_t* first = root->left;
+    const filter_node_t* second = root->right;
+
+    size_t first_estimate = estimate_filter_ids(first);
+    size_t second_estimate = estimate_filter_ids(second);
+
+    if(second_estimate < first_estimate) {
+        std::swap(first, second);
+        std::swap(first_estimate, second_estimate);
+    }
+
+    uint32_t* first_ids = nullptr;
+    uint32_t first_ids_length = 0;
+    recursive_filter(first_ids, first_ids_length, first, enable_short_circuit);
+
+    if(first_ids_length == 0) {
+        delete[] first_ids;
+        filter_ids = nullptr;
+        filter_ids_length = 0;
+        return;
+    }
+
+    if(size_t(first_ids_length) * FILTER_PROBE_COST_RATIO < second_estimate && can_probe_filter(second)) {
+        probe_filter(first_ids, first_ids_length, second, filter_ids, filter_ids_length);
+        delete[] first_ids;
+        return;
+    }
+
+    uint32_t* second_ids = nullptr;
+    uint32_t second_ids_length = 0;
+    recursive_filter(second_ids, second_ids_length, second, enable_short_circuit);
+
+    uint32_t* filtered_results = nullptr;
+    filter_ids_length = ArrayUtils::and_scalar(first_ids, first_ids_length, second_ids, second_ids_length,
+                                               &filtered_results);
+
+    delete[] first_ids;
+    delete[] second_ids;
+
+    filter_ids = filtered_results;
+}
+
+static int64_t get_num_filter_value(const field& a_field, const std::string& filter_value) {
+    if(a_field.is_float()) {
+        return Index::float_to_int64_t((float) std::atof(filter_value.c_str()));
+    }
+
+    if(a_field.is_bool()) {
+        return (filter_value == "1") ? 1 : 0;
+    }
+
+    return (int64_t) std::stol(filter_value);
+}
+
+size_t Index::estimate_filter_ids(const filter_node_t* root) const {
+    if(root == nullptr) {
+        return 0;
+    }
+
+    const size_t num_seq_ids = seq_ids->num_ids();
+
+    if(root->isOperator) {
+        const size_t left_estimate = estimate_filter_ids(root->left);
+        const size_t right_estimate = estimate_filter_ids(root->right);
+        return (root->filter_operator == AND) ? std::min(left_estimate, right_estimate) :
+                                                std::min(num_seq_ids, left_estimate + right_estimate);
+    }
+
+    const filter& a_filter = root->filter_exp;
+
+    if(a_filter.field_name == "id") {
+        return a_filter.values.size();
+    }
+
+    const auto field_it = search_schema.find(a_filter.field_name);
+    if(field_it == search_schema.end()) {
+        return 0;
+    }
+
+    const field& f = field_it.value();
+    size_t estimate = 0;
+
+    if(f.is_integer() || f.is_float() || f.is_bool()) {
+        const auto num_tree_it = numerical_index.find(a_filter.field_name);
+        if(num_tree_it == numerical_index.end()) {
+            return 0;
+        }
+
+        num_tree_t* num_tree = num_tree_it->second;
+
+        for(size_t fi = 0; fi < a_filter.values.size(); fi++) {
+            const int64_t value = get_num_filter_value(f, a_filter.values[fi]);
+
+            if(a_filter.comparators[fi] == RANGE_INCLUSIVE && fi+1 < a_filter.values.size()) {
+                const int64_t range_end_value = get_num_filter_value(f, a_filter.values[fi+1]);
+                estimate += num_tree->estimate_range_inclusive(value, range_end_value);
+                fi++;
+            } else if(f.is_bool() && a_filter.comparators[fi] == NOT_EQUALS) {
+                // negations also match the documents without a value
+                estimate += num_seq_ids - std::min(num_seq_ids, num_tree->estimate(EQUALS, value));
+            } else {
+                estimate += num_tree->estimate(a_filter.comparators[fi], value);
+            }
+        }
+    } else if(f.is_string()) {
+        const auto search_index_it = search_index.find(a_filter.field_name);
+        if(search_index_it == search_index.end()) {
+            return 0;
+        }
+
+        art_tree* t = search_index_it->second;
+
+        for(const std::string& filter_value: a_filter.values) {
+            auto tokenizer = Tokenizer::acquire(filter_value, true, false, f.locale, symbols_to_index,
+                                                token_separators);
+
+            std::string str_token;
+            size_t token_index = 0;
+            size_t value_estimate = 0;
+            bool is_first_token = true;
+
+            // tokens of a value are ANDed, so the rarest one bounds its matches
+            while(tokenizer->next(str_token, token_index)) {
+                art_leaf* leaf = (art_leaf *) art_search(t, (const unsigned char*) str_token.c_str(),
+                                                         str_token.length()+1);
+                const size_t token_num_ids = (leaf == nullptr) ? 0 : posting_t::num_ids(leaf->values);
+                value_estimate = is_first_token ? token_num_ids : std::min(value_estimate, token_num_ids);
+                is_first_token = false;
+            }
+
+            estimate += value_estimate;
+        }
+
+        if(a_filter.comparators[0] == NOT_EQUALS) {
+            estimate = num_seq_ids - std::min(num_seq_ids, estimate);
+        }
+    } else {
+        // geo filters are only known once they are evaluated, so they are assumed to match everything
+        estimate = num_seq_ids;
+    }
+
+    return std::min(estimate, num_seq_ids);
+}
+
+bool Index::can_probe_filter(const filter_node_t* root) const {
+    if(root == nullptr || root->isOperator || root->filter_exp.field_name == "id") {
+        return false;
+    }
+
+    const filter& a_filter = root->filter_exp;
+    const auto field_it = search_schema.find(a_filter.field_name);
+
+    if(field_it == search_schema.end()) {
+        return false;
+    }
+
+    const field& f = field_it.value();
+
+    // the values of single valued numerical fields are held per id by the sort index
+    if(!(f.is_integer() || f.is_float() || f.is_bool()) || f.is_array() ||
+       numerical_index.count(a_filter.field_name) == 0 || sort_index.count(a_filter.field_name) == 0) {
+        return false;
+    }
+
+    for(const auto comparator: a_filter.comparators) {
+        if(comparator == NOT_EQUALS || comparator == CONTAINS) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool num_filter_matches(const std::vector<NUM_COMPARATOR>& comparators, const std::vector<int64_t>& values,
+                               const int64_t doc_value) {
+    for(size_t fi = 0; fi < values.size(); fi++) {
+        if(comparators[fi] == RANGE_INCLUSIVE && fi+1 < values.size()) {
+            if(values[fi] <= doc_value && doc_value <= values[fi+1]) {
+                return true;
+            }
+
+            fi++;
+            continue;
+        }
+
+        switch(comparators[fi]) {
+            case EQUALS:
+                if(doc_value == values[fi]) { return true; }
+                break;
+            case GREATER_THAN:
+                if(doc_value > values[fi]) { return true; }
+                break;
+            case GREATER_THAN_EQUALS:
+                if(doc_value >= values[fi]) { return true; }
+                break;
+            case LESS_THAN:
+                if(doc_value < values[fi]) { return true; }
+                break;
+            case LESS_THAN_EQUALS:
+                if(doc_value <= values[fi]) { return true; }
+                break;
+            default:
+                break;
+        }
+    }
+
+    return false;
+}
+
+void Index::probe_filter(const uint32_t* ids, const uint32_t ids_length, const filter_node_t* root,
+                         uint32_t*& filter_ids, uint32_t& filter_ids_length) const {
+    const filter& a_filter = root->filter_exp;
+    const field& f = search_schema.at(a_filter.field_name);
+    const spp::sparse_hash_map<uint32_t, int64_t>* doc_to_value = sort_index.at(a_filter.field_name);
+
+    std::vector<int64_t> values;
+    for(const std::string& filter_value: a_filter.values) {
+        values.push_back(get_num_filter_value(f, filter_value));
+    }
+
+    filter_ids = new uint32_t[ids_length];
+    filter_ids_length = 0;
+
+    for(uint32_t i = 0; i < ids_length; i++) {
+        const auto value_it = doc_to_value->find(ids[i]);
+        if(value_it != doc_to_value->end() && num_filter_matches(a_filter.comparators, values, value_it->second)) {
+            filter_ids[filter_ids_length++] = ids[i];
+        }
+    }
+
+    if(filter_ids_length == 0) {
+        delete[] filter_ids;
+        filter_ids = nullptr;
+    }
+}
+
+void Index::explain_filter(const filter_node_t* root, const std::string& strategy, nlohmann::json& plan) const {
+    if(root == nullptr) {
+        return;
+    }
+
+    plan["estimated_ids"] = estimate_filter_ids(root);
+    plan["strategy"] = strategy;
+
+    if(root->isOperator) {
+        plan["operator"] = (root->filter_operator == AND) ? "AND" : "OR";
+
+        const filter_node_t* first = root->left;
+        const filter_node_t* second = root->right;
+        std::string second_strategy = "materialize";
+
+        if(root->filter_operator == AND) {
+            size_t first_estimate = estimate_filter_ids(first);
+            size_t second_estimate = estimate_filter_ids(second);
+
+            if(second_estimate < first_estimate) {
+                std::swap(first, second);
+                std::swap(first_estimate, second_estimate);
+            }
+
+            // the actual choice is made on the ids matched by the first side
+            if(first_estimate == 0) {
+                second_strategy = "skip";
+            } else if(first_estimate * FILTER_PROBE_COST_RATIO < second_estimate && can_probe_filter(second)) {
+                second_strategy = "probe";
+            }
+        }
+
+        plan["children"] = nlohmann::json::array();
+        for(const auto& child_strategy: {std::make_pair(first, std::string("materialize")),
+                                         std::make_pair(second, second_strategy)}) {
+            if(child_strategy.first != nullptr) {
+                nlohmann::json child_plan;
+                explain_filter(child_strategy.first, child_strategy.second, child_plan);
+                plan["children"].push_back(child_plan);
+            }
+        }
+
+        return;
+    }
+
+    const filter& a_filter = root->filter_exp;
+    plan["field"] = a_filter.field_name;
+
+    const auto num_tree_it = numerical_index.find(a_filter.field_name);
+    if(num_tree_it != numerical_index.end()) {
+        plan["distinct_values"] = num_tree_it->second->size();
+    }
+
+    const auto search_index_it = search_index.find(a_filter.field_name);
+    if(search_index_it != search_index.end()) {
+        plan["distinct_values"] = art_size(search_index_it->second);
+    }
+}
+
+void Index::do_cached_filtering(uint32_t*& filter_ids,
+                                uint32_t& filter_ids_length,
+                                filter_node_t const* const root) const {
+    const filter& a_filter = root->filter_exp;
+    const auto field_it = search_schema.find(a_filter.field_name);
+
+    std::string key;
+
+    // results narrowed down by existing `filter_ids` cannot be shared
+    if(filter_ids != nullptr || field_it == search_schema.end() || !filter_result_cache_t::get_key(a_filter, key)) {
+        do_filtering(filter_ids, filter_ids_length, root);
+        return;
+    }
+
+    if(filter_result_cache->get(key, filter_ids, filter_ids_length)) {
+        return;
+    }
+
+    const uint64_t generation = filter_result_cache->get_generation();
+    do_filtering(filter_ids, filter_ids_length, root);
+
+    if(!filter_result_cache_t::is_expensive(field_it.value(), a_filter) &&
+       filter_ids_length < filter_result_cache_t::MIN_LARGE_RESULT_IDS) {
+        return;
+    }
+
+    std::vector<std::string> field_names = {a_filter.field_name};
+
+    // negations are evaluated against all the ids, which change with writes to any field
+    if(std::find(a_filter.comparators.begin(), a_filter.comparators.end(), NOT_EQUALS) != a_filter.comparators.end()) {
+        field_names.emplace_back(filter_result_cache_t::ALL_IDS_FIELD);
+    }
+
+    filter_result_cache->put(key, field_names, generation, filter_ids, filter_ids_length);
+}
+
+void Index::do_filtering_with_lock(uint32_t*& filter_ids,
+                                   uint32_t& filter_ids_length,
+                                   filter_node_t const* const& filter_tree_root) const {
+    std::shared_lock lock(mutex);
+    recursive_filter(filter_ids, filter_ids_length, filter_tree_root, false);
+}
+
+void Index::explain_filter_with_lock(filter_node_t const* const& filter_tree_root, nlohmann::json& plan) const {
+    std::shared_lock lock(mutex);
+    explain_filter(filter_tree_root, "materialize", plan);
+}
+
+filter_result_iterator_t* Index::new_filter_iterator(const filter_node_t* root) const {
+    if(root == nullptr) {
+        return new filter_result_iterator_t(nullptr, 0);
+    }
+
+    if(root->isOperator) {
+        const auto op = (root->filter_operator == AND) ? filter_result_iterator_t::op_t::AND :
+                                                         filter_result_iterator_t::op_t::OR;
+        return new filter_result_iterator_t(op, new_filter_iterator(root->left), new_filter_iterator(root->right));
+    }
+
+    const filter& a_filter = root->filter_exp;
+    const auto field_it = search_schema.find(a_filter.field_name);
+    const auto search_index_it = search_index.find(a_filter.field_name);
+
+    if(a_filter.field_name == "id" || field_it == search_schema.end() || !field_it.value().is_string() ||
+       search_index_it == search_index.end()) {
+        uint32_t* filter_ids = nullptr;
+        uint32_t filter_ids_length = 0;
+        do_cached_filtering(filter_ids, filter_ids_length, root);
+        return new filter_result_iterator_t(filter_ids, filter_ids_length);
+    }
+
+    const field& f = field_it.value();
+    std::vector<std::vector<void*>> value_posting_lists;
+
+    for(const std::string& filter_value: a_filter.values) {
+        std::vector<void*> posting_lists;
+
+        // tokens of a value are ANDed
+        auto tokenizer = Tokenizer::acquire(filter_value, true, false, f.locale, symbols_to_index,
+                                            token_separators);
+
+        std::string str_token;
+        size_t token_index = 0;
+        bool all_tokens_found = true;
+
+        while(tokenizer->next(str_token, token_index)) {
+            art_leaf* leaf = (art_leaf *) art_search(search_index_it->second, (const unsigned char*) str_token.c_str(),
+                                                     str_token.length()+1);
+            if(leaf == nullptr) {
+                all_tokens_found = false;
+                break;
+            }
+
+            posting_lists.push_back(leaf->values);
+        }
+
+        if(all_tokens_found && !posting_lists.empty()) {
+            value_posting_lists.push_back(std::move(posting_lists));
+        }
+    }
+
+    const bool exact_match = (a_filter.comparators[0] == EQUALS || a_filter.comparators[0] == NOT_EQUALS);
+    auto value_iterator = new filter_result_iterator_t(value_posting_lists, exact_match, f.is_array());
+
+    if(a_filter.comparators[0] == NOT_EQUALS) {
+        return new filter_result_iterator_t(filter_result_iterator_t::op_t::AND_NOT,
+                                            new filter_result_iterator_t(seq_ids), value_iterator);
+    }
+
+    return value_iterator;
+}
+
+bool Index::use_lazy_filter(const filter_node_t* filter_tree_root,
+                            const std::vector<query_tokens_t>& field_query_tokens,
+                            const std::vector<std::pair<uint32_t, uint32_t>>& included_ids,
+                            const bool filter_curated_hits, const vector_query_t& vector_query) const {
+    if(filter_tree_root == nullptr || field_query_tokens.empty() || !vector_query.field_name.empty() ||
+       (filter_curated_hits && !included_ids.empty())) {
+        return false;
+    }
+
+    // wildcard and phrase queries need all of the filtered ids
+    const auto& query_tokens = field_query_tokens[0];
+    if(query_tokens.q_include_tokens.empty() || query_tokens.q_include_tokens[0].value == "*" ||
+       !query_tokens.q_phrases.empty()) {
+        return false;
+    }
+
+    // other clauses are materialized by the iterator anyway
+    if(!filter_tree_root->isOperator) {
+        const auto field_it = search_schema.find(filter_tree_root->filter_exp.field_name);
+        if(field_it == search_schema.end() || !field_it.value().is_string()) {
+            return false;
+        }
+    }
+
+    const size_t estimate = estimate_filter_ids(filter_tree_root);
+    return estimate >= lazy_filter_min_ids && estimate * 2 >= seq_ids->num_ids();
+}
+
+hnswlib::SpaceInterface<float>* hnsw_index_t::create_space(size_t num_dim, vector_quantization_t quantization) {
+    switch(quantization) {
+        case vector_quantization_t::int8:
+            return new int8_space_t(num_dim);
+        case vector_quantization_t::pq:
+            return new pq_space_t(num_dim);
+        default:
+            return new hnswlib::InnerProductSpace(num_dim);
+    }
+}
+
+void hnsw_index_t::reserve(size_t num_new_elements) {
+    size_t num_pending_vectors = 0;
+    if(!quantizer_trained) {
+        // pending vectors are all inserted into the graph at once when the codebook is trained
+        std::unique_lock<std::mutex> lock(pending_mutex);
+        num_pending_vectors = pending_vectors.size();
+    }
+
+    size_t curr_ele_count = vecdex->getCurrentElementCount();
+    if(curr_ele_count + num_pending_vectors + num_new_elements > vecdex->getMaxElements()) {
+        vecdex->resizeIndex((curr_ele_count + num_pending_vectors + num_new_elements) * 1.3);
+    }
+}
+
+void hnsw_index_t::insert(const float* values, size_t seq_id) {
+    if(restoring && skip_restored_insert(values, seq_id)) {
+        return;
+    }
+
+    if(quantized_space == nullptr) {
+        vecdex->insertPoint(values, seq_id);
+        return;
+    }
+
+    if(!quantizer_trained) {
+        std::unique_lock<std::mutex> lock(pending_mutex);
+
+        if(!quantizer_trained) {
+            pending_vectors[seq_id] = std::vector<float>(values, values + num_dim);
+            if(pending_vectors.size() < PQ_TRAINING_SIZE) {
+                return;
+            }
+
+            std::vector<float> training_vectors;
+            training_vectors.reserve(pending_vectors.size() * num_dim);
+            for(const auto& pending_vector: pending_vectors) {
+                training_vectors.insert(training_vectors.end(), pending_vector.second.begin(),
+                                        pending_vector.second.end());
+            }
+
+            quantized_space->train(training_vectors.data(), pending_vectors.size());
+
+            std::vector<char> code(quantized_space->get_data_size());
+            for(const auto& pending_vector: pending_vectors) {
+                quantized_space->encode(pending_vector.second.data(), code.data());
+                vecdex->insertPoint(code.data(), pending_vector.first);
+            }
+
+            pending_vectors.clear();
+            quantizer_trained = true;
+            return;
+        }
+    }
+
+    std::vector<char> code(quantized_space->get_data_size());
+    quantized_space->encode(values, code.data());
+    vecdex->insertPoint(code.data(), seq_id);
+}
+
+void hnsw_index_t::remove(size_t seq_id) {
+    if(!quantizer_trained) {
+        std::unique_lock<std::mutex> lock(pending_mutex);
+        if(pending_vectors.erase(seq_id) != 0) {
+            return;
+        }
+    }
+
+    vecdex->markDelete(seq_id);
+}
+
+bool hnsw_index_t::needs_rerank() const {
+    // until a PQ codebook is trained, searches are exact
+    return quantized_space != nullptr && rerank != 0 && quantizer_trained;
+}
+
+size_t hnsw_index_t::get_num_candidates(size_t k) const {
+    return needs_rerank() ? std::max(k, rerank) : k;
+}
+
+void hnsw_index_t::search(const float* query, size_t k, VectorFilterFunctor& filter_functor,
+                          std::vector<std::pair<float, size_t>>& dist_labels) {
+    if(quantized_space == nullptr) {
+        dist_labels = vecdex->searchKnnCloserFirst(query, k, filter_functor);
+        return;
+    }
+
+    if(!quantizer_trained) {
+        std::unique_lock<std::mutex> lock(pending_mutex);
+
+        std::vector<const float*> vectors;
+        std::vector<uint32_t> labels;
+        for(const auto& pending_vector: pending_vectors) {
+            if(filter_functor(pending_vector.first)) {
+                vectors.push_back(pending_vector.second.data());
+                labels.push_back(pending_vector.first);
+            }
+        }
+
+        vector_scan_t::top_k(query, vectors.data(), labels.data(), vectors.size(), num_dim, k, dist_labels);
+        return;
+    }
+
+    std::vector<char> query_code;
+    std::vector<float> query_buffer;
+    quantized_space->encode_query(query, query_code, query_buffer);
+    dist_labels = vecdex->searchKnnCloserFirst(query_code.data(), k, filter_functor);
+}
+
+void hnsw_index_t::flat_search(const float* query, const uint32_t* labels, size_t num_labels, size_t k,
+                               ThreadPool* thread_pool, size_t concurrency,
+                               std::vector<std::pair<float, size_t>>& dist_labels) {
+    if(!quantizer_trained) {
+        std::unique_lock<std::mutex> lock(pending_mutex);
+
+        std::vector<const float*> vectors;
+        std::vector<uint32_t> found_labels;
+        for(size_t i = 0; i < num_labels; i++) {
+            auto pending_it = pending_vectors.find(labels[i]);
+            if(pending_it != pending_vectors.end()) {
+                vectors.push_back(pending_it->second.data());
+                found_labels.push_back(labels[i]);
+            }
+        }
+
+        vector_scan_t::top_k(query, vectors.data(), found_labels.data(), vectors.size(), num_dim, k, dist_labels);
+        return;
+    }
+
+    // resolve all candidates under a single lock, reading the vectors in place instead of copying them out
+    std::vector<const float*> vectors;
+    std::vector<const char*> codes;
+    std::vector<uint32_t> found_labels;
+    found_labels.reserve(num_labels);
+
+    {
+        std::unique_lock<std::mutex> lock(vecdex->label_lookup_lock);
+
+        for(size_t i = 0; i < num_labels; i++) {
+            auto label_it = vecdex->label_lookup_.find(labels[i]);
+            if(label_it == vecdex->label_lookup_.end() || vecdex->isMarkedDeleted(label_it->second)) {
+                continue;
+            }
+
+            const char* data = vecdex->getDataByInternalId(label_it->second);
+            if(quantized_space == nullptr) {
+                vectors.push_back(reinterpret_cast<const float*>(data));
+            } else {
+                codes.push_back(data);
+            }
+
+            found_labels.push_back(labels[i]);
+        }
+    }
+
+    if(quantized_space != nullptr) {
+        std::vector<char> query_code;
+        std::vector<float> query_buffer;
+        quantized_space->encode_query(query, query_code, query_buffer);
+
+        auto dist_func = quantized_space->get_dist_func();
+        void* dist_func_param = quantized_space->get_dist_func_param();
+
+        dist_labels.clear();
+        dist_labels.reserve(codes.size());
+        for(size_t i = 0; i < codes.size(); i++) {
+            dist_labels.emplace_back(dist_func(query_code.data(), codes[i], dist_func_param), found_labels[i]);
+        }
+
+        if(dist_labels.size() > k) {
+            std::partial_sort(dist_labels.begin(), dist_labels.begin() + k, dist_labels.end());
+            dist_labels.resize(k);
+        } else {
+            std::sort(dist_labels.begin(), dist_labels.end());
+        }
+
+        return;
+    }
+
+    const size_t num_threads = (thread_pool == nullptr) ? 1 :
+                               std::max<size_t>(1, std::min<size_t>(concurrency,
+                                                    vectors.size() / vector_scan_t::MIN_PARALLEL_CANDIDATES));
+
+    if(num_threads == 1) {
+        vector_scan_t::top_k(query, vectors.data(), found_labels.data(), vectors.size(), num_dim, k, dist_labels);
+        return;
+    }
+
+    const size_t window_size = (vectors.size() + num_threads - 1) / num_threads;  // rounds up
+    std::vector<std::vector<std::pair<float, size_t>>> partial_dist_labels(num_threads);
+
+    size_t num_processed = 0;
+    std::mutex m_process;
+    std::condition_variable cv_process;
+
+    size_t num_queued = 0;
+    size_t vector_index = 0;
+
+    for(size_t thread_id = 0; thread_id < num_threads && vector_index < vectors.size(); thread_id++) {
+        const size_t batch_len = std::min(window_size, vectors.size() - vector_index);
+        num_queued++;
+
+        thread_pool->enqueue([this, thread_id, query, k, vector_index, batch_len, &vectors, &found_labels,
+                              &partial_dist_labels, &num_processed, &m_process, &cv_process]() {
+            vector_scan_t::top_k(query, vectors.data() + vector_index, found_labels.data() + vector_index,
+                                 batch_len, num_dim, k, partial_dist_labels[thread_id]);
+
+            std::unique_lock<std::mutex> lock(m_process);
+            num_processed++;
+            cv_process.notify_one();
+        });
+
+        vector_index += batch_len;
+    }
+
+    std::unique_lock<std::mutex> lock_process(m_process);
+    cv_process.wait(lock_process, [&](){ return num_processed == num_queued; });
+
+    vector_scan_t::merge_top_k(partial_dist_labels, k, dist_labels);
+}
+
+void hnsw_index_t::planned_search(const float* query, const vector_search_plan_t& plan, size_t k, size_t ef,
+                                  const uint32_t* filter_ids, size_t filter_ids_length,
+                                  VectorFilterFunctor& filter_functor, ThreadPool* thread_pool, size_t concurrency,
+                                  std::vector<std::pair<float, size_t>>& dist_labels) {
+    // hnswlib's own `ef` is shared by concurrent searches, so the beam is widened by asking for more results
+    const size_t num_graph_candidates = std::max(plan.num_candidates, ef);
+
+    switch(plan.strategy) {
+        case vector_search_strategy_t::flat:
+            flat_search(query, filter_ids, filter_ids_length, plan.num_candidates, thread_pool, concurrency,
+                        dist_labels);
+            break;
+        case vector_search_strategy_t::post_filtered_hnsw: {
+            VectorFilterFunctor no_filter(nullptr, 0);
+            search(query, num_graph_candidates, no_filter, dist_labels);
+
+            dist_labels.erase(std::remove_if(dist_labels.begin(), dist_labels.end(),
+                                             [&filter_functor](const std::pair<float, size_t>& dist_label) {
+                                                 return !filter_functor(dist_label.second);
+                                             }), dist_labels.end());
+
+            if(dist_labels.size() < k) {
+                // too few of the oversampled candidates passed the filter
+                search(query, num_graph_candidates, filter_functor, dist_labels);
+            }
+            break;
+        }
+        default:
+            search(query, num_graph_candidates, filter_functor, dist_labels);
+            break;
+    }
+
+    if(dist_labels.size() > k) {
+        dist_labels.resize(k);
+    }
+}
+
+void hnsw_index_t::rerank_candidates(const float* query, size_t k,
+                                     const std::function<bool(uint32_t, std::vector<float>&)>& get_vector,
+                                     std::vector<std::pair<float, size_t>>& dist_labels) const {
+    std::vector<float> values;
+    std::vector<float> normalized_values(num_dim);
+
+    size_t num_reranked = 0;
+
+    for(auto& dist_label: dist_labels) {
+        if(!get_vector(dist_label.second, values) || values.size() != num_dim) {
+            // an approximate distance is not comparable with the exact ones, so the candidate is dropped
+            continue;
+        }
+
+        const float* exact_values = values.data();
+        if(distance_type == cosine) {
+            normalize_vector(values, normalized_values);
+            exact_values = normalized_values.data();
+        }
+
+        dist_labels[num_reranked++] = {1.0f - vector_scan_t::inner_product(query, exact_values, num_dim),
+                                       dist_label.second};
+    }
+
+    dist_labels.resize(num_reranked);
+    std::sort(dist_labels.begin(), dist_labels.end());
+    if(dist_labels.size() > k) {
+        dist_labels.resize(k);
+    }
+}
+
+bool hnsw_index_t::save(const std::string& path_prefix) {
+    if(!quantizer_trained) {
+        // vectors pending the PQ codebook are not in the graph yet
+        return false;
+    }
+
+    try {
+        if(quantized_space != nullptr) {
+            std::ofstream quantizer_file(path_prefix + ".quantizer", std::ios::binary);
+            quantized_space->serialize(quantizer_file);
+            if(!quantizer_file.good()) {
+                return false;
+            }
+        }
+
+        vecdex->saveIndex(path_prefix + ".hnsw");
+    } catch(const std::exception& e) {
+        LOG(ERROR) << "Error while saving vector index to " << path_prefix << ": " << e.what();
+        return false;
+    }
+
+    return true;
+}
+
+bool hnsw_index_t::restore(const std::string& path_prefix, bool fresh) {
+    hnswlib::HierarchicalNSW<float, VectorFilterFunctor>* restored_vecdex = nullptr;
+
+    try {
+        if(quantized_space != nullptr) {
+            std::ifstream quantizer_file(path_prefix + ".quantizer", std::ios::binary);
+            if(!quantizer_file.good() || !quantized_space->deserialize(quantizer_file)) {
+                LOG(ERROR) << "Unable to read vector quantizer from " << path_prefix;
+                return false;
+            }
+        }
+
+        // hnswlib reads the graph into its own allocations, so the file need not outlive the restore
+        restored_vecdex = new hnswlib::HierarchicalNSW<float, VectorFilterFunctor>(space, path_prefix + ".hnsw",
+                                                                                   false, 0, true);
+    } catch(const std::exception& e) {
+        LOG(ERROR) << "Error while restoring vector index from " << path_prefix << ": " << e.what();
+        return false;
+    }
+
+    delete vecdex;
+    vecdex = restored_vecdex;
+    quantizer_trained = true;
+
+    std::unique_lock<std::mutex> lock(restore_mutex);
+    restored_labels.clear();
+
+    for(const auto& label_internal_id: vecdex->label_lookup_) {
+        if(!vecdex->isMarkedDeleted(label_internal_id.second)) {
+            restored_labels.insert(label_internal_id.first);
+        }
+    }
+
+    restored_fresh = fresh;
+    restoring = true;
+
+    return true;
+}
+
+bool hnsw_index_t::skip_restored_insert(const float* values, size_t seq_id) {
+    {
+        std::unique_lock<std::mutex> lock(restore_mutex);
+        if(restored_labels.erase(seq_id) == 0) {
+            return false;
+        }
+    }
+
+    if(restored_fresh) {
+        return true;
+    }
+
+    // the graph is older than the documents, so the vector is inserted again unless it is unchanged
+    std::vector<char> data(space->get_data_size());
+    if(quantized_space == nullptr) {
+        memcpy(data.data(), values, data.size());
+    } else {
+        quantized_space->encode(values, data.data());
+    }
+
+    std::unique_lock<std::mutex> lock(vecdex->label_lookup_lock);
+    auto label_it = vecdex->label_lookup_.find(seq_id);
+    return label_it != vecdex->label_lookup_.end() &&
+           memcmp(vecdex->getDataByInternalId(label_it->second), data.data(), data.size()) == 0;
+}
+
+void hnsw_index_t::finish_restore() {
+    std::unique_lock<std::mutex> lock(restore_mutex);
+
+    for(auto label: restored_labels) {
+        try {
+            vecdex->markDelete(label);
+        } catch(const std::exception& e) {
+            LOG(ERROR) << "Unable to remove vector of " << label << " from the restored index: " << e.what();
+        }
+    }
+
+    restored_labels.clear();
+    restoring = false;
+}
+
+void hnsw_index_t::schedule_ef_tuning(ThreadPool* thread_pool) {
+    if(hnsw_params.target_recall == 0 || quantized_space != nullptr || defer_ef_tuning) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> tuning_lock(ef_tuning_mutex);
+
+    const size_t num_elements = vecdex->getCurrentElementCount();
+    if(num_elements < MIN_TUNING_ELEMENTS || num_elements < 2 * num_elements_at_tuning) {
+        return;
+    }
+
+    if(ef_tuning.valid() && ef_tuning.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        // tuned again once the graph has grown further
+        return;
+    }
+
+    // the sample is copied, since inserts can resize the graph while it is being tuned on
+    std::vector<float> sample;
+
+    {
+        std::unique_lock<std::mutex> lock(vecdex->label_lookup_lock);
+        const size_t num_labels = vecdex->label_lookup_.size();
+        const size_t stride = std::max<size_t>(1, (num_labels + MAX_TUNING_VECTORS - 1) / MAX_TUNING_VECTORS);
+        sample.reserve(std::min(num_labels, MAX_TUNING_VECTORS) * num_dim);
+
+        size_t label_index = 0;
+        for(const auto& label_internal_id: vecdex->label_lookup_) {
+            if(label_index++ % stride != 0 || vecdex->isMarkedDeleted(label_internal_id.second)) {
+                continue;
+            }
+
+            const float* values = reinterpret_cast<const float*>(
+                                      vecdex->getDataByInternalId(label_internal_id.second));
+            sample.insert(sample.end(), values, values + num_dim);
         }
-
-        result_ids = or_ids;
-        result_ids_len = or_ids_size;
     }
 
-    filter_ids = result_ids;
-    filter_ids_length = result_ids_len;
+    num_elements_at_tuning = num_elements;
 
-    /*long long int timeMillis =
-            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now()
-    - begin).count();
+    ef_tuning = thread_pool->enqueue([this, sample = std::move(sample)]() {
+        const size_t tuned_ef = tune_ef(sample, num_dim, hnsw_params);
+        if(tuned_ef == 0) {
+            return;
+        }
 
-    LOG(INFO) << "Time taken for filtering: " << timeMillis << "ms";*/
+        ef = tuned_ef;
+
+        LOG(INFO) << "Tuned ef of vector index to " << tuned_ef << " for target recall " << hnsw_params.target_recall
+                  << " over " << sample.size() / num_dim << " sampled vectors.";
+    });
 }
 
-void Index::recursive_filter(uint32_t*& filter_ids,
-                             uint32_t& filter_ids_length,
-                             const filter_node_t* root,
-                             const bool enable_short_circuit) const {
-    if (root == nullptr) {
-        return;
+size_t hnsw_index_t::tune_ef(const std::vector<float>& sample, size_t num_dim, const hnsw_params_t& hnsw_params) {
+    const size_t num_vectors = sample.size() / num_dim;
+    if(num_vectors <= TUNING_K) {
+        return 0;
     }
 
-    uint32_t* l_filter_ids = nullptr;
-    uint32_t l_filter_ids_length = 0;
-    if (root->left != nullptr) {
-        recursive_filter(l_filter_ids, l_filter_ids_length, root->left,
-                         enable_short_circuit);
-    }
+    // recall is measured on a graph of the sample, so that its exact results need not scan the whole index
+    hnswlib::InnerProductSpace space(num_dim);
+    hnswlib::HierarchicalNSW<float, VectorFilterFunctor> graph(&space, num_vectors, hnsw_params.M,
+                                                               hnsw_params.ef_construction);
 
-    uint32_t* r_filter_ids = nullptr;
-    uint32_t r_filter_ids_length = 0;
-    if (root->right != nullptr) {
-        recursive_filter(r_filter_ids, r_filter_ids_length, root->right,
-                         enable_short_circuit);
+    std::vector<const float*> vectors(num_vectors);
+    std::vector<uint32_t> labels(num_vectors);
+
+    for(size_t i = 0; i < num_vectors; i++) {
+        vectors[i] = sample.data() + i * num_dim;
+        labels[i] = i;
+        graph.insertPoint(vectors[i], i);
     }
 
-    if (root->isOperator) {
-        uint32_t* filtered_results = nullptr;
-        if (root->filter_operator == AND) {
-            filter_ids_length = ArrayUtils::and_scalar(
-                l_filter_ids, l_filter_ids_length, r_filter_ids,
-                r_filter_ids_length, &filtered_results);
-        } else {
-            filter_ids_length = ArrayUtils::or_scalar(
-                l_filter_ids, l_filter_ids_length, r_filter_ids,
-                r_filter_ids_length, &filtered_results);
+    // fixed seed, so that replicas tune to the same `ef` given the same vectors
+    std::mt19937 rng(42);
+    std::vector<const float*> queries;
+    std::vector<std::set<size_t>> exact_labels;
+
+    for(size_t i = 0; i < NUM_TUNING_QUERIES; i++) {
+        const float* query = vectors[rng() % num_vectors];
+        queries.push_back(query);
+
+        std::vector<std::pair<float, size_t>> dist_labels;
+        vector_scan_t::top_k(query, vectors.data(), labels.data(), num_vectors, num_dim, TUNING_K, dist_labels);
+
+        exact_labels.emplace_back();
+        for(const auto& dist_label: dist_labels) {
+            exact_labels.back().insert(dist_label.second);
         }
+    }
 
-        delete[] l_filter_ids;
-        delete[] r_filter_ids;
+    VectorFilterFunctor no_filter(nullptr, 0);
+    size_t tuned_ef = TUNING_K;
 
-        filter_ids = filtered_results;
-    } else if (root->left == nullptr && root->right == nullptr) {
-        do_filtering(filter_ids, filter_ids_length, root);
-    } else {
-        // malformed
+    for(; tuned_ef < MAX_TUNED_EF; tuned_ef += std::max<size_t>(TUNING_K, tuned_ef / 2)) {
+        size_t num_found = 0;
+
+        for(size_t i = 0; i < queries.size(); i++) {
+            const auto& dist_labels = graph.searchKnnCloserFirst(queries[i], tuned_ef, no_filter);
+
+            for(size_t j = 0; j < dist_labels.size() && j < TUNING_K; j++) {
+                num_found += exact_labels[i].count(dist_labels[j].second);
+            }
+        }
+
+        if(float(num_found) / (queries.size() * TUNING_K) >= hnsw_params.target_recall) {
+            break;
+        }
     }
+
+    return std::min(tuned_ef, MAX_TUNED_EF);
 }
 
-void Index::do_filtering_with_lock(uint32_t*& filter_ids,
-                                   uint32_t& filter_ids_length,
-                                   filter_node_t const* const& filter_tree_root) const {
-    std::shared_lock lock(mutex);
-    recursive_filter(filter_ids, filter_ids_length, filter_tree_root, false);
+size_t hnsw_index_t::vectors_memory_used() {
+    size_t memory_used = vecdex->getCurrentElementCount() * space->get_data_size();
+
+    if(quantized_space != nullptr) {
+        memory_used += quantized_space->memory_used();
+
+        std::unique_lock<std::mutex> lock(pending_mutex);
+        memory_used += pending_vectors.size() * num_dim * sizeof(float);
+    }
+
+    return memory_used;
 }
 
 void Index::run_search(search_args* search_params) {
+    // scratch state of the request thread is released in one go once the search is done
+    search_arena_t arena;
+
     search(search_params->field_query_tokens,
            search_params->search_fields,
            search_params->match_type,
@@ -1964,7 +3045,8 @@ void Index::run_search(search_args* search_params) {
            search_params->facet_query_num_typos,
            search_params->filter_curated_hits,
            search_params->split_join_tokens,
-           search_params->vector_query);
+           search_params->vector_query,
+           search_params->vector_search_info);
 }
 
 void Index::collate_included_ids(const std::vector<token_t>& q_included_tokens,
@@ -2413,7 +3495,7 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
                    size_t max_candidates, const std::vector<enable_t>& infixes, const size_t max_extra_prefix,
                    const size_t max_extra_suffix, const size_t facet_query_num_typos,
                    const bool filter_curated_hits, const enable_t split_join_tokens,
-                   const vector_query_t& vector_query) const {
+                   const vector_query_t& vector_query, vector_search_info_t& vector_search_info) const {
 
     // process the filters
 
@@ -2422,11 +3504,21 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
 
     std::shared_lock lock(mutex);
 
-    recursive_filter(filter_ids, filter_ids_length, filter_tree_root, true);
+    // a broad filter is checked against the matches of the query instead of being materialized upfront
+    std::unique_ptr<filter_result_iterator_t> filter_iterator;
 
-    if (filter_tree_root != nullptr && filter_ids_length == 0) {
-        delete [] filter_ids;
-        return;
+    if(use_lazy_filter(filter_tree_root, field_query_tokens, included_ids, filter_curated_hits, vector_query)) {
+        filter_iterator.reset(new_filter_iterator(filter_tree_root));
+        if(!filter_iterator->valid()) {
+            return;
+        }
+    } else {
+        recursive_filter(filter_ids, filter_ids_length, filter_tree_root, true);
+
+        if (filter_tree_root != nullptr && filter_ids_length == 0) {
+            delete [] filter_ids;
+            return;
+        }
     }
 
     std::set<uint32_t> curated_ids;
@@ -2476,13 +3568,26 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
         const uint8_t field_id = (uint8_t)(FIELD_LIMIT_NUM - 0);
         bool no_filters_provided = (filter_tree_root == nullptr && filter_ids_length == 0);
 
+        // when no hits are requested, only the ids of the matching documents are needed: not their ranking
+        const bool count_only = (per_page == 0 && group_limit == 0 && vector_query.field_name.empty());
+
+        const bool seq_id_desc_sort = (sort_fields_std.size() == 1 &&
+                                       sort_fields_std[0].name == sort_field_const::seq_id &&
+                                       sort_fields_std[0].order == sort_field_const::desc);
+
         if(no_filters_provided && facets.empty() && curated_ids.empty() && vector_query.field_name.empty() &&
-           sort_fields_std.size() == 1 && sort_fields_std[0].name == sort_field_const::seq_id &&
-           sort_fields_std[0].order == sort_field_const::desc) {
+           exclude_token_ids_size == 0 && (seq_id_desc_sort || count_only)) {
             // optimize for this path specifically
             std::vector<uint32_t> result_ids;
             auto it = seq_ids->new_rev_iterator();
-            while (it.valid()) {
+
+            if(seq_id_desc_sort && topster->has_cursor && topster->cursor_kv.scores[0] >= 0 &&
+               topster->cursor_kv.scores[0] <= UINT32_MAX) {
+                // ids above the cursor were on the previous pages
+                it.skip_back_to(topster->cursor_kv.scores[0]);
+            }
+
+            while (it.valid() && result_ids.size() < page * per_page) {
                 uint32_t seq_id = it.id();
                 uint64_t distinct_id = seq_id;
                 if (group_limit != 0) {
@@ -2494,12 +3599,10 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
                 scores[0] = seq_id;
                 int64_t match_score_index = -1;
 
-                result_ids.push_back(seq_id);
                 KV kv(searched_queries.size(), seq_id, distinct_id, match_score_index, scores);
-                topster->add(&kv);
-
-                if (result_ids.size() == page * per_page) {
-                    break;
+                if(topster->add(&kv)) {
+                    // ids that precede a cursor are not counted towards the page
+                    result_ids.push_back(seq_id);
                 }
 
                 it.previous();
@@ -2527,44 +3630,71 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
                 k++;
             }
 
-            VectorFilterFunctor filterFunctor(filter_ids, filter_ids_length);
             auto& field_vector_index = vector_index.at(vector_query.field_name);
 
-            std::vector<std::pair<float, size_t>> dist_labels;
+            std::vector<float> query_values = vector_query.values;
+            if(field_vector_index->distance_type == cosine) {
+                hnsw_index_t::normalize_vector(vector_query.values, query_values);
+            }
 
-            if(!no_filters_provided && filter_ids_length < vector_query.flat_search_cutoff) {
-                for(size_t i = 0; i < filter_ids_length; i++) {
-                    auto seq_id = filter_ids[i];
-                    std::vector<float> values;
+            auto vector_search_begin = std::chrono::high_resolution_clock::now();
 
-                    try {
-                        values = field_vector_index->vecdex->getDataByLabel<float>(seq_id);
-                    } catch(...) {
-                        // likely not found
-                        continue;
-                    }
+            // without filters, curated or excluded ids, `filter_ids` holds every document, which the graph search
+            // need not check
+            const bool vector_filtered = !no_filters_provided || excluded_result_ids_size != 0;
+            VectorFilterFunctor filterFunctor(filter_ids, vector_filtered ? filter_ids_length : 0);
 
-                    float dist;
-                    if(field_vector_index->distance_type == cosine) {
-                        std::vector<float> normalized_q(vector_query.values.size());
-                        hnsw_index_t::normalize_vector(vector_query.values, normalized_q);
-                        dist = field_vector_index->space->get_dist_func()(normalized_q.data(), values.data(),
-                                                                           &field_vector_index->num_dim);
-                    } else {
-                        dist = field_vector_index->space->get_dist_func()(vector_query.values.data(), values.data(),
-                                                                           &field_vector_index->num_dim);
-                    }
+            const size_t num_candidates = field_vector_index->get_num_candidates(k);
+            const size_t num_elements = field_vector_index->vecdex->getCurrentElementCount();
+            const auto plan = vector_search_planner_t::plan(vector_filtered, filter_ids_length, num_elements,
+                                                            num_candidates, field_vector_index->hnsw_params.M,
+                                                            vector_query.flat_search_cutoff);
+
+            const size_t ef = (vector_query.ef != 0) ? vector_query.ef : field_vector_index->ef.load();
 
-                    dist_labels.emplace_back(dist, seq_id);
+            std::vector<std::pair<float, size_t>> dist_labels;
+            field_vector_index->planned_search(query_values.data(), plan, num_candidates, ef, filter_ids,
+                                               filter_ids_length, filterFunctor, thread_pool, concurrency,
+                                               dist_labels);
+
+            auto get_stored_vector_values = [this, &vector_query](uint32_t seq_id, std::vector<float>& values) {
+                return get_stored_vector(vector_query.field_name, seq_id, values);
+            };
+
+            if(field_vector_index->needs_rerank()) {
+                field_vector_index->rerank_candidates(query_values.data(), k, get_stored_vector_values,
+                                                      dist_labels);
+            }
+
+            vector_search_info.executed = true;
+            vector_search_info.plan = plan;
+            vector_search_info.num_filtered = filter_ids_length;
+            vector_search_info.num_elements = num_elements;
+            vector_search_info.search_time_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::high_resolution_clock::now() - vector_search_begin).count();
+
+            if(vector_query.measure_recall) {
+                // recall is relative to an exhaustive scan of the same index
+                std::vector<std::pair<float, size_t>> exact_dist_labels;
+                field_vector_index->flat_search(query_values.data(), filter_ids, filter_ids_length, num_candidates,
+                                                thread_pool, concurrency, exact_dist_labels);
+                if(field_vector_index->needs_rerank()) {
+                    field_vector_index->rerank_candidates(query_values.data(), k, get_stored_vector_values,
+                                                          exact_dist_labels);
                 }
-            } else {
-                if(field_vector_index->distance_type == cosine) {
-                    std::vector<float> normalized_q(vector_query.values.size());
-                    hnsw_index_t::normalize_vector(vector_query.values, normalized_q);
-                    dist_labels = field_vector_index->vecdex->searchKnnCloserFirst(normalized_q.data(), k, filterFunctor);
-                } else {
-                    dist_labels = field_vector_index->vecdex->searchKnnCloserFirst(vector_query.values.data(), k, filterFunctor);
+
+                std::set<size_t> exact_labels;
+                for(size_t i = 0; i < exact_dist_labels.size() && i < k; i++) {
+                    exact_labels.insert(exact_dist_labels[i].second);
+                }
+
+                size_t num_found = 0;
+                for(const auto& dist_label: dist_labels) {
+                    num_found += exact_labels.count(dist_label.second);
                 }
+
+                vector_search_info.recall_measured = true;
+                vector_search_info.recall = exact_labels.empty() ? 1.0f : float(num_found) / exact_labels.size();
             }
 
             std::vector<uint32_t> nearest_ids;
@@ -2602,6 +3732,12 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
                 std::copy(nearest_ids.begin(), nearest_ids.end(), all_result_ids);
                 all_result_ids_len = nearest_ids.size();
             }
+        } else if(count_only) {
+            // the filtered ids are the results as is, so that they can be faceted without being scored
+            all_result_ids = filter_ids;
+            all_result_ids_len = filter_ids_length;
+            filter_ids = nullptr;
+            filter_ids_length = 0;
         } else {
             search_wildcard(filter_tree_root, included_ids_map, sort_fields_std, topster,
                             curated_topster, groups_processed, searched_queries, group_limit, group_by_fields,
@@ -2615,6 +3751,9 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
         // In multi-field searches, a record can be matched across different fields, so we use this for aggregation
         //begin = std::chrono::high_resolution_clock::now();
 
+        // a document can be matched by several queries, each with a different score
+        topster->track_cursor_keys = topster->has_cursor;
+
         // FIXME: needed?
         std::set<uint64> query_hashes;
 
@@ -2649,9 +3788,10 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
         }
 
         fuzzy_search_fields(the_fields, field_query_tokens[0].q_include_tokens, match_type, false, excluded_result_ids,
-                            excluded_result_ids_size, filter_ids, filter_ids_length, curated_ids_sorted,
-                            sort_fields_std, num_typos, searched_queries, qtoken_set, topster, groups_processed,
-                            all_result_ids, all_result_ids_len, group_limit, group_by_fields, prioritize_exact_match,
+                            excluded_result_ids_size, filter_ids, filter_ids_length, filter_iterator.get(),
+                            curated_ids_sorted, sort_fields_std, num_typos, searched_queries, qtoken_set, topster,
+                            groups_processed, all_result_ids, all_result_ids_len, group_limit, group_by_fields,
+                            prioritize_exact_match,
                             prioritize_token_position, query_hashes, token_order, prefixes,
                             typo_tokens_threshold, exhaustive_search,
                             max_candidates, min_len_1typo, min_len_2typo, syn_orig_num_tokens, sort_order,
@@ -2686,9 +3826,10 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
                 }
 
                 fuzzy_search_fields(the_fields, resolved_tokens, match_type, false, excluded_result_ids,
-                                    excluded_result_ids_size, filter_ids, filter_ids_length, curated_ids_sorted,
-                                    sort_fields_std, num_typos, searched_queries, qtoken_set, topster, groups_processed,
-                                    all_result_ids, all_result_ids_len, group_limit, group_by_fields, prioritize_exact_match,
+                                    excluded_result_ids_size, filter_ids, filter_ids_length, filter_iterator.get(),
+                                    curated_ids_sorted, sort_fields_std, num_typos, searched_queries, qtoken_set,
+                                    topster, groups_processed, all_result_ids, all_result_ids_len, group_limit,
+                                    group_by_fields, prioritize_exact_match,
                                     prioritize_token_position, query_hashes, token_order, prefixes, typo_tokens_threshold, exhaustive_search,
                                     max_candidates, min_len_1typo, min_len_2typo, syn_orig_num_tokens, sort_order, field_values, geopoint_indices);
             }
@@ -2702,7 +3843,7 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
                           min_len_1typo, min_len_2typo, max_candidates, curated_ids, curated_ids_sorted,
                           excluded_result_ids, excluded_result_ids_size, topster, q_pos_synonyms, syn_orig_num_tokens,
                           groups_processed, searched_queries, all_result_ids, all_result_ids_len,
-                          filter_ids, filter_ids_length, query_hashes,
+                          filter_ids, filter_ids_length, filter_iterator.get(), query_hashes,
                           sort_order, field_values, geopoint_indices,
                           qtoken_set);
 
@@ -2743,8 +3884,9 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
                         }
 
                         fuzzy_search_fields(the_fields, truncated_tokens, match_type, true, excluded_result_ids,
-                                            excluded_result_ids_size, filter_ids, filter_ids_length, curated_ids_sorted,
-                                            sort_fields_std, num_typos, searched_queries, qtoken_set, topster, groups_processed,
+                                            excluded_result_ids_size, filter_ids, filter_ids_length,
+                                            filter_iterator.get(), curated_ids_sorted, sort_fields_std, num_typos,
+                                            searched_queries, qtoken_set, topster, groups_processed,
                                             all_result_ids, all_result_ids_len, group_limit, group_by_fields, prioritize_exact_match,
                                             prioritize_token_position, query_hashes, token_order, prefixes, typo_tokens_threshold,
                                             exhaustive_search, max_candidates, min_len_1typo,
@@ -2757,6 +3899,14 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
             }
         }
 
+        const bool infix_enabled = std::any_of(infixes.begin(), infixes.end(),
+                                               [](const enable_t infix) { return infix != off; });
+
+        if(filter_iterator != nullptr && infix_enabled) {
+            // infix matches are intersected with the filtered ids
+            filter_ids_length = filter_iterator->to_filter_id_array(filter_ids);
+        }
+
         do_infix_search(num_search_fields, the_fields, infixes, sort_fields_std, searched_queries,
                         group_limit, group_by_fields,
                         max_extra_prefix, max_extra_suffix,
@@ -2792,7 +3942,7 @@ void Index::search(std::vector<query_tokens_t>& field_query_tokens, const std::v
         std::vector<std::vector<facet>> facet_batches(num_threads);
         for(size_t i = 0; i < num_threads; i++) {
             for(const auto& this_facet: facets) {
-                facet_batches[i].emplace_back(facet(this_facet.field_name));
+                facet_batches[i].emplace_back(facet(this_facet.field_name, this_facet.ranges));
             }
         }
 
@@ -2982,6 +4132,7 @@ void Index::fuzzy_search_fields(const std::vector<search_field_t>& the_fields,
                                 const uint32_t* exclude_token_ids,
                                 size_t exclude_token_ids_size,
                                 const uint32_t* filter_ids, size_t filter_ids_length,
+                                filter_result_iterator_t* const filter_iterator,
                                 const std::vector<uint32_t>& curated_ids,
                                 const std::vector<sort_by> & sort_fields,
                                 const std::vector<uint32_t>& num_typos,
@@ -3123,9 +4274,8 @@ void Index::fuzzy_search_fields(const std::vector<search_field_t>& the_fields,
 
                     std::vector<art_leaf*> field_leaves;
                     int max_words = 100000;
-                    art_fuzzy_search(search_index.at(the_field.name), (const unsigned char *) token.c_str(), token_len,
-                                     costs[token_index], costs[token_index], max_words, token_order, prefix_search,
-                                     filter_ids, filter_ids_length, field_leaves, unique_tokens);
+                    fuzzy_search_leaves(the_field.name, token, token_len, costs[token_index], max_words, token_order,
+                                        prefix_search, filter_ids, filter_ids_length, field_leaves, unique_tokens);
 
                     /*auto timeMillis = std::chrono::duration_cast<std::chrono::milliseconds>(
                                     std::chrono::high_resolution_clock::now() - begin).count();
@@ -3197,8 +4347,9 @@ void Index::fuzzy_search_fields(const std::vector<search_field_t>& the_fields,
                     std::vector<uint32_t> prev_token_doc_ids;
                     find_across_fields(token_candidates_vec.back().token,
                                        token_candidates_vec.back().candidates[0],
-                                       the_fields, num_search_fields, filter_ids, filter_ids_length, exclude_token_ids,
-                                       exclude_token_ids_size, prev_token_doc_ids, popular_field_ids);
+                                       the_fields, num_search_fields, filter_ids, filter_ids_length, filter_iterator,
+                                       exclude_token_ids, exclude_token_ids_size, prev_token_doc_ids,
+                                       popular_field_ids);
 
                     for(size_t field_id: query_field_ids) {
                         auto& the_field = the_fields[field_id];
@@ -3219,9 +4370,9 @@ void Index::fuzzy_search_fields(const std::vector<search_field_t>& the_fields,
 
                         std::vector<art_leaf*> field_leaves;
                         int max_words = 100000;
-                        art_fuzzy_search(search_index.at(the_field.name), (const unsigned char *) token.c_str(), token_len,
-                                         costs[token_index], costs[token_index], max_words, token_order, prefix_search,
-                                         filter_ids, filter_ids_length, field_leaves, unique_tokens);
+                        fuzzy_search_leaves(the_field.name, token, token_len, costs[token_index], max_words,
+                                            token_order, prefix_search, filter_ids, filter_ids_length,
+                                            field_leaves, unique_tokens);
 
                         if(field_leaves.empty()) {
                             // look at the next field
@@ -3284,7 +4435,7 @@ void Index::fuzzy_search_fields(const std::vector<search_field_t>& the_fields,
         if(token_candidates_vec.size() == query_tokens.size()) {
             std::vector<uint32_t> id_buff;
             search_all_candidates(num_search_fields, match_type, the_fields, filter_ids, filter_ids_length,
-                                  exclude_token_ids, exclude_token_ids_size,
+                                  filter_iterator, exclude_token_ids, exclude_token_ids_size,
                                   sort_fields, token_candidates_vec, searched_queries, qtoken_set, topster,
                                   groups_processed, all_result_ids, all_result_ids_len,
                                   typo_tokens_threshold, group_limit, group_by_fields, query_tokens,
@@ -3348,11 +4499,82 @@ void Index::popular_fields_of_token(const spp::sparse_hash_map<std::string, art_
     }
 }
 
+void Index::expand_token_leaves(art_tree* t, const typo_index_t* field_typo_index, const std::string& token,
+                                const size_t token_len, const int cost, const int max_words,
+                                const token_ordering token_order, const bool prefix_search,
+                                const uint32_t* filter_ids, const size_t filter_ids_length,
+                                std::vector<art_leaf*>& field_leaves, const std::set<std::string>& exclude_leaves) {
+
+    // short, fully typed tokens are resolved via hash lookups on their deletion neighbourhood
+    if(field_typo_index != nullptr && cost > 0 && !prefix_search && field_typo_index->searchable(token)) {
+        field_typo_index->search(t, token, cost, max_words, token_order, filter_ids, filter_ids_length,
+                                 field_leaves, exclude_leaves);
+        return;
+    }
+
+    art_fuzzy_search(t, (const unsigned char *) token.c_str(), token_len, cost, cost, max_words, token_order,
+                     prefix_search, filter_ids, filter_ids_length, field_leaves, exclude_leaves);
+}
+
+void Index::fuzzy_search_leaves(const std::string& field_name, const std::string& token, const size_t token_len,
+                                const int cost, const int max_words, const token_ordering token_order,
+                                const bool prefix_search, const uint32_t* filter_ids, const size_t filter_ids_length,
+                                std::vector<art_leaf*>& field_leaves,
+                                const std::set<std::string>& exclude_leaves) const {
+
+    art_tree* t = search_index.at(field_name);
+    auto typo_index_it = typo_index.find(field_name);
+    const typo_index_t* field_typo_index = (typo_index_it != typo_index.end()) ? typo_index_it->second : nullptr;
+
+    auto cache_it = token_expansion_caches.find(field_name);
+    if(cache_it == token_expansion_caches.end()) {
+        expand_token_leaves(t, field_typo_index, token, token_len, cost, max_words, token_order, prefix_search,
+                            filter_ids, filter_ids_length, field_leaves, exclude_leaves);
+        return;
+    }
+
+    token_expansion_cache_t* expansion_cache = cache_it->second;
+    auto expansion = expansion_cache->get(token, cost, prefix_search, token_order, max_words);
+
+    if(expansion == nullptr) {
+        // expansion is computed without filter and exclusions so that other queries can reuse it
+        const uint64_t generation = expansion_cache->get_generation();
+        std::vector<art_leaf*> leaves;
+        expand_token_leaves(t, field_typo_index, token, token_len, cost, max_words, token_order, prefix_search,
+                            nullptr, 0, leaves, {});
+
+        // a truncated expansion can miss the leaves that pass the filter and exclusions, and isn't cached anyway
+        if(leaves.size() >= size_t(max_words) && (filter_ids_length != 0 || !exclude_leaves.empty())) {
+            expand_token_leaves(t, field_typo_index, token, token_len, cost, max_words, token_order, prefix_search,
+                                filter_ids, filter_ids_length, field_leaves, exclude_leaves);
+            return;
+        }
+
+        art_leaf* exact_leaf = nullptr;
+        if(cost == 0 && !leaves.empty()) {
+            exact_leaf = static_cast<art_leaf*>(art_search(t, (const unsigned char *) token.c_str(),
+                                                           token.size() + 1));
+            if(exact_leaf != nullptr && leaves.front() == exact_leaf) {
+                leaves.erase(leaves.begin());
+            } else {
+                exact_leaf = nullptr;
+            }
+        }
+
+        expansion = expansion_cache->put(token, cost, prefix_search, token_order, max_words, generation,
+                                         exact_leaf, std::move(leaves));
+    }
+
+    token_expansion_cache_t::apply(*expansion, max_words, filter_ids, filter_ids_length, exclude_leaves,
+                                   field_leaves);
+}
+
 void Index::find_across_fields(const token_t& previous_token,
                                const std::string& previous_token_str,
                                const std::vector<search_field_t>& the_fields,
                                const size_t num_search_fields,
                                const uint32_t* filter_ids, uint32_t filter_ids_length,
+                               filter_result_iterator_t* const filter_iterator,
                                const uint32_t* exclude_token_ids, size_t exclude_token_ids_size,
                                std::vector<uint32_t>& prev_token_doc_ids,
                                std::vector<size_t>& top_prefix_field_ids) const {
@@ -3364,6 +4586,7 @@ void Index::find_across_fields(const token_t& previous_token,
     std::vector<posting_list_t*> expanded_plists;
 
     result_iter_state_t istate(exclude_token_ids, exclude_token_ids_size, filter_ids, filter_ids_length);
+    istate.filter_iterator = filter_iterator;
 
     const bool prefix_search = previous_token.is_prefix_searched;
     const uint32_t token_num_typos = previous_token.num_typos;
@@ -3444,6 +4667,7 @@ void Index::search_across_fields(const std::vector<token_t>& query_tokens,
                                  const bool prioritize_exact_match,
                                  const bool prioritize_token_position,
                                  const uint32_t* filter_ids, uint32_t filter_ids_length,
+                                 filter_result_iterator_t* const filter_iterator,
                                  const uint32_t total_cost, const int syn_orig_num_tokens,
                                  const uint32_t* exclude_token_ids, size_t exclude_token_ids_size,
                                  const int* sort_order,
@@ -3461,6 +4685,7 @@ void Index::search_across_fields(const std::vector<token_t>& query_tokens,
     std::vector<posting_list_t*> expanded_plists;
 
     result_iter_state_t istate(exclude_token_ids, exclude_token_ids_size, filter_ids, filter_ids_length);
+    istate.filter_iterator = filter_iterator;
 
     // for each token, find the posting lists across all query_by fields
     for(size_t ti = 0; ti < query_tokens.size(); ti++) {
@@ -3525,10 +4750,15 @@ void Index::search_across_fields(const std::vector<token_t>& query_tokens,
     std::vector<uint32_t> result_ids;
     size_t filter_index = 0;
 
+    // reused across candidates so that the per field iterator lists keep their capacity
+    std::vector<std::vector<posting_list_t::iterator_t>> field_to_tokens(num_search_fields);
+
     or_iterator_t::intersect(token_its, istate, [&](uint32_t seq_id, const std::vector<or_iterator_t>& its) {
         //LOG(INFO) << "seq_id: " << seq_id;
         // Convert [token -> fields] orientation to [field -> tokens] orientation
-        std::vector<std::vector<posting_list_t::iterator_t>> field_to_tokens(num_search_fields);
+        for(auto& token_postings: field_to_tokens) {
+            token_postings.clear();
+        }
 
         for(size_t ti = 0; ti < its.size(); ti++) {
             const or_iterator_t& token_fields_iters = its[ti];
@@ -4014,6 +5244,7 @@ void Index::do_synonym_search(const std::vector<search_field_t>& the_fields,
                               std::vector<std::vector<art_leaf*>>& searched_queries,
                               uint32_t*& all_result_ids, size_t& all_result_ids_len,
                               const uint32_t* filter_ids, const uint32_t filter_ids_length,
+                              filter_result_iterator_t* const filter_iterator,
                               std::set<uint64>& query_hashes,
                               const int* sort_order,
                               std::array<spp::sparse_hash_map<uint32_t, int64_t>*, 3>& field_values,
@@ -4023,7 +5254,7 @@ void Index::do_synonym_search(const std::vector<search_field_t>& the_fields,
     for (const auto& syn_tokens : q_pos_synonyms) {
         query_hashes.clear();
         fuzzy_search_fields(the_fields, syn_tokens, match_type, false, exclude_token_ids,
-                            exclude_token_ids_size, filter_ids, filter_ids_length, curated_ids_sorted,
+                            exclude_token_ids_size, filter_ids, filter_ids_length, filter_iterator, curated_ids_sorted,
                             sort_fields_std, {0}, searched_queries, qtoken_set, actual_topster, groups_processed,
                             all_result_ids, all_result_ids_len, group_limit, group_by_fields, prioritize_exact_match,
                             prioritize_token_position, query_hashes, token_order, prefixes, typo_tokens_threshold,
@@ -4206,6 +5437,7 @@ void Index::compute_facet_infos(const std::vector<facet>& facets, facet_query_t&
 
         const field &facet_field = search_schema.at(a_facet.field_name);
         facet_infos[findex].facet_field = facet_field;
+        facet_infos[findex].num_type = get_facet_num_type(facet_field);
 
         facet_infos[findex].should_compute_stats = (facet_field.type != field_types::STRING &&
                                                     facet_field.type != field_types::BOOL &&
@@ -4225,8 +5457,38 @@ void Index::compute_facet_infos(const std::vector<facet>& facets, facet_query_t&
 
             //LOG(INFO) << "facet_query.query: " << facet_query.query;
 
+            if(!facet_field.is_string()) {
+                // non-string facet values are matched on the prefix of their textual form
+                const auto& field_facet_mapping = field_facet_mapping_it->second;
+                std::unordered_set<uint64_t> unmatched_hashes;
+
+                for(size_t i = 0; i < all_result_ids_len; i++) {
+                    const uint32_t seq_id = all_result_ids[i];
+                    const auto doc_fvalues_it = field_facet_mapping[seq_id % ARRAY_FACET_DIM]->find(seq_id);
+                    if(doc_fvalues_it == field_facet_mapping[seq_id % ARRAY_FACET_DIM]->end()) {
+                        continue;
+                    }
+
+                    for(size_t j = 0; j < doc_fvalues_it->second.length; j++) {
+                        const uint64_t hash = doc_fvalues_it->second.hashes[j];
+                        if(facet_infos[findex].hashes.count(hash) != 0 || unmatched_hashes.count(hash) != 0) {
+                            continue;
+                        }
+
+                        const std::string value = facet_hash_to_str(hash, facet_infos[findex].num_type);
+                        if(value.rfind(facet_query.query, 0) == 0) {
+                            facet_infos[findex].hashes.emplace(hash, std::vector<std::string>{value});
+                        } else {
+                            unmatched_hashes.insert(hash);
+                        }
+                    }
+                }
+
+                continue;
+            }
+
             std::vector<std::string> query_tokens;
-            Tokenizer(facet_query.query, true, !facet_field.is_string(),
+            Tokenizer(facet_query.query, true, false,
                       facet_field.locale, symbols_to_index, token_separators).tokenize(query_tokens);
 
             std::vector<token_t> qtokens;
@@ -4248,7 +5510,7 @@ void Index::compute_facet_infos(const std::vector<facet>& facets, facet_query_t&
             std::vector<sort_by> sort_fields;
 
             search_field(0, qtokens, nullptr, 0, num_toks_dropped,
-                         facet_field, facet_field.faceted_name(),
+                         facet_field, facet_field.name,
                          all_result_ids, all_result_ids_len, {}, sort_fields, -1, facet_query_num_typos, searched_queries, topster,
                          groups_processed, &field_result_ids, field_result_ids_len, field_num_results, 0, group_by_fields,
                          false, 4, query_hashes, MAX_SCORE, true, 0, 1, false, -1, 3, 1000, max_candidates);
@@ -4397,6 +5659,9 @@ void Index::search_wildcard(filter_node_t const* const& filter_tree_root,
         searched_queries.push_back({});
 
         topsters[thread_id] = new Topster(topster->MAX_SIZE, topster->distinct);
+        if(topster->has_cursor) {
+            topsters[thread_id]->set_cursor(topster->cursor_kv.scores, topster->cursor_kv.key);
+        }
 
         thread_pool->enqueue([this, &parent_search_begin, &parent_search_stop_ms, &parent_search_cutoff,
                                      thread_id, &sort_fields, &searched_queries,
@@ -4410,6 +5675,8 @@ void Index::search_wildcard(filter_node_t const* const& filter_tree_root,
             search_stop_us = parent_search_stop_ms;
             search_cutoff = parent_search_cutoff;
 
+            search_arena_t arena;
+
             size_t filter_index = 0;
 
             for(size_t i = 0; i < batch_res_len; i++) {
@@ -4747,11 +6014,11 @@ int64_t Index::score_results2(const std::vector<sort_by> & sort_fields, const ui
                   << ", match_score: " << match_score;*/
 
     } else {
-        std::map<size_t, std::vector<token_positions_t>> array_token_positions;
+        std::pmr::map<size_t, std::pmr::vector<token_positions_t>> array_token_positions(search_arena_t::resource());
         posting_list_t::get_offsets(posting_lists, array_token_positions);
 
         for (const auto& kv: array_token_positions) {
-            const std::vector<token_positions_t>& token_positions = kv.second;
+            const auto& token_positions = kv.second;
             if (token_positions.empty()) {
                 continue;
             }
@@ -4894,7 +6161,7 @@ void Index::score_results(const std::vector<sort_by> & sort_fields, const uint16
         Match single_token_match = Match(words_present, distance, is_verbatim_match);
         match_score = single_token_match.get_match_score(total_cost, words_present);
     } else {
-        std::map<size_t, std::vector<token_positions_t>> array_token_positions;
+        std::pmr::map<size_t, std::pmr::vector<token_positions_t>> array_token_positions(search_arena_t::resource());
         posting_list_t::get_offsets(posting_lists, array_token_positions);
 
         // NOTE: tokens found returned by matcher is only within the best matched window, so we have to still consider
@@ -4905,7 +6172,7 @@ void Index::score_results(const std::vector<sort_by> & sort_fields, const uint16
         }
 
         for (const auto& kv: array_token_positions) {
-            const std::vector<token_positions_t>& token_positions = kv.second;
+            const auto& token_positions = kv.second;
             if (token_positions.empty()) {
                 continue;
             }
@@ -5133,20 +6400,135 @@ inline uint32_t Index::next_suggestion(const std::vector<token_candidates> &toke
     return total_cost;
 }
 
-void Index::remove_facet_token(const field& search_field, spp::sparse_hash_map<std::string, art_tree*>& search_index,
-                               const std::string& token, uint32_t seq_id) {
-    const unsigned char *key = (const unsigned char *) token.c_str();
-    int key_len = (int) (token.length() + 1);
-    const std::string& field_name = search_field.faceted_name();
+void Index::save_vector_indices(const std::string& dir_path, nlohmann::json& saved_indices) const {
+    std::shared_lock lock(mutex);
+
+    for(const auto& field_vector_index: vector_index) {
+        const std::string file_name = std::to_string(collection_id) + "_" + std::to_string(saved_indices.size());
+        hnsw_index_t* hnsw_index = field_vector_index.second;
+
+        if(!hnsw_index->save(dir_path + "/" + file_name)) {
+            continue;
+        }
+
+        nlohmann::json saved_index;
+        saved_index["collection_id"] = collection_id;
+        saved_index["field"] = field_vector_index.first;
+        saved_index["file"] = file_name;
+        saved_index["num_dim"] = hnsw_index->num_dim;
+        saved_index["quantization"] = magic_enum::enum_name(hnsw_index->quantization);
+        saved_index["num_elements"] = hnsw_index->vecdex->getCurrentElementCount();
+        saved_indices.push_back(saved_index);
+    }
+}
+
+void Index::restore_vector_indices(const std::string& dir_path, const nlohmann::json& saved_indices, bool fresh) {
+    std::unique_lock lock(mutex);
+
+    for(const auto& saved_index: saved_indices) {
+        if(saved_index["collection_id"].get<uint32_t>() != collection_id) {
+            continue;
+        }
+
+        auto vector_index_it = vector_index.find(saved_index["field"].get<std::string>());
+        if(vector_index_it == vector_index.end()) {
+            continue;
+        }
+
+        hnsw_index_t* hnsw_index = vector_index_it->second;
+        if(saved_index["num_dim"].get<size_t>() != hnsw_index->num_dim ||
+           saved_index["quantization"].get<std::string>() != magic_enum::enum_name(hnsw_index->quantization)) {
+            continue;
+        }
+
+        auto begin = std::chrono::high_resolution_clock::now();
+
+        if(hnsw_index->restore(dir_path + "/" + saved_index["file"].get<std::string>(), fresh)) {
+            LOG(INFO) << "Restored vector index of field " << vector_index_it->first << " with "
+                      << hnsw_index->vecdex->getCurrentElementCount() << " elements in "
+                      << std::chrono::duration_cast<std::chrono::milliseconds>(
+                              std::chrono::high_resolution_clock::now() - begin).count() << "ms.";
+        }
+    }
+}
+
+void Index::finish_vector_index_restore() {
+    std::unique_lock lock(mutex);
+
+    for(auto& field_vector_index: vector_index) {
+        if(field_vector_index.second->restoring) {
+            field_vector_index.second->finish_restore();
+        }
+    }
+}
+
+void Index::set_lazy_filter_min_ids(size_t min_ids) {
+    std::unique_lock lock(mutex);
+    lazy_filter_min_ids = min_ids;
+}
+
+void Index::defer_vector_index_tuning(bool defer) {
+    std::unique_lock lock(mutex);
+
+    for(auto& field_vector_index: vector_index) {
+        field_vector_index.second->defer_ef_tuning = defer;
+        field_vector_index.second->schedule_ef_tuning(thread_pool);
+    }
+}
+
+bool Index::get_stored_vector(const std::string& field_name, uint32_t seq_id, std::vector<float>& values) const {
+    // same key as `Collection::get_seq_id_key()`
+    const std::string seq_id_key = std::to_string(collection_id) + "_$SI_" + StringUtils::serialize_uint32_t(seq_id);
+
+    std::string json_doc_str;
+    if(store->get(seq_id_key, json_doc_str) != StoreStatus::FOUND) {
+        return false;
+    }
+
+    // a nested field is stored within its parent objects
+    std::vector<std::string> field_path;
+    StringUtils::split(field_name, field_path, ".");
+
+    // only the keys that lead to the field are parsed, since documents can be much larger than their vectors
+    nlohmann::json::parser_callback_t keep_field = [&field_name, &field_path]
+            (int depth, nlohmann::json::parse_event_t event, nlohmann::json& parsed) {
+        if(event != nlohmann::json::parse_event_t::key) {
+            return true;
+        }
+
+        const std::string& key = parsed.get_ref<const std::string&>();
+        return (depth == 1 && key == field_name) ||
+               (depth >= 1 && size_t(depth) <= field_path.size() && key == field_path[depth - 1]);
+    };
 
-    art_leaf* leaf = (art_leaf *) art_search(search_index.at(field_name), key, key_len);
-    if(leaf != nullptr) {
-        posting_t::erase(leaf->values, seq_id);
-        if (posting_t::num_ids(leaf->values) == 0) {
-            void* values = art_delete(search_index.at(field_name), key, key_len);
-            posting_t::destroy_list(values);
+    try {
+        const auto& document = nlohmann::json::parse(json_doc_str, keep_field);
+
+        const nlohmann::json* field_value = nullptr;
+        if(document.contains(field_name)) {
+            field_value = &document[field_name];
+        } else {
+            field_value = &document;
+            for(const auto& key: field_path) {
+                if(!field_value->is_object() || !field_value->contains(key)) {
+                    return false;
+                }
+
+                field_value = &(*field_value)[key];
+            }
+        }
+
+        if(!field_value->is_array()) {
+            return false;
         }
+
+        values = field_value->get<std::vector<float>>();
+    } catch(const std::exception& e) {
+        LOG(ERROR) << "Unable to read vector field " << field_name << " of document " << seq_id << ": " << e.what();
+        return false;
     }
+
+    return true;
 }
 
 void Index::remove_field(uint32_t seq_id, const nlohmann::json& document, const std::string& field_name) {
@@ -5161,8 +6543,20 @@ void Index::remove_field(uint32_t seq_id, const nlohmann::json& document, const
         return;
     }
 
+    filter_result_cache->invalidate(field_name);
+
     // Go through all the field names and find the keys+values so that they can be removed from in-memory index
     if(search_field.type == field_types::STRING_ARRAY || search_field.type == field_types::STRING) {
+        auto cache_it = token_expansion_caches.find(field_name);
+        if(cache_it != token_expansion_caches.end()) {
+            cache_it->second->invalidate();
+        }
+
+        auto offset_index_it = token_offset_index.find(field_name);
+        if(offset_index_it != token_offset_index.end()) {
+            offset_index_it->second->remove(seq_id);
+        }
+
         std::vector<std::string> tokens;
         tokenize_string_field(document, search_field, tokens, search_field.locale, symbols_to_index, token_separators);
 
@@ -5177,6 +6571,11 @@ void Index::remove_field(uint32_t seq_id, const nlohmann::json& document, const
                 if (posting_t::num_ids(leaf->values) == 0) {
                     void* values = art_delete(search_index.at(field_name), key, key_len);
                     posting_t::destroy_list(values);
+
+                    auto typo_index_it = typo_index.find(field_name);
+                    if(typo_index_it != typo_index.end()) {
+                        typo_index_it->second->remove(token);
+                    }
                 }
             }
 
@@ -5193,9 +6592,6 @@ void Index::remove_field(uint32_t seq_id, const nlohmann::json& document, const
         for(int32_t value: values) {
             num_tree_t* num_tree = numerical_index.at(field_name);
             num_tree->remove(value, seq_id);
-            if(search_field.facet) {
-                remove_facet_token(search_field, search_index, std::to_string(value), seq_id);
-            }
         }
     } else if(search_field.is_int64()) {
         const std::vector<int64_t>& values = search_field.is_single_integer() ?
@@ -5204,12 +6600,9 @@ void Index::remove_field(uint32_t seq_id, const nlohmann::json& document, const
         for(int64_t value: values) {
             num_tree_t* num_tree = numerical_index.at(field_name);
             num_tree->remove(value, seq_id);
-            if(search_field.facet) {
-                remove_facet_token(search_field, search_index, std::to_string(value), seq_id);
-            }
         }
     } else if(search_field.num_dim) {
-        vector_index[search_field.name]->vecdex->markDelete(seq_id);
+        vector_index[search_field.name]->remove(seq_id);
     } else if(search_field.is_float()) {
         const std::vector<float>& values = search_field.is_single_float() ?
                                            std::vector<float>{document[field_name].get<float>()} :
@@ -5219,9 +6612,6 @@ void Index::remove_field(uint32_t seq_id, const nlohmann::json& document, const
             num_tree_t* num_tree = numerical_index.at(field_name);
             int64_t fintval = float_to_int64_t(value);
             num_tree->remove(fintval, seq_id);
-            if(search_field.facet) {
-                remove_facet_token(search_field, search_index, StringUtils::float_to_str(value), seq_id);
-            }
         }
     } else if(search_field.is_bool()) {
 
@@ -5232,9 +6622,6 @@ void Index::remove_field(uint32_t seq_id, const nlohmann::json& document, const
             num_tree_t* num_tree = numerical_index.at(field_name);
             int64_t bool_int64 = value ? 1 : 0;
             num_tree->remove(bool_int64, seq_id);
-            if(search_field.facet) {
-                remove_facet_token(search_field, search_index, std::to_string(value), seq_id);
-            }
         }
     } else if(search_field.is_geopoint()) {
         auto geo_index = geopoint_index[field_name];
@@ -5327,6 +6714,7 @@ Option<uint32_t> Index::remove(const uint32_t seq_id, const nlohmann::json & doc
 
     if(!is_update) {
         seq_ids->erase(seq_id);
+        filter_result_cache->invalidate(filter_result_cache_t::ALL_IDS_FIELD);
     }
 
     return Option<uint32_t>(seq_id);
@@ -5340,11 +6728,12 @@ void Index::tokenize_string_field(const nlohmann::json& document, const field& s
     const std::string& field_name = search_field.name;
 
     if(search_field.type == field_types::STRING) {
-        Tokenizer(document[field_name], true, false, locale, symbols_to_index, token_separators).tokenize(tokens);
+        const std::string& value = document[field_name].get<std::string>();
+        Tokenizer::acquire(value, true, false, locale, symbols_to_index, token_separators)->tokenize(tokens);
     } else if(search_field.type == field_types::STRING_ARRAY) {
         const std::vector<std::string>& values = document[field_name].get<std::vector<std::string>>();
         for(const std::string & value: values) {
-            Tokenizer(value, true, false, locale, symbols_to_index, token_separators).tokenize(tokens);
+            Tokenizer::acquire(value, true, false, locale, symbols_to_index, token_separators)->tokenize(tokens);
         }
     }
 }
@@ -5371,6 +6760,64 @@ const spp::sparse_hash_map<std::string, hnsw_index_t*>& Index::_get_vector_index
     return vector_index;
 }
 
+const spp::sparse_hash_map<std::string, typo_index_t*>& Index::_get_typo_index() const {
+    return typo_index;
+}
+
+void Index::get_filter_result_cache_stats(uint64_t& hits, uint64_t& misses, uint64_t& evictions,
+                                          uint64_t& invalidations, size_t& num_bytes) const {
+    std::shared_lock lock(mutex);
+
+    hits += filter_result_cache->hits();
+    misses += filter_result_cache->misses();
+    evictions += filter_result_cache->evictions();
+    invalidations += filter_result_cache->invalidations();
+    num_bytes += filter_result_cache->get_num_bytes();
+}
+
+void Index::get_token_expansion_cache_stats(uint64_t& hits, uint64_t& narrowed_hits, uint64_t& misses) const {
+    std::shared_lock lock(mutex);
+
+    for(const auto& kv: token_expansion_caches) {
+        hits += kv.second->hits();
+        narrowed_hits += kv.second->narrowed_hits();
+        misses += kv.second->misses();
+    }
+}
+
+const spp::sparse_hash_map<std::string, token_offset_index_t*>& Index::_get_token_offset_index() const {
+    return token_offset_index;
+}
+
+bool Index::seek_token_offset(const std::string& field_name, uint32_t seq_id, size_t array_index,
+                              size_t token_index, size_t& checkpoint_token_index, size_t& checkpoint_offset) const {
+    std::shared_lock lock(mutex);
+
+    auto offset_index_it = token_offset_index.find(field_name);
+    if(offset_index_it == token_offset_index.end()) {
+        return false;
+    }
+
+    return offset_index_it->second->seek(seq_id, array_index, token_index, checkpoint_token_index, checkpoint_offset);
+}
+
+nlohmann::json Index::get_typo_index_stats() const {
+    std::shared_lock lock(mutex);
+
+    nlohmann::json stats = nlohmann::json::object();
+
+    for(const auto& kv: typo_index) {
+        nlohmann::json field_stats;
+        field_stats["max_token_len"] = kv.second->get_max_token_len();
+        field_stats["num_tokens"] = kv.second->num_tokens();
+        field_stats["num_variants"] = kv.second->num_variants();
+        field_stats["memory_used_bytes"] = kv.second->memory_used();
+        stats[kv.first] = field_stats;
+    }
+
+    return stats;
+}
+
 void Index::refresh_schemas(const std::vector<field>& new_fields, const std::vector<field>& del_fields) {
     std::unique_lock lock(mutex);
 
@@ -5380,9 +6827,12 @@ void Index::refresh_schemas(const std::vector<field>& new_fields, const std::vec
         }
 
         search_schema.emplace(new_field.name, new_field);
+        filter_result_cache->invalidate(new_field.name);
 
         if(new_field.type == field_types::FLOAT_ARRAY && new_field.num_dim > 0) {
-            auto hnsw_index = new hnsw_index_t(new_field.num_dim, 1024, new_field.vec_dist);
+            auto hnsw_index = new hnsw_index_t(new_field.num_dim, 1024, new_field.vec_dist,
+                                               new_field.vec_quantization, new_field.vec_rerank,
+                                               new_field.hnsw_params);
             vector_index.emplace(new_field.name, hnsw_index);
             continue;
         }
@@ -5401,6 +6851,7 @@ void Index::refresh_schemas(const std::vector<field>& new_fields, const std::vec
                 art_tree *t = new art_tree;
                 art_tree_init(t);
                 search_index.emplace(new_field.name, t);
+                token_expansion_caches.emplace(new_field.name, new token_expansion_cache_t());
             } else if(new_field.is_geopoint()) {
                 auto field_geo_index = new spp::sparse_hash_map<std::string, std::vector<uint32_t>>();
                 geopoint_index.emplace(new_field.name, field_geo_index);
@@ -5421,13 +6872,6 @@ void Index::refresh_schemas(const std::vector<field>& new_fields, const std::vec
             }
 
             facet_index_v3.emplace(new_field.name, facet_array);
-
-            // initialize for non-string facet fields
-            if(!new_field.is_string()) {
-                art_tree *ft = new art_tree;
-                art_tree_init(ft);
-                search_index.emplace(new_field.faceted_name(), ft);
-            }
         }
 
         if(new_field.infix) {
@@ -5438,6 +6882,14 @@ void Index::refresh_schemas(const std::vector<field>& new_fields, const std::vec
 
             infix_index.emplace(new_field.name, infix_sets);
         }
+
+        if(new_field.is_string() && new_field.typo_index_max_len > 0 && typo_index.count(new_field.name) == 0) {
+            typo_index.emplace(new_field.name, new typo_index_t(new_field.typo_index_max_len));
+        }
+
+        if(new_field.is_string() && new_field.store_token_offsets && token_offset_index.count(new_field.name) == 0) {
+            token_offset_index.emplace(new_field.name, new token_offset_index_t());
+        }
     }
 
     for(const auto & del_field: del_fields) {
@@ -5447,6 +6899,7 @@ void Index::refresh_schemas(const std::vector<field>& new_fields, const std::vec
         }
 
         search_schema.erase(del_field.name);
+        filter_result_cache->invalidate(del_field.name);
 
         if(!del_field.index) {
             continue;
@@ -5456,6 +6909,9 @@ void Index::refresh_schemas(const std::vector<field>& new_fields, const std::vec
             art_tree_destroy(search_index[del_field.name]);
             delete search_index[del_field.name];
             search_index.erase(del_field.name);
+
+            delete token_expansion_caches[del_field.name];
+            token_expansion_caches.erase(del_field.name);
         } else if(del_field.is_geopoint()) {
             delete geopoint_index[del_field.name];
             geopoint_index.erase(del_field.name);
@@ -5490,12 +6946,6 @@ void Index::refresh_schemas(const std::vector<field>& new_fields, const std::vec
             }
 
             facet_index_v3.erase(del_field.name);
-
-            if(!del_field.is_string()) {
-                art_tree_destroy(search_index[del_field.faceted_name()]);
-                delete search_index[del_field.faceted_name()];
-                search_index.erase(del_field.faceted_name());
-            }
         }
 
         if(del_field.infix) {
@@ -5507,6 +6957,18 @@ void Index::refresh_schemas(const std::vector<field>& new_fields, const std::vec
             infix_index.erase(del_field.name);
         }
 
+        auto typo_index_it = typo_index.find(del_field.name);
+        if(typo_index_it != typo_index.end()) {
+            delete typo_index_it->second;
+            typo_index.erase(typo_index_it);
+        }
+
+        auto offset_index_it = token_offset_index.find(del_field.name);
+        if(offset_index_it != token_offset_index.end()) {
+            delete offset_index_it->second;
+            token_offset_index.erase(offset_index_it);
+        }
+
         if(del_field.num_dim) {
             auto hnsw_index = vector_index[del_field.name];
             delete hnsw_index;
@@ -8,12 +8,39 @@
 #include <unordered_map>
 #include <queue>
 #include <ctime>
+#include <random>
 #include "collection.h"
 #include "string_utils.h"
 #include "collection_manager.h"
+#include "tokenizer.h"
+#include "search_arena.h"
+#include "vector_scan.h"
+#include "threadpool.h"
+#include "core_api.h"
 
 using namespace std;
 
+// heap allocations made by the process so far, across all threads
+static std::atomic<uint64_t> num_heap_allocations = 0;
+
+void* operator new(size_t size) {
+    num_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    void* ptr = malloc(size == 0 ? 1 : size);
+    if(ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
 std::string get_query(StringUtils & string_utils, std::string & text) {
     std::vector<std::string> tokens;
     std::vector<std::string> normalized_tokens;
@@ -169,6 +196,84 @@ void benchmark_reactjs_pages(char* file_path) {
     std::cout << "Results total: " << results_total << std::endl;
 }
 
+// compares fresh vs pooled tokenizers and then measures indexing throughput, e.g. on an English corpus with
+// locale "" and on a CJK corpus with locale "zh" or "ja": every line must be a JSON object with a `title` field
+void benchmark_tokenizer(char* file_path, const std::string& locale) {
+    std::ifstream infile(file_path);
+    std::vector<std::string> titles;
+    std::vector<std::string> json_lines;
+    std::string json_line;
+    size_t num_bytes = 0;
+
+    while (std::getline(infile, json_line)) {
+        nlohmann::json obj = nlohmann::json::parse(json_line);
+        titles.push_back(obj["title"].get<std::string>());
+        json_lines.push_back(json_line);
+        num_bytes += titles.back().size();
+    }
+
+    infile.close();
+
+    uint64_t num_tokens = 0; // to prevent no-op optimization!
+    std::string token;
+    size_t token_index = 0;
+
+    auto begin = std::chrono::high_resolution_clock::now();
+
+    for(const auto& title: titles) {
+        Tokenizer tokenizer(title, true, false, locale);
+        while(tokenizer.next(token, token_index)) {
+            num_tokens++;
+        }
+    }
+
+    long long int fresh_micros = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - begin).count();
+
+    begin = std::chrono::high_resolution_clock::now();
+
+    for(const auto& title: titles) {
+        auto tokenizer = Tokenizer::acquire(title, true, false, locale);
+        while(tokenizer->next(token, token_index)) {
+            num_tokens++;
+        }
+    }
+
+    long long int pooled_micros = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - begin).count();
+
+    std::cout << "Locale: " << (locale.empty() ? "default" : locale) << ", texts: " << titles.size()
+              << ", bytes: " << num_bytes << ", tokens: " << num_tokens << std::endl;
+    std::cout << "Fresh tokenizers: " << fresh_micros << "us" << std::endl;
+    std::cout << "Pooled tokenizers: " << pooled_micros << "us" << std::endl;
+
+    std::vector<field> fields_to_index = { field("title", field_types::STRING, false, false, true, locale),
+                                           field("points", field_types::INT32, false) };
+
+    Store *store = new Store("/tmp/typesense-data");
+    CollectionManager & collectionManager = CollectionManager::get_instance();
+    std::atomic<bool> quit;
+    collectionManager.init(store, 4, "abcd", quit);
+    collectionManager.load(100, 100);
+
+    const std::string collection_name = "tokenizer_" + (locale.empty() ? std::string("default") : locale);
+    collectionManager.drop_collection(collection_name);
+    Collection *collection = collectionManager.create_collection(collection_name, 4, fields_to_index,
+                                                                 "points").get();
+
+    begin = std::chrono::high_resolution_clock::now();
+
+    for(const auto& line: json_lines) {
+        collection->add(line);
+    }
+
+    long long int index_millis = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::high_resolution_clock::now() - begin).count();
+
+    std::cout << "Indexing time taken: " << index_millis << "ms, throughput: "
+              << (index_millis == 0 ? 0 : (num_bytes / 1024) * 1000 / index_millis) << " KB/s" << std::endl;
+}
+
 void generate_word_freq() {
     std::ifstream infile("/tmp/unigram_freq.jsonl");
     std::ofstream outfile("/tmp/eng_words.jsonl", std::ios_base::app);
@@ -189,12 +294,586 @@ void generate_word_freq() {
     outfile.close();
 }
 
+// runs the same multi-token queries on the `title` field with the per request search arena disabled and enabled,
+// reporting the number of heap allocations per query: every line must be a JSON object with a `title` field
+void benchmark_search_allocations(char* file_path) {
+    std::vector<field> fields_to_index = { field("title", field_types::STRING, false),
+                                           field("points", field_types::INT32, false) };
+
+    Store *store = new Store("/tmp/typesense-data");
+    CollectionManager & collectionManager = CollectionManager::get_instance();
+    std::atomic<bool> quit;
+    collectionManager.init(store, 4, "abcd", quit);
+    collectionManager.load(100, 100);
+
+    Collection *collection = collectionManager.get_collection("search_allocations").get();
+    if(collection == nullptr) {
+        collection = collectionManager.create_collection("search_allocations", 4, fields_to_index, "points").get();
+    }
+
+    std::ifstream infile(file_path);
+
+    std::string json_line;
+    StringUtils string_utils;
+    std::vector<std::string> queries;
+    size_t counter = 0;
+
+    while (std::getline(infile, json_line)) {
+        counter++;
+        nlohmann::json obj = nlohmann::json::parse(json_line);
+        if(!obj.contains("points")) {
+            obj["points"] = int32_t(counter);
+        }
+
+        collection->add(obj.dump());
+
+        if(counter % 100 == 0) {
+            std::string title = obj["title"];
+            queries.push_back(get_query(string_utils, title));
+        }
+    }
+
+    infile.close();
+    std::cout << "FINISHED INDEXING!" << flush << std::endl;
+
+    std::vector<std::string> search_fields = {"title"};
+
+    // warms up the caches that are shared across queries, so that both runs below see the same state
+    for(size_t i = 0; i < queries.size(); i++) {
+        collection->search(queries[i], search_fields, "", { }, {sort_by("points", "DESC")}, {2}, 10, 1,
+                           MAX_SCORE, {true});
+    }
+
+    for(bool arena_enabled: {false, true}) {
+        search_arena_t::enabled = arena_enabled;
+        uint64_t results_total = 0; // to prevent no-op optimization!
+
+        const uint64_t allocations_before = num_heap_allocations.load();
+        auto begin = std::chrono::high_resolution_clock::now();
+
+        for(size_t i = 0; i < queries.size(); i++) {
+            auto results_op = collection->search(queries[i], search_fields, "", { }, {sort_by("points", "DESC")},
+                                                 {2}, 10, 1, MAX_SCORE, {true});
+            if(results_op.ok() != true) {
+                exit(2);
+            }
+            results_total += results_op.get()["hits"].size();
+        }
+
+        long long int timeMillis = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::high_resolution_clock::now() - begin).count();
+        const uint64_t num_allocations = num_heap_allocations.load() - allocations_before;
+
+        std::cout << "Search arena: " << (arena_enabled ? "enabled" : "disabled") << std::endl;
+        std::cout << "Number of queries: " << queries.size() << std::endl;
+        std::cout << "Time taken: " << timeMillis << "ms" << std::endl;
+        std::cout << "Allocations per query: " << (num_allocations / std::max<size_t>(1, queries.size())) << std::endl;
+        std::cout << "Results total: " << results_total << std::endl;
+    }
+
+    search_arena_t::enabled = true;
+}
+
+// compares the per candidate copy-and-compare loop that was used for filtered vector queries against the batched
+// flat scan, for 1k, 10k and 100k filtered candidates of 384 and 768 dimensional cosine vectors
+void benchmark_vector_flat_scan() {
+    const size_t num_vectors = 100000;
+    const size_t k = 10;
+    const size_t num_queries = 20;
+
+    ThreadPool thread_pool(4);
+    std::mt19937 rng(47);
+    std::uniform_real_distribution<float> distrib(-1.0f, 1.0f);
+
+    std::cout << "Flat scan kernel: " << vector_scan_t::kernel_name() << std::endl;
+
+    for(size_t num_dim: {384, 768}) {
+        hnsw_index_t index(num_dim, num_vectors, cosine);
+        std::vector<float> values(num_dim), normalized_values(num_dim);
+
+        for(size_t i = 0; i < num_vectors; i++) {
+            for(auto& value: values) {
+                value = distrib(rng);
+            }
+
+            hnsw_index_t::normalize_vector(values, normalized_values);
+            index.vecdex->insertPoint(normalized_values.data(), i);
+        }
+
+        std::vector<std::vector<float>> queries(num_queries, std::vector<float>(num_dim));
+        for(auto& query: queries) {
+            for(auto& value: query) {
+                value = distrib(rng);
+            }
+        }
+
+        for(size_t num_candidates: {1000, 10000, 100000}) {
+            std::vector<uint32_t> filter_ids;
+            for(size_t i = 0; i < num_vectors; i += num_vectors / num_candidates) {
+                filter_ids.push_back(i);
+            }
+
+            float results_total = 0; // to prevent no-op optimization!
+            auto begin = std::chrono::high_resolution_clock::now();
+
+            for(const auto& query: queries) {
+                std::vector<std::pair<float, size_t>> dist_labels;
+
+                for(auto seq_id: filter_ids) {
+                    std::vector<float> vec_values = index.vecdex->getDataByLabel<float>(seq_id);
+                    std::vector<float> normalized_q(query.size());
+                    hnsw_index_t::normalize_vector(query, normalized_q);
+                    float dist = index.space->get_dist_func()(normalized_q.data(), vec_values.data(), &index.num_dim);
+                    dist_labels.emplace_back(dist, seq_id);
+                }
+
+                std::partial_sort(dist_labels.begin(), dist_labels.begin() + k, dist_labels.end());
+                results_total += dist_labels[0].first;
+            }
+
+            long long int loop_micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::high_resolution_clock::now() - begin).count();
+
+            begin = std::chrono::high_resolution_clock::now();
+
+            for(const auto& query: queries) {
+                std::vector<std::pair<float, size_t>> dist_labels;
+                std::vector<float> normalized_q(query.size());
+                hnsw_index_t::normalize_vector(query, normalized_q);
+                index.flat_search(normalized_q.data(), filter_ids.data(), filter_ids.size(), k,
+                                  &thread_pool, 4, dist_labels);
+                results_total += dist_labels[0].first;
+            }
+
+            long long int scan_micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::high_resolution_clock::now() - begin).count();
+
+            std::cout << "num_dim: " << num_dim << ", candidates: " << filter_ids.size()
+                      << ", per candidate loop: " << (loop_micros / num_queries) << "us/query"
+                      << ", flat scan: " << (scan_micros / num_queries) << "us/query"
+                      << ", results total: " << results_total << std::endl;
+        }
+    }
+
+    thread_pool.shutdown();
+}
+
+void benchmark_vector_quantization() {
+    const size_t num_dim = 384;
+    const size_t num_vectors = 100000;
+    const size_t k = 10;
+    const size_t num_queries = 100;
+
+    std::mt19937 rng(47);
+    std::uniform_real_distribution<float> distrib(-1.0f, 1.0f);
+
+    // clustered data, since recall on uniformly random vectors says little about real embeddings
+    const size_t num_clusters = 100;
+    std::vector<std::vector<float>> centers(num_clusters, std::vector<float>(num_dim));
+    for(auto& center: centers) {
+        for(auto& value: center) {
+            value = distrib(rng);
+        }
+    }
+
+    auto random_vector = [&]() {
+        const auto& center = centers[rng() % num_clusters];
+        std::vector<float> values(num_dim), normalized_values(num_dim);
+        for(size_t d = 0; d < num_dim; d++) {
+            values[d] = center[d] + 0.5f * distrib(rng);
+        }
+
+        hnsw_index_t::normalize_vector(values, normalized_values);
+        return normalized_values;
+    };
+
+    std::vector<std::vector<float>> vectors(num_vectors);
+    for(auto& values: vectors) {
+        values = random_vector();
+    }
+
+    std::vector<std::vector<float>> queries(num_queries);
+    std::vector<std::vector<size_t>> exact_results(num_queries);
+    std::vector<const float*> vector_ptrs;
+    std::vector<uint32_t> labels;
+
+    for(size_t i = 0; i < num_vectors; i++) {
+        vector_ptrs.push_back(vectors[i].data());
+        labels.push_back(i);
+    }
+
+    for(size_t q = 0; q < num_queries; q++) {
+        queries[q] = random_vector();
+
+        std::vector<std::pair<float, size_t>> dist_labels;
+        vector_scan_t::top_k(queries[q].data(), vector_ptrs.data(), labels.data(), num_vectors, num_dim, k,
+                             dist_labels);
+        for(const auto& dist_label: dist_labels) {
+            exact_results[q].push_back(dist_label.second);
+        }
+    }
+
+    auto get_vector = [&](uint32_t seq_id, std::vector<float>& values) {
+        values = vectors[seq_id];
+        return true;
+    };
+
+    VectorFilterFunctor filter_functor(nullptr, 0);
+
+    for(auto quantization: {vector_quantization_t::none, vector_quantization_t::int8, vector_quantization_t::pq}) {
+        hnsw_index_t index(num_dim, num_vectors, cosine, quantization, 100);
+
+        auto begin = std::chrono::high_resolution_clock::now();
+        for(size_t i = 0; i < num_vectors; i++) {
+            index.insert(vectors[i].data(), i);
+        }
+
+        long long int index_millis = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::high_resolution_clock::now() - begin).count();
+
+        for(bool rerank: {false, true}) {
+            if(rerank && quantization == vector_quantization_t::none) {
+                continue;
+            }
+
+            size_t num_found = 0;
+            begin = std::chrono::high_resolution_clock::now();
+
+            for(size_t q = 0; q < num_queries; q++) {
+                std::vector<std::pair<float, size_t>> dist_labels;
+                index.search(queries[q].data(), rerank ? index.get_num_candidates(k) : k, filter_functor,
+                             dist_labels);
+
+                if(rerank) {
+                    index.rerank_candidates(queries[q].data(), k, get_vector, dist_labels);
+                }
+
+                for(const auto& dist_label: dist_labels) {
+                    num_found += std::count(exact_results[q].begin(), exact_results[q].end(), dist_label.second);
+                }
+            }
+
+            long long int search_micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::high_resolution_clock::now() - begin).count();
+
+            std::cout << "quantization: " << magic_enum::enum_name(quantization)
+                      << ", re-rank: " << rerank
+                      << ", vectors memory: " << (index.vectors_memory_used() / (1024 * 1024)) << "MB"
+                      << ", indexing: " << index_millis << "ms"
+                      << ", recall@" << k << ": " << (double(num_found) / (num_queries * k))
+                      << ", search: " << (search_micros / num_queries) << "us/query" << std::endl;
+        }
+    }
+}
+
+void benchmark_vector_hnsw_params() {
+    const size_t num_dim = 128;
+    const size_t num_vectors = 100000;
+    const size_t k = 10;
+    const size_t num_queries = 200;
+
+    std::mt19937 rng(47);
+    std::uniform_real_distribution<float> distrib(-1.0f, 1.0f);
+
+    const size_t num_clusters = 100;
+    std::vector<std::vector<float>> centers(num_clusters, std::vector<float>(num_dim));
+    for(auto& center: centers) {
+        for(auto& value: center) {
+            value = distrib(rng);
+        }
+    }
+
+    auto random_vector = [&]() {
+        const auto& center = centers[rng() % num_clusters];
+        std::vector<float> values(num_dim), normalized_values(num_dim);
+        for(size_t d = 0; d < num_dim; d++) {
+            values[d] = center[d] + 0.5f * distrib(rng);
+        }
+
+        hnsw_index_t::normalize_vector(values, normalized_values);
+        return normalized_values;
+    };
+
+    std::vector<std::vector<float>> vectors(num_vectors);
+    std::vector<const float*> vector_ptrs;
+    std::vector<uint32_t> labels;
+
+    for(size_t i = 0; i < num_vectors; i++) {
+        vectors[i] = random_vector();
+        vector_ptrs.push_back(vectors[i].data());
+        labels.push_back(i);
+    }
+
+    std::vector<std::vector<float>> queries(num_queries);
+    std::vector<std::vector<size_t>> exact_results(num_queries);
+
+    for(size_t q = 0; q < num_queries; q++) {
+        queries[q] = random_vector();
+
+        std::vector<std::pair<float, size_t>> dist_labels;
+        vector_scan_t::top_k(queries[q].data(), vector_ptrs.data(), labels.data(), num_vectors, num_dim, k,
+                             dist_labels);
+        for(const auto& dist_label: dist_labels) {
+            exact_results[q].push_back(dist_label.second);
+        }
+    }
+
+    VectorFilterFunctor filter_functor(nullptr, 0);
+    vector_search_plan_t plan;
+    plan.num_candidates = k;
+
+    for(size_t M: {8, 16, 32}) {
+        hnsw_params_t hnsw_params;
+        hnsw_params.M = M;
+        hnsw_params.target_recall = 0.95;
+
+        hnsw_index_t index(num_dim, num_vectors, cosine, vector_quantization_t::none, 0, hnsw_params);
+
+        auto begin = std::chrono::high_resolution_clock::now();
+        for(size_t i = 0; i < num_vectors; i++) {
+            index.insert(vectors[i].data(), i);
+        }
+
+        long long int index_millis = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::high_resolution_clock::now() - begin).count();
+
+        // recall/QPS curve over `ef`
+        for(size_t ef: {10, 20, 40, 80, 160, 320}) {
+            size_t num_found = 0;
+            begin = std::chrono::high_resolution_clock::now();
+
+            for(size_t q = 0; q < num_queries; q++) {
+                std::vector<std::pair<float, size_t>> dist_labels;
+                index.planned_search(queries[q].data(), plan, k, ef, nullptr, 0, filter_functor, nullptr, 1,
+                                     dist_labels);
+
+                for(const auto& dist_label: dist_labels) {
+                    num_found += std::count(exact_results[q].begin(), exact_results[q].end(), dist_label.second);
+                }
+            }
+
+            long long int search_micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::high_resolution_clock::now() - begin).count();
+
+            std::cout << "M: " << M << ", ef: " << ef
+                      << ", indexing: " << index_millis << "ms"
+                      << ", recall@" << k << ": " << (double(num_found) / (num_queries * k))
+                      << ", QPS: " << (num_queries * 1000000.0 / std::max<long long int>(search_micros, 1))
+                      << std::endl;
+        }
+
+        begin = std::chrono::high_resolution_clock::now();
+
+        std::vector<float> sample;
+        for(size_t i = 0; i < std::min(num_vectors, hnsw_index_t::MAX_TUNING_VECTORS); i++) {
+            sample.insert(sample.end(), vectors[i].begin(), vectors[i].end());
+        }
+
+        size_t tuned_ef = hnsw_index_t::tune_ef(sample, num_dim, hnsw_params);
+        long long int tune_millis = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::high_resolution_clock::now() - begin).count();
+
+        std::cout << "M: " << M << ", auto-tuned ef for recall " << hnsw_params.target_recall << ": " << tuned_ef
+                  << ", tuning: " << tune_millis << "ms" << std::endl;
+    }
+}
+
+// time and heap allocations taken to build the response of a search and of a multi search, for pages of 250 hits
+void benchmark_search_response() {
+    const size_t num_docs = 20000;
+    const size_t num_queries = 200;
+    const size_t per_page = 250;
+
+    Store *store = new Store("/tmp/typesense-data");
+    CollectionManager & collectionManager = CollectionManager::get_instance();
+    std::atomic<bool> quit;
+    collectionManager.init(store, 4, "abcd", quit);
+    collectionManager.load(100, 100);
+
+    std::vector<field> fields_to_index = { field("title", field_types::STRING, false),
+                                           field("description", field_types::STRING, false),
+                                           field("tags", field_types::STRING_ARRAY, false),
+                                           field("points", field_types::INT32, false) };
+
+    Collection *collection = collectionManager.get_collection("search_response").get();
+    if(collection == nullptr) {
+        collection = collectionManager.create_collection("search_response", 4, fields_to_index, "points").get();
+    }
+
+    const std::vector<std::string> words = {"red", "green", "blue", "large", "small", "cotton", "wool", "shirt",
+                                            "jacket", "shoes", "sale", "new", "classic", "summer", "winter"};
+    std::mt19937 rng(47);
+
+    for(size_t i = 0; i < num_docs; i++) {
+        nlohmann::json doc;
+        std::string description;
+        for(size_t j = 0; j < 40; j++) {
+            description += words[rng() % words.size()] + " ";
+        }
+
+        doc["title"] = words[rng() % words.size()] + " " + words[rng() % words.size()];
+        doc["description"] = description;
+        doc["tags"] = {words[rng() % words.size()], words[rng() % words.size()]};
+        doc["points"] = int32_t(i);
+        collection->add(doc.dump());
+    }
+
+    std::cout << "FINISHED INDEXING!" << flush << std::endl;
+
+    auto get_search_params = [&](size_t i) {
+        std::map<std::string, std::string> params;
+        params["collection"] = "search_response";
+        params["q"] = words[i % words.size()];
+        params["query_by"] = "title,description";
+        params["per_page"] = std::to_string(per_page);
+        return params;
+    };
+
+    uint64_t response_bytes = 0; // to prevent no-op optimization!
+    uint64_t allocations_before = num_heap_allocations.load();
+    auto begin = std::chrono::high_resolution_clock::now();
+
+    for(size_t i = 0; i < num_queries; i++) {
+        auto params = get_search_params(i);
+        nlohmann::json embedded_params;
+        std::string results_json_str;
+        CollectionManager::do_search(params, embedded_params, results_json_str, 0);
+        response_bytes += results_json_str.size();
+    }
+
+    long long int timeMillis = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::high_resolution_clock::now() - begin).count();
+
+    std::cout << "Search, per_page: " << per_page << std::endl;
+    std::cout << "Time per query: " << (double(timeMillis) / num_queries) << "ms" << std::endl;
+    std::cout << "Allocations per query: " << ((num_heap_allocations.load() - allocations_before) / num_queries)
+              << std::endl;
+    std::cout << "Response bytes per query: " << (response_bytes / num_queries) << std::endl;
+
+    // multi search of 4 searches, assembled from the serialized results of each search
+    const size_t num_searches = 4;
+    response_bytes = 0;
+    allocations_before = num_heap_allocations.load();
+    begin = std::chrono::high_resolution_clock::now();
+
+    for(size_t i = 0; i < num_queries; i++) {
+        std::shared_ptr<http_req> req = std::make_shared<http_req>();
+        std::shared_ptr<http_res> res = std::make_shared<http_res>(nullptr);
+
+        nlohmann::json body;
+        for(size_t j = 0; j < num_searches; j++) {
+            auto search_params = get_search_params(i + j);
+            body["searches"].push_back(nlohmann::json(search_params));
+            req->embedded_params_vec.emplace_back(nlohmann::json::object());
+        }
+
+        req->body = body.dump();
+        post_multi_search(req, res);
+        response_bytes += res->body.size();
+    }
+
+    timeMillis = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::high_resolution_clock::now() - begin).count();
+
+    std::cout << "Multi search of " << num_searches << " searches, per_page: " << per_page << std::endl;
+    std::cout << "Time per request: " << (double(timeMillis) / num_queries) << "ms" << std::endl;
+    std::cout << "Allocations per request: " << ((num_heap_allocations.load() - allocations_before) / num_queries)
+              << std::endl;
+    std::cout << "Response bytes per request: " << (response_bytes / num_queries) << std::endl;
+}
+
+// searches whose parameters other than the query repeat, with the search plan of the collection resolved afresh for
+// every search and reused across searches
+void benchmark_search_plan() {
+    const size_t num_docs = 20000;
+    const size_t num_queries = 2000;
+
+    Store *store = new Store("/tmp/typesense-data");
+    CollectionManager & collectionManager = CollectionManager::get_instance();
+    std::atomic<bool> quit;
+    collectionManager.init(store, 4, "abcd", quit);
+    collectionManager.load(100, 100);
+
+    std::vector<field> fields_to_index = { field("title", field_types::STRING, false),
+                                           field("description", field_types::STRING, false),
+                                           field("brand", field_types::STRING, true),
+                                           field("tags", field_types::STRING_ARRAY, true),
+                                           field("in_stock", field_types::BOOL, false),
+                                           field("price", field_types::FLOAT, false),
+                                           field("points", field_types::INT32, false) };
+
+    Collection *collection = collectionManager.get_collection("search_plan").get();
+    if(collection == nullptr) {
+        collection = collectionManager.create_collection("search_plan", 4, fields_to_index, "points").get();
+    }
+
+    const std::vector<std::string> words = {"red", "green", "blue", "large", "small", "cotton", "wool", "shirt",
+                                            "jacket", "shoes", "sale", "new", "classic", "summer", "winter"};
+    std::mt19937 rng(45);
+
+    for(size_t i = 0; i < num_docs; i++) {
+        nlohmann::json doc;
+        doc["title"] = words[rng() % words.size()] + " " + words[rng() % words.size()];
+        doc["description"] = words[rng() % words.size()] + " " + words[rng() % words.size()] + " " +
+                             words[rng() % words.size()];
+        doc["brand"] = words[rng() % 5];
+        doc["tags"] = {words[rng() % words.size()], words[rng() % words.size()]};
+        doc["in_stock"] = (rng() % 2 == 0);
+        doc["price"] = float(rng() % 10000) / 100;
+        doc["points"] = int32_t(i);
+        collection->add(doc.dump());
+    }
+
+    std::cout << "FINISHED INDEXING!" << flush << std::endl;
+
+    const std::vector<std::string> search_fields = {"title", "description"};
+    const std::string filter_query = "in_stock: true && price: [10..50] && tags: [red, blue, sale]";
+    const std::vector<std::string> facet_fields = {"brand", "tags"};
+    const std::vector<sort_by> sort_fields = {sort_by("price", "ASC"), sort_by("points", "DESC")};
+
+    for(bool reuse_plans: {false, true}) {
+        uint64_t results_total = 0; // to prevent no-op optimization!
+        uint64_t allocations_before = num_heap_allocations.load();
+        auto begin = std::chrono::high_resolution_clock::now();
+
+        for(size_t i = 0; i < num_queries; i++) {
+            if(!reuse_plans) {
+                collection->clear_search_plans();
+            }
+
+            auto results_op = collection->search(words[i % words.size()], search_fields, filter_query, facet_fields,
+                                                 sort_fields, {2}, 10, 1, FREQUENCY, {true});
+            if(!results_op.ok()) {
+                exit(2);
+            }
+            results_total += results_op.get()["found"].get<size_t>();
+        }
+
+        long long int timeMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::high_resolution_clock::now() - begin).count();
+
+        std::cout << "Search plans: " << (reuse_plans ? "reused" : "resolved per search") << std::endl;
+        std::cout << "Time per query: " << (double(timeMicros) / num_queries) << "us" << std::endl;
+        std::cout << "Allocations per query: " << ((num_heap_allocations.load() - allocations_before) / num_queries)
+                  << std::endl;
+        std::cout << "Results total: " << results_total << std::endl;
+    }
+}
+
 int main(int argc, char* argv[]) {
     srand(time(NULL));
 //    system("rm -rf /tmp/typesense-data && mkdir -p /tmp/typesense-data");
 
 //    benchmark_hn_titles(argv[1]);
 //    benchmark_reactjs_pages(argv[1]);
+//    benchmark_tokenizer(argv[1], "");
+//    benchmark_tokenizer(argv[1], "zh");
+//    benchmark_search_allocations(argv[1]);
+//    benchmark_vector_flat_scan();
+//    benchmark_vector_quantization();
+//    benchmark_vector_hnsw_params();
+//    benchmark_search_response();
+//    benchmark_search_plan();
 
     generate_word_freq();
 
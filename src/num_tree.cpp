@@ -1,3 +1,4 @@
+#include <cmath>
 #include "num_tree.h"
 #include "parasort.h"
 #include "timsort.hpp"
@@ -5,11 +6,15 @@
 void num_tree_t::insert(int64_t value, uint32_t id) {
     if (int64map.count(value) == 0) {
         int64map.emplace(value, SET_COMPACT_IDS(compact_id_list_t::create(1, {id})));
+        num_ids++;
+        num_histogram_updates++;
     } else {
         auto ids = int64map[value];
         if (!ids_t::contains(ids, id)) {
             ids_t::upsert(ids, id);
             int64map[value] = ids;
+            num_ids++;
+            num_histogram_updates++;
         }
     }
 }
@@ -135,6 +140,11 @@ void num_tree_t::search(NUM_COMPARATOR comparator, int64_t value, uint32_t** ids
 void num_tree_t::remove(uint64_t value, uint32_t id) {
     if(int64map.count(value) != 0) {
         void* arr = int64map[value];
+        if(ids_t::contains(arr, id)) {
+            num_ids--;
+            num_histogram_updates++;
+        }
+
         ids_t::erase(arr, id);
 
         if(ids_t::num_ids(arr) == 0) {
@@ -150,6 +160,92 @@ size_t num_tree_t::size() {
     return int64map.size();
 }
 
+size_t num_tree_t::get_num_ids() const {
+    return num_ids;
+}
+
+void num_tree_t::refresh_histogram() {
+    if(!histogram.empty() && num_histogram_updates <= HISTOGRAM_STALE_RATIO * num_ids) {
+        return;
+    }
+
+    histogram.clear();
+    num_histogram_updates = 0;
+
+    if(int64map.empty()) {
+        return;
+    }
+
+    const size_t bucket_num_ids = (num_ids + NUM_HISTOGRAM_BUCKETS - 1) / NUM_HISTOGRAM_BUCKETS;
+
+    for(const auto& kv: int64map) {
+        const size_t value_num_ids = ids_t::num_ids(kv.second);
+
+        // frequent values get a bucket of their own, so that they are not spread over the values around them
+        if(histogram.empty() || histogram.back().num_ids >= bucket_num_ids || value_num_ids >= bucket_num_ids) {
+            histogram.push_back({kv.first, kv.first, 0});
+        }
+
+        histogram.back().max_value = kv.first;
+        histogram.back().num_ids += value_num_ids;
+    }
+}
+
+size_t num_tree_t::estimate_histogram_range(int64_t start, int64_t end) {
+    std::unique_lock<std::mutex> lock(histogram_mutex);
+    refresh_histogram();
+
+    double estimate = 0;
+
+    for(const auto& bucket: histogram) {
+        if(bucket.max_value < start || bucket.min_value > end) {
+            continue;
+        }
+
+        if(start <= bucket.min_value && bucket.max_value <= end) {
+            estimate += bucket.num_ids;
+            continue;
+        }
+
+        // assumes that the ids of a partially overlapping bucket are spread evenly across its values
+        const double overlap = double(std::min(end, bucket.max_value)) - double(std::max(start, bucket.min_value)) + 1;
+        const double width = double(bucket.max_value) - double(bucket.min_value) + 1;
+        estimate += bucket.num_ids * (overlap / width);
+    }
+
+    return std::min<size_t>(num_ids, std::ceil(estimate));
+}
+
+size_t num_tree_t::estimate(NUM_COMPARATOR comparator, int64_t value) {
+    if(comparator == EQUALS || comparator == NOT_EQUALS) {
+        const auto it = int64map.find(value);
+        const size_t num_equal_ids = (it == int64map.end()) ? 0 : ids_t::num_ids(it->second);
+        return (comparator == EQUALS) ? num_equal_ids : num_ids - num_equal_ids;
+    }
+
+    if(comparator == GREATER_THAN) {
+        return (value == INT64_MAX) ? 0 : estimate_histogram_range(value + 1, INT64_MAX);
+    }
+
+    if(comparator == GREATER_THAN_EQUALS) {
+        return estimate_histogram_range(value, INT64_MAX);
+    }
+
+    if(comparator == LESS_THAN) {
+        return (value == INT64_MIN) ? 0 : estimate_histogram_range(INT64_MIN, value - 1);
+    }
+
+    if(comparator == LESS_THAN_EQUALS) {
+        return estimate_histogram_range(INT64_MIN, value);
+    }
+
+    return num_ids;
+}
+
+size_t num_tree_t::estimate_range_inclusive(int64_t start, int64_t end) {
+    return (start > end) ? 0 : estimate_histogram_range(start, end);
+}
+
 num_tree_t::~num_tree_t() {
     for(auto& kv: int64map) {
         ids_t::destroy_list(kv.second);
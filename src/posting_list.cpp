@@ -2,6 +2,7 @@
 #include <bitset>
 #include "for.h"
 #include "array_utils.h"
+#include "filter_result_iterator.h"
 
 /* block_t operations */
 
@@ -763,6 +764,10 @@ bool posting_list_t::take_id(result_iter_state_t& istate, uint32_t id) {
         }
     }
 
+    if(istate.filter_iterator != nullptr) {
+        return istate.filter_iterator->contains(id);
+    }
+
     // decide if this result be matched with filter results
     if(istate.filter_ids_length != 0) {
         return std::binary_search(istate.filter_ids, istate.filter_ids + istate.filter_ids_length, id);
@@ -771,8 +776,8 @@ bool posting_list_t::take_id(result_iter_state_t& istate, uint32_t id) {
     return true;
 }
 
-bool posting_list_t::get_offsets(const std::vector<iterator_t>& its,
-                                 std::map<size_t, std::vector<token_positions_t>>& array_token_pos) {
+template<class M>
+static bool get_offsets_impl(const std::vector<posting_list_t::iterator_t>& its, M& array_token_pos) {
 
     // Plain string format:
     // offset1, offset2, ... , 0 (if token is the last offset for the document)
@@ -787,7 +792,7 @@ bool posting_list_t::get_offsets(const std::vector<iterator_t>& its,
     size_t id_block_index = 0;
 
     for(size_t j = 0; j < its.size(); j++) {
-        block_t* curr_block = its[j].block();
+        posting_list_t::block_t* curr_block = its[j].block();
         uint32_t curr_index = its[j].index();
 
         if(curr_block == nullptr || curr_index == UINT32_MAX) {
@@ -857,6 +862,16 @@ bool posting_list_t::get_offsets(const std::vector<iterator_t>& its,
     return true;
 }
 
+bool posting_list_t::get_offsets(const std::vector<iterator_t>& its,
+                                 std::map<size_t, std::vector<token_positions_t>>& array_token_pos) {
+    return get_offsets_impl(its, array_token_pos);
+}
+
+bool posting_list_t::get_offsets(const std::vector<iterator_t>& its,
+                                 std::pmr::map<size_t, std::pmr::vector<token_positions_t>>& array_token_pos) {
+    return get_offsets_impl(its, array_token_pos);
+}
+
 bool posting_list_t::is_single_token_verbatim_match(const posting_list_t::iterator_t& it, bool field_is_array) {
     block_t* curr_block = it.block();
     uint32_t curr_index = it.index();
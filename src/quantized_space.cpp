@@ -0,0 +1,122 @@
+#include <cstring>
+#include "quantized_space.h"
+
+int8_space_t::int8_space_t(size_t num_dim): num_dim(num_dim) {
+
+}
+
+float int8_space_t::distance(const void* code_a, const void* code_b, const void* param) {
+    const size_t num_dim = *static_cast<const size_t*>(param);
+    return 1.0f - scalar_quantizer_t::inner_product(static_cast<const char*>(code_a),
+                                                    static_cast<const char*>(code_b), num_dim);
+}
+
+size_t int8_space_t::get_data_size() {
+    return scalar_quantizer_t::code_size(num_dim);
+}
+
+hnswlib::DISTFUNC<float> int8_space_t::get_dist_func() {
+    return distance;
+}
+
+void* int8_space_t::get_dist_func_param() {
+    return &num_dim;
+}
+
+void int8_space_t::encode(const float* src, char* code) const {
+    scalar_quantizer_t::encode(src, num_dim, code);
+}
+
+void int8_space_t::encode_query(const float* query, std::vector<char>& query_code,
+                                std::vector<float>& query_buffer) const {
+    // symmetric: the query is quantized just like the stored vectors
+    query_code.resize(scalar_quantizer_t::code_size(num_dim));
+    scalar_quantizer_t::encode(query, num_dim, query_code.data());
+}
+
+bool int8_space_t::trained() const {
+    return true;
+}
+
+void int8_space_t::train(const float* vectors, size_t num_vectors) {
+
+}
+
+size_t int8_space_t::memory_used() const {
+    return 0;
+}
+
+void int8_space_t::serialize(std::ostream& out) const {
+
+}
+
+bool int8_space_t::deserialize(std::istream& in) {
+    return true;
+}
+
+pq_space_t::pq_space_t(size_t num_dim): codebook(num_dim) {
+    data_size = 1 + codebook.get_num_subspaces();
+}
+
+float pq_space_t::distance(const void* code_a, const void* code_b, const void* param) {
+    const pq_codebook_t& codebook = static_cast<const pq_space_t*>(param)->codebook;
+    const uint8_t* bytes_a = static_cast<const uint8_t*>(code_a);
+    const uint8_t* bytes_b = static_cast<const uint8_t*>(code_b);
+
+    // hnswlib always passes the query or the element being inserted as the first argument
+    if(bytes_a[0] == QUERY_MARKER) {
+        const float* table;
+        memcpy(&table, bytes_a + 1, sizeof(table));
+        return 1.0f - codebook.table_inner_product(table, bytes_b + 1);
+    }
+
+    return 1.0f - codebook.code_inner_product(bytes_a + 1, bytes_b + 1);
+}
+
+size_t pq_space_t::get_data_size() {
+    return data_size;
+}
+
+hnswlib::DISTFUNC<float> pq_space_t::get_dist_func() {
+    return distance;
+}
+
+void* pq_space_t::get_dist_func_param() {
+    return this;
+}
+
+void pq_space_t::encode(const float* src, char* code) const {
+    code[0] = STORED_MARKER;
+    codebook.encode(src, reinterpret_cast<uint8_t*>(code + 1));
+}
+
+void pq_space_t::encode_query(const float* query, std::vector<char>& query_code,
+                              std::vector<float>& query_buffer) const {
+    query_buffer.resize(codebook.table_size());
+    codebook.compute_inner_product_table(query, query_buffer.data());
+
+    const float* table = query_buffer.data();
+    query_code.resize(1 + sizeof(table));
+    query_code[0] = QUERY_MARKER;
+    memcpy(query_code.data() + 1, &table, sizeof(table));
+}
+
+bool pq_space_t::trained() const {
+    return codebook.trained();
+}
+
+void pq_space_t::train(const float* vectors, size_t num_vectors) {
+    codebook.train(vectors, num_vectors);
+}
+
+size_t pq_space_t::memory_used() const {
+    return codebook.memory_used();
+}
+
+void pq_space_t::serialize(std::ostream& out) const {
+    codebook.serialize(out);
+}
+
+bool pq_space_t::deserialize(std::istream& in) {
+    return codebook.deserialize(in);
+}
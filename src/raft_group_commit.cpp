@@ -0,0 +1,159 @@
+#include "raft_group_commit.h"
+#include <algorithm>
+#include "logger.h"
+
+static uint64_t now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+RaftGroupCommit::RaftGroupCommit(uint64_t max_delay_us, size_t max_batch_size, size_t max_batch_bytes,
+                                 propose_t propose):
+                                 max_delay_us(max_delay_us), max_batch_size(std::min(max_batch_size, MAX_BATCH_SIZE)),
+                                 max_batch_bytes(max_batch_bytes), propose(std::move(propose)) {
+    if(enabled()) {
+        LOG(INFO) << "Batching raft writes for up to " << max_delay_us << "us, max batch size: " << this->max_batch_size
+                  << ", max batch bytes: " << max_batch_bytes;
+        flush_thread = std::thread(&RaftGroupCommit::run, this);
+    }
+}
+
+RaftGroupCommit::~RaftGroupCommit() {
+    stop();
+}
+
+bool RaftGroupCommit::enabled() const {
+    return max_delay_us != 0 && max_batch_size > 1;
+}
+
+bool RaftGroupCommit::can_batch(const std::shared_ptr<http_req>& req) {
+    return req->first_chunk_aggregate && req->last_chunk_aggregate &&
+           (req->_req == nullptr || req->_req->proceed_req == nullptr);
+}
+
+void RaftGroupCommit::add(const std::shared_ptr<http_req>& req, const std::shared_ptr<http_res>& res) {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    pending.push_back({req, res, now_us()});
+    pending_bytes += req->body.size();
+
+    if(pending.size() >= max_batch_size || pending_bytes >= max_batch_bytes) {
+        std::vector<group_commit_write_t> writes;
+        take_pending(writes);
+
+        // hold `propose_mutex` across the hand over so that batches are proposed in the order they were taken
+        std::unique_lock<std::mutex> propose_lock(propose_mutex);
+        lock.unlock();
+        propose_writes(writes);
+        return;
+    }
+
+    if(pending.size() == 1) {
+        // the flush thread waits on the oldest pending write
+        cv.notify_one();
+    }
+}
+
+void RaftGroupCommit::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while(!quit) {
+        if(pending.empty()) {
+            cv.wait(lock, [&]() { return quit || !pending.empty(); });
+            continue;
+        }
+
+        const uint64_t deadline_us = pending.front().queued_us + max_delay_us;
+        const uint64_t current_us = now_us();
+
+        if(current_us < deadline_us) {
+            cv.wait_for(lock, std::chrono::microseconds(deadline_us - current_us));
+            continue;
+        }
+
+        std::vector<group_commit_write_t> writes;
+        take_pending(writes);
+
+        std::unique_lock<std::mutex> propose_lock(propose_mutex);
+        lock.unlock();
+        propose_writes(writes);
+        propose_lock.unlock();
+        lock.lock();
+    }
+}
+
+void RaftGroupCommit::take_pending(std::vector<group_commit_write_t>& writes) {
+    writes.swap(pending);
+    pending.reserve(writes.size());
+    pending_bytes = 0;
+}
+
+void RaftGroupCommit::propose_writes(std::vector<group_commit_write_t>& writes) {
+    if(writes.empty()) {
+        return;
+    }
+
+    size_t num_bytes = 0;
+    for(const auto& write: writes) {
+        num_bytes += write.req->body.size();
+    }
+
+    batch_size_histogram.record(writes.size());
+    batch_bytes_histogram.record(num_bytes);
+
+    propose(writes);
+}
+
+void RaftGroupCommit::stop() {
+    std::vector<group_commit_write_t> writes;
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if(quit) {
+            return;
+        }
+
+        quit = true;
+        take_pending(writes);
+        cv.notify_one();
+    }
+
+    if(flush_thread.joinable()) {
+        flush_thread.join();
+    }
+
+    std::unique_lock<std::mutex> propose_lock(propose_mutex);
+    propose_writes(writes);
+}
+
+void RaftGroupCommit::on_commit(const std::vector<group_commit_write_t>& writes) {
+    const uint64_t current_us = now_us();
+
+    for(const auto& write: writes) {
+        commit_latency_us_histogram.record(current_us - write.queued_us);
+    }
+}
+
+void RaftGroupCommit::get_stats(nlohmann::json& stats) const {
+    stats["enabled"] = enabled();
+    stats["batch_size"] = batch_size_histogram.to_json();
+    stats["batch_bytes"] = batch_bytes_histogram.to_json();
+    stats["commit_latency_us"] = commit_latency_us_histogram.to_json();
+}
+
+std::string RaftGroupCommit::serialize(const std::vector<group_commit_write_t>& writes) {
+    nlohmann::json content;
+    content[BATCH_KEY] = nlohmann::json::array();
+
+    for(const auto& write: writes) {
+        nlohmann::json req_json;
+        write.req->to_json(req_json);
+        content[BATCH_KEY].push_back(std::move(req_json));
+    }
+
+    return content.dump(-1, ' ', false, nlohmann::detail::error_handler_t::ignore);
+}
+
+bool RaftGroupCommit::is_batch(const nlohmann::json& content) {
+    return content.is_object() && content.count(BATCH_KEY) != 0 && content[BATCH_KEY].is_array();
+}
@@ -7,7 +7,9 @@
 #include <file_utils.h>
 #include <collection_manager.h>
 #include <http_client.h>
+#include "core_api.h"
 #include "rocksdb/utilities/checkpoint.h"
+#include <braft/local_file_meta.pb.h>
 #include "thread_local_vars.h"
 
 namespace braft {
@@ -25,6 +27,11 @@ void ReplicationClosure::Run() {
     std::unique_ptr<ReplicationClosure> self_guard(this);
 }
 
+void GroupCommitClosure::Run() {
+    // like `ReplicationClosure`, responses are sent once the writes are indexed
+    std::unique_ptr<GroupCommitClosure> self_guard(this);
+}
+
 // State machine implementation
 
 int ReplicationState::start(const butil::EndPoint & peering_endpoint, const int api_port,
@@ -83,10 +90,17 @@ int ReplicationState::start(const butil::EndPoint & peering_endpoint, const int
     // automatic snapshot is disabled since it caused issues during slow follower catch-ups
     node_options.snapshot_interval_s = -1;
 
+    if(config->get_snapshot_max_bytes_per_second() != 0) {
+        // limits both the reads of the node sending a snapshot and the writes of the node installing it
+        snapshot_throttle = new braft::ThrottleSnapshotThrottle(config->get_snapshot_max_bytes_per_second(), 10);
+        node_options.snapshot_throttle = &snapshot_throttle;
+    }
+
     node_options.catchup_margin = config->get_healthy_read_lag();
     node_options.election_timeout_ms = election_timeout_ms;
     node_options.fsm = this;
     node_options.node_owns_fsm = false;
+    // files of a remote snapshot whose checksums match local ones are not downloaded (see `SnapshotFileChecksums`)
     node_options.filter_before_copy_remote = true;
     std::string prefix = "local://" + raft_dir;
     node_options.log_uri = prefix + "/" + log_dir_name;
@@ -213,6 +227,12 @@ void ReplicationState::write(const std::shared_ptr<http_req>& request, const std
         return write_to_leader(request, response);
     }
 
+    if(group_commit.enabled() && RaftGroupCommit::can_batch(request)) {
+        pending_writes++;
+        lock.unlock();
+        return group_commit.add(request, response);
+    }
+
     // Serialize request to replicated WAL so that all the nodes in the group receive it as well.
     // NOTE: actual write must be done only on the `on_apply` method to maintain consistency.
 
@@ -241,6 +261,239 @@ void ReplicationState::write(const std::shared_ptr<http_req>& request, const std
     pending_writes++;
 }
 
+void ReplicationState::propose_write_batch(std::vector<group_commit_write_t>& writes) {
+    std::shared_lock lock(node_mutex);
+
+    if(!node || !node->is_leader()) {
+        // leadership moved while the writes were waiting to be batched
+        for(const auto& write: writes) {
+            pending_writes--;
+            write_to_leader(write.req, write.res);
+        }
+
+        return ;
+    }
+
+    butil::IOBufBuilder bufBuilder;
+    braft::Task task;
+
+    if(writes.size() == 1) {
+        // a lone write is replicated just like an unbatched one
+        bufBuilder << writes[0].req->to_json();
+        task.done = new ReplicationClosure(writes[0].req, writes[0].res);
+    } else {
+        bufBuilder << RaftGroupCommit::serialize(writes);
+        task.done = new GroupCommitClosure(std::move(writes));
+    }
+
+    task.data = &bufBuilder.buf();
+    task.expected_term = leader_term.load(butil::memory_order_relaxed);
+
+    node->apply(task);
+}
+
+void ReplicationState::apply_write_batch(nlohmann::json& content, int64_t log_index) {
+    auto& batch = content[RaftGroupCommit::BATCH_KEY];
+
+    for(size_t slot = 0; slot < batch.size(); slot++) {
+        std::shared_ptr<http_req> request_generated = std::make_shared<http_req>();
+        std::shared_ptr<http_res> response_generated = std::make_shared<http_res>(nullptr);
+
+        request_generated->load_from_json(batch[slot]);
+        request_generated->log_index = log_index;
+        request_generated->log_slot = slot;
+
+        batched_indexer->enqueue(request_generated, response_generated);
+    }
+}
+
+void ReplicationState::get_group_commit_stats(nlohmann::json& stats) const {
+    group_commit.get_stats(stats);
+}
+
+void ReplicationState::get_forward_stats(nlohmann::json& stats) const {
+    forward_batcher.get_stats(stats);
+    stats["request_latency_us"] = forward_latency_us.to_json();
+    stats["batch_request_latency_us"] = forward_batch_latency_us.to_json();
+    HttpClient::get_stats(stats["http_client"]);
+}
+
+static uint64_t get_now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool ReplicationState::can_forward_in_batch(const std::shared_ptr<http_req>& request) const {
+    if(request->http_method != "POST" || !RaftGroupCommit::can_batch(request)) {
+        return false;
+    }
+
+    route_path* rpath = nullptr;
+    if(!server->get_route(request->route_hash, &rpath) || rpath->handler != post_add_document) {
+        return false;
+    }
+
+    // the parameters are passed on in the query string of the import
+    for(const char* param: {"action", "dirty_values"}) {
+        auto param_it = request->params.find(param);
+        if(param_it != request->params.end() &&
+           !std::all_of(param_it->second.begin(), param_it->second.end(),
+                        [](char c) { return std::isalnum(c) || c == '_'; })) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void ReplicationState::forward_write_batch(std::vector<group_commit_write_t>& writes) {
+    // Writes to the same collection with the same parameters are sent as one import. This is called with the
+    // batcher's lock held, and possibly from a thread which holds `node_mutex`, so the forwarding is done elsewhere.
+    std::map<std::string, std::vector<group_commit_write_t>> grouped_writes;
+
+    for(auto& write: writes) {
+        const auto& params = write.req->params;
+        auto action_it = params.find("action");
+        auto dirty_values_it = params.find("dirty_values");
+
+        const std::string& key = write.req->path_without_query + "?" +
+                                 (action_it == params.end() ? "" : action_it->second) + "&" +
+                                 (dirty_values_it == params.end() ? "" : dirty_values_it->second);
+
+        grouped_writes[key].push_back(std::move(write));
+    }
+
+    for(auto& kv: grouped_writes) {
+        thread_pool->enqueue([this, group_writes = std::move(kv.second)]() mutable {
+            forward_writes(group_writes);
+        });
+    }
+}
+
+void ReplicationState::forward_writes(std::vector<group_commit_write_t>& writes) {
+    std::string leader_addr;
+
+    {
+        std::shared_lock lock(node_mutex);
+        if(node && !node->leader_id().is_empty()) {
+            leader_addr = node->leader_id().to_string();
+        }
+    }
+
+    const std::string& protocol = api_uses_ssl ? "https" : "http";
+    const auto& first_req = writes.front().req;
+
+    std::string query;
+    for(const char* param: {"action", "dirty_values"}) {
+        auto param_it = first_req->params.find(param);
+        if(param_it != first_req->params.end() && !param_it->second.empty()) {
+            query += std::string(param) + "=" + param_it->second + "&";
+        }
+    }
+
+    // bodies are sent as the lines of the import, so they must not span lines
+    std::string import_body;
+    std::vector<group_commit_write_t> import_writes;
+    std::vector<group_commit_write_t> single_writes;
+
+    for(auto& write: writes) {
+        nlohmann::json doc = nlohmann::json::parse(write.req->body, nullptr, false);
+        if(writes.size() == 1 || doc.is_discarded() || !doc.is_object()) {
+            single_writes.push_back(std::move(write));
+            continue;
+        }
+
+        if(!import_body.empty()) {
+            import_body += "\n";
+        }
+
+        import_body += doc.dump(-1, ' ', false, nlohmann::detail::error_handler_t::ignore);
+        import_writes.push_back(std::move(write));
+    }
+
+    if(leader_addr.empty()) {
+        LOG(ERROR) << "Rejecting write: could not find a leader.";
+    }
+
+    if(import_writes.size() == 1) {
+        single_writes.push_back(std::move(import_writes.front()));
+        import_writes.clear();
+    }
+
+    for(auto& write: single_writes) {
+        if(leader_addr.empty()) {
+            write.res->set_500("Could not find a leader.");
+            continue;
+        }
+
+        const std::string& url = get_node_url_path(leader_addr, write.req->path_without_query + "?" + query, protocol);
+        std::string api_res;
+        std::map<std::string, std::string> res_headers;
+
+        const uint64_t begin_us = get_now_us();
+        long status = HttpClient::post_response(url, write.req->body, api_res, res_headers);
+        forward_latency_us.record(get_now_us() - begin_us);
+
+        write.res->content_type_header = res_headers["content-type"];
+        write.res->set_body(status, api_res);
+    }
+
+    if(!import_writes.empty()) {
+        if(leader_addr.empty()) {
+            for(auto& write: import_writes) {
+                write.res->set_500("Could not find a leader.");
+            }
+        } else {
+            const std::string& url = get_node_url_path(leader_addr, first_req->path_without_query + "/import?" +
+                                                                    query + "return_doc=true", protocol);
+            std::string api_res;
+            std::map<std::string, std::string> res_headers;
+
+            const uint64_t begin_us = get_now_us();
+            long status = HttpClient::post_response(url, import_body, api_res, res_headers);
+            forward_batch_latency_us.record(get_now_us() - begin_us);
+
+            std::vector<std::string> res_lines;
+            if(status == 200) {
+                StringUtils::split(api_res, res_lines, "\n");
+            }
+
+            for(size_t i = 0; i < import_writes.size(); i++) {
+                const auto& res = import_writes[i].res;
+                nlohmann::json line_res;
+
+                if(res_lines.size() == import_writes.size()) {
+                    line_res = nlohmann::json::parse(res_lines[i], nullptr, false);
+                }
+
+                if(line_res.is_object() && line_res.count("success") != 0 && line_res["success"].is_boolean()) {
+                    // the response that the write would have got if it had been forwarded on its own
+                    if(line_res["success"].get<bool>()) {
+                        res->set_201(line_res["document"].dump(-1, ' ', false,
+                                                               nlohmann::detail::error_handler_t::ignore));
+                    } else {
+                        res->set(line_res["code"].get<uint32_t>(), line_res["error"].get<std::string>());
+                    }
+                } else {
+                    // import was rejected as a whole, e.g. when the collection is not found
+                    res->content_type_header = res_headers["content-type"];
+                    res->set_body(status, api_res);
+                }
+            }
+        }
+    }
+
+    for(auto* forwarded: {&single_writes, &import_writes}) {
+        forward_batcher.on_commit(*forwarded);
+
+        for(auto& write: *forwarded) {
+            auto req_res = new async_req_res_t(write.req, write.res, true);
+            message_dispatcher->send_message(HttpServer::STREAM_RESPONSE_MESSAGE, req_res);
+            pending_writes--;
+        }
+    }
+}
+
 void ReplicationState::write_to_leader(const std::shared_ptr<http_req>& request, const std::shared_ptr<http_res>& response) {
     // no lock on `node` needed as caller uses the lock
     if(!node || node->leader_id().is_empty()) {
@@ -267,6 +520,11 @@ void ReplicationState::write_to_leader(const std::shared_ptr<http_req>& request,
         return ;
     }
 
+    if(forward_batcher.enabled() && can_forward_in_batch(request)) {
+        pending_writes++;
+        return forward_batcher.add(request, response);
+    }
+
     const std::string & leader_addr = node->leader_id().to_string();
     //LOG(INFO) << "Redirecting write to leader at: " << leader_addr;
 
@@ -301,7 +559,9 @@ void ReplicationState::write_to_leader(const std::shared_ptr<http_req>& request,
                 }
             } else {
                 std::string api_res;
+                const uint64_t begin_us = get_now_us();
                 long status = HttpClient::post_response(url, request->body, api_res, res_headers);
+                forward_latency_us.record(get_now_us() - begin_us);
                 response->content_type_header = res_headers["content-type"];
                 response->set_body(status, api_res);
             }
@@ -349,6 +609,36 @@ void ReplicationState::on_apply(braft::Iterator& iter) {
     for (; iter.valid(); iter.next()) {
         // Guard invokes replication_arg->done->Run() asynchronously to avoid the callback blocking the main thread
         braft::AsyncClosureGuard closure_guard(iter.done());
+        last_applied_index = iter.index();
+
+        auto group_commit_closure = dynamic_cast<GroupCommitClosure*>(iter.done());
+
+        if(group_commit_closure != nullptr) {
+            // batch proposed by this node: fan out to the original requests, which are waiting for responses
+            const auto& writes = group_commit_closure->get_writes();
+
+            // the slots match those of the serialized batch that followers apply
+            for(size_t slot = 0; slot < writes.size(); slot++) {
+                writes[slot].req->log_index = iter.index();
+                writes[slot].req->log_slot = slot;
+                batched_indexer->enqueue(writes[slot].req, writes[slot].res);
+            }
+
+            group_commit.on_commit(writes);
+            pending_writes -= writes.size();
+            continue;
+        }
+
+        nlohmann::json content;
+
+        if(!iter.done()) {
+            content = nlohmann::json::parse(iter.data().to_string());
+
+            if(RaftGroupCommit::is_batch(content)) {
+                apply_write_batch(content, iter.index());
+                continue;
+            }
+        }
 
         //LOG(INFO) << "Apply entry";
 
@@ -362,10 +652,11 @@ void ReplicationState::on_apply(braft::Iterator& iter) {
 
         if(!iter.done()) {
             // indicates log serialized request
-            request_generated->load_from_json(iter.data().to_string());
+            request_generated->load_from_json(content);
         }
 
         request_generated->log_index = iter.index();
+        request_generated->log_slot = 0;
 
         // To avoid blocking the serial Raft write thread persist the log entry in local storage.
         // Actual operations will be done in collection-sharded batch indexing threads.
@@ -396,6 +687,34 @@ void* ReplicationState::save_snapshot(void* arg) {
 
     for (butil::FilePath file = dir_enum.Next(); !file.empty(); file = dir_enum.Next()) {
         std::string file_name = std::string(db_snapshot_name) + "/" + file.BaseName().value();
+        std::string checksum;
+        int add_status;
+
+        // With a checksum, the file is not copied again to a follower which already has it. This also lets an
+        // interrupted snapshot install resume from the files which were already copied.
+        if(sa->replication_state->snapshot_file_checksums.get(file.value(), checksum)) {
+            braft::LocalFileMeta file_meta;
+            file_meta.set_source(braft::FILE_SOURCE_LOCAL);
+            file_meta.set_checksum(checksum);
+            add_status = sa->writer->add_file(file_name, &file_meta);
+        } else {
+            add_status = sa->writer->add_file(file_name);
+        }
+
+        if (add_status != 0) {
+            sa->done->status().set_error(EIO, "Fail to add file to writer.");
+            return nullptr;
+        }
+    }
+
+    sa->replication_state->snapshot_file_checksums.prune();
+
+    // add the vector index files, so that graphs need not be rebuilt when the snapshot is loaded
+    butil::FileEnumerator vector_dir_enum(butil::FilePath(sa->vector_index_snapshot_path), false,
+                                          butil::FileEnumerator::FILES);
+
+    for (butil::FilePath file = vector_dir_enum.Next(); !file.empty(); file = vector_dir_enum.Next()) {
+        std::string file_name = std::string(vector_index_snapshot_name) + "/" + file.BaseName().value();
         if (sa->writer->add_file(file_name) != 0) {
             sa->done->status().set_error(EIO, "Fail to add file to writer.");
             return nullptr;
@@ -445,6 +764,10 @@ void ReplicationState::on_snapshot_save(braft::SnapshotWriter* writer, braft::Cl
     LOG(INFO) << "on_snapshot_save";
 
     std::string db_snapshot_path = writer->get_path() + "/" + db_snapshot_name;
+    std::string vector_index_snapshot_path = writer->get_path() + "/" + vector_index_snapshot_name;
+
+    // serial to on_apply, so this is the last log index included in the snapshot
+    const int64_t applied_index = last_applied_index;
 
     {
         // grab batch indexer lock so that we can take a clean snapshot
@@ -453,7 +776,9 @@ void ReplicationState::on_snapshot_save(braft::SnapshotWriter* writer, braft::Cl
 
         nlohmann::json batch_index_state;
         batched_indexer->serialize_state(batch_index_state);
-        store->insert(CollectionManager::BATCHED_INDEXER_STATE_KEY, batch_index_state.dump());
+        // request bodies pending indexing are part of the state and are not guaranteed to be valid UTF-8
+        store->insert(CollectionManager::BATCHED_INDEXER_STATE_KEY,
+                      batch_index_state.dump(-1, ' ', false, nlohmann::detail::error_handler_t::ignore));
 
         // we will delete all the skip indices in meta store and flush that DB
         // this will block writes, but should be pretty fast
@@ -467,6 +792,17 @@ void ReplicationState::on_snapshot_save(braft::SnapshotWriter* writer, braft::Cl
             LOG(ERROR) << "Failure during checkpoint creation, msg:" << status.ToString();
             done->status().set_error(EIO, "Checkpoint creation failure.");
         }
+
+        // graphs must be saved under the same pause as the checkpoint for them to hold the same documents: this
+        // stalls writes for as long as the graphs take to be written out
+        if(butil::CreateDirectory(butil::FilePath(vector_index_snapshot_path), true)) {
+            auto save_op = CollectionManager::get_instance().save_vector_indices(vector_index_snapshot_path,
+                                                                                 applied_index);
+            if(!save_op.ok()) {
+                // not fatal: graphs are rebuilt from the documents when they are missing
+                LOG(ERROR) << "Failure while saving vector indices, msg: " << save_op.error();
+            }
+        }
     }
 
     SnapshotArg* arg = new SnapshotArg;
@@ -474,6 +810,7 @@ void ReplicationState::on_snapshot_save(braft::SnapshotWriter* writer, braft::Cl
     arg->writer = writer;
     arg->state_dir_path = raft_dir_path;
     arg->db_snapshot_path = db_snapshot_path;
+    arg->vector_index_snapshot_path = vector_index_snapshot_path;
     arg->done = done;
 
     if(!ext_snapshot_path.empty()) {
@@ -523,6 +860,13 @@ int ReplicationState::on_snapshot_load(braft::SnapshotReader* reader) {
         return reload_store;
     }
 
+    braft::SnapshotMeta snapshot_meta;
+    reader->load_meta(&snapshot_meta);
+    last_applied_index = snapshot_meta.last_included_index();
+    CollectionManager::get_instance().set_vector_index_snapshot(
+        reader->get_path() + "/" + vector_index_snapshot_name, snapshot_meta.last_included_index()
+    );
+
     bool init_db_status = init_db();
 
     return init_db_status;
@@ -694,6 +1038,12 @@ ReplicationState::ReplicationState(HttpServer* server, BatchedIndexer* batched_i
         num_documents_parallel_load(num_documents_parallel_load),
         read_caught_up(false), write_caught_up(false),
         ready(false), shutting_down(false), pending_writes(0),
+        group_commit(config->get_raft_write_batch_delay_us(), config->get_raft_write_batch_max_size(),
+                     config->get_raft_write_batch_max_bytes(),
+                     [this](std::vector<group_commit_write_t>& writes) { propose_write_batch(writes); }),
+        forward_batcher(config->get_raft_forward_batch_delay_us(), config->get_raft_write_batch_max_size(),
+                        config->get_raft_write_batch_max_bytes(),
+                        [this](std::vector<group_commit_write_t>& writes) { forward_write_batch(writes); }),
         last_snapshot_ts(std::time(nullptr)), snapshot_interval_s(config->get_snapshot_interval_seconds()) {
 
 }
@@ -781,6 +1131,10 @@ void ReplicationState::shutdown() {
     LOG(INFO) << "Set shutting_down = true";
     shutting_down = true;
 
+    // writes still waiting to be batched are proposed right away
+    group_commit.stop();
+    forward_batcher.stop();
+
     // wait for pending writes to drop to zero
     LOG(INFO) << "Waiting for in-flight writes to finish...";
     while(pending_writes.load() != 0) {
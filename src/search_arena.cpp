@@ -0,0 +1,46 @@
+#include <memory>
+#include "search_arena.h"
+
+thread_local search_arena_t* search_arena_t::current = nullptr;
+
+std::atomic<bool> search_arena_t::enabled = true;
+
+static char* thread_buffer() {
+    // reused by every request served by the thread, so the common case does not touch the heap at all
+    thread_local std::unique_ptr<char[]> buffer(new char[search_arena_t::INITIAL_BUFFER_SIZE]);
+    return buffer.get();
+}
+
+search_arena_t::search_arena_t() {
+    if(current != nullptr || !enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    monotonic_resource.emplace(thread_buffer(), INITIAL_BUFFER_SIZE);
+    pool_resource.emplace(&monotonic_resource.value());
+    current = this;
+}
+
+search_arena_t::~search_arena_t() {
+    if(current != this) {
+        return;
+    }
+
+    current = nullptr;
+
+    // pool must give back its chunks before the buffers underneath are released
+    pool_resource.reset();
+    monotonic_resource.reset();
+}
+
+bool search_arena_t::active() const {
+    return current == this;
+}
+
+std::pmr::memory_resource* search_arena_t::resource() {
+    if(current == nullptr) {
+        return std::pmr::get_default_resource();
+    }
+
+    return &current->pool_resource.value();
+}
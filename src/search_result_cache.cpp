@@ -0,0 +1,193 @@
+#include "search_result_cache.h"
+
+SearchResultCache::SearchResultCache(size_t max_bytes, generation_fn_t get_generation):
+                                     max_bytes(max_bytes), get_generation(std::move(get_generation)) {
+
+}
+
+SearchResultCache::shard_t& SearchResultCache::get_shard(uint64_t hash) {
+    return shards[hash % NUM_SHARDS];
+}
+
+size_t SearchResultCache::get_num_bytes(const entry_t& entry) {
+    size_t num_bytes = sizeof(entry_t) + entry.res.body.size() + entry.res.content_type_header.size();
+    for(const auto& generation: entry.generations) {
+        num_bytes += sizeof(generation) + generation.first.size();
+    }
+
+    return num_bytes;
+}
+
+SearchResultCache::generations_t SearchResultCache::get_generations(
+                                                const std::vector<std::string>& collection_names) const {
+    generations_t generations;
+    for(const auto& collection_name: collection_names) {
+        generations.emplace_back(collection_name, get_generation(collection_name));
+    }
+
+    return generations;
+}
+
+void SearchResultCache::erase_entry(shard_t& shard, std::list<entry_t>::iterator entry_it) {
+    shard.num_bytes -= entry_it->num_bytes;
+    shard.entry_map.erase(entry_it->hash);
+    shard.entries.erase(entry_it);
+}
+
+void SearchResultCache::record(const generations_t& generations, uint64_t collection_stats_t::* counter) {
+    // stats are kept only for existing collections, so that unknown and dropped ones don't accumulate
+    std::vector<const std::string*> collection_names;
+    for(const auto& generation: generations) {
+        if(generation.second != 0 && get_generation(generation.first) != 0) {
+            collection_names.push_back(&generation.first);
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(stats_mutex);
+    for(const auto collection_name: collection_names) {
+        collection_stats[*collection_name].*counter += 1;
+    }
+}
+
+void SearchResultCache::remove_collection_stats(const std::string& collection_name) {
+    std::unique_lock<std::mutex> lock(stats_mutex);
+    collection_stats.erase(collection_name);
+}
+
+bool SearchResultCache::lookup(uint64_t hash, cached_res_t& res) {
+    shard_t& shard = get_shard(hash);
+    std::unique_lock<std::mutex> lock(shard.mutex);
+
+    auto entry_map_it = shard.entry_map.find(hash);
+    if(entry_map_it == shard.entry_map.end()) {
+        num_misses++;
+        return false;
+    }
+
+    auto entry_it = entry_map_it->second;
+
+    uint64_t seconds_elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::high_resolution_clock::now() - entry_it->res.created_at).count();
+
+    if(seconds_elapsed >= entry_it->res.ttl) {
+        generations_t generations = std::move(entry_it->generations);
+        erase_entry(shard, entry_it);
+        lock.unlock();
+        num_misses++;
+        record(generations, &collection_stats_t::expirations);
+        return false;
+    }
+
+    for(const auto& generation: entry_it->generations) {
+        if(get_generation(generation.first) != generation.second) {
+            generations_t generations = std::move(entry_it->generations);
+            erase_entry(shard, entry_it);
+            lock.unlock();
+            num_misses++;
+            record(generations, &collection_stats_t::invalidations);
+            return false;
+        }
+    }
+
+    // most recently used
+    shard.entries.splice(shard.entries.begin(), shard.entries, entry_it);
+    res = entry_it->res;
+    generations_t generations = entry_it->generations;
+    lock.unlock();
+
+    num_hits++;
+    record(generations, &collection_stats_t::hits);
+    return true;
+}
+
+void SearchResultCache::record_miss(const generations_t& generations) {
+    record(generations, &collection_stats_t::misses);
+}
+
+void SearchResultCache::insert(uint64_t hash, const cached_res_t& res, const generations_t& generations) {
+    entry_t entry{hash, res, generations, 0};
+    entry.num_bytes = get_num_bytes(entry);
+
+    const size_t max_shard_bytes = max_bytes / NUM_SHARDS;
+    if(entry.num_bytes > max_shard_bytes) {
+        return;
+    }
+
+    shard_t& shard = get_shard(hash);
+    std::vector<generations_t> evicted_generations;
+
+    {
+        std::unique_lock<std::mutex> lock(shard.mutex);
+
+        auto entry_map_it = shard.entry_map.find(hash);
+        if(entry_map_it != shard.entry_map.end()) {
+            erase_entry(shard, entry_map_it->second);
+        }
+
+        while(!shard.entries.empty() && shard.num_bytes + entry.num_bytes > max_shard_bytes) {
+            auto lru_it = std::prev(shard.entries.end());
+            evicted_generations.push_back(std::move(lru_it->generations));
+            erase_entry(shard, lru_it);
+        }
+
+        shard.num_bytes += entry.num_bytes;
+        shard.entries.push_front(std::move(entry));
+        shard.entry_map[hash] = shard.entries.begin();
+    }
+
+    for(const auto& generations_evicted: evicted_generations) {
+        record(generations_evicted, &collection_stats_t::evictions);
+    }
+}
+
+void SearchResultCache::set_max_bytes(size_t max_bytes) {
+    this->max_bytes = max_bytes;
+}
+
+void SearchResultCache::clear() {
+    for(auto& shard: shards) {
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        shard.entries.clear();
+        shard.entry_map.clear();
+        shard.num_bytes = 0;
+    }
+}
+
+size_t SearchResultCache::size() {
+    size_t num_entries = 0;
+    for(auto& shard: shards) {
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        num_entries += shard.entries.size();
+    }
+
+    return num_entries;
+}
+
+size_t SearchResultCache::get_num_bytes() {
+    size_t num_bytes = 0;
+    for(auto& shard: shards) {
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        num_bytes += shard.num_bytes;
+    }
+
+    return num_bytes;
+}
+
+void SearchResultCache::get_stats(nlohmann::json& stats) {
+    stats["num_entries"] = size();
+    stats["num_bytes"] = get_num_bytes();
+    stats["max_bytes"] = max_bytes.load();
+    stats["hits"] = num_hits.load();
+    stats["misses"] = num_misses.load();
+    stats["collections"] = nlohmann::json::object();
+
+    std::unique_lock<std::mutex> lock(stats_mutex);
+    for(const auto& kv: collection_stats) {
+        nlohmann::json& coll_stats = stats["collections"][kv.first];
+        coll_stats["hits"] = kv.second.hits;
+        coll_stats["misses"] = kv.second.misses;
+        coll_stats["evictions"] = kv.second.evictions;
+        coll_stats["invalidations"] = kv.second.invalidations;
+        coll_stats["expirations"] = kv.second.expirations;
+    }
+}
@@ -0,0 +1,114 @@
+#include "snapshot_file_checksums.h"
+#include <fstream>
+#include <vector>
+#include <memory>
+#include <sys/stat.h>
+#include <openssl/evp.h>
+#include "logger.h"
+
+bool SnapshotFileChecksums::is_immutable(const std::string& file_path) {
+    const std::string suffix = ".sst";
+    return file_path.size() > suffix.size() &&
+           file_path.compare(file_path.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool SnapshotFileChecksums::compute(const std::string& file_path, std::string& checksum) {
+    std::ifstream infile(file_path, std::ios::binary);
+    if(!infile.is_open()) {
+        return false;
+    }
+
+    std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> md_ctx(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+    if(md_ctx == nullptr || EVP_DigestInit_ex(md_ctx.get(), EVP_sha256(), nullptr) != 1) {
+        return false;
+    }
+
+    std::vector<char> buffer(READ_BUFFER_SIZE);
+    size_t file_size = 0;
+
+    while(infile) {
+        infile.read(buffer.data(), buffer.size());
+        const size_t num_read = infile.gcount();
+        if(EVP_DigestUpdate(md_ctx.get(), buffer.data(), num_read) != 1) {
+            return false;
+        }
+
+        file_size += num_read;
+    }
+
+    if(infile.bad()) {
+        return false;
+    }
+
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digest_len = 0;
+    if(EVP_DigestFinal_ex(md_ctx.get(), digest, &digest_len) != 1) {
+        return false;
+    }
+
+    checksum.clear();
+    for(unsigned int i = 0; i < digest_len; i++) {
+        char byte_hex[3];
+        snprintf(byte_hex, sizeof(byte_hex), "%02x", digest[i]);
+        checksum += byte_hex;
+    }
+
+    checksum += "-" + std::to_string(file_size);
+
+    return true;
+}
+
+bool SnapshotFileChecksums::get(const std::string& file_path, std::string& checksum) {
+    if(!is_immutable(file_path)) {
+        return false;
+    }
+
+    struct stat info;
+    if(stat(file_path.c_str(), &info) != 0) {
+        return false;
+    }
+
+    const size_t name_pos = file_path.rfind('/');
+    const std::string& file_name = (name_pos == std::string::npos) ? file_path : file_path.substr(name_pos + 1);
+    const std::string& key = file_name + ":" + std::to_string(info.st_size) + ":" + std::to_string(info.st_ino);
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        used_keys.insert(key);
+
+        auto checksum_it = checksums.find(key);
+        if(checksum_it != checksums.end()) {
+            checksum = checksum_it->second;
+            return true;
+        }
+    }
+
+    if(!compute(file_path, checksum)) {
+        LOG(ERROR) << "Could not compute the checksum of " << file_path;
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    checksums.emplace(key, checksum);
+
+    return true;
+}
+
+void SnapshotFileChecksums::prune() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for(auto it = checksums.begin(); it != checksums.end();) {
+        if(used_keys.count(it->first) == 0) {
+            it = checksums.erase(it);
+        } else {
+            it++;
+        }
+    }
+
+    used_keys.clear();
+}
+
+size_t SnapshotFileChecksums::size() {
+    std::unique_lock<std::mutex> lock(mutex);
+    return checksums.size();
+}
@@ -0,0 +1,184 @@
+#include <cstring>
+#include "token_expansion_cache.h"
+#include "posting.h"
+
+token_expansion_cache_t::token_expansion_cache_t(size_t capacity): cache(capacity) {
+
+}
+
+std::string token_expansion_cache_t::get_key(const std::string& token, int cost, bool prefix,
+                                             token_ordering token_order, size_t max_words) {
+    std::string key;
+    key.reserve(token.size() + 16);
+    key += token;
+    key += '\0';
+    key += std::to_string(cost);
+    key += prefix ? 'p' : 'f';
+    key += std::to_string(int(token_order));
+    key += '_';
+    key += std::to_string(max_words);
+    return key;
+}
+
+uint64_t token_expansion_cache_t::get_generation() const {
+    return generation.load();
+}
+
+void token_expansion_cache_t::invalidate() {
+    generation++;
+}
+
+std::shared_ptr<const token_expansion_t> token_expansion_cache_t::find(const std::string& key,
+                                                                       uint64_t current_generation) {
+    auto hit_it = cache.find(key);
+    if(hit_it == cache.end()) {
+        return nullptr;
+    }
+
+    const auto& expansion = hit_it.value();
+    if(expansion->generation != current_generation) {
+        return nullptr;
+    }
+
+    return expansion;
+}
+
+void token_expansion_cache_t::insert(const std::string& key, const std::shared_ptr<const token_expansion_t>& expansion) {
+    // replaces any stale expansion stored against the same key
+    cache.erase(key);
+    cache.insert(key, expansion);
+}
+
+std::shared_ptr<const token_expansion_t> token_expansion_cache_t::narrow_parent(const std::string& token,
+                                                                                token_ordering token_order,
+                                                                                size_t max_words,
+                                                                                uint64_t current_generation) {
+    // a zero cost prefix expansion of `token` is made of the leaves of a shorter prefix's expansion that
+    // also begin with `token`, provided that the parent expansion was not truncated
+    for(size_t parent_len = token.size() - 1; parent_len > 0; parent_len--) {
+        const std::string& parent_key = get_key(token.substr(0, parent_len), 0, true, token_order, max_words);
+        auto parent = find(parent_key, current_generation);
+        if(parent == nullptr) {
+            continue;
+        }
+
+        size_t parent_size = parent->leaves.size() + (parent->exact_leaf != nullptr);
+        if(parent_size >= max_words) {
+            return nullptr;
+        }
+
+        auto expansion = std::make_shared<token_expansion_t>();
+        expansion->generation = current_generation;
+
+        for(auto leaf: parent->leaves) {
+            if(size_t(leaf->key_len - 1) < token.size() || memcmp(leaf->key, token.c_str(), token.size()) != 0) {
+                continue;
+            }
+
+            if(size_t(leaf->key_len - 1) == token.size()) {
+                expansion->exact_leaf = leaf;
+                continue;
+            }
+
+            expansion->leaves.push_back(leaf);
+        }
+
+        insert(get_key(token, 0, true, token_order, max_words), expansion);
+        return expansion;
+    }
+
+    return nullptr;
+}
+
+std::shared_ptr<const token_expansion_t> token_expansion_cache_t::get(const std::string& token, int cost,
+                                                                      bool prefix, token_ordering token_order,
+                                                                      size_t max_words) {
+    const uint64_t current_generation = generation.load();
+
+    std::unique_lock lock(mutex);
+
+    auto expansion = find(get_key(token, cost, prefix, token_order, max_words), current_generation);
+    if(expansion != nullptr) {
+        num_hits++;
+        return expansion;
+    }
+
+    if(prefix && cost == 0 && token.size() > 1) {
+        expansion = narrow_parent(token, token_order, max_words, current_generation);
+        if(expansion != nullptr) {
+            num_narrowed_hits++;
+            return expansion;
+        }
+    }
+
+    num_misses++;
+    return nullptr;
+}
+
+std::shared_ptr<const token_expansion_t> token_expansion_cache_t::put(const std::string& token, int cost,
+                                                                      bool prefix, token_ordering token_order,
+                                                                      size_t max_words,
+                                                                      uint64_t computed_generation,
+                                                                      art_leaf* exact_leaf,
+                                                                      std::vector<art_leaf*>&& leaves) {
+    auto expansion = std::make_shared<token_expansion_t>();
+    expansion->generation = computed_generation;
+    expansion->exact_leaf = exact_leaf;
+    expansion->leaves = std::move(leaves);
+
+    const size_t expansion_size = expansion->leaves.size() + (exact_leaf != nullptr);
+
+    // truncated expansions cannot be filtered or narrowed later, so they are not retained
+    if(expansion_size < max_words && expansion_size <= MAX_CACHED_LEAVES &&
+       computed_generation == generation.load()) {
+        std::unique_lock lock(mutex);
+        insert(get_key(token, cost, prefix, token_order, max_words), expansion);
+    }
+
+    return expansion;
+}
+
+void token_expansion_cache_t::apply(const token_expansion_t& expansion, size_t max_words,
+                                    const uint32_t* filter_ids, size_t filter_ids_length,
+                                    const std::set<std::string>& exclude_leaves, std::vector<art_leaf*>& results) {
+    // mirrors `art_fuzzy_search`, which places the exact leaf upfront without checking the filter or exclusions
+    if(expansion.exact_leaf != nullptr) {
+        results.push_back(expansion.exact_leaf);
+    }
+
+    for(auto leaf: expansion.leaves) {
+        if(results.size() >= max_words) {
+            break;
+        }
+
+        if(filter_ids_length != 0 && !posting_t::contains_atleast_one(leaf->values, filter_ids, filter_ids_length)) {
+            continue;
+        }
+
+        if(!exclude_leaves.empty()) {
+            std::string tok(reinterpret_cast<char*>(leaf->key), leaf->key_len - 1);
+            if(exclude_leaves.count(tok) != 0) {
+                continue;
+            }
+        }
+
+        results.push_back(leaf);
+    }
+}
+
+uint64_t token_expansion_cache_t::hits() const {
+    return num_hits.load();
+}
+
+uint64_t token_expansion_cache_t::narrowed_hits() const {
+    return num_narrowed_hits.load();
+}
+
+uint64_t token_expansion_cache_t::misses() const {
+    return num_misses.load();
+}
+
+size_t token_expansion_cache_t::size() {
+    std::unique_lock lock(mutex);
+    return cache.size();
+}
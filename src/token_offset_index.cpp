@@ -0,0 +1,69 @@
+#include <algorithm>
+#include "token_offset_index.h"
+
+void token_offset_index_t::insert(uint32_t seq_id, const std::vector<std::vector<uint32_t>>& value_checkpoints) {
+    remove(seq_id);
+
+    size_t value_num_checkpoints = 0;
+    for(const auto& offsets: value_checkpoints) {
+        value_num_checkpoints += offsets.size();
+    }
+
+    if(value_num_checkpoints == 0) {
+        return;
+    }
+
+    checkpoints.emplace(seq_id, value_checkpoints);
+    num_checkpoints += value_num_checkpoints;
+}
+
+void token_offset_index_t::remove(uint32_t seq_id) {
+    auto checkpoints_it = checkpoints.find(seq_id);
+    if(checkpoints_it == checkpoints.end()) {
+        return;
+    }
+
+    for(const auto& offsets: checkpoints_it->second) {
+        num_checkpoints -= offsets.size();
+    }
+
+    checkpoints.erase(checkpoints_it);
+}
+
+bool token_offset_index_t::seek(uint32_t seq_id, size_t array_index, size_t token_index,
+                                size_t& checkpoint_token_index, size_t& checkpoint_offset) const {
+    if(token_index < CHECKPOINT_INTERVAL) {
+        return false;
+    }
+
+    auto checkpoints_it = checkpoints.find(seq_id);
+    if(checkpoints_it == checkpoints.end() || array_index >= checkpoints_it->second.size()) {
+        return false;
+    }
+
+    const auto& offsets = checkpoints_it->second[array_index];
+    if(offsets.empty()) {
+        return false;
+    }
+
+    // offsets[i] is the offset of the token at position (i + 1) * CHECKPOINT_INTERVAL
+    size_t checkpoint_index = std::min(token_index / CHECKPOINT_INTERVAL, offsets.size()) - 1;
+
+    checkpoint_token_index = (checkpoint_index + 1) * CHECKPOINT_INTERVAL;
+    checkpoint_offset = offsets[checkpoint_index];
+    return true;
+}
+
+size_t token_offset_index_t::num_docs() const {
+    return checkpoints.size();
+}
+
+size_t token_offset_index_t::memory_used() const {
+    size_t value_bytes = 0;
+    for(const auto& kv: checkpoints) {
+        value_bytes += sizeof(uint32_t) + sizeof(std::vector<std::vector<uint32_t>>) +
+                       kv.second.size() * sizeof(std::vector<uint32_t>);
+    }
+
+    return value_bytes + num_checkpoints * sizeof(uint32_t);
+}
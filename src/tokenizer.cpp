@@ -1,7 +1,56 @@
 #include <sstream>
 #include <algorithm>
+#include <cstring>
+#include <unordered_map>
 #include "tokenizer.h"
 
+namespace {
+    // pool key => idle tokenizers of the current thread
+    thread_local std::unordered_map<std::string, std::vector<std::unique_ptr<Tokenizer>>> tokenizer_pool;
+
+    std::string get_pool_key(bool normalize, bool no_op, const std::string& locale,
+                             const std::vector<char>& symbols_to_index, const std::vector<char>& separators) {
+        std::string key;
+        key.reserve(locale.size() + symbols_to_index.size() + separators.size() + 4);
+        key += normalize ? '1' : '0';
+        key += no_op ? '1' : '0';
+        key += locale;
+        key += '\0';
+        key.append(symbols_to_index.begin(), symbols_to_index.end());
+        key += '\0';
+        key.append(separators.begin(), separators.end());
+        return key;
+    }
+}
+
+void tokenizer_releaser_t::operator()(Tokenizer* tokenizer) const {
+    auto& idle_tokenizers = tokenizer_pool[pool_key];
+    if(idle_tokenizers.size() < Tokenizer::MAX_POOLED_PER_CONFIG) {
+        idle_tokenizers.emplace_back(tokenizer);
+    } else {
+        delete tokenizer;
+    }
+}
+
+pooled_tokenizer_t Tokenizer::acquire(const std::string& input, bool normalize, bool no_op,
+                                      const std::string& locale,
+                                      const std::vector<char>& symbols_to_index,
+                                      const std::vector<char>& separators) {
+
+    std::string pool_key = get_pool_key(normalize, no_op, locale, symbols_to_index, separators);
+    auto pool_it = tokenizer_pool.find(pool_key);
+
+    if(pool_it != tokenizer_pool.end() && !pool_it->second.empty()) {
+        Tokenizer* tokenizer = pool_it->second.back().release();
+        pool_it->second.pop_back();
+        tokenizer->reset(input);
+        return pooled_tokenizer_t(tokenizer, tokenizer_releaser_t{std::move(pool_key)});
+    }
+
+    auto tokenizer = new Tokenizer(input, normalize, no_op, locale, symbols_to_index, separators);
+    return pooled_tokenizer_t(tokenizer, tokenizer_releaser_t{std::move(pool_key)});
+}
+
 Tokenizer::Tokenizer(const std::string& input, bool normalize, bool no_op, const std::string& locale,
                      const std::vector<char>& symbols_to_index,
                      const std::vector<char>& separators):
@@ -15,6 +64,10 @@ Tokenizer::Tokenizer(const std::string& input, bool normalize, bool no_op, const
         separator_symbols[uint8_t(c)] = 1;
     }
 
+    for(size_t c = 0; c < 128; c++) {
+        ascii_stream_modes[c] = get_stream_mode(char(c));
+    }
+
     UErrorCode errcode = U_ZERO_ERROR;
 
     if(locale == "ko") {
@@ -25,11 +78,40 @@ Tokenizer::Tokenizer(const std::string& input, bool normalize, bool no_op, const
         nfkc = icu::Normalizer2::getNFKCInstance(errcode);
     }
 
-    cd = iconv_open("ASCII//TRANSLIT", "UTF-8");
+    init(input);
+}
 
+void Tokenizer::reset(const std::string& input) {
+    i = 0;
+    token_counter = 0;
+    out.clear();
     init(input);
 }
 
+void Tokenizer::seek(size_t offset, size_t token_index) {
+    i = std::min(offset, text.size());
+    token_counter = token_index;
+    out.clear();
+}
+
+bool Tokenizer::is_ascii(const char* text, size_t len) {
+    // inspect 8 bytes at a time: OR-ing them preserves any high bit
+    uint64_t acc = 0;
+    size_t index = 0;
+
+    for(; index + 8 <= len; index += 8) {
+        uint64_t word;
+        memcpy(&word, text + index, sizeof(word));
+        acc |= word;
+    }
+
+    for(; index < len; index++) {
+        acc |= uint8_t(text[index]);
+    }
+
+    return (acc & 0x8080808080808080ULL) == 0;
+}
+
 
 void Tokenizer::init(const std::string& input) {
     // init() can be called multiple times safely without leaking memory as we check for prior initialization
@@ -74,6 +156,8 @@ void Tokenizer::init(const std::string& input) {
         text = input;
     }
 
+    ascii_text = is_ascii(text.data(), text.size());
+
     if(!locale.empty() && locale != "en") {
         UErrorCode status = U_ZERO_ERROR;
         const icu::Locale& icu_locale = icu::Locale(locale.c_str());
@@ -206,6 +290,10 @@ bool Tokenizer::next(std::string &token, size_t& token_index, size_t& start_inde
         return true;
     }
 
+    if(ascii_text) {
+        return next_ascii(token, token_index, start_index, end_index);
+    }
+
     while(i < text.size()) {
         if(is_ascii_char(text[i])) {
             size_t this_stream_mode = get_stream_mode(text[i]);
@@ -266,6 +354,10 @@ bool Tokenizer::next(std::string &token, size_t& token_index, size_t& start_inde
 
         //printf("[%s]\n", inbuf);
 
+        if(cd == (iconv_t)(-1)) {
+            cd = iconv_open("ASCII//TRANSLIT", "UTF-8");
+        }
+
         errno = 0;
         iconv(cd, &inptr, &insize, &outptr, &outsize);  // this can be handled by ICU via "Latin-ASCII"
 
@@ -304,6 +396,52 @@ bool Tokenizer::next(std::string &token, size_t& token_index, size_t& start_inde
     return true;
 }
 
+bool Tokenizer::next_ascii(std::string& token, size_t& token_index, size_t& start_index, size_t& end_index) {
+    // same as the generic loop below, but without the unicode handling and with table driven stream modes
+    while(i < text.size()) {
+        const char c = text[i];
+        const uint8_t this_stream_mode = ascii_stream_modes[uint8_t(c)];
+
+        if(this_stream_mode == SKIP) {
+            i++;
+            continue;
+        }
+
+        if(this_stream_mode == SEPARATE) {
+            if(out.empty()) {
+                i++;
+                continue;
+            }
+
+            token = out;
+            out.clear();
+
+            token_index = token_counter++;
+            end_index = i - 1;
+            i++;
+            return true;
+        }
+
+        if(out.empty()) {
+            start_index = i;
+        }
+
+        out += normalize ? char(std::tolower(c)) : c;
+        i++;
+    }
+
+    token = out;
+    out.clear();
+    end_index = i - 1;
+
+    if(token.empty()) {
+        return false;
+    }
+
+    token_index = token_counter++;
+    return true;
+}
+
 void Tokenizer::tokenize(std::vector<std::string> &tokens) {
     std::string token;
     size_t token_index;
@@ -315,7 +453,7 @@ void Tokenizer::tokenize(std::vector<std::string> &tokens) {
 
 bool Tokenizer::tokenize(std::string& token) {
     size_t token_index = 0;
-    init(token);
+    reset(token);
     return next(token, token_index);
 }
 
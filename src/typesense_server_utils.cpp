@@ -87,6 +87,8 @@ void init_cmdline_options(cmdline::parser & options, int argc, char **argv) {
     options.add<float>("max-memory-ratio", '\0', "Maximum fraction of system memory to be used.", false, 1.0f);
     options.add<int>("snapshot-interval-seconds", '\0', "Frequency of replication log snapshots.", false, 3600);
     options.add<int>("snapshot-max-byte-count-per-rpc", '\0', "Maximum snapshot file size in bytes transferred for each RPC.", false, 4194304);
+    options.add<uint32_t>("snapshot-max-bytes-per-second", '\0', "Maximum rate in bytes per second at which a snapshot is sent to or received from another node. Default: 0 (unlimited).", false, 0);
+    options.add<size_t>("search-cache-max-bytes", '\0', "Maximum size in bytes of the cached search results. Default: 67108864 (64 MB).", false, 64 * 1024 * 1024);
     options.add<size_t>("healthy-read-lag", '\0', "Reads are rejected if the updates lag behind this threshold.", false, 1000);
     options.add<size_t>("healthy-write-lag", '\0', "Writes are rejected if the updates lag behind this threshold.", false, 500);
     options.add<int>("log-slow-requests-time-ms", '\0', "When >= 0, requests that take longer than this duration are logged.", false, -1);
@@ -107,6 +109,11 @@ void init_cmdline_options(cmdline::parser & options, int argc, char **argv) {
 
     options.add<int>("log-slow-searches-time-ms", '\0', "When >= 0, searches that take longer than this duration are logged.", false, 30*1000);
 
+    options.add<uint32_t>("raft-write-batch-delay-us", '\0', "When > 0, concurrent writes arriving within this window are replicated as a single log entry. Enable only once all nodes support it. Default: 0 (disabled).", false, 0);
+    options.add<uint32_t>("raft-write-batch-max-size", '\0', "Maximum number of writes replicated as a single log entry.", false, 64);
+    options.add<uint32_t>("raft-write-batch-max-bytes", '\0', "Maximum size in bytes of the writes replicated as a single log entry.", false, 1024 * 1024);
+    options.add<uint32_t>("raft-forward-batch-delay-us", '\0', "When > 0, a follower coalesces single document writes arriving within this window into one import request to the leader. Default: 0 (disabled).", false, 0);
+
     // DEPRECATED
     options.add<std::string>("listen-address", 'h', "[DEPRECATED: use `api-address`] Address to which Typesense API service binds.", false, "0.0.0.0");
     options.add<uint32_t>("listen-port", 'p', "[DEPRECATED: use `api-port`] Port on which Typesense API service listens.", false, 8108);
@@ -447,7 +454,9 @@ int run_server(const Config & config, const std::string & version, void (*master
     CollectionManager & collectionManager = CollectionManager::get_instance();
     collectionManager.init(&store, &app_thread_pool, config.get_max_memory_ratio(),
                            config.get_api_key(), quit_raft_service, batch_indexer);
-    
+
+    set_search_cache_max_bytes(config.get_search_cache_max_bytes());
+
     RateLimitManager *rateLimitManager = RateLimitManager::getInstance();
     auto rate_limit_manager_init = rateLimitManager->init(&store);
 
@@ -0,0 +1,216 @@
+#include <algorithm>
+#include "typo_index.h"
+#include "posting.h"
+#include "string_utils.h"
+
+typo_index_t::typo_index_t(size_t max_token_len): max_token_len(std::min(max_token_len, MAX_TOKEN_LEN)) {
+
+}
+
+size_t typo_index_t::get_max_token_len() const {
+    return max_token_len;
+}
+
+bool typo_index_t::indexable(const std::string& token) const {
+    return !token.empty() && token.size() <= max_token_len + MAX_COST;
+}
+
+bool typo_index_t::searchable(const std::string& token) const {
+    return !token.empty() && token.size() <= max_token_len;
+}
+
+void typo_index_t::compute_deletes(const std::string& token, size_t max_deletes, std::set<std::string>& deletes) {
+    deletes.insert(token);
+
+    std::vector<std::string> frontier = {token};
+
+    for(size_t num_deletes = 0; num_deletes < max_deletes; num_deletes++) {
+        std::vector<std::string> next_frontier;
+
+        for(const auto& variant: frontier) {
+            if(variant.size() <= 1) {
+                continue;
+            }
+
+            for(size_t i = 0; i < variant.size(); i++) {
+                std::string deleted = variant.substr(0, i) + variant.substr(i + 1);
+                if(deletes.insert(deleted).second) {
+                    next_frontier.push_back(std::move(deleted));
+                }
+            }
+        }
+
+        frontier = std::move(next_frontier);
+    }
+}
+
+void typo_index_t::insert(const std::string& token) {
+    if(!indexable(token) || token_ids.count(token) != 0) {
+        return;
+    }
+
+    uint32_t token_id;
+    if(free_token_ids.empty()) {
+        token_id = tokens.size();
+        tokens.push_back(token);
+    } else {
+        token_id = free_token_ids.back();
+        free_token_ids.pop_back();
+        tokens[token_id] = token;
+    }
+
+    token_ids.emplace(token, token_id);
+
+    std::set<std::string> deletes;
+    compute_deletes(token, MAX_COST, deletes);
+
+    for(const auto& variant: deletes) {
+        uint64_t variant_hash = StringUtils::hash_wy(variant.c_str(), variant.size());
+        variants[variant_hash].push_back(token_id);
+        num_variant_refs++;
+    }
+}
+
+void typo_index_t::remove(const std::string& token) {
+    auto token_id_it = token_ids.find(token);
+    if(token_id_it == token_ids.end()) {
+        return;
+    }
+
+    const uint32_t token_id = token_id_it->second;
+    token_ids.erase(token_id_it);
+    tokens[token_id].clear();
+    free_token_ids.push_back(token_id);
+
+    std::set<std::string> deletes;
+    compute_deletes(token, MAX_COST, deletes);
+
+    for(const auto& variant: deletes) {
+        uint64_t variant_hash = StringUtils::hash_wy(variant.c_str(), variant.size());
+        auto variant_it = variants.find(variant_hash);
+        if(variant_it == variants.end()) {
+            continue;
+        }
+
+        auto& variant_token_ids = variant_it->second;
+        auto variant_token_id_it = std::find(variant_token_ids.begin(), variant_token_ids.end(), token_id);
+        if(variant_token_id_it != variant_token_ids.end()) {
+            variant_token_ids.erase(variant_token_id_it);
+            num_variant_refs--;
+        }
+
+        if(variant_token_ids.empty()) {
+            variants.erase(variant_it);
+        }
+    }
+
+    if(token_ids.empty()) {
+        tokens.clear();
+        free_token_ids.clear();
+    }
+}
+
+void typo_index_t::search(art_tree* t, const std::string& term, int cost, size_t max_words,
+                          token_ordering token_order, const uint32_t* filter_ids, size_t filter_ids_length,
+                          std::vector<art_leaf*>& results, const std::set<std::string>& exclude_leaves) const {
+
+    if(cost <= 0 || cost > int(MAX_COST) || !searchable(term)) {
+        return;
+    }
+
+    std::set<std::string> deletes;
+    compute_deletes(term, cost, deletes);
+
+    spp::sparse_hash_set<uint32_t> seen_tokens;
+
+    for(const auto& variant: deletes) {
+        uint64_t variant_hash = StringUtils::hash_wy(variant.c_str(), variant.size());
+        auto variant_it = variants.find(variant_hash);
+        if(variant_it == variants.end()) {
+            continue;
+        }
+
+        for(uint32_t token_id: variant_it->second) {
+            if(!seen_tokens.insert(token_id).second) {
+                continue;
+            }
+
+            const std::string& token = tokens[token_id];
+
+            // deletion neighbourhoods only produce candidates: distance must match ART's fuzzy search semantics
+            if(exclude_leaves.count(token) != 0 || osa_distance(term, token) != cost) {
+                continue;
+            }
+
+            art_leaf* leaf = static_cast<art_leaf*>(art_search(t, (const unsigned char*) token.c_str(),
+                                                               token.size() + 1));
+            if(leaf == nullptr) {
+                continue;
+            }
+
+            if(filter_ids_length != 0 && !posting_t::contains_atleast_one(leaf->values, filter_ids,
+                                                                          filter_ids_length)) {
+                continue;
+            }
+
+            results.push_back(leaf);
+        }
+    }
+
+    if(token_order == FREQUENCY) {
+        std::sort(results.begin(), results.end(), compare_art_leaf_frequency);
+    } else {
+        std::sort(results.begin(), results.end(), compare_art_leaf_score);
+    }
+
+    if(results.size() > max_words) {
+        results.resize(max_words);
+    }
+}
+
+int typo_index_t::osa_distance(const std::string& a, const std::string& b) {
+    const size_t a_len = a.size();
+    const size_t b_len = b.size();
+
+    std::vector<std::vector<int>> d(a_len + 1, std::vector<int>(b_len + 1, 0));
+
+    for(size_t i = 0; i <= a_len; i++) {
+        d[i][0] = i;
+    }
+
+    for(size_t j = 0; j <= b_len; j++) {
+        d[0][j] = j;
+    }
+
+    for(size_t i = 1; i <= a_len; i++) {
+        for(size_t j = 1; j <= b_len; j++) {
+            int cost = (a[i-1] == b[j-1]) ? 0 : 1;
+            d[i][j] = std::min({d[i-1][j] + 1, d[i][j-1] + 1, d[i-1][j-1] + cost});
+
+            if(i > 1 && j > 1 && a[i-1] == b[j-2] && a[i-2] == b[j-1]) {
+                d[i][j] = std::min(d[i][j], d[i-2][j-2] + 1);
+            }
+        }
+    }
+
+    return d[a_len][b_len];
+}
+
+size_t typo_index_t::num_tokens() const {
+    return token_ids.size();
+}
+
+size_t typo_index_t::num_variants() const {
+    return variants.size();
+}
+
+size_t typo_index_t::memory_used() const {
+    // every token is held both as the key of its id and by its id
+    size_t token_bytes = 0;
+    for(const auto& kv: token_ids) {
+        token_bytes += sizeof(uint32_t) + 2 * (sizeof(std::string) + kv.first.capacity());
+    }
+
+    return token_bytes + variants.size() * (sizeof(uint64_t) + sizeof(std::vector<uint32_t>)) +
+           num_variant_refs * sizeof(uint32_t);
+}
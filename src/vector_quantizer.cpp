@@ -0,0 +1,219 @@
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include "vector_quantizer.h"
+#include "vector_scan.h"
+
+size_t scalar_quantizer_t::code_size(size_t num_dim) {
+    return sizeof(float) + num_dim;
+}
+
+void scalar_quantizer_t::encode(const float* src, size_t num_dim, char* code) {
+    float max_abs = 0;
+    for(size_t i = 0; i < num_dim; i++) {
+        max_abs = std::max(max_abs, std::abs(src[i]));
+    }
+
+    const float scale = max_abs / 127.0f;
+    memcpy(code, &scale, sizeof(float));
+
+    int8_t* values = reinterpret_cast<int8_t*>(code + sizeof(float));
+    for(size_t i = 0; i < num_dim; i++) {
+        const float value = (scale == 0) ? 0 : std::round(src[i] / scale);
+        values[i] = int8_t(std::max(-127.0f, std::min(127.0f, value)));
+    }
+}
+
+float scalar_quantizer_t::inner_product(const char* code_a, const char* code_b, size_t num_dim) {
+    float scale_a, scale_b;
+    memcpy(&scale_a, code_a, sizeof(float));
+    memcpy(&scale_b, code_b, sizeof(float));
+
+    const int32_t product = vector_scan_t::int8_inner_product(
+        reinterpret_cast<const int8_t*>(code_a + sizeof(float)),
+        reinterpret_cast<const int8_t*>(code_b + sizeof(float)), num_dim
+    );
+
+    return scale_a * scale_b * float(product);
+}
+
+pq_codebook_t::pq_codebook_t(size_t num_dim): num_dim(num_dim) {
+    // 8 dimensions per subspace gives 32x compression of float32 vectors
+    sub_dim = 8;
+    while(num_dim % sub_dim != 0) {
+        sub_dim /= 2;
+    }
+
+    num_subspaces = num_dim / sub_dim;
+}
+
+const float* pq_codebook_t::centroid(size_t subspace, size_t centroid_id) const {
+    return centroids.data() + (subspace * MAX_CENTROIDS + centroid_id) * sub_dim;
+}
+
+size_t pq_codebook_t::nearest_centroid(size_t subspace, const float* sub_vector) const {
+    size_t nearest = 0;
+    float nearest_dist = std::numeric_limits<float>::max();
+
+    for(size_t c = 0; c < num_centroids; c++) {
+        const float* cvec = centroid(subspace, c);
+        float dist = 0;
+        for(size_t d = 0; d < sub_dim; d++) {
+            const float diff = sub_vector[d] - cvec[d];
+            dist += diff * diff;
+        }
+
+        if(dist < nearest_dist) {
+            nearest_dist = dist;
+            nearest = c;
+        }
+    }
+
+    return nearest;
+}
+
+bool pq_codebook_t::trained() const {
+    return num_centroids != 0;
+}
+
+void pq_codebook_t::train(const float* vectors, size_t num_vectors, size_t num_iterations) {
+    if(num_vectors == 0) {
+        return;
+    }
+
+    num_centroids = std::min(MAX_CENTROIDS, num_vectors);
+    centroids.assign(num_subspaces * MAX_CENTROIDS * sub_dim, 0);
+
+    // fixed seed, so that every replica trains the same codebook from the same vectors
+    std::mt19937 rng(42);
+    std::vector<size_t> vector_ids(num_vectors);
+    std::iota(vector_ids.begin(), vector_ids.end(), 0);
+
+    std::vector<uint32_t> assignments(num_vectors);
+    std::vector<float> sums(num_centroids * sub_dim);
+    std::vector<size_t> counts(num_centroids);
+
+    for(size_t m = 0; m < num_subspaces; m++) {
+        // initialize with distinct random vectors
+        std::shuffle(vector_ids.begin(), vector_ids.end(), rng);
+        for(size_t c = 0; c < num_centroids; c++) {
+            const float* sub_vector = vectors + vector_ids[c] * num_dim + m * sub_dim;
+            std::copy(sub_vector, sub_vector + sub_dim, centroids.begin() + (m * MAX_CENTROIDS + c) * sub_dim);
+        }
+
+        for(size_t iteration = 0; iteration < num_iterations; iteration++) {
+            for(size_t i = 0; i < num_vectors; i++) {
+                assignments[i] = nearest_centroid(m, vectors + i * num_dim + m * sub_dim);
+            }
+
+            std::fill(sums.begin(), sums.end(), 0);
+            std::fill(counts.begin(), counts.end(), 0);
+
+            for(size_t i = 0; i < num_vectors; i++) {
+                const float* sub_vector = vectors + i * num_dim + m * sub_dim;
+                float* sum = sums.data() + assignments[i] * sub_dim;
+                for(size_t d = 0; d < sub_dim; d++) {
+                    sum[d] += sub_vector[d];
+                }
+
+                counts[assignments[i]]++;
+            }
+
+            for(size_t c = 0; c < num_centroids; c++) {
+                if(counts[c] == 0) {
+                    // empty cluster retains its previous centroid
+                    continue;
+                }
+
+                float* cvec = centroids.data() + (m * MAX_CENTROIDS + c) * sub_dim;
+                for(size_t d = 0; d < sub_dim; d++) {
+                    cvec[d] = sums[c * sub_dim + d] / counts[c];
+                }
+            }
+        }
+    }
+}
+
+size_t pq_codebook_t::get_num_subspaces() const {
+    return num_subspaces;
+}
+
+void pq_codebook_t::encode(const float* src, uint8_t* codes) const {
+    for(size_t m = 0; m < num_subspaces; m++) {
+        codes[m] = uint8_t(nearest_centroid(m, src + m * sub_dim));
+    }
+}
+
+size_t pq_codebook_t::table_size() const {
+    return num_subspaces * MAX_CENTROIDS;
+}
+
+void pq_codebook_t::compute_inner_product_table(const float* query, float* table) const {
+    for(size_t m = 0; m < num_subspaces; m++) {
+        const float* sub_query = query + m * sub_dim;
+        for(size_t c = 0; c < num_centroids; c++) {
+            const float* cvec = centroid(m, c);
+            float product = 0;
+            for(size_t d = 0; d < sub_dim; d++) {
+                product += sub_query[d] * cvec[d];
+            }
+
+            table[m * MAX_CENTROIDS + c] = product;
+        }
+    }
+}
+
+float pq_codebook_t::table_inner_product(const float* table, const uint8_t* codes) const {
+    float product = 0;
+    for(size_t m = 0; m < num_subspaces; m++) {
+        product += table[m * MAX_CENTROIDS + codes[m]];
+    }
+
+    return product;
+}
+
+float pq_codebook_t::code_inner_product(const uint8_t* codes_a, const uint8_t* codes_b) const {
+    float product = 0;
+    for(size_t m = 0; m < num_subspaces; m++) {
+        const float* cvec_a = centroid(m, codes_a[m]);
+        const float* cvec_b = centroid(m, codes_b[m]);
+        for(size_t d = 0; d < sub_dim; d++) {
+            product += cvec_a[d] * cvec_b[d];
+        }
+    }
+
+    return product;
+}
+
+size_t pq_codebook_t::memory_used() const {
+    return centroids.size() * sizeof(float);
+}
+
+void pq_codebook_t::serialize(std::ostream& out) const {
+    const uint64_t header[4] = {num_dim, sub_dim, num_subspaces, num_centroids};
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(centroids.data()), centroids.size() * sizeof(float));
+}
+
+bool pq_codebook_t::deserialize(std::istream& in) {
+    uint64_t header[4];
+    if(!in.read(reinterpret_cast<char*>(header), sizeof(header)) || header[0] != num_dim ||
+       header[1] != sub_dim || header[2] != num_subspaces || header[3] > MAX_CENTROIDS) {
+        return false;
+    }
+
+    std::vector<float> read_centroids(num_subspaces * MAX_CENTROIDS * sub_dim);
+    if(header[3] != 0 && !in.read(reinterpret_cast<char*>(read_centroids.data()),
+                                  read_centroids.size() * sizeof(float))) {
+        return false;
+    }
+
+    num_centroids = header[3];
+    centroids = (num_centroids == 0) ? std::vector<float>() : std::move(read_centroids);
+    return true;
+}
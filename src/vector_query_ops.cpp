@@ -145,6 +145,23 @@ Option<bool> VectorQueryOps::parse_vector_query_str(std::string vector_query_str
 
                     vector_query.flat_search_cutoff = std::stoi(param_kv[1]);
                 }
+
+                if(param_kv[0] == "ef") {
+                    if(!StringUtils::is_uint32_t(param_kv[1])) {
+                        return Option<bool>(400, "Malformed vector query string: `ef` parameter must be an integer.");
+                    }
+
+                    vector_query.ef = std::stoul(param_kv[1]);
+                }
+
+                if(param_kv[0] == "measure_recall") {
+                    if(param_kv[1] != "true" && param_kv[1] != "false") {
+                        return Option<bool>(400, "Malformed vector query string: "
+                                                 "`measure_recall` parameter must be a boolean.");
+                    }
+
+                    vector_query.measure_recall = (param_kv[1] == "true");
+                }
             }
 
             if(!vector_query.query_doc_given && vector_query.values.empty()) {
@@ -0,0 +1,317 @@
+#include <queue>
+#include <algorithm>
+#include "vector_scan.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define VECTOR_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+typedef void (*inner_products_fn)(const float* query, const float* const* vectors, size_t num_vectors,
+                                  size_t num_dim, float* out);
+
+static float inner_product_scalar(const float* a, const float* b, size_t num_dim) {
+    float sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+    size_t d = 0;
+
+    for(; d + 4 <= num_dim; d += 4) {
+        sum0 += a[d] * b[d];
+        sum1 += a[d + 1] * b[d + 1];
+        sum2 += a[d + 2] * b[d + 2];
+        sum3 += a[d + 3] * b[d + 3];
+    }
+
+    for(; d < num_dim; d++) {
+        sum0 += a[d] * b[d];
+    }
+
+    return (sum0 + sum1) + (sum2 + sum3);
+}
+
+static int32_t int8_inner_product_scalar(const int8_t* a, const int8_t* b, size_t num_dim) {
+    int32_t sum = 0;
+    for(size_t d = 0; d < num_dim; d++) {
+        sum += int32_t(a[d]) * int32_t(b[d]);
+    }
+
+    return sum;
+}
+
+static void inner_products_scalar(const float* query, const float* const* vectors, size_t num_vectors,
+                                  size_t num_dim, float* out) {
+    for(size_t i = 0; i < num_vectors; i++) {
+        out[i] = inner_product_scalar(query, vectors[i], num_dim);
+    }
+}
+
+#ifdef VECTOR_SCAN_X86
+
+__attribute__((target("avx2,fma")))
+static inline float hsum_avx2(__m256 v) {
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 0x55));
+    return _mm_cvtss_f32(sum);
+}
+
+__attribute__((target("avx2,fma")))
+static float inner_product_avx2(const float* a, const float* b, size_t num_dim) {
+    __m256 acc = _mm256_setzero_ps();
+    size_t d = 0;
+
+    for(; d + 8 <= num_dim; d += 8) {
+        acc = _mm256_fmadd_ps(_mm256_loadu_ps(a + d), _mm256_loadu_ps(b + d), acc);
+    }
+
+    float sum = hsum_avx2(acc);
+    for(; d < num_dim; d++) {
+        sum += a[d] * b[d];
+    }
+
+    return sum;
+}
+
+__attribute__((target("avx2,fma")))
+static void inner_products_avx2(const float* query, const float* const* vectors, size_t num_vectors,
+                                size_t num_dim, float* out) {
+    size_t i = 0;
+
+    // every query lane is loaded once for the whole batch
+    for(; i + vector_scan_t::BATCH_SIZE <= num_vectors; i += vector_scan_t::BATCH_SIZE) {
+        const float* v0 = vectors[i];
+        const float* v1 = vectors[i + 1];
+        const float* v2 = vectors[i + 2];
+        const float* v3 = vectors[i + 3];
+
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+        __m256 acc2 = _mm256_setzero_ps();
+        __m256 acc3 = _mm256_setzero_ps();
+
+        size_t d = 0;
+        for(; d + 8 <= num_dim; d += 8) {
+            const __m256 q = _mm256_loadu_ps(query + d);
+            acc0 = _mm256_fmadd_ps(q, _mm256_loadu_ps(v0 + d), acc0);
+            acc1 = _mm256_fmadd_ps(q, _mm256_loadu_ps(v1 + d), acc1);
+            acc2 = _mm256_fmadd_ps(q, _mm256_loadu_ps(v2 + d), acc2);
+            acc3 = _mm256_fmadd_ps(q, _mm256_loadu_ps(v3 + d), acc3);
+        }
+
+        float sum0 = hsum_avx2(acc0), sum1 = hsum_avx2(acc1), sum2 = hsum_avx2(acc2), sum3 = hsum_avx2(acc3);
+
+        for(; d < num_dim; d++) {
+            sum0 += query[d] * v0[d];
+            sum1 += query[d] * v1[d];
+            sum2 += query[d] * v2[d];
+            sum3 += query[d] * v3[d];
+        }
+
+        out[i] = sum0;
+        out[i + 1] = sum1;
+        out[i + 2] = sum2;
+        out[i + 3] = sum3;
+    }
+
+    for(; i < num_vectors; i++) {
+        out[i] = inner_product_avx2(query, vectors[i], num_dim);
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static int32_t int8_inner_product_avx2(const int8_t* a, const int8_t* b, size_t num_dim) {
+    __m256i acc = _mm256_setzero_si256();
+    size_t d = 0;
+
+    // widened to 16 bits, so that adjacent products can be summed into 32 bits without saturating
+    for(; d + 16 <= num_dim; d += 16) {
+        const __m256i va = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + d)));
+        const __m256i vb = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + d)));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));
+    }
+
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+
+    int32_t product = _mm_cvtsi128_si32(sum);
+    for(; d < num_dim; d++) {
+        product += int32_t(a[d]) * int32_t(b[d]);
+    }
+
+    return product;
+}
+
+__attribute__((target("avx512f,avx2,fma")))
+static inline float hsum_avx512(__m512 v) {
+    // reduced via memory: the 512 => 256 bit cast intrinsics trip -Wmaybe-uninitialized on GCC 12
+    alignas(64) float lanes[16];
+    _mm512_store_ps(lanes, v);
+
+    float sum = 0;
+    for(float lane: lanes) {
+        sum += lane;
+    }
+
+    return sum;
+}
+
+__attribute__((target("avx512f,avx2,fma")))
+static float inner_product_avx512(const float* a, const float* b, size_t num_dim) {
+    __m512 acc = _mm512_setzero_ps();
+    size_t d = 0;
+
+    for(; d + 16 <= num_dim; d += 16) {
+        acc = _mm512_fmadd_ps(_mm512_loadu_ps(a + d), _mm512_loadu_ps(b + d), acc);
+    }
+
+    if(d < num_dim) {
+        const __mmask16 tail_mask = (__mmask16) ((1u << (num_dim - d)) - 1);
+        acc = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(tail_mask, a + d), _mm512_maskz_loadu_ps(tail_mask, b + d), acc);
+    }
+
+    return hsum_avx512(acc);
+}
+
+__attribute__((target("avx512f,avx2,fma")))
+static void inner_products_avx512(const float* query, const float* const* vectors, size_t num_vectors,
+                                  size_t num_dim, float* out) {
+    size_t i = 0;
+    const size_t num_full_dim = num_dim - (num_dim % 16);
+    const __mmask16 tail_mask = (__mmask16) ((1u << (num_dim % 16)) - 1);
+
+    for(; i + vector_scan_t::BATCH_SIZE <= num_vectors; i += vector_scan_t::BATCH_SIZE) {
+        const float* v0 = vectors[i];
+        const float* v1 = vectors[i + 1];
+        const float* v2 = vectors[i + 2];
+        const float* v3 = vectors[i + 3];
+
+        __m512 acc0 = _mm512_setzero_ps();
+        __m512 acc1 = _mm512_setzero_ps();
+        __m512 acc2 = _mm512_setzero_ps();
+        __m512 acc3 = _mm512_setzero_ps();
+
+        for(size_t d = 0; d < num_full_dim; d += 16) {
+            const __m512 q = _mm512_loadu_ps(query + d);
+            acc0 = _mm512_fmadd_ps(q, _mm512_loadu_ps(v0 + d), acc0);
+            acc1 = _mm512_fmadd_ps(q, _mm512_loadu_ps(v1 + d), acc1);
+            acc2 = _mm512_fmadd_ps(q, _mm512_loadu_ps(v2 + d), acc2);
+            acc3 = _mm512_fmadd_ps(q, _mm512_loadu_ps(v3 + d), acc3);
+        }
+
+        if(tail_mask != 0) {
+            const __m512 q = _mm512_maskz_loadu_ps(tail_mask, query + num_full_dim);
+            acc0 = _mm512_fmadd_ps(q, _mm512_maskz_loadu_ps(tail_mask, v0 + num_full_dim), acc0);
+            acc1 = _mm512_fmadd_ps(q, _mm512_maskz_loadu_ps(tail_mask, v1 + num_full_dim), acc1);
+            acc2 = _mm512_fmadd_ps(q, _mm512_maskz_loadu_ps(tail_mask, v2 + num_full_dim), acc2);
+            acc3 = _mm512_fmadd_ps(q, _mm512_maskz_loadu_ps(tail_mask, v3 + num_full_dim), acc3);
+        }
+
+        out[i] = hsum_avx512(acc0);
+        out[i + 1] = hsum_avx512(acc1);
+        out[i + 2] = hsum_avx512(acc2);
+        out[i + 3] = hsum_avx512(acc3);
+    }
+
+    for(; i < num_vectors; i++) {
+        out[i] = inner_product_avx512(query, vectors[i], num_dim);
+    }
+}
+
+#endif
+
+struct vector_scan_kernel_t {
+    const char* name;
+    float (*inner_product)(const float* a, const float* b, size_t num_dim);
+    inner_products_fn inner_products;
+    int32_t (*int8_inner_product)(const int8_t* a, const int8_t* b, size_t num_dim);
+};
+
+static vector_scan_kernel_t select_kernel() {
+#ifdef VECTOR_SCAN_X86
+    __builtin_cpu_init();
+
+    if(__builtin_cpu_supports("avx512f")) {
+        return {"avx512", inner_product_avx512, inner_products_avx512, int8_inner_product_avx2};
+    }
+
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return {"avx2", inner_product_avx2, inner_products_avx2, int8_inner_product_avx2};
+    }
+#endif
+
+    return {"scalar", inner_product_scalar, inner_products_scalar, int8_inner_product_scalar};
+}
+
+static const vector_scan_kernel_t& kernel() {
+    static const vector_scan_kernel_t selected_kernel = select_kernel();
+    return selected_kernel;
+}
+
+float vector_scan_t::inner_product(const float* a, const float* b, size_t num_dim) {
+    return kernel().inner_product(a, b, num_dim);
+}
+
+int32_t vector_scan_t::int8_inner_product(const int8_t* a, const int8_t* b, size_t num_dim) {
+    return kernel().int8_inner_product(a, b, num_dim);
+}
+
+void vector_scan_t::inner_products(const float* query, const float* const* vectors, size_t num_vectors,
+                                   size_t num_dim, float* out) {
+    kernel().inner_products(query, vectors, num_vectors, num_dim, out);
+}
+
+void vector_scan_t::top_k(const float* query, const float* const* vectors, const uint32_t* labels,
+                          size_t num_vectors, size_t num_dim, size_t k,
+                          std::vector<std::pair<float, size_t>>& dist_labels) {
+    dist_labels.clear();
+
+    if(k == 0) {
+        return;
+    }
+
+    // max-heap on distance, so that the farthest of the current top k is evicted first
+    std::priority_queue<std::pair<float, size_t>> top_candidates;
+    float products[BLOCK_SIZE];
+
+    for(size_t block_start = 0; block_start < num_vectors; block_start += BLOCK_SIZE) {
+        const size_t block_len = std::min(BLOCK_SIZE, num_vectors - block_start);
+        inner_products(query, vectors + block_start, block_len, num_dim, products);
+
+        for(size_t i = 0; i < block_len; i++) {
+            const float dist = 1.0f - products[i];
+
+            if(top_candidates.size() < k) {
+                top_candidates.emplace(dist, labels[block_start + i]);
+            } else if(dist < top_candidates.top().first) {
+                top_candidates.pop();
+                top_candidates.emplace(dist, labels[block_start + i]);
+            }
+        }
+    }
+
+    dist_labels.resize(top_candidates.size());
+    for(size_t i = dist_labels.size(); i > 0; i--) {
+        dist_labels[i - 1] = top_candidates.top();
+        top_candidates.pop();
+    }
+}
+
+void vector_scan_t::merge_top_k(const std::vector<std::vector<std::pair<float, size_t>>>& partial_dist_labels,
+                                size_t k, std::vector<std::pair<float, size_t>>& dist_labels) {
+    dist_labels.clear();
+
+    for(const auto& partial: partial_dist_labels) {
+        dist_labels.insert(dist_labels.end(), partial.begin(), partial.end());
+    }
+
+    if(dist_labels.size() > k) {
+        std::partial_sort(dist_labels.begin(), dist_labels.begin() + k, dist_labels.end());
+        dist_labels.resize(k);
+    } else {
+        std::sort(dist_labels.begin(), dist_labels.end());
+    }
+}
+
+const char* vector_scan_t::kernel_name() {
+    return kernel().name;
+}
@@ -0,0 +1,67 @@
+#include <cmath>
+#include <algorithm>
+#include "vector_search_planner.h"
+
+nlohmann::json vector_search_info_t::to_json() const {
+    nlohmann::json info;
+    info["strategy"] = vector_search_planner_t::strategy_name(plan.strategy);
+    info["num_candidates"] = plan.num_candidates;
+    info["selectivity"] = plan.selectivity;
+    info["num_filtered"] = num_filtered;
+    info["num_elements"] = num_elements;
+    info["search_time_us"] = search_time_us;
+
+    if(recall_measured) {
+        info["recall"] = recall;
+    }
+
+    return info;
+}
+
+vector_search_plan_t vector_search_planner_t::plan(bool filtered, size_t num_filtered, size_t num_elements,
+                                                   size_t k, size_t graph_degree, size_t flat_search_cutoff) {
+    vector_search_plan_t plan;
+    plan.num_candidates = k;
+
+    if(!filtered) {
+        return plan;
+    }
+
+    plan.selectivity = (num_elements == 0 || num_filtered >= num_elements) ? 1.0f :
+                       float(num_filtered) / num_elements;
+
+    if(num_filtered < flat_search_cutoff || num_filtered <= k) {
+        plan.strategy = vector_search_strategy_t::flat;
+        return plan;
+    }
+
+    const double graph_cost = double(k) / std::max(plan.selectivity, 1e-6f) * graph_degree;
+    if(double(num_filtered) <= graph_cost) {
+        plan.strategy = vector_search_strategy_t::flat;
+        return plan;
+    }
+
+    if(plan.selectivity >= POST_FILTER_MIN_SELECTIVITY) {
+        plan.strategy = vector_search_strategy_t::post_filtered_hnsw;
+        plan.num_candidates = std::ceil(k / plan.selectivity * POST_FILTER_OVERSAMPLING);
+        return plan;
+    }
+
+    // nodes that fail the filter still have to be traversed, so the search needs a wider beam to find `k` hits
+    plan.strategy = vector_search_strategy_t::filtered_hnsw;
+    plan.num_candidates = std::min<size_t>(std::ceil(k / plan.selectivity), k * MAX_EF_FACTOR);
+    return plan;
+}
+
+const char* vector_search_planner_t::strategy_name(vector_search_strategy_t strategy) {
+    switch(strategy) {
+        case vector_search_strategy_t::flat:
+            return "flat";
+        case vector_search_strategy_t::filtered_hnsw:
+            return "filtered_hnsw";
+        case vector_search_strategy_t::post_filtered_hnsw:
+            return "post_filtered_hnsw";
+        default:
+            return "hnsw";
+    }
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "batched_indexer.h"
+#include "thread_local_vars.h"
+
+class BatchedIndexerTest : public ::testing::Test {
+protected:
+    Store *meta_store;
+    std::atomic<bool> skip_writes{false};
+
+    void SetupStore() {
+        std::string state_dir_path = "/tmp/typesense_test/batched_indexer";
+        LOG(INFO) << "Truncating and creating: " << state_dir_path;
+        system(("rm -rf "+state_dir_path+" && mkdir -p "+state_dir_path).c_str());
+
+        meta_store = new Store(state_dir_path);
+    }
+
+    virtual void SetUp() {
+        SetupStore();
+    }
+
+    virtual void TearDown() {
+        write_log_index = 0;
+        delete meta_store;
+    }
+};
+
+TEST_F(BatchedIndexerTest, WritePositionsOfBatchedEntry) {
+    // writes of a group-committed entry share its log index but not their position
+    ASSERT_NE(BatchedIndexer::get_write_position(5, 0), BatchedIndexer::get_write_position(5, 1));
+    ASSERT_LT(BatchedIndexer::get_write_position(5, 1), BatchedIndexer::get_write_position(5, 2));
+    ASSERT_LT(BatchedIndexer::get_write_position(5, 65535), BatchedIndexer::get_write_position(6, 0));
+
+    ASSERT_EQ("5", BatchedIndexer::serialize_write_position(BatchedIndexer::get_write_position(5, 0)));
+    ASSERT_EQ("5_2", BatchedIndexer::serialize_write_position(BatchedIndexer::get_write_position(5, 2)));
+
+    int64_t position = 0;
+    ASSERT_TRUE(BatchedIndexer::parse_write_position("5_2", position));
+    ASSERT_EQ(BatchedIndexer::get_write_position(5, 2), position);
+
+    // log index persisted by an older version
+    ASSERT_TRUE(BatchedIndexer::parse_write_position("7", position));
+    ASSERT_EQ(BatchedIndexer::get_write_position(7, 0), position);
+
+    ASSERT_FALSE(BatchedIndexer::parse_write_position("", position));
+    ASSERT_FALSE(BatchedIndexer::parse_write_position("7_", position));
+    ASSERT_FALSE(BatchedIndexer::parse_write_position("7_65536", position));
+    ASSERT_FALSE(BatchedIndexer::parse_write_position("abc", position));
+}
+
+TEST_F(BatchedIndexerTest, SkipOnlyCrashedWriteOfBatchedEntry) {
+    Config& config = Config::get_instance();
+
+    {
+        BatchedIndexer batched_indexer(nullptr, meta_store, meta_store, 1, config, skip_writes);
+
+        // crash while indexing the third write of a batched entry
+        write_log_index = BatchedIndexer::get_write_position(5, 2);
+        batched_indexer.persist_applying_index();
+    }
+
+    // on a restart, only that write must be skipped and not the others of the entry
+    BatchedIndexer batched_indexer(nullptr, meta_store, meta_store, 1, config, skip_writes);
+    batched_indexer.load_skip_indices();
+
+    ASSERT_EQ(BatchedIndexer::get_write_position(5, 2), batched_indexer.get_skip_index());
+    ASSERT_NE(BatchedIndexer::get_write_position(5, 0), batched_indexer.get_skip_index());
+    ASSERT_NE(BatchedIndexer::get_write_position(5, 1), batched_indexer.get_skip_index());
+
+    batched_indexer.populate_skip_index();
+    ASSERT_NE(BatchedIndexer::get_write_position(5, 2), batched_indexer.get_skip_index());
+
+    // skip indices are gone once a snapshot is taken
+    write_log_index = BatchedIndexer::get_write_position(9, 1);
+    batched_indexer.persist_applying_index();
+    batched_indexer.clear_skip_indices();
+    batched_indexer.load_skip_indices();
+    ASSERT_NE(BatchedIndexer::get_write_position(9, 1), batched_indexer.get_skip_index());
+}
@@ -1012,3 +1012,189 @@ TEST_F(CollectionFacetingTest, FacetOnArrayFieldWithSpecialChars) {
         }
     }
 }
+
+TEST_F(CollectionFacetingTest, RangeFacets) {
+    std::vector<field> fields = {
+        field("title", field_types::STRING, false),
+        field("price", field_types::FLOAT, true),
+        field("in_stock", field_types::BOOL, true),
+    };
+
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields).get();
+
+    std::vector<float> prices = {-5.5, 4.99, 9.99, 10, 24.5, 49.99, 50, 120};
+
+    for(size_t i = 0; i < prices.size(); i++) {
+        nlohmann::json doc;
+        doc["title"] = "Item " + std::to_string(i);
+        doc["price"] = prices[i];
+        doc["in_stock"] = (i % 2 == 0);
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    auto results = coll1->search("*", {}, "", {"price(-10-10, 10-50, 50+)"}, {}, {0}, 10, 1,
+                                 FREQUENCY, {true}, 10).get();
+
+    ASSERT_EQ(8, results["found"].get<size_t>());
+    ASSERT_EQ(1, results["facet_counts"].size());
+    ASSERT_EQ("price", results["facet_counts"][0]["field_name"]);
+    ASSERT_EQ(3, results["facet_counts"][0]["counts"].size());
+
+    // upper bounds are exclusive
+    std::map<std::string, size_t> range_counts;
+    for(const auto& count: results["facet_counts"][0]["counts"]) {
+        range_counts[count["value"].get<std::string>()] = count["count"].get<size_t>();
+    }
+
+    ASSERT_EQ(3, range_counts["-10-10"]);
+    ASSERT_EQ(3, range_counts["10-50"]);
+    ASSERT_EQ(2, range_counts["50+"]);
+
+    ASSERT_FLOAT_EQ(-5.5, results["facet_counts"][0]["stats"]["min"].get<double>());
+    ASSERT_FLOAT_EQ(120, results["facet_counts"][0]["stats"]["max"].get<double>());
+
+    // values outside every range are not counted
+    results = coll1->search("*", {}, "", {"price(0-10)", "in_stock"}, {}, {0}, 10, 1,
+                            FREQUENCY, {true}, 10).get();
+
+    ASSERT_EQ(2, results["facet_counts"].size());
+    ASSERT_EQ(1, results["facet_counts"][0]["counts"].size());
+    ASSERT_EQ("0-10", results["facet_counts"][0]["counts"][0]["value"].get<std::string>());
+    ASSERT_EQ(2, results["facet_counts"][0]["counts"][0]["count"].get<size_t>());
+    ASSERT_EQ("in_stock", results["facet_counts"][1]["field_name"]);
+    ASSERT_EQ(2, results["facet_counts"][1]["counts"].size());
+
+    // facet query matches the values, which are then counted towards their ranges
+    results = coll1->search("*", {}, "", {"price(-10-10, 10-50, 50+)"}, {}, {0}, 10, 1,
+                            FREQUENCY, {true}, 10, spp::sparse_hash_set<std::string>(),
+                            spp::sparse_hash_set<std::string>(), 10, "price: 1").get();
+
+    ASSERT_EQ(1, results["facet_counts"].size());
+    ASSERT_EQ(2, results["facet_counts"][0]["counts"].size());
+
+    range_counts.clear();
+    for(const auto& count: results["facet_counts"][0]["counts"]) {
+        range_counts[count["value"].get<std::string>()] = count["count"].get<size_t>();
+    }
+
+    ASSERT_EQ(1, range_counts["10-50"]);
+    ASSERT_EQ(1, range_counts["50+"]);
+
+    // a document is counted once per range, however many of its array values fall in it
+    std::vector<field> array_fields = {
+        field("prices", field_types::FLOAT_ARRAY, true),
+        field("sizes", field_types::INT32_ARRAY, true),
+    };
+
+    Collection* coll2 = collectionManager.create_collection("coll2", 1, array_fields).get();
+
+    std::vector<std::vector<float>> array_prices = {{5, 7}, {5, 20}, {60}};
+    std::vector<std::vector<int32_t>> array_sizes = {{1, 2, 30}, {40}, {3, 4}};
+
+    for(size_t i = 0; i < array_prices.size(); i++) {
+        nlohmann::json doc;
+        doc["prices"] = array_prices[i];
+        doc["sizes"] = array_sizes[i];
+        ASSERT_TRUE(coll2->add(doc.dump()).ok());
+    }
+
+    results = coll2->search("*", {}, "", {"prices(0-10, 10-50, 50+)", "sizes(0-10, 10-100)"}, {}, {0}, 10, 1,
+                            FREQUENCY, {true}, 10).get();
+
+    ASSERT_EQ(2, results["facet_counts"].size());
+
+    range_counts.clear();
+    for(const auto& count: results["facet_counts"][0]["counts"]) {
+        range_counts[count["value"].get<std::string>()] = count["count"].get<size_t>();
+    }
+
+    ASSERT_EQ(3, range_counts.size());
+    ASSERT_EQ(2, range_counts["0-10"]);
+    ASSERT_EQ(1, range_counts["10-50"]);
+    ASSERT_EQ(1, range_counts["50+"]);
+
+    range_counts.clear();
+    for(const auto& count: results["facet_counts"][1]["counts"]) {
+        range_counts[count["value"].get<std::string>()] = count["count"].get<size_t>();
+    }
+
+    ASSERT_EQ(2, range_counts.size());
+    ASSERT_EQ(2, range_counts["0-10"]);
+    ASSERT_EQ(2, range_counts["10-100"]);
+
+    collectionManager.drop_collection("coll2");
+
+    // ranges must be numerical and are only allowed on numerical fields
+    auto res_op = coll1->search("*", {}, "", {"price(0-abc)"}, {}, {0}, 10, 1, FREQUENCY, {true}, 10);
+    ASSERT_FALSE(res_op.ok());
+    ASSERT_EQ("Facet range `0-abc` is not in expected format.", res_op.error());
+
+    res_op = coll1->search("*", {}, "", {"price(10-0)"}, {}, {0}, 10, 1, FREQUENCY, {true}, 10);
+    ASSERT_FALSE(res_op.ok());
+
+    res_op = coll1->search("*", {}, "", {"in_stock(0-1)"}, {}, {0}, 10, 1, FREQUENCY, {true}, 10);
+    ASSERT_FALSE(res_op.ok());
+    ASSERT_EQ("Facet field `in_stock` must be a numerical field to be faceted by ranges.", res_op.error());
+
+    collectionManager.drop_collection("coll1");
+}
+
+TEST_F(CollectionFacetingTest, FacetCountsWithoutHits) {
+    std::vector<field> fields = {
+        field("title", field_types::STRING, false),
+        field("brand", field_types::STRING, true),
+        field("points", field_types::INT32, true),
+    };
+
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields).get();
+
+    std::vector<std::string> brands = {"Acme", "Globex", "Initech"};
+
+    for(size_t i = 0; i < 30; i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["title"] = (i % 2 == 0) ? "Blue Shirt" : "Red Shoes";
+        doc["brand"] = brands[i % brands.size()];
+        doc["points"] = i;
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    std::vector<sort_by> sort_fields = { sort_by("points", "ASC") };
+
+    // `per_page: 0` must return the same counts as a page of hits
+    auto assert_same_counts = [&](const std::string& query, const std::string& filter,
+                                  const std::string& pinned_hits, const std::string& hidden_hits,
+                                  const std::vector<std::string>& facets) {
+        std::vector<std::string> query_by = (query == "*") ? std::vector<std::string>{} :
+                                            std::vector<std::string>{"title"};
+
+        auto hits_res = coll1->search(query, query_by, filter, facets, sort_fields, {0}, 10, 1, FREQUENCY,
+                                      {false}, Index::DROP_TOKENS_THRESHOLD, spp::sparse_hash_set<std::string>(),
+                                      spp::sparse_hash_set<std::string>(), 10, "", 30, 4, "",
+                                      Index::TYPO_TOKENS_THRESHOLD, pinned_hits, hidden_hits).get();
+
+        auto count_res = coll1->search(query, query_by, filter, facets, sort_fields, {0}, 0, 1, FREQUENCY,
+                                       {false}, Index::DROP_TOKENS_THRESHOLD, spp::sparse_hash_set<std::string>(),
+                                       spp::sparse_hash_set<std::string>(), 10, "", 30, 4, "",
+                                       Index::TYPO_TOKENS_THRESHOLD, pinned_hits, hidden_hits).get();
+
+        ASSERT_EQ(0, count_res["hits"].size());
+        ASSERT_EQ(hits_res["found"].get<size_t>(), count_res["found"].get<size_t>());
+        ASSERT_EQ(hits_res["facet_counts"], count_res["facet_counts"]);
+    };
+
+    assert_same_counts("*", "", "", "", {});
+    assert_same_counts("*", "", "", "", {"brand"});
+    assert_same_counts("*", "points:>=10", "", "", {"brand", "points"});
+    assert_same_counts("*", "points:>=10", "3:1,4:2", "12", {"brand"});
+    assert_same_counts("shirt", "", "", "", {"brand"});
+    assert_same_counts("shirt", "brand:Acme", "1:1", "", {"brand"});
+
+    auto results = coll1->search("*", {}, "points:>=10", {"brand"}, sort_fields, {0}, 0, 1, FREQUENCY,
+                                 {false}).get();
+
+    ASSERT_EQ(20, results["found"].get<size_t>());
+    ASSERT_EQ(3, results["facet_counts"][0]["counts"].size());
+
+    collectionManager.drop_collection("coll1");
+}
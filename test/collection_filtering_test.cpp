@@ -2453,3 +2453,173 @@ TEST_F(CollectionFilteringTest, FilteringAfterUpsertOnArrayWithSymbolsToIndex) {
 
     collectionManager.drop_collection("coll1");
 }
+
+TEST_F(CollectionFilteringTest, CachedFilterResultsFollowWrites) {
+    std::vector<field> fields = {field("name", field_types::STRING, false),
+                                 field("points", field_types::INT32, false),
+                                 field("in_stock", field_types::BOOL, false)};
+
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields).get();
+
+    for(size_t i = 0; i < 5; i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["name"] = "david";
+        doc["points"] = i * 10;
+        doc["in_stock"] = (i % 2 == 0);
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    auto results = coll1->search("*", {}, "points:>15", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(3, results["found"].get<size_t>());
+
+    results = coll1->search("*", {}, "points:>15", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(3, results["found"].get<size_t>());
+
+    results = coll1->search("*", {}, "in_stock:!=true", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(2, results["found"].get<size_t>());
+
+    uint64_t hits = 0, misses = 0, evictions = 0, invalidations = 0;
+    size_t num_bytes = 0;
+    coll1->get_filter_result_cache_stats(hits, misses, evictions, invalidations, num_bytes);
+    ASSERT_EQ(1, hits);
+    ASSERT_EQ(2, misses);
+
+    nlohmann::json doc;
+    doc["id"] = "5";
+    doc["name"] = "david";
+    doc["points"] = 50;
+    doc["in_stock"] = false;
+    ASSERT_TRUE(coll1->add(doc.dump()).ok());
+
+    results = coll1->search("*", {}, "points:>15", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(4, results["found"].get<size_t>());
+
+    results = coll1->search("*", {}, "in_stock:!=true", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(3, results["found"].get<size_t>());
+
+    ASSERT_TRUE(coll1->remove("4").ok());
+    results = coll1->search("*", {}, "points:>15", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(3, results["found"].get<size_t>());
+
+    collectionManager.drop_collection("coll1");
+}
+
+TEST_F(CollectionFilteringTest, SelectiveClausesAreEvaluatedFirst) {
+    std::vector<field> fields = {field("name", field_types::STRING, false),
+                                 field("points", field_types::INT32, false),
+                                 field("in_stock", field_types::BOOL, false)};
+
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields).get();
+
+    for(size_t i = 0; i < 200; i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["name"] = (i % 100 == 7) ? "rare" : "common";
+        doc["points"] = i;
+        doc["in_stock"] = (i % 2 == 1);
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    // the range is probed with the ids of the rare name
+    auto results = coll1->search("*", {}, "points:>=100 && name: rare", {}, {}, {0}, 10, 1, FREQUENCY,
+                                 {false}).get();
+    ASSERT_EQ(1, results["found"].get<size_t>());
+    ASSERT_EQ("107", results["hits"][0]["document"]["id"].get<std::string>());
+
+    results = coll1->search("*", {}, "points:[0..50, 150..160] && in_stock: true && name: rare", {}, {}, {0}, 10, 1,
+                            FREQUENCY, {false}).get();
+    ASSERT_EQ(1, results["found"].get<size_t>());
+    ASSERT_EQ("7", results["hits"][0]["document"]["id"].get<std::string>());
+
+    results = coll1->search("*", {}, "points:<10 && name: missing", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(0, results["found"].get<size_t>());
+
+    results = coll1->search("*", {}, "(name: rare || points:<5) && points:>3", {}, {}, {0}, 10, 1, FREQUENCY,
+                            {false}).get();
+    ASSERT_EQ(3, results["found"].get<size_t>());
+
+    nlohmann::json plan;
+    ASSERT_TRUE(coll1->explain_filter("points:>=100 && name: rare", plan).ok());
+    ASSERT_EQ("AND", plan["operator"].get<std::string>());
+    ASSERT_EQ(2, plan["children"].size());
+    ASSERT_EQ("name", plan["children"][0]["field"].get<std::string>());
+    ASSERT_EQ(2, plan["children"][0]["estimated_ids"].get<size_t>());
+    ASSERT_EQ(2, plan["children"][0]["distinct_values"].get<size_t>());
+    ASSERT_EQ("materialize", plan["children"][0]["strategy"].get<std::string>());
+    ASSERT_EQ("points", plan["children"][1]["field"].get<std::string>());
+    ASSERT_NEAR(100, plan["children"][1]["estimated_ids"].get<size_t>(), 10);
+    ASSERT_EQ("probe", plan["children"][1]["strategy"].get<std::string>());
+
+    plan.clear();
+    ASSERT_TRUE(coll1->explain_filter("points:<10 && name: missing", plan).ok());
+    ASSERT_EQ("name", plan["children"][0]["field"].get<std::string>());
+    ASSERT_EQ("skip", plan["children"][1]["strategy"].get<std::string>());
+
+    plan.clear();
+    ASSERT_FALSE(coll1->explain_filter("foo: bar", plan).ok());
+
+    collectionManager.drop_collection("coll1");
+}
+
+TEST_F(CollectionFilteringTest, LazyAndEagerFilteringMatch) {
+    std::vector<field> fields = {field("title", field_types::STRING, false, false, true, "", -1, 1),
+                                 field("brand", field_types::STRING, false),
+                                 field("points", field_types::INT32, false)};
+
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields).get();
+
+    std::vector<std::string> colors = {"red", "blue", "green"};
+
+    for(size_t i = 0; i < 200; i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["title"] = "shoe " + colors[i % colors.size()];
+        doc["brand"] = (i % 4 == 0) ? "globex" : "acme";
+        doc["points"] = i;
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    std::vector<sort_by> sort_fields = {sort_by("points", "DESC")};
+
+    auto search = [&](const std::string& query, const std::string& filter, enable_t infix) {
+        return coll1->search(query, {"title"}, filter, {}, sort_fields, {0}, 50, 1, FREQUENCY, {false}, 0,
+                             spp::sparse_hash_set<std::string>(), spp::sparse_hash_set<std::string>(), 10, "", 30,
+                             4, "", 20, {}, {}, {}, 0, "<mark>", "</mark>", {}, 1000, true, false, true, "", false,
+                             6000 * 1000, 4, 7, fallback, 4, {infix}).get();
+    };
+
+    auto get_ids = [](const nlohmann::json& results) {
+        std::vector<std::string> ids;
+        for(const auto& hit: results["hits"]) {
+            ids.push_back(hit["document"]["id"].get<std::string>());
+        }
+        return ids;
+    };
+
+    const std::vector<std::string> filters = {
+        "brand:= acme",
+        "brand:!= globex",
+        "brand: acme && points:>20",
+        "brand:!= globex || points:<10",
+        "(brand: acme && points:>=50) || (brand:= globex && points:<100)",
+        "points:>=10 && (brand:!= globex || points:<120)",
+    };
+
+    for(const auto& query_infix: std::vector<std::pair<std::string, enable_t>>{{"shoe", off}, {"hoe", always}}) {
+        for(const auto& filter: filters) {
+            coll1->set_lazy_filter_min_ids(Index::LAZY_FILTER_MIN_IDS);
+            auto eager_results = search(query_infix.first, filter, query_infix.second);
+
+            // every broad filter is evaluated lazily
+            coll1->set_lazy_filter_min_ids(0);
+            auto lazy_results = search(query_infix.first, filter, query_infix.second);
+
+            ASSERT_LT(0, eager_results["found"].get<size_t>()) << filter;
+            ASSERT_EQ(eager_results["found"].get<size_t>(), lazy_results["found"].get<size_t>()) << filter;
+            ASSERT_EQ(get_ids(eager_results), get_ids(lazy_results)) << filter;
+        }
+    }
+
+    collectionManager.drop_collection("coll1");
+}
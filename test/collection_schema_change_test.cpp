@@ -1446,3 +1446,61 @@ TEST_F(CollectionSchemaChangeTest, GeoFieldSchemaAddition) {
     ASSERT_TRUE(res_op.ok());
     ASSERT_EQ(2, res_op.get()["found"].get<size_t>());
 }
+
+TEST_F(CollectionSchemaChangeTest, SearchPlansFollowSchemaChanges) {
+    std::vector<field> fields = {field("title", field_types::STRING, false),
+                                 field("tags", field_types::STRING_ARRAY, true),
+                                 field("points", field_types::INT32, false),};
+
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields, "points").get();
+
+    nlohmann::json doc;
+    doc["id"] = "0";
+    doc["title"] = "The quick brown fox";
+    doc["tags"] = {"animals"};
+    doc["points"] = 100;
+    ASSERT_TRUE(coll1->add(doc.dump()).ok());
+
+    doc["id"] = "1";
+    doc["title"] = "The lazy dog";
+    doc["tags"] = {"animals", "pets"};
+    doc["points"] = 200;
+    ASSERT_TRUE(coll1->add(doc.dump()).ok());
+
+    // searches with the same parameters reuse the plan across different queries
+    for(const std::string& query: {"the", "the", "fox"}) {
+        auto res_op = coll1->search(query, {"title"}, "points:>50", {"tags"}, {sort_by("points", "ASC")}, {0}, 10, 1,
+                                    FREQUENCY, {true});
+        ASSERT_TRUE(res_op.ok());
+
+        auto res = res_op.get();
+        ASSERT_EQ(query == "fox" ? 1 : 2, res["found"].get<size_t>());
+        ASSERT_EQ("0", res["hits"][0]["document"]["id"].get<std::string>());
+        ASSERT_EQ(1, res["facet_counts"].size());
+    }
+
+    // a failed search is not affected by the plans of others
+    auto res_op = coll1->search("the", {"title"}, "points:>50", {"tags"}, {sort_by("rank", "ASC")}, {0}, 10, 1,
+                                FREQUENCY, {true});
+    ASSERT_FALSE(res_op.ok());
+    ASSERT_EQ("Could not find a field named `rank` in the schema for sorting.", res_op.error());
+
+    auto schema_changes = R"({
+        "fields": [
+            {"name": "tags", "drop": true},
+            {"name": "rank", "type": "int32", "optional": true}
+        ]
+    })"_json;
+
+    ASSERT_TRUE(coll1->alter(schema_changes).ok());
+
+    res_op = coll1->search("the", {"title"}, "points:>50", {"tags"}, {sort_by("points", "ASC")}, {0}, 10, 1,
+                           FREQUENCY, {true});
+    ASSERT_FALSE(res_op.ok());
+    ASSERT_EQ("Could not find a facet field named `tags` in the schema.", res_op.error());
+
+    res_op = coll1->search("the", {"title"}, "points:>50", {}, {sort_by("rank", "ASC")}, {0}, 10, 1,
+                           FREQUENCY, {true});
+    ASSERT_TRUE(res_op.ok());
+    ASSERT_EQ(2, res_op.get()["found"].get<size_t>());
+}
@@ -1811,3 +1811,294 @@ TEST_F(CollectionSpecificMoreTest, CrossFieldTypoAndPrefixWithWeights) {
                         "<mark>", "</mark>", {2, 3}).get();
     ASSERT_EQ(1, res["hits"].size());
 }
+
+TEST_F(CollectionSpecificMoreTest, HighlightWithStoredTokenOffsets) {
+    std::vector<Collection*> colls;
+
+    for(const std::string& store_token_offsets: {"false", "true"}) {
+        nlohmann::json schema = nlohmann::json::parse(R"({
+            "name": "coll_)" + store_token_offsets + R"(",
+            "fields": [
+                {"name": "description", "type": "string", "store_token_offsets": )" + store_token_offsets + R"(},
+                {"name": "tags", "type": "string[]", "store_token_offsets": )" + store_token_offsets + R"(}
+            ]
+        })");
+
+        auto coll_op = collectionManager.create_collection(schema);
+        ASSERT_TRUE(coll_op.ok());
+        colls.push_back(coll_op.get());
+    }
+
+    ASSERT_TRUE(colls[1]->get_summary_json()["fields"][0]["store_token_offsets"].get<bool>());
+    ASSERT_EQ(0, colls[0]->get_summary_json()["fields"][0].count("store_token_offsets"));
+
+    for(size_t i = 0; i < 10; i++) {
+        std::string description;
+        for(size_t j = 0; j < 100; j++) {
+            description += (j == 40 + i * 5) ? "Needle, " : ("word" + std::to_string(j) + " ");
+        }
+
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["description"] = description;
+        doc["tags"] = {"short tag", description};
+
+        for(auto coll: colls) {
+            ASSERT_TRUE(coll->add(doc.dump()).ok());
+        }
+    }
+
+    ASSERT_EQ(10, colls[1]->_get_index()->_get_token_offset_index().at("description")->num_docs());
+
+    auto res = colls[0]->search("needle", {"description", "tags"}, "", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    auto offsets_res = colls[1]->search("needle", {"description", "tags"}, "", {}, {}, {0}, 10, 1,
+                                        FREQUENCY, {false}).get();
+
+    ASSERT_EQ(10, offsets_res["hits"].size());
+    ASSERT_EQ(res["hits"], offsets_res["hits"]);
+
+    for(const auto& hit: offsets_res["hits"]) {
+        if(hit["document"]["id"] == "0") {
+            ASSERT_EQ("word36 word37 word38 word39 <mark>Needle</mark>, word41 word42 word43 word44",
+                      hit["highlight"]["description"]["snippet"].get<std::string>());
+        }
+    }
+
+    // updating the field must replace its stored offsets
+    nlohmann::json doc;
+    doc["id"] = "0";
+    doc["description"] = "Needle in a haystack";
+    doc["tags"] = nlohmann::json::array();
+
+    for(auto coll: colls) {
+        ASSERT_TRUE(coll->add(doc.dump(), UPSERT).ok());
+    }
+
+    ASSERT_EQ(9, colls[1]->_get_index()->_get_token_offset_index().at("description")->num_docs());
+
+    res = colls[0]->search("needle", {"description"}, "", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    offsets_res = colls[1]->search("needle", {"description"}, "", {}, {}, {0}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(res["hits"], offsets_res["hits"]);
+
+    nlohmann::json schema = R"({
+            "name": "coll2",
+            "fields": [
+                {"name": "points", "type": "int32", "store_token_offsets": true}
+            ]
+        })"_json;
+
+    auto coll_op = collectionManager.create_collection(schema);
+    ASSERT_FALSE(coll_op.ok());
+    ASSERT_EQ("The `store_token_offsets` property of the field `points` is only allowed on a string field.",
+              coll_op.error());
+
+    schema["fields"][0] = R"({"name": "title", "type": "string", "locale": "th", "store_token_offsets": true})"_json;
+    coll_op = collectionManager.create_collection(schema);
+    ASSERT_FALSE(coll_op.ok());
+    ASSERT_EQ("The `store_token_offsets` property of the field `title` is not supported with the `th` locale.",
+              coll_op.error());
+
+    collectionManager.drop_collection("coll_false");
+    collectionManager.drop_collection("coll_true");
+}
+
+TEST_F(CollectionSpecificMoreTest, TypoIndexForShortTokens) {
+    nlohmann::json schema = R"({
+            "name": "coll1",
+            "fields": [
+                {"name": "title", "type": "string", "typo_index_max_len": 6}
+            ]
+        })"_json;
+
+    auto coll_op = collectionManager.create_collection(schema);
+    ASSERT_TRUE(coll_op.ok());
+    Collection* coll1 = coll_op.get();
+
+    std::vector<std::string> titles = {"Running shoes", "Snow boots", "Shoe polish", "Cool trousers"};
+    for(size_t i = 0; i < titles.size(); i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["title"] = titles[i];
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    auto res = coll1->search("shoez", {"title"}, "", {}, {}, {1}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(2, res["hits"].size());
+
+    res = coll1->search("trouzers", {"title"}, "", {}, {}, {2}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(1, res["hits"].size());
+    ASSERT_EQ("3", res["hits"][0]["document"]["id"].get<std::string>());
+
+    auto summary = coll1->get_summary_json();
+    ASSERT_EQ(6, summary["fields"][0]["typo_index_max_len"].get<size_t>());
+    ASSERT_EQ(6, summary["typo_index"]["title"]["max_token_len"].get<size_t>());
+    size_t num_tokens = summary["typo_index"]["title"]["num_tokens"].get<size_t>();
+    ASSERT_EQ(8, num_tokens);
+
+    // deleting a document must remove its tokens from the typo index
+    ASSERT_TRUE(coll1->remove("2").ok());
+    summary = coll1->get_summary_json();
+    ASSERT_EQ(num_tokens - 2, summary["typo_index"]["title"]["num_tokens"].get<size_t>());
+
+    res = coll1->search("shoez", {"title"}, "", {}, {}, {1}, 10, 1, FREQUENCY, {false}).get();
+    ASSERT_EQ(1, res["hits"].size());
+    ASSERT_EQ("0", res["hits"][0]["document"]["id"].get<std::string>());
+
+    schema = R"({
+            "name": "coll2",
+            "fields": [
+                {"name": "points", "type": "int32", "typo_index_max_len": 6}
+            ]
+        })"_json;
+
+    coll_op = collectionManager.create_collection(schema);
+    ASSERT_FALSE(coll_op.ok());
+    ASSERT_EQ("The `typo_index_max_len` property of the field `points` is only allowed on a string field.",
+              coll_op.error());
+
+    schema["fields"][0] = R"({"name": "title", "type": "string", "typo_index_max_len": 100})"_json;
+    coll_op = collectionManager.create_collection(schema);
+    ASSERT_FALSE(coll_op.ok());
+    ASSERT_EQ("The `typo_index_max_len` property of the field `title` should be an integer between 0 and 16.",
+              coll_op.error());
+
+    collectionManager.drop_collection("coll1");
+}
+
+TEST_F(CollectionSpecificMoreTest, TokenExpansionCacheAcrossQueries) {
+    nlohmann::json schema = R"({
+            "name": "coll1",
+            "fields": [
+                {"name": "title", "type": "string"}
+            ]
+        })"_json;
+
+    Collection* coll1 = collectionManager.create_collection(schema).get();
+
+    std::vector<std::string> titles = {"Apple iPhone", "Apple iPad", "Samsung phone"};
+    for(size_t i = 0; i < titles.size(); i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["title"] = titles[i];
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    auto res = coll1->search("ip", {"title"}, "", {}, {}, {0}, 10, 1, FREQUENCY, {true}).get();
+    ASSERT_EQ(2, res["hits"].size());
+
+    res = coll1->search("iph", {"title"}, "", {}, {}, {0}, 10, 1, FREQUENCY, {true}).get();
+    ASSERT_EQ(1, res["hits"].size());
+    ASSERT_EQ("0", res["hits"][0]["document"]["id"].get<std::string>());
+
+    res = coll1->search("iph", {"title"}, "", {}, {}, {0}, 10, 1, FREQUENCY, {true}).get();
+    ASSERT_EQ(1, res["hits"].size());
+
+    nlohmann::json stats;
+    collectionManager.get_token_expansion_cache_stats(stats);
+    ASSERT_LT(0, stats["token_expansion_cache"]["hits"].get<uint64_t>());
+    ASSERT_LT(0, stats["token_expansion_cache"]["narrowed_hits"].get<uint64_t>());
+
+    // cached expansions must not outlive writes
+    nlohmann::json doc;
+    doc["id"] = "3";
+    doc["title"] = "iPhone case";
+    ASSERT_TRUE(coll1->add(doc.dump()).ok());
+
+    res = coll1->search("iph", {"title"}, "", {}, {}, {0}, 10, 1, FREQUENCY, {true}).get();
+    ASSERT_EQ(2, res["hits"].size());
+
+    ASSERT_TRUE(coll1->remove("0").ok());
+    ASSERT_TRUE(coll1->remove("3").ok());
+
+    res = coll1->search("iph", {"title"}, "", {}, {}, {0}, 10, 1, FREQUENCY, {true}).get();
+    ASSERT_EQ(0, res["hits"].size());
+
+    collectionManager.drop_collection("coll1");
+}
+
+TEST_F(CollectionSpecificMoreTest, TokenExpansionCacheTruncatedWithFilter) {
+    nlohmann::json schema = R"({
+            "name": "coll1",
+            "fields": [
+                {"name": "title", "type": "string"}
+            ]
+        })"_json;
+
+    Collection* coll1 = collectionManager.create_collection(schema).get();
+
+    std::vector<std::string> titles = {"ipad", "ipad", "ipad", "iphone", "iphone", "ipod"};
+    for(size_t i = 0; i < titles.size(); i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["title"] = titles[i];
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    auto get_tokens = [](const std::vector<art_leaf*>& leaves) {
+        std::vector<std::string> tokens;
+        for(auto leaf: leaves) {
+            tokens.emplace_back((const char*) leaf->key, leaf->key_len - 1);
+        }
+        return tokens;
+    };
+
+    // the filter matches only a leaf past the first `max_words` of the unfiltered expansion
+    const Index* index = coll1->_get_index();
+    std::vector<uint32_t> filter_ids = {5};
+    std::vector<art_leaf*> leaves;
+    index->fuzzy_search_leaves("title", "ip", 2, 0, 2, FREQUENCY, true, filter_ids.data(), filter_ids.size(),
+                               leaves, std::set<std::string>());
+    ASSERT_EQ(std::vector<std::string>({"ipod"}), get_tokens(leaves));
+
+    leaves.clear();
+    index->fuzzy_search_leaves("title", "ip", 2, 0, 2, FREQUENCY, true, nullptr, 0,
+                               leaves, std::set<std::string>({"ipad"}));
+    ASSERT_EQ(std::vector<std::string>({"iphone", "ipod"}), get_tokens(leaves));
+
+    leaves.clear();
+    index->fuzzy_search_leaves("title", "ip", 2, 0, 2, FREQUENCY, true, nullptr, 0,
+                               leaves, std::set<std::string>());
+    ASSERT_EQ(std::vector<std::string>({"ipad", "iphone"}), get_tokens(leaves));
+
+    collectionManager.drop_collection("coll1");
+}
+
+TEST_F(CollectionSpecificMoreTest, WritesAdvanceWriteGeneration) {
+    nlohmann::json schema = R"({
+        "name": "coll1",
+        "fields": [
+            {"name": "title", "type": "string"}
+        ]
+    })"_json;
+
+    Collection* coll1 = collectionManager.create_collection(schema).get();
+    uint64_t generation = coll1->get_write_generation();
+    ASSERT_LT(0, generation);
+
+    nlohmann::json doc;
+    doc["id"] = "0";
+    doc["title"] = "Apple iPhone";
+    ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    ASSERT_LT(generation, coll1->get_write_generation());
+    generation = coll1->get_write_generation();
+
+    // searches leave it unchanged
+    ASSERT_TRUE(coll1->search("apple", {"title"}, "", {}, {}, {0}, 10, 1, FREQUENCY, {true}).ok());
+    ASSERT_EQ(generation, coll1->get_write_generation());
+
+    nlohmann::json synonym = R"({"id": "syn-1", "root": "apple", "synonyms": ["fruit"]})"_json;
+    ASSERT_TRUE(coll1->add_synonym(synonym).ok());
+    ASSERT_LT(generation, coll1->get_write_generation());
+    generation = coll1->get_write_generation();
+
+    ASSERT_TRUE(coll1->remove("0").ok());
+    ASSERT_LT(generation, coll1->get_write_generation());
+    generation = coll1->get_write_generation();
+
+    // a re-created collection never repeats a generation
+    collectionManager.drop_collection("coll1");
+    coll1 = collectionManager.create_collection(schema).get();
+    ASSERT_LT(generation, coll1->get_write_generation());
+
+    collectionManager.drop_collection("coll1");
+}
@@ -4232,3 +4232,71 @@ TEST_F(CollectionTest, QueryParsingForPhraseSearch) {
 
     collectionManager.drop_collection("coll1");
 }
+
+TEST_F(CollectionTest, SearchAfterCursor) {
+    auto search = [&](const std::string& query, const std::string& filter, const std::string& pinned_hits,
+                      size_t per_page, size_t page, const std::string& search_after) {
+        return collection->search(query, query_fields, filter, {}, sort_fields, {0}, per_page, page, FREQUENCY,
+                                  {false}, Index::DROP_TOKENS_THRESHOLD, spp::sparse_hash_set<std::string>(),
+                                  spp::sparse_hash_set<std::string>(), 10, "", 30, 4, "",
+                                  Index::TYPO_TOKENS_THRESHOLD, pinned_hits, "", {}, 3, "<mark>", "</mark>", {},
+                                  UINT32_MAX, true, false, true, "", false, 6000*1000, 4, 7, fallback, 4, {off},
+                                  INT16_MAX, INT16_MAX, 2, 2, false, "", true, 0, max_score, search_after);
+    };
+
+    auto get_ids = [](const nlohmann::json& results) {
+        std::vector<std::string> ids;
+        for(const auto& hit: results["hits"]) {
+            ids.push_back(hit["document"]["id"].get<std::string>());
+        }
+        return ids;
+    };
+
+    // following the cursors must return the same hits as fetching every hit at once
+    auto assert_cursor_pages = [&](const std::string& query, const std::string& filter,
+                                   const std::string& pinned_hits) {
+        auto all_results = search(query, filter, pinned_hits, 100, 1, "").get();
+        std::vector<std::string> all_ids = get_ids(all_results);
+
+        std::vector<std::string> cursor_ids;
+        std::string search_after;
+        size_t num_pages = 0;
+
+        do {
+            auto results = search(query, filter, pinned_hits, 3, 1, search_after).get();
+            ASSERT_EQ(all_results["found"], results["found"]);
+            ASSERT_LE(results["hits"].size(), 3);
+
+            for(const auto& id: get_ids(results)) {
+                cursor_ids.push_back(id);
+            }
+
+            search_after = results.count("search_after") != 0 ? results["search_after"].get<std::string>() : "";
+            num_pages++;
+        } while(!search_after.empty() && num_pages < 20);
+
+        ASSERT_EQ(all_ids, cursor_ids);
+    };
+
+    assert_cursor_pages("the", "", "");
+    assert_cursor_pages("*", "points:>0", "");
+    assert_cursor_pages("*", "", "");
+    assert_cursor_pages("the", "", "13:1,4:5");
+    assert_cursor_pages("*", "points:>10", "7:2,9:4,11:5,14:12");
+
+    // the cursor of a page also follows the pages before it
+    auto results = search("the", "", "", 3, 2, "").get();
+    ASSERT_EQ(std::vector<std::string>({"13", "10", "8"}), get_ids(results));
+
+    results = search("the", "", "", 3, 1, results["search_after"].get<std::string>()).get();
+    ASSERT_EQ(std::vector<std::string>({"16"}), get_ids(results));
+    ASSERT_EQ(0, results.count("search_after"));
+
+    auto res_op = search("the", "", "", 3, 1, "not a cursor");
+    ASSERT_FALSE(res_op.ok());
+    ASSERT_EQ("Parameter `search_after` is malformed.", res_op.error());
+
+    res_op = search("the", "", "", 3, 2, Collection::get_search_after_str(search_cursor_t{}));
+    ASSERT_FALSE(res_op.ok());
+    ASSERT_EQ(422, res_op.code());
+}
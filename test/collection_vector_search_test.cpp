@@ -313,6 +313,8 @@ TEST_F(CollectionVectorTest, VecSearchWithFiltering) {
 
     ASSERT_EQ(num_docs, results["found"].get<size_t>());
     ASSERT_EQ(num_docs, results["hits"].size());
+    ASSERT_EQ("hnsw", results["vector_search_info"]["strategy"].get<std::string>());
+    ASSERT_EQ(0, results["vector_search_info"].count("recall"));
 
     // with points:<10, non-flat-search
 
@@ -366,6 +368,72 @@ TEST_F(CollectionVectorTest, VecSearchWithFiltering) {
 
     ASSERT_EQ(1, results["found"].get<size_t>());
     ASSERT_EQ(1, results["hits"].size());
+
+    // fewer filtered documents than requested hits are always scanned
+    results = coll1->search("*", {}, "points:<10", {}, {}, {0}, 20, 1, FREQUENCY, {true}, Index::DROP_TOKENS_THRESHOLD,
+                            spp::sparse_hash_set<std::string>(),
+                            spp::sparse_hash_set<std::string>(), 10, "", 30, 5,
+                            "", 10, {}, {}, {}, 0,
+                            "<mark>", "</mark>", {}, 1000, true, false, true, "", false, 6000 * 1000, 4, 7,
+                            fallback,
+                            4, {off}, 32767, 32767, 2,
+                            false, true, "vec:([0.96826, 0.94, 0.39557, 0.306488], measure_recall: true)").get();
+
+    ASSERT_EQ(10, results["found"].get<size_t>());
+    ASSERT_EQ("flat", results["vector_search_info"]["strategy"].get<std::string>());
+    ASSERT_EQ(10, results["vector_search_info"]["num_filtered"].get<size_t>());
+    ASSERT_EQ(20, results["vector_search_info"]["num_elements"].get<size_t>());
+    ASSERT_FLOAT_EQ(1.0, results["vector_search_info"]["recall"].get<float>());
+}
+
+TEST_F(CollectionVectorTest, VecSearchWithCuratedHits) {
+    nlohmann::json schema = R"({
+        "name": "coll1",
+        "fields": [
+            {"name": "title", "type": "string"},
+            {"name": "vec", "type": "float[]", "num_dim": 4}
+        ]
+    })"_json;
+
+    Collection* coll1 = collectionManager.create_collection(schema).get();
+
+    std::mt19937 rng;
+    rng.seed(47);
+    std::uniform_real_distribution<> distrib;
+
+    size_t num_docs = 20;
+
+    for (size_t i = 0; i < num_docs; i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["title"] = std::to_string(i) + " title";
+
+        std::vector<float> values;
+        for(size_t j = 0; j < 4; j++) {
+            values.push_back(distrib(rng));
+        }
+
+        doc["vec"] = values;
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    // without a filter, hidden and pinned hits must still be kept out of the nearest neighbours
+    auto results = coll1->search("*", {}, "", {}, {}, {0}, 20, 1, FREQUENCY, {true}, Index::DROP_TOKENS_THRESHOLD,
+                                 spp::sparse_hash_set<std::string>(),
+                                 spp::sparse_hash_set<std::string>(), 10, "", 30, 5,
+                                 "", 10, "3:1", "5", {}, 0,
+                                 "<mark>", "</mark>", {}, 1000, true, false, true, "", false, 6000 * 1000, 4, 7,
+                                 fallback,
+                                 4, {off}, 32767, 32767, 2,
+                                 false, true, "vec:([0.96826, 0.94, 0.39557, 0.306488])").get();
+
+    ASSERT_EQ(num_docs - 1, results["hits"].size());
+    ASSERT_EQ("3", results["hits"][0]["document"]["id"].get<std::string>());
+
+    for(size_t i = 1; i < results["hits"].size(); i++) {
+        ASSERT_NE("3", results["hits"][i]["document"]["id"].get<std::string>());
+        ASSERT_NE("5", results["hits"][i]["document"]["id"].get<std::string>());
+    }
 }
 
 TEST_F(CollectionVectorTest, VecSearchWithFilteringWithMissingVectorValues) {
@@ -642,3 +710,291 @@ TEST_F(CollectionVectorTest, VectorWithNullValue) {
     ASSERT_EQ("Field `vec` must be an array.",
               nlohmann::json::parse(json_lines[1])["error"].get<std::string>());
 }
+
+TEST_F(CollectionVectorTest, QuantizedVectorQuerying) {
+    nlohmann::json schema = R"({
+        "name": "coll1",
+        "fields": [
+            {"name": "title", "type": "string"},
+            {"name": "points", "type": "int32"},
+            {"name": "vec", "type": "float[]", "num_dim": 4, "vec_quantization": "int8"}
+        ]
+    })"_json;
+
+    Collection* coll1 = collectionManager.create_collection(schema).get();
+
+    auto summary = coll1->get_summary_json();
+    ASSERT_EQ("int8", summary["fields"][2]["vec_quantization"].get<std::string>());
+    ASSERT_EQ(100, summary["fields"][2]["vec_rerank"].get<size_t>());
+
+    std::vector<std::vector<float>> values = {
+        {0.851758, 0.909671, 0.823431, 0.372063},
+        {0.97826, 0.933157, 0.39557, 0.306488},
+        {0.230606, 0.634397, 0.514009, 0.399594}
+    };
+
+    for (size_t i = 0; i < values.size(); i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["title"] = std::to_string(i) + " title";
+        doc["points"] = i;
+        doc["vec"] = values[i];
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    for(const std::string flat_search_cutoff: {"0", "1000"}) {
+        auto results = coll1->search("*", {}, "points:[0,1,2]", {}, {}, {0}, 10, 1, FREQUENCY, {true},
+                                     Index::DROP_TOKENS_THRESHOLD, spp::sparse_hash_set<std::string>(),
+                                     spp::sparse_hash_set<std::string>(), 10, "", 30, 5,
+                                     "", 10, {}, {}, {}, 0,
+                                     "<mark>", "</mark>", {}, 1000, true, false, true, "", false, 6000 * 1000, 4, 7,
+                                     fallback, 4, {off}, 32767, 32767, 2, false, true,
+                                     "vec:([0.96826, 0.94, 0.39557, 0.306488], flat_search_cutoff: " +
+                                     flat_search_cutoff + ")").get();
+
+        ASSERT_EQ(3, results["found"].get<size_t>());
+        ASSERT_EQ(3, results["hits"].size());
+
+        ASSERT_STREQ("1", results["hits"][0]["document"]["id"].get<std::string>().c_str());
+        ASSERT_STREQ("0", results["hits"][1]["document"]["id"].get<std::string>().c_str());
+        ASSERT_STREQ("2", results["hits"][2]["document"]["id"].get<std::string>().c_str());
+
+        // distances are re-ranked against the original vectors
+        ASSERT_NEAR(3.409385681152344e-05, results["hits"][0]["vector_distance"].get<float>(), 1e-5);
+        ASSERT_NEAR(0.04329806566238403, results["hits"][1]["vector_distance"].get<float>(), 1e-5);
+        ASSERT_NEAR(0.15141665935516357, results["hits"][2]["vector_distance"].get<float>(), 1e-5);
+    }
+
+    ASSERT_TRUE(coll1->remove("1").ok());
+
+    auto results = coll1->search("*", {}, "", {}, {}, {0}, 10, 1, FREQUENCY, {true}, Index::DROP_TOKENS_THRESHOLD,
+                                 spp::sparse_hash_set<std::string>(),
+                                 spp::sparse_hash_set<std::string>(), 10, "", 30, 5,
+                                 "", 10, {}, {}, {}, 0,
+                                 "<mark>", "</mark>", {}, 1000, true, false, true, "", false, 6000 * 1000, 4, 7, fallback,
+                                 4, {off}, 32767, 32767, 2,
+                                 false, true, "vec:([0.96826, 0.94, 0.39557, 0.306488])").get();
+
+    ASSERT_EQ(2, results["found"].get<size_t>());
+    ASSERT_STREQ("0", results["hits"][0]["document"]["id"].get<std::string>().c_str());
+
+    // invalid quantization properties
+    schema = R"({
+        "name": "coll2",
+        "fields": [
+            {"name": "vec", "type": "float[]", "num_dim": 4, "vec_quantization": "int4"}
+        ]
+    })"_json;
+
+    auto coll_op = collectionManager.create_collection(schema);
+    ASSERT_FALSE(coll_op.ok());
+    ASSERT_EQ("Property `vec_quantization` must be one of `none`, `int8` or `pq`.", coll_op.error());
+
+    schema = R"({
+        "name": "coll2",
+        "fields": [
+            {"name": "vec", "type": "float[]", "vec_quantization": "int8"}
+        ]
+    })"_json;
+
+    coll_op = collectionManager.create_collection(schema);
+    ASSERT_FALSE(coll_op.ok());
+    ASSERT_EQ("Property `vec_quantization` is only allowed on a vector field.", coll_op.error());
+
+    schema = R"({
+        "name": "coll2",
+        "fields": [
+            {"name": "vec", "type": "float[]", "vec_rerank": 50}
+        ]
+    })"_json;
+
+    coll_op = collectionManager.create_collection(schema);
+    ASSERT_FALSE(coll_op.ok());
+    ASSERT_EQ("Property `vec_rerank` is only allowed on a vector field.", coll_op.error());
+}
+
+TEST_F(CollectionVectorTest, HnswParams) {
+    nlohmann::json schema = R"({
+        "name": "coll1",
+        "fields": [
+            {"name": "title", "type": "string"},
+            {"name": "points", "type": "int32"},
+            {"name": "vec", "type": "float[]", "num_dim": 4, "hnsw_params": {"M": 8, "ef_construction": 100, "ef": 20}}
+        ]
+    })"_json;
+
+    Collection* coll1 = collectionManager.create_collection(schema).get();
+
+    auto summary = coll1->get_summary_json();
+    ASSERT_EQ(8, summary["fields"][2]["hnsw_params"]["M"].get<size_t>());
+    ASSERT_EQ(100, summary["fields"][2]["hnsw_params"]["ef_construction"].get<size_t>());
+    ASSERT_EQ(20, summary["fields"][2]["hnsw_params"]["ef"].get<size_t>());
+    ASSERT_EQ(0, summary["fields"][2]["hnsw_params"].count("target_recall"));
+
+    std::vector<std::vector<float>> values = {
+        {0.851758, 0.909671, 0.823431, 0.372063},
+        {0.97826, 0.933157, 0.39557, 0.306488},
+        {0.230606, 0.634397, 0.514009, 0.399594}
+    };
+
+    for (size_t i = 0; i < values.size(); i++) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["title"] = std::to_string(i) + " title";
+        doc["points"] = i;
+        doc["vec"] = values[i];
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    // per-query `ef` overrides the one of the field
+    auto results = coll1->search("*", {}, "", {}, {}, {0}, 10, 1, FREQUENCY, {true}, Index::DROP_TOKENS_THRESHOLD,
+                                 spp::sparse_hash_set<std::string>(),
+                                 spp::sparse_hash_set<std::string>(), 10, "", 30, 5,
+                                 "", 10, {}, {}, {}, 0,
+                                 "<mark>", "</mark>", {}, 1000, true, false, true, "", false, 6000 * 1000, 4, 7, fallback,
+                                 4, {off}, 32767, 32767, 2,
+                                 false, true, "vec:([0.96826, 0.94, 0.39557, 0.306488], k: 2, ef: 50)").get();
+
+    ASSERT_EQ(2, results["found"].get<size_t>());
+    ASSERT_EQ(2, results["hits"].size());
+    ASSERT_STREQ("1", results["hits"][0]["document"]["id"].get<std::string>().c_str());
+    ASSERT_STREQ("0", results["hits"][1]["document"]["id"].get<std::string>().c_str());
+
+    // invalid params
+    schema = R"({
+        "name": "coll2",
+        "fields": [
+            {"name": "vec", "type": "float[]", "num_dim": 4, "hnsw_params": {"M": 0}}
+        ]
+    })"_json;
+
+    auto coll_op = collectionManager.create_collection(schema);
+    ASSERT_FALSE(coll_op.ok());
+    ASSERT_EQ("Property `M` of `hnsw_params` must be a positive integer.", coll_op.error());
+
+    schema = R"({
+        "name": "coll2",
+        "fields": [
+            {"name": "vec", "type": "float[]", "num_dim": 4, "hnsw_params": {"target_recall": 1.5}}
+        ]
+    })"_json;
+
+    coll_op = collectionManager.create_collection(schema);
+    ASSERT_FALSE(coll_op.ok());
+    ASSERT_EQ("Property `target_recall` of `hnsw_params` must be a number between 0 and 1.", coll_op.error());
+
+    schema = R"({
+        "name": "coll2",
+        "fields": [
+            {"name": "title", "type": "string", "hnsw_params": {"M": 8}}
+        ]
+    })"_json;
+
+    coll_op = collectionManager.create_collection(schema);
+    ASSERT_FALSE(coll_op.ok());
+    ASSERT_EQ("Property `hnsw_params` is only allowed on a vector field.", coll_op.error());
+
+    // default params are not part of the schema
+    schema = R"({
+        "name": "coll2",
+        "fields": [
+            {"name": "vec", "type": "float[]", "num_dim": 4, "hnsw_params": {"M": 16}}
+        ]
+    })"_json;
+
+    coll_op = collectionManager.create_collection(schema);
+    ASSERT_TRUE(coll_op.ok());
+    summary = coll_op.get()->get_summary_json();
+    ASSERT_EQ(0, summary["fields"][0].count("hnsw_params"));
+}
+
+TEST_F(CollectionVectorTest, RestoreSavedVectorIndex) {
+    nlohmann::json schema = R"({
+        "name": "coll1",
+        "fields": [
+            {"name": "title", "type": "string"},
+            {"name": "vec", "type": "float[]", "num_dim": 4},
+            {"name": "vec_int8", "type": "float[]", "num_dim": 4, "vec_quantization": "int8"}
+        ]
+    })"_json;
+
+    Collection* coll1 = collectionManager.create_collection(schema).get();
+
+    std::mt19937 rng;
+    rng.seed(47);
+    std::uniform_real_distribution<> distrib;
+
+    auto random_doc = [&](size_t i) {
+        nlohmann::json doc;
+        doc["id"] = std::to_string(i);
+        doc["title"] = std::to_string(i) + " title";
+
+        std::vector<float> values;
+        for(size_t j = 0; j < 4; j++) {
+            values.push_back(distrib(rng));
+        }
+
+        doc["vec"] = values;
+        doc["vec_int8"] = values;
+        return doc;
+    };
+
+    for (size_t i = 0; i < 20; i++) {
+        ASSERT_TRUE(coll1->add(random_doc(i).dump()).ok());
+    }
+
+    std::string vector_index_dir = "/tmp/typesense_test/collection_vector_search_graphs";
+    system(("rm -rf "+vector_index_dir+" && mkdir -p "+vector_index_dir).c_str());
+    ASSERT_TRUE(collectionManager.save_vector_indices(vector_index_dir, 100).ok());
+
+    // changes made after the graphs were saved must be replayed over the restored graphs
+    ASSERT_TRUE(coll1->remove("0").ok());
+    ASSERT_TRUE(coll1->add(random_doc(1).dump(), UPSERT).ok());
+    ASSERT_TRUE(coll1->add(random_doc(20).dump()).ok());
+
+    auto search = [&](Collection* coll, const std::string& vector_query) {
+        return coll->search("*", {}, "", {}, {}, {0}, 30, 1, FREQUENCY, {true}, Index::DROP_TOKENS_THRESHOLD,
+                            spp::sparse_hash_set<std::string>(),
+                            spp::sparse_hash_set<std::string>(), 10, "", 30, 5,
+                            "", 10, {}, {}, {}, 0,
+                            "<mark>", "</mark>", {}, 1000, true, false, true, "", false, 6000 * 1000, 4, 7,
+                            fallback, 4, {off}, 32767, 32767, 2,
+                            false, true, vector_query).get();
+    };
+
+    const std::vector<std::string> vector_queries = {
+        "vec:([0.96826, 0.94, 0.39557, 0.306488])",
+        "vec_int8:([0.96826, 0.94, 0.39557, 0.306488])"
+    };
+
+    std::vector<nlohmann::json> expected_results;
+    for(const auto& vector_query: vector_queries) {
+        expected_results.push_back(search(coll1, vector_query));
+        ASSERT_EQ(20, expected_results.back()["found"].get<size_t>());
+    }
+
+    collectionManager.dispose();
+    delete store;
+
+    store = new Store("/tmp/typesense_test/collection_vector_search");
+    collectionManager.init(store, 1.0, "auth_key", quit);
+
+    // saved at a different log index than the documents, so every vector is compared against the graph
+    collectionManager.set_vector_index_snapshot(vector_index_dir, 101);
+    ASSERT_TRUE(collectionManager.load(8, 1000).ok());
+
+    coll1 = collectionManager.get_collection("coll1").get();
+    ASSERT_NE(nullptr, coll1);
+
+    for(size_t i = 0; i < vector_queries.size(); i++) {
+        auto results = search(coll1, vector_queries[i]);
+        ASSERT_EQ(20, results["found"].get<size_t>());
+        ASSERT_EQ(expected_results[i]["hits"].size(), results["hits"].size());
+
+        for(size_t j = 0; j < results["hits"].size(); j++) {
+            ASSERT_EQ(expected_results[i]["hits"][j]["document"]["id"], results["hits"][j]["document"]["id"]);
+            ASSERT_FLOAT_EQ(expected_results[i]["hits"][j]["vector_distance"].get<float>(),
+                            results["hits"][j]["vector_distance"].get<float>());
+        }
+    }
+}
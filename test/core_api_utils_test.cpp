@@ -606,6 +606,64 @@ TEST_F(CoreAPIUtilsTest, PresetSingleSearch) {
     collectionManager.drop_collection("coll1");
 }
 
+TEST_F(CoreAPIUtilsTest, MultiSearchResultsFollowRequestOrder) {
+    nlohmann::json schema = R"({
+        "name": "coll1",
+        "fields": [
+          {"name": "name", "type": "string" },
+          {"name": "points", "type": "int32" }
+        ]
+    })"_json;
+
+    auto op = collectionManager.create_collection(schema);
+    ASSERT_TRUE(op.ok());
+    Collection* coll1 = op.get();
+
+    for(size_t i = 0; i < 10; i++) {
+        nlohmann::json doc;
+        doc["name"] = (i % 2 == 0) ? "apple" : "orange";
+        doc["points"] = i;
+        ASSERT_TRUE(coll1->add(doc.dump()).ok());
+    }
+
+    std::shared_ptr<http_req> req = std::make_shared<http_req>();
+    std::shared_ptr<http_res> res = std::make_shared<http_res>(nullptr);
+
+    auto search_body = R"(
+        {"searches":[
+            {"collection":"coll1", "q":"apple", "query_by": "name"},
+            {"collection":"coll1", "q":"orange", "query_by": "name", "filter_by": "points: >5"},
+            {"collection":"coll2", "q":"apple", "query_by": "name"},
+            {"collection":"coll1", "q":"apple", "query_by": "name"},
+            {"collection":"coll1", "q":"*", "query_by": "name"}
+        ]}
+    )";
+
+    req->body = search_body;
+
+    for(size_t i = 0; i < 5; i++) {
+        req->embedded_params_vec.push_back(nlohmann::json::object());
+    }
+
+    ASSERT_TRUE(post_multi_search(req, res));
+
+    nlohmann::json results = nlohmann::json::parse(res->body)["results"];
+    ASSERT_EQ(5, results.size());
+
+    ASSERT_EQ(5, results[0]["found"].get<size_t>());
+    ASSERT_EQ(2, results[1]["found"].get<size_t>());
+    ASSERT_EQ(404, results[2]["code"].get<size_t>());
+    ASSERT_EQ(10, results[4]["found"].get<size_t>());
+
+    // the identical search is answered with the same results
+    ASSERT_EQ(results[0]["hits"], results[3]["hits"]);
+
+    // params of the last search are left on the request
+    ASSERT_EQ("*", req->params["q"]);
+
+    collectionManager.drop_collection("coll1");
+}
+
 TEST_F(CoreAPIUtilsTest, ExportWithFilter) {
     Collection *coll1;
     std::vector<field> fields = {field("title", field_types::STRING, false),
@@ -765,4 +823,55 @@ TEST_F(CoreAPIUtilsTest, ExportIncludeExcludeFieldsWithFilter) {
     ASSERT_EQ(1, doc["name"].count("first"));
 
     collectionManager.drop_collection("coll1");
-}
\ No newline at end of file
+}
+TEST_F(CoreAPIUtilsTest, BatchAddDocuments) {
+    std::vector<field> fields = {field("title", field_types::STRING, false),
+                                 field("points", field_types::INT32, false),};
+
+    Collection* coll1 = collectionManager.create_collection("coll1", 1, fields, "points").get();
+
+    std::vector<std::string> bodies = {
+        R"({"id": "0", "title": "Title 0", "points": 0})",
+        R"({"id": "1", "title": "Title 1", "points": "abc"})",
+        R"({"id": "0", "title": "Title 0 again", "points": 10})",
+        R"({"title": "Title without id", "points": 20})",
+        "{bad json",
+    };
+
+    std::vector<std::shared_ptr<http_req>> reqs;
+    std::vector<std::shared_ptr<http_res>> ress;
+
+    for(const auto& body: bodies) {
+        auto req = std::make_shared<http_req>();
+        req->params["collection"] = "coll1";
+        req->params["action"] = "create";
+        req->body = body;
+        reqs.push_back(req);
+        ress.push_back(std::make_shared<http_res>(nullptr));
+    }
+
+    batch_add_documents(reqs, ress);
+
+    // every request gets the response that it would have got on its own
+    ASSERT_EQ(201, ress[0]->status_code);
+    ASSERT_EQ("Title 0", nlohmann::json::parse(ress[0]->body)["title"]);
+
+    ASSERT_EQ(400, ress[1]->status_code);
+    ASSERT_EQ("Field `points` must be an int32.", nlohmann::json::parse(ress[1]->body)["message"]);
+
+    ASSERT_EQ(409, ress[2]->status_code);
+
+    ASSERT_EQ(201, ress[3]->status_code);
+    ASSERT_EQ(1, nlohmann::json::parse(ress[3]->body).count("id"));
+
+    ASSERT_EQ(400, ress[4]->status_code);
+
+    ASSERT_EQ(2, coll1->get_num_documents());
+
+    // unknown collection
+    reqs[0]->params["collection"] = "coll2";
+    batch_add_documents({reqs[0]}, {ress[0]});
+    ASSERT_EQ(404, ress[0]->status_code);
+
+    collectionManager.drop_collection("coll1");
+}
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include "filter_result_cache.h"
+
+class FilterResultCacheTest : public ::testing::Test {
+protected:
+    static filter make_filter(const std::string& field_name, const std::vector<std::string>& values,
+                              const std::vector<NUM_COMPARATOR>& comparators) {
+        filter a_filter;
+        a_filter.field_name = field_name;
+        a_filter.values = values;
+        a_filter.comparators = comparators;
+        return a_filter;
+    }
+
+    static std::vector<uint32_t> get_ids(filter_result_cache_t& cache, const std::string& key) {
+        uint32_t* ids = nullptr;
+        uint32_t ids_length = 0;
+        if(!cache.get(key, ids, ids_length)) {
+            return {UINT32_MAX};
+        }
+
+        std::vector<uint32_t> id_vec(ids, ids + ids_length);
+        delete [] ids;
+        return id_vec;
+    }
+};
+
+TEST_F(FilterResultCacheTest, KeysAreNormalized) {
+    std::string key1, key2;
+
+    ASSERT_TRUE(filter_result_cache_t::get_key(make_filter("tags", {"b", "a"}, {EQUALS, EQUALS}), key1));
+    ASSERT_TRUE(filter_result_cache_t::get_key(make_filter("tags", {"a", "b"}, {EQUALS, EQUALS}), key2));
+    ASSERT_EQ(key1, key2);
+
+    // order of range bounds is significant
+    ASSERT_TRUE(filter_result_cache_t::get_key(make_filter("points", {"10", "20"},
+                                                           {RANGE_INCLUSIVE, RANGE_INCLUSIVE}), key1));
+    ASSERT_TRUE(filter_result_cache_t::get_key(make_filter("points", {"20", "10"},
+                                                           {RANGE_INCLUSIVE, RANGE_INCLUSIVE}), key2));
+    ASSERT_NE(key1, key2);
+
+    ASSERT_TRUE(filter_result_cache_t::get_key(make_filter("points", {"10"}, {GREATER_THAN}), key1));
+    ASSERT_TRUE(filter_result_cache_t::get_key(make_filter("points", {"10"}, {LESS_THAN}), key2));
+    ASSERT_NE(key1, key2);
+
+    ASSERT_FALSE(filter_result_cache_t::get_key(make_filter("id", {"10"}, {EQUALS}), key1));
+}
+
+TEST_F(FilterResultCacheTest, OnlyExpensiveFiltersAreCached) {
+    field points("points", field_types::INT32, false);
+    field in_stock("in_stock", field_types::BOOL, false);
+    field location("location", field_types::GEOPOINT, false);
+    field tags("tags", field_types::STRING_ARRAY, false);
+
+    ASSERT_TRUE(filter_result_cache_t::is_expensive(points, make_filter("points", {"10"}, {GREATER_THAN})));
+    ASSERT_FALSE(filter_result_cache_t::is_expensive(points, make_filter("points", {"10"}, {EQUALS})));
+
+    ASSERT_TRUE(filter_result_cache_t::is_expensive(in_stock, make_filter("in_stock", {"1"}, {NOT_EQUALS})));
+    ASSERT_FALSE(filter_result_cache_t::is_expensive(in_stock, make_filter("in_stock", {"1"}, {EQUALS})));
+
+    ASSERT_TRUE(filter_result_cache_t::is_expensive(location, make_filter("location", {"48.9, 2.3, 5, km"},
+                                                                         {EQUALS})));
+    ASSERT_FALSE(filter_result_cache_t::is_expensive(tags, make_filter("tags", {"gold"}, {EQUALS})));
+}
+
+TEST_F(FilterResultCacheTest, WritesToFieldsInvalidateResults) {
+    filter_result_cache_t cache;
+    const std::vector<uint32_t> ids = {1, 5, 9, 200};
+
+    uint64_t generation = cache.get_generation();
+    cache.put("points>10", {"points"}, generation, ids.data(), ids.size());
+    cache.put("in_stock!=1", {"in_stock", filter_result_cache_t::ALL_IDS_FIELD}, generation,
+              ids.data(), ids.size());
+    cache.put("empty", {"points"}, generation, nullptr, 0);
+
+    ASSERT_EQ(ids, get_ids(cache, "points>10"));
+    ASSERT_EQ(ids, get_ids(cache, "in_stock!=1"));
+    ASSERT_EQ(std::vector<uint32_t>{}, get_ids(cache, "empty"));
+    ASSERT_EQ(3, cache.hits());
+    ASSERT_EQ(3, cache.misses());
+
+    // writes to other fields leave the results intact
+    cache.invalidate("title");
+    ASSERT_EQ(ids, get_ids(cache, "points>10"));
+
+    // new documents affect negations only
+    cache.invalidate(filter_result_cache_t::ALL_IDS_FIELD);
+    ASSERT_EQ(ids, get_ids(cache, "points>10"));
+    ASSERT_EQ(std::vector<uint32_t>{UINT32_MAX}, get_ids(cache, "in_stock!=1"));
+
+    cache.invalidate("points");
+    ASSERT_EQ(std::vector<uint32_t>{UINT32_MAX}, get_ids(cache, "points>10"));
+    ASSERT_EQ(2, cache.invalidations());
+
+    // stale results linger until they are looked up or evicted
+    ASSERT_EQ(1, cache.size());
+    ASSERT_EQ(std::vector<uint32_t>{UINT32_MAX}, get_ids(cache, "empty"));
+    ASSERT_EQ(0, cache.size());
+
+    // a result computed before a write is never stored
+    generation = cache.get_generation();
+    cache.invalidate("points");
+    cache.put("points>10", {"points"}, generation, ids.data(), ids.size());
+    ASSERT_EQ(0, cache.size());
+}
+
+TEST_F(FilterResultCacheTest, EvictsLeastRecentlyUsedBeyondMaxBytes) {
+    std::vector<uint32_t> ids;
+    for(uint32_t i = 0; i < 1000; i++) {
+        ids.push_back(i * 1000);
+    }
+
+    filter_result_cache_t probe_cache;
+    probe_cache.put("probe", {"points"}, 0, ids.data(), ids.size());
+    const size_t entry_bytes = probe_cache.get_num_bytes();
+
+    filter_result_cache_t cache(entry_bytes * 2 + entry_bytes / 2);
+    cache.put("a", {"points"}, 0, ids.data(), ids.size());
+    cache.put("b", {"points"}, 0, ids.data(), ids.size());
+
+    // `a` is now the most recently used, so `b` is evicted
+    ASSERT_EQ(ids, get_ids(cache, "a"));
+    cache.put("c", {"points"}, 0, ids.data(), ids.size());
+
+    ASSERT_EQ(2, cache.size());
+    ASSERT_EQ(1, cache.evictions());
+    ASSERT_EQ(std::vector<uint32_t>{UINT32_MAX}, get_ids(cache, "b"));
+    ASSERT_EQ(ids, get_ids(cache, "a"));
+    ASSERT_EQ(ids, get_ids(cache, "c"));
+
+    cache.clear();
+    ASSERT_EQ(0, cache.size());
+    ASSERT_EQ(0, cache.get_num_bytes());
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include "filter_result_iterator.h"
+
+static uint32_t* new_ids(const std::vector<uint32_t>& ids) {
+    uint32_t* arr = new uint32_t[ids.size()];
+    std::copy(ids.begin(), ids.end(), arr);
+    return arr;
+}
+
+static std::vector<uint32_t> all_ids(filter_result_iterator_t& it) {
+    std::vector<uint32_t> ids;
+    while(it.valid()) {
+        ids.push_back(it.seq_id);
+        it.next();
+    }
+
+    return ids;
+}
+
+TEST(FilterResultIteratorTest, Operators) {
+    auto and_it = filter_result_iterator_t(filter_result_iterator_t::op_t::AND,
+                                           new filter_result_iterator_t(new_ids({1, 3, 5, 7, 9}), 5),
+                                           new filter_result_iterator_t(new_ids({2, 3, 4, 9, 10}), 5));
+    ASSERT_EQ(std::vector<uint32_t>({3, 9}), all_ids(and_it));
+    ASSERT_FALSE(and_it.valid());
+
+    auto or_it = filter_result_iterator_t(filter_result_iterator_t::op_t::OR,
+                                          new filter_result_iterator_t(new_ids({1, 3, 5}), 3),
+                                          new filter_result_iterator_t(new_ids({3, 4, 10}), 3));
+    ASSERT_EQ(std::vector<uint32_t>({1, 3, 4, 5, 10}), all_ids(or_it));
+
+    auto not_it = filter_result_iterator_t(filter_result_iterator_t::op_t::AND_NOT,
+                                           new filter_result_iterator_t(new_ids({1, 2, 3, 4, 5}), 5),
+                                           new filter_result_iterator_t(new_ids({2, 3, 5, 6}), 4));
+    ASSERT_EQ(std::vector<uint32_t>({1, 4}), all_ids(not_it));
+
+    // nested: (a OR b) AND NOT c
+    auto nested_it = filter_result_iterator_t(filter_result_iterator_t::op_t::AND_NOT,
+        new filter_result_iterator_t(filter_result_iterator_t::op_t::OR,
+                                     new filter_result_iterator_t(new_ids({1, 5, 9}), 3),
+                                     new filter_result_iterator_t(new_ids({2, 6, 10}), 3)),
+        new filter_result_iterator_t(new_ids({5, 6}), 2));
+    ASSERT_EQ(std::vector<uint32_t>({1, 2, 9, 10}), all_ids(nested_it));
+
+    auto empty_it = filter_result_iterator_t(filter_result_iterator_t::op_t::AND,
+                                             new filter_result_iterator_t(new_ids({1, 3}), 2),
+                                             new filter_result_iterator_t(nullptr, 0));
+    ASSERT_FALSE(empty_it.valid());
+}
+
+TEST(FilterResultIteratorTest, SkipToAndContains) {
+    auto it = filter_result_iterator_t(filter_result_iterator_t::op_t::AND,
+                                       new filter_result_iterator_t(new_ids({1, 3, 5, 7, 9, 11}), 6),
+                                       new filter_result_iterator_t(new_ids({3, 5, 9, 11, 13}), 5));
+
+    it.skip_to(6);
+    ASSERT_TRUE(it.valid());
+    ASSERT_EQ(9, it.seq_id);
+
+    // skipping backwards does not move the iterator
+    it.skip_to(2);
+    ASSERT_EQ(9, it.seq_id);
+
+    it.skip_to(12);
+    ASSERT_FALSE(it.valid());
+
+    ASSERT_TRUE(it.contains(3));
+    ASSERT_FALSE(it.contains(4));
+    ASSERT_TRUE(it.contains(11));
+    ASSERT_FALSE(it.contains(13));
+
+    // smaller ids restart the iteration
+    ASSERT_TRUE(it.contains(5));
+    ASSERT_FALSE(it.contains(1));
+}
+
+TEST(FilterResultIteratorTest, PostingLeaf) {
+    std::vector<uint32_t> offsets = {0};
+
+    posting_list_t south(4), africa(4), asia(4);
+
+    for(uint32_t id: {1, 4, 6, 9, 12, 20, 21}) {
+        south.upsert(id, offsets);
+    }
+
+    for(uint32_t id: {2, 4, 9, 10, 20}) {
+        africa.upsert(id, offsets);
+    }
+
+    for(uint32_t id: {3, 9, 15}) {
+        asia.upsert(id, offsets);
+    }
+
+    // values are ORed, while the tokens of a value are ANDed
+    std::vector<std::vector<void*>> value_posting_lists = {{&south, &africa}, {&asia}};
+    filter_result_iterator_t it(value_posting_lists, false, false);
+    ASSERT_EQ(std::vector<uint32_t>({3, 4, 9, 15, 20}), all_ids(it));
+
+    it.reset();
+    it.skip_to(10);
+    ASSERT_EQ(15, it.seq_id);
+
+    it.skip_to(21);
+    ASSERT_FALSE(it.valid());
+
+    id_list_t all_ids_list(4);
+    for(uint32_t id = 1; id <= 22; id++) {
+        all_ids_list.upsert(id);
+    }
+
+    auto not_it = filter_result_iterator_t(filter_result_iterator_t::op_t::AND_NOT,
+                                           new filter_result_iterator_t(&all_ids_list),
+                                           new filter_result_iterator_t(value_posting_lists, false, false));
+    ASSERT_EQ(std::vector<uint32_t>({1, 2, 5, 6, 7, 8, 10, 11, 12, 13, 14, 16, 17, 18, 19, 21, 22}),
+              all_ids(not_it));
+
+    // matches can be materialized on demand
+    uint32_t* filter_ids = nullptr;
+    uint32_t filter_ids_length = it.to_filter_id_array(filter_ids);
+    ASSERT_EQ(5, filter_ids_length);
+    ASSERT_EQ(3, filter_ids[0]);
+    ASSERT_EQ(20, filter_ids[4]);
+    ASSERT_TRUE(it.valid());
+    ASSERT_EQ(3, it.seq_id);
+
+    delete [] filter_ids;
+}
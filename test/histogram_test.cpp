@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include "histogram.h"
+
+TEST(HistogramTest, PercentilesFollowBuckets) {
+    histogram_t histogram;
+    ASSERT_EQ(0, histogram.percentile(0.5));
+
+    for(uint64_t value = 1; value <= 100; value++) {
+        histogram.record(value);
+    }
+
+    ASSERT_EQ(100, histogram.get_count());
+
+    // 50 falls into the [32, 64) bucket
+    ASSERT_EQ(63, histogram.percentile(0.5));
+
+    // capped at the largest recorded value
+    ASSERT_EQ(100, histogram.percentile(0.99));
+    ASSERT_EQ(1, histogram.percentile(0));
+
+    auto histogram_json = histogram.to_json();
+    ASSERT_EQ(100, histogram_json["count"].get<uint64_t>());
+    ASSERT_DOUBLE_EQ(50.5, histogram_json["mean"].get<double>());
+    ASSERT_EQ(100, histogram_json["max"].get<uint64_t>());
+    ASSERT_EQ(1, histogram_json["buckets"]["1"].get<uint64_t>());
+    ASSERT_EQ(2, histogram_json["buckets"]["3"].get<uint64_t>());
+    ASSERT_EQ(37, histogram_json["buckets"]["127"].get<uint64_t>());
+}
+
+TEST(HistogramTest, ZeroesAndLargeValues) {
+    histogram_t histogram;
+    histogram.record(0);
+    histogram.record(UINT64_MAX);
+
+    ASSERT_EQ(0, histogram.percentile(0.5));
+    ASSERT_EQ(UINT64_MAX, histogram.percentile(1));
+    ASSERT_EQ(1, histogram.to_json()["buckets"]["0"].get<uint64_t>());
+}
+
+TEST(HistogramTest, ConcurrentRecords) {
+    histogram_t histogram;
+    std::vector<std::thread> threads;
+
+    for(size_t i = 0; i < 4; i++) {
+        threads.emplace_back([&histogram, i]() {
+            for(uint64_t value = 0; value < 10000; value++) {
+                histogram.record(value + i);
+            }
+        });
+    }
+
+    for(auto& thread: threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(40000, histogram.get_count());
+    ASSERT_EQ(10002, histogram.to_json()["max"].get<uint64_t>());
+}
@@ -72,3 +72,38 @@ TEST(NumTreeTest, EraseFullList) {
     tree.search(NUM_COMPARATOR::EQUALS, 0, &ids, ids_len);
     ASSERT_EQ(nullptr, ids);
 }
+
+TEST(NumTreeTest, Estimates) {
+    num_tree_t tree;
+
+    // 1000 ids over the values 0..999, and 1000 more ids for the value 5000
+    for(uint32_t i = 0; i < 1000; i++) {
+        tree.insert(i, i);
+        tree.insert(5000, 1000 + i);
+    }
+
+    ASSERT_EQ(2000, tree.get_num_ids());
+
+    // equality is exact
+    ASSERT_EQ(1000, tree.estimate(NUM_COMPARATOR::EQUALS, 5000));
+    ASSERT_EQ(1, tree.estimate(NUM_COMPARATOR::EQUALS, 10));
+    ASSERT_EQ(0, tree.estimate(NUM_COMPARATOR::EQUALS, 1200));
+    ASSERT_EQ(1999, tree.estimate(NUM_COMPARATOR::NOT_EQUALS, 10));
+
+    // ranges are approximated from the histogram
+    ASSERT_NEAR(1000, tree.estimate(NUM_COMPARATOR::GREATER_THAN_EQUALS, 1000), 20);
+    ASSERT_NEAR(500, tree.estimate(NUM_COMPARATOR::LESS_THAN, 500), 20);
+    ASSERT_NEAR(100, tree.estimate_range_inclusive(100, 199), 20);
+    ASSERT_EQ(0, tree.estimate_range_inclusive(2000, 3000));
+    ASSERT_EQ(0, tree.estimate_range_inclusive(10, 0));
+    ASSERT_EQ(0, tree.estimate(NUM_COMPARATOR::GREATER_THAN, 5000));
+
+    // the histogram follows writes once enough values have changed
+    for(uint32_t i = 0; i < 1000; i++) {
+        tree.remove(5000, 1000 + i);
+    }
+
+    ASSERT_EQ(1000, tree.get_num_ids());
+    ASSERT_EQ(0, tree.estimate(NUM_COMPARATOR::GREATER_THAN_EQUALS, 1000));
+    ASSERT_NEAR(500, tree.estimate(NUM_COMPARATOR::LESS_THAN, 500), 20);
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include "raft_group_commit.h"
+
+class RaftGroupCommitTest : public ::testing::Test {
+protected:
+    std::mutex mutex;
+    std::vector<std::vector<group_commit_write_t>> proposed;
+
+    RaftGroupCommit::propose_t get_propose() {
+        return [this](std::vector<group_commit_write_t>& writes) {
+            std::unique_lock<std::mutex> lock(mutex);
+            proposed.push_back(writes);
+        };
+    }
+
+    size_t num_proposed() {
+        std::unique_lock<std::mutex> lock(mutex);
+        return proposed.size();
+    }
+
+    static std::shared_ptr<http_req> make_req(const std::string& body) {
+        std::shared_ptr<http_req> req = std::make_shared<http_req>();
+        req->body = body;
+        req->last_chunk_aggregate = true;
+        req->params["collection"] = "coll1";
+        return req;
+    }
+};
+
+TEST_F(RaftGroupCommitTest, ProposesFullBatchesRightAway) {
+    RaftGroupCommit group_commit(60 * 1000 * 1000, 3, 1024 * 1024, get_propose());
+    ASSERT_TRUE(group_commit.enabled());
+
+    for(size_t i = 0; i < 7; i++) {
+        group_commit.add(make_req("{\"id\": \"" + std::to_string(i) + "\"}"), std::make_shared<http_res>(nullptr));
+    }
+
+    ASSERT_EQ(2, num_proposed());
+    ASSERT_EQ(3, proposed[0].size());
+    ASSERT_EQ(3, proposed[1].size());
+    ASSERT_EQ("{\"id\": \"0\"}", proposed[0][0].req->body);
+    ASSERT_EQ("{\"id\": \"5\"}", proposed[1][2].req->body);
+
+    // the remainder is proposed on stop
+    group_commit.stop();
+    ASSERT_EQ(3, num_proposed());
+    ASSERT_EQ(1, proposed[2].size());
+
+    nlohmann::json stats;
+    group_commit.get_stats(stats);
+    ASSERT_EQ(3, stats["batch_size"]["count"].get<size_t>());
+    ASSERT_EQ(3, stats["batch_size"]["max"].get<size_t>());
+}
+
+TEST_F(RaftGroupCommitTest, ProposesOnBytesLimit) {
+    RaftGroupCommit group_commit(60 * 1000 * 1000, 100, 10, get_propose());
+
+    group_commit.add(make_req("12345"), std::make_shared<http_res>(nullptr));
+    ASSERT_EQ(0, num_proposed());
+
+    group_commit.add(make_req("67890"), std::make_shared<http_res>(nullptr));
+    ASSERT_EQ(1, num_proposed());
+    ASSERT_EQ(2, proposed[0].size());
+}
+
+TEST_F(RaftGroupCommitTest, ProposesAfterDelay) {
+    RaftGroupCommit group_commit(1000, 100, 1024 * 1024, get_propose());
+
+    group_commit.add(make_req("a"), std::make_shared<http_res>(nullptr));
+    group_commit.add(make_req("b"), std::make_shared<http_res>(nullptr));
+
+    for(size_t i = 0; i < 1000 && num_proposed() == 0; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    ASSERT_EQ(1, num_proposed());
+    ASSERT_EQ(2, proposed[0].size());
+
+    group_commit.on_commit(proposed[0]);
+
+    nlohmann::json stats;
+    group_commit.get_stats(stats);
+    ASSERT_EQ(2, stats["commit_latency_us"]["count"].get<size_t>());
+    ASSERT_LE(1000, stats["commit_latency_us"]["max"].get<size_t>());
+}
+
+TEST_F(RaftGroupCommitTest, Disabled) {
+    ASSERT_FALSE(RaftGroupCommit(0, 64, 1024, get_propose()).enabled());
+    ASSERT_FALSE(RaftGroupCommit(1000, 1, 1024, get_propose()).enabled());
+}
+
+TEST_F(RaftGroupCommitTest, OnlyCompleteRequestsAreBatched) {
+    auto req = make_req("{}");
+    ASSERT_TRUE(RaftGroupCommit::can_batch(req));
+
+    req->last_chunk_aggregate = false;
+    ASSERT_FALSE(RaftGroupCommit::can_batch(req));
+
+    req->last_chunk_aggregate = true;
+    req->first_chunk_aggregate = false;
+    ASSERT_FALSE(RaftGroupCommit::can_batch(req));
+}
+
+TEST_F(RaftGroupCommitTest, SerializeBatch) {
+    std::vector<group_commit_write_t> writes;
+    writes.push_back({make_req("{\"id\": \"0\"}"), std::make_shared<http_res>(nullptr), 0});
+    writes.push_back({make_req("{\"id\": \"1\"}"), std::make_shared<http_res>(nullptr), 0});
+    writes[1].req->metadata = "abc";
+
+    nlohmann::json content = nlohmann::json::parse(RaftGroupCommit::serialize(writes));
+    ASSERT_TRUE(RaftGroupCommit::is_batch(content));
+    ASSERT_EQ(2, content[RaftGroupCommit::BATCH_KEY].size());
+
+    for(size_t i = 0; i < writes.size(); i++) {
+        http_req req;
+        req.load_from_json(content[RaftGroupCommit::BATCH_KEY][i]);
+
+        ASSERT_EQ(writes[i].req->body, req.body);
+        ASSERT_EQ(writes[i].req->start_ts, req.start_ts);
+        ASSERT_EQ(writes[i].req->metadata, req.metadata);
+        ASSERT_EQ("coll1", req.params["collection"]);
+        ASSERT_TRUE(req.last_chunk_aggregate);
+    }
+
+    // an unbatched entry
+    content = nlohmann::json::parse(writes[0].req->to_json());
+    ASSERT_FALSE(RaftGroupCommit::is_batch(content));
+}
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include <map>
+#include <thread>
+#include "search_arena.h"
+
+TEST(SearchArenaTest, InstallsResourceForScope) {
+    ASSERT_EQ(std::pmr::get_default_resource(), search_arena_t::resource());
+
+    {
+        search_arena_t arena;
+        ASSERT_TRUE(arena.active());
+        ASSERT_NE(std::pmr::get_default_resource(), search_arena_t::resource());
+
+        std::pmr::map<size_t, std::pmr::vector<uint32_t>> scratch(search_arena_t::resource());
+        for(size_t i = 0; i < 1000; i++) {
+            scratch[i % 10].push_back(i);
+        }
+
+        ASSERT_EQ(10, scratch.size());
+        ASSERT_EQ(100, scratch[9].size());
+        ASSERT_EQ(999, scratch[9].back());
+
+        // the inner vectors are allocated from the arena as well
+        ASSERT_EQ(search_arena_t::resource(), scratch[0].get_allocator().resource());
+    }
+
+    ASSERT_EQ(std::pmr::get_default_resource(), search_arena_t::resource());
+}
+
+TEST(SearchArenaTest, NestedArenaIsNoop) {
+    search_arena_t outer;
+    auto outer_resource = search_arena_t::resource();
+
+    {
+        search_arena_t inner;
+        ASSERT_FALSE(inner.active());
+        ASSERT_EQ(outer_resource, search_arena_t::resource());
+    }
+
+    ASSERT_TRUE(outer.active());
+    ASSERT_EQ(outer_resource, search_arena_t::resource());
+}
+
+TEST(SearchArenaTest, ArenaIsThreadLocal) {
+    search_arena_t arena;
+    auto this_thread_resource = search_arena_t::resource();
+
+    std::pmr::memory_resource* other_thread_resource = nullptr;
+    std::thread other([&other_thread_resource]() {
+        other_thread_resource = search_arena_t::resource();
+    });
+    other.join();
+
+    ASSERT_NE(this_thread_resource, other_thread_resource);
+    ASSERT_EQ(std::pmr::get_default_resource(), other_thread_resource);
+}
+
+TEST(SearchArenaTest, DisabledArenaUsesDefaultResource) {
+    search_arena_t::enabled = false;
+
+    {
+        search_arena_t arena;
+        ASSERT_FALSE(arena.active());
+        ASSERT_EQ(std::pmr::get_default_resource(), search_arena_t::resource());
+    }
+
+    search_arena_t::enabled = true;
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include "search_result_cache.h"
+
+class SearchResultCacheTest : public ::testing::Test {
+protected:
+    std::unordered_map<std::string, uint64_t> generations;
+
+    SearchResultCache::generation_fn_t get_generation_fn() {
+        return [this](const std::string& collection_name) {
+            auto it = generations.find(collection_name);
+            return it == generations.end() ? 0 : it->second;
+        };
+    }
+
+    static cached_res_t make_res(const std::string& body, uint32_t ttl = 60) {
+        cached_res_t res;
+        res.load(200, "application/json", body, std::chrono::high_resolution_clock::now(), ttl, 0);
+        return res;
+    }
+};
+
+TEST_F(SearchResultCacheTest, WritesInvalidateEntries) {
+    generations = {{"coll1", 1}, {"coll2", 5}};
+    SearchResultCache cache(SearchResultCache::DEFAULT_MAX_BYTES, get_generation_fn());
+
+    cached_res_t res;
+    for(const auto& collection_names: std::vector<std::vector<std::string>>{{"coll1"}, {"coll1", "coll2"}}) {
+        const uint64_t hash = 100 * collection_names.size();
+        ASSERT_FALSE(cache.lookup(hash, res));
+
+        const auto cache_generations = cache.get_generations(collection_names);
+        cache.record_miss(cache_generations);
+        cache.insert(hash, make_res("r" + std::to_string(collection_names.size())), cache_generations);
+    }
+
+    ASSERT_TRUE(cache.lookup(100, res));
+    ASSERT_EQ("r1", res.body);
+    ASSERT_TRUE(cache.lookup(200, res));
+    ASSERT_EQ("r2", res.body);
+    ASSERT_FALSE(cache.lookup(300, res));
+
+    // a write to one of the collections of a multi search invalidates it
+    generations["coll2"] = 6;
+    ASSERT_TRUE(cache.lookup(100, res));
+    ASSERT_FALSE(cache.lookup(200, res));
+    ASSERT_EQ(1, cache.size());
+
+    // a dropped collection
+    generations.erase("coll1");
+    ASSERT_FALSE(cache.lookup(100, res));
+    ASSERT_EQ(0, cache.size());
+
+    nlohmann::json stats;
+    cache.get_stats(stats);
+    ASSERT_EQ(3, stats["collections"]["coll1"]["hits"].get<size_t>());
+    ASSERT_EQ(2, stats["collections"]["coll1"]["misses"].get<size_t>());
+    ASSERT_EQ(1, stats["collections"]["coll1"]["invalidations"].get<size_t>());
+    ASSERT_EQ(1, stats["collections"]["coll2"]["invalidations"].get<size_t>());
+
+    // every failed lookup is a miss, including those of responses that were never cached
+    ASSERT_EQ(3, stats["hits"].get<size_t>());
+    ASSERT_EQ(5, stats["misses"].get<size_t>());
+
+    // stats are not kept for collections that don't exist
+    cache.record_miss(cache.get_generations({"coll3"}));
+    cache.remove_collection_stats("coll1");
+
+    stats.clear();
+    cache.get_stats(stats);
+    ASSERT_EQ(1, stats["collections"].size());
+    ASSERT_EQ(1, stats["collections"].count("coll2"));
+}
+
+TEST_F(SearchResultCacheTest, ExpiresByTTL) {
+    generations = {{"coll1", 1}};
+    SearchResultCache cache(SearchResultCache::DEFAULT_MAX_BYTES, get_generation_fn());
+    cache.insert(100, make_res("r1", 0), cache.get_generations({"coll1"}));
+
+    cached_res_t res;
+    ASSERT_FALSE(cache.lookup(100, res));
+
+    nlohmann::json stats;
+    cache.get_stats(stats);
+    ASSERT_EQ(1, stats["collections"]["coll1"]["expirations"].get<size_t>());
+}
+
+TEST_F(SearchResultCacheTest, EvictsLeastRecentlyUsedBeyondMaxBytes) {
+    // every shard holds about 10 KB
+    generations = {{"coll1", 1}};
+    SearchResultCache cache(16 * 10 * 1024, get_generation_fn());
+    const std::string body(3000, 'x');
+
+    // keys which land on the same shard
+    for(uint64_t i = 0; i < 4; i++) {
+        cache.insert(i * 16, make_res(body), cache.get_generations({"coll1"}));
+    }
+
+    ASSERT_EQ(3, cache.size());
+    ASSERT_LE(cache.get_num_bytes(), 10 * 1024);
+
+    cached_res_t res;
+    ASSERT_FALSE(cache.lookup(0, res));
+    ASSERT_TRUE(cache.lookup(16, res));
+
+    // 16 is now the most recently used, so 32 is evicted next
+    cache.insert(64, make_res(body), cache.get_generations({"coll1"}));
+    ASSERT_TRUE(cache.lookup(16, res));
+    ASSERT_FALSE(cache.lookup(32, res));
+
+    // larger than the shard's share of `max_bytes`, so too large to be cached at all
+    cache.insert(80, make_res(std::string(20 * 1024, 'x')), cache.get_generations({"coll1"}));
+    ASSERT_FALSE(cache.lookup(80, res));
+
+    nlohmann::json stats;
+    cache.get_stats(stats);
+    ASSERT_EQ(2, stats["collections"]["coll1"]["evictions"].get<size_t>());
+
+    cache.clear();
+    ASSERT_EQ(0, cache.size());
+    ASSERT_EQ(0, cache.get_num_bytes());
+}
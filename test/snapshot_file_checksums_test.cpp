@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include "snapshot_file_checksums.h"
+
+class SnapshotFileChecksumsTest : public ::testing::Test {
+protected:
+    const std::string dir_path = "/tmp/typesense_test/snapshot_file_checksums";
+
+    virtual void SetUp() {
+        system(("rm -rf " + dir_path + " && mkdir -p " + dir_path).c_str());
+    }
+
+    void write_file(const std::string& name, const std::string& contents) {
+        std::ofstream outfile(dir_path + "/" + name, std::ios::binary | std::ios::trunc);
+        outfile << contents;
+    }
+};
+
+TEST_F(SnapshotFileChecksumsTest, ChecksumsOnlyImmutableFiles) {
+    write_file("000010.sst", "abc");
+    write_file("MANIFEST-000005", "abc");
+
+    SnapshotFileChecksums checksums;
+    std::string checksum;
+
+    ASSERT_TRUE(checksums.get(dir_path + "/000010.sst", checksum));
+    ASSERT_EQ("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad-3", checksum);
+
+    ASSERT_FALSE(checksums.get(dir_path + "/MANIFEST-000005", checksum));
+    ASSERT_FALSE(checksums.get(dir_path + "/000011.sst", checksum));
+}
+
+TEST_F(SnapshotFileChecksumsTest, HardLinksShareTheCachedChecksum) {
+    write_file("000010.sst", std::string(3 * 1024 * 1024, 'x'));
+    link((dir_path + "/000010.sst").c_str(), (dir_path + "/linked.sst").c_str());
+
+    std::string expected_checksum;
+    ASSERT_TRUE(SnapshotFileChecksums::compute(dir_path + "/000010.sst", expected_checksum));
+
+    SnapshotFileChecksums checksums;
+    std::string checksum;
+    ASSERT_TRUE(checksums.get(dir_path + "/000010.sst", checksum));
+    ASSERT_EQ(expected_checksum, checksum);
+    ASSERT_EQ(1, checksums.size());
+
+    // a file of another name is checksummed on its own
+    ASSERT_TRUE(checksums.get(dir_path + "/linked.sst", checksum));
+    ASSERT_EQ(expected_checksum, checksum);
+    ASSERT_EQ(2, checksums.size());
+
+    mkdir((dir_path + "/checkpoint").c_str(), 0755);
+    link((dir_path + "/000010.sst").c_str(), (dir_path + "/checkpoint/000010.sst").c_str());
+    ASSERT_TRUE(checksums.get(dir_path + "/checkpoint/000010.sst", checksum));
+    ASSERT_EQ(expected_checksum, checksum);
+    ASSERT_EQ(2, checksums.size());
+}
+
+TEST_F(SnapshotFileChecksumsTest, PruneForgetsUnusedFiles) {
+    write_file("000010.sst", "abc");
+    write_file("000011.sst", "def");
+
+    SnapshotFileChecksums checksums;
+    std::string checksum;
+    ASSERT_TRUE(checksums.get(dir_path + "/000010.sst", checksum));
+    ASSERT_TRUE(checksums.get(dir_path + "/000011.sst", checksum));
+    checksums.prune();
+    ASSERT_EQ(2, checksums.size());
+
+    // next snapshot holds only one of the files
+    ASSERT_TRUE(checksums.get(dir_path + "/000011.sst", checksum));
+    checksums.prune();
+    ASSERT_EQ(1, checksums.size());
+}
@@ -365,3 +365,13 @@ TEST(StringUtilsTest, TokenizeFilterQuery) {
     tokenList = {"(", "(", "age:<5", "||", "age:>10", ")", "&&", "location:(48.906,2.343,5mi)", ")", "||", "tags:AT&T"};
     tokenizeTestHelper(filter_query, tokenList);
 }
+
+TEST(StringUtilsTest, SplitFacetBy) {
+    std::vector<std::string> facet_fields;
+    StringUtils::split_facet_by("brand, price(0-10,10-50, 50+) ,rating", facet_fields);
+    ASSERT_EQ(std::vector<std::string>({"brand", "price(0-10,10-50, 50+)", "rating"}), facet_fields);
+
+    facet_fields.clear();
+    StringUtils::split_facet_by("brand,,", facet_fields);
+    ASSERT_EQ(std::vector<std::string>({"brand"}), facet_fields);
+}
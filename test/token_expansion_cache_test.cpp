@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include <art.h>
+#include <posting.h>
+#include "token_expansion_cache.h"
+
+class TokenExpansionCacheTest : public ::testing::Test {
+protected:
+    art_tree t;
+
+    void insert(const std::string& token, uint32_t id) {
+        art_document document(id, id, {0});
+        art_insert(&t, (const unsigned char*) token.c_str(), token.size() + 1, &document);
+    }
+
+    std::vector<art_leaf*> prefix_search(const std::string& token) {
+        std::vector<art_leaf*> leaves;
+        art_fuzzy_search(&t, (const unsigned char*) token.c_str(), token.size(), 0, 0, 100, MAX_SCORE, true,
+                         nullptr, 0, leaves);
+        return leaves;
+    }
+
+    static std::vector<std::string> leaf_tokens(const std::vector<art_leaf*>& leaves) {
+        std::vector<std::string> tokens;
+        for(auto leaf: leaves) {
+            tokens.emplace_back((const char*) leaf->key, leaf->key_len - 1);
+        }
+
+        return tokens;
+    }
+
+    virtual void SetUp() {
+        art_tree_init(&t);
+        insert("iph", 0);
+        insert("iphone", 1);
+        insert("iphones", 2);
+        insert("ipho", 3);
+        insert("ipad", 4);
+    }
+
+    virtual void TearDown() {
+        art_tree_destroy(&t);
+    }
+};
+
+TEST_F(TokenExpansionCacheTest, HitAndInvalidation) {
+    token_expansion_cache_t cache;
+
+    ASSERT_EQ(nullptr, cache.get("ip", 0, true, MAX_SCORE, 100));
+    ASSERT_EQ(1, cache.misses());
+
+    auto leaves = prefix_search("ip");
+    cache.put("ip", 0, true, MAX_SCORE, 100, cache.get_generation(), nullptr, std::move(leaves));
+
+    auto expansion = cache.get("ip", 0, true, MAX_SCORE, 100);
+    ASSERT_NE(nullptr, expansion);
+    ASSERT_EQ(1, cache.hits());
+    ASSERT_EQ(5, expansion->leaves.size());
+
+    // parameters are part of the key
+    ASSERT_EQ(nullptr, cache.get("ip", 1, true, MAX_SCORE, 100));
+    ASSERT_EQ(nullptr, cache.get("ip", 0, false, MAX_SCORE, 100));
+    ASSERT_EQ(nullptr, cache.get("ip", 0, true, FREQUENCY, 100));
+
+    cache.invalidate();
+    ASSERT_EQ(nullptr, cache.get("ip", 0, true, MAX_SCORE, 100));
+
+    // expansion computed against an older generation is not retained
+    uint64_t old_generation = cache.get_generation();
+    cache.invalidate();
+    cache.put("ip", 0, true, MAX_SCORE, 100, old_generation, nullptr, prefix_search("ip"));
+    ASSERT_EQ(nullptr, cache.get("ip", 0, true, MAX_SCORE, 100));
+
+    // truncated expansions are not retained either
+    cache.put("ip", 0, true, MAX_SCORE, 5, cache.get_generation(), nullptr, prefix_search("ip"));
+    ASSERT_EQ(nullptr, cache.get("ip", 0, true, MAX_SCORE, 5));
+}
+
+TEST_F(TokenExpansionCacheTest, NarrowParentExpansion) {
+    token_expansion_cache_t cache;
+    cache.put("ip", 0, true, MAX_SCORE, 100, cache.get_generation(), nullptr, prefix_search("ip"));
+
+    auto expansion = cache.get("ipho", 0, true, MAX_SCORE, 100);
+    ASSERT_NE(nullptr, expansion);
+    ASSERT_EQ(1, cache.narrowed_hits());
+
+    std::vector<art_leaf*> results;
+    token_expansion_cache_t::apply(*expansion, 100, nullptr, 0, {}, results);
+    ASSERT_EQ(leaf_tokens(prefix_search("ipho")), leaf_tokens(results));
+
+    // narrowed expansion is cached as well
+    ASSERT_NE(nullptr, cache.get("ipho", 0, true, MAX_SCORE, 100));
+    ASSERT_EQ(1, cache.hits());
+
+    // only zero cost prefix expansions can be narrowed
+    ASSERT_EQ(nullptr, cache.get("iphon", 1, true, MAX_SCORE, 100));
+}
+
+TEST_F(TokenExpansionCacheTest, ApplyFilterAndExclusions) {
+    token_expansion_cache_t cache;
+    auto expansion = cache.put("ip", 0, true, MAX_SCORE, 100, cache.get_generation(), nullptr, prefix_search("ip"));
+
+    std::vector<uint32_t> filter_ids = {1, 4};
+    std::vector<art_leaf*> results;
+    token_expansion_cache_t::apply(*expansion, 100, filter_ids.data(), filter_ids.size(), {"ipad"}, results);
+    ASSERT_EQ(std::vector<std::string>({"iphone"}), leaf_tokens(results));
+
+    results.clear();
+    token_expansion_cache_t::apply(*expansion, 2, nullptr, 0, {}, results);
+    ASSERT_EQ(2, results.size());
+}
@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+#include "token_offset_index.h"
+
+TEST(TokenOffsetIndexTest, SeekToClosestCheckpoint) {
+    token_offset_index_t offset_index;
+
+    // 2 values: the first one is too short to have checkpoints
+    offset_index.insert(10, {{}, {100, 200, 300}});
+    ASSERT_EQ(1, offset_index.num_docs());
+    ASSERT_LT(0, offset_index.memory_used());
+
+    size_t checkpoint_token_index = 0, checkpoint_offset = 0;
+
+    ASSERT_FALSE(offset_index.seek(10, 0, 40, checkpoint_token_index, checkpoint_offset));
+    ASSERT_FALSE(offset_index.seek(10, 1, 15, checkpoint_token_index, checkpoint_offset));
+    ASSERT_FALSE(offset_index.seek(10, 2, 40, checkpoint_token_index, checkpoint_offset));
+    ASSERT_FALSE(offset_index.seek(11, 1, 40, checkpoint_token_index, checkpoint_offset));
+
+    ASSERT_TRUE(offset_index.seek(10, 1, 16, checkpoint_token_index, checkpoint_offset));
+    ASSERT_EQ(16, checkpoint_token_index);
+    ASSERT_EQ(100, checkpoint_offset);
+
+    ASSERT_TRUE(offset_index.seek(10, 1, 40, checkpoint_token_index, checkpoint_offset));
+    ASSERT_EQ(32, checkpoint_token_index);
+    ASSERT_EQ(200, checkpoint_offset);
+
+    // positions beyond the last checkpoint resume from the last one
+    ASSERT_TRUE(offset_index.seek(10, 1, 1000, checkpoint_token_index, checkpoint_offset));
+    ASSERT_EQ(48, checkpoint_token_index);
+    ASSERT_EQ(300, checkpoint_offset);
+}
+
+TEST(TokenOffsetIndexTest, InsertReplacesAndRemove) {
+    token_offset_index_t offset_index;
+
+    offset_index.insert(1, {{10, 20}});
+    offset_index.insert(1, {{30}});
+    ASSERT_EQ(1, offset_index.num_docs());
+
+    size_t checkpoint_token_index = 0, checkpoint_offset = 0;
+    ASSERT_TRUE(offset_index.seek(1, 0, 40, checkpoint_token_index, checkpoint_offset));
+    ASSERT_EQ(16, checkpoint_token_index);
+    ASSERT_EQ(30, checkpoint_offset);
+
+    // values without any checkpoint are not stored
+    offset_index.insert(2, {{}, {}});
+    ASSERT_EQ(1, offset_index.num_docs());
+
+    offset_index.remove(1);
+    offset_index.remove(3);
+    ASSERT_EQ(0, offset_index.num_docs());
+    ASSERT_EQ(0, offset_index.memory_used());
+}
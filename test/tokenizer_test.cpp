@@ -355,3 +355,129 @@ TEST(TokenizerTest, ShouldTokenizeWithDifferentSymbolConfigs) {
     ASSERT_EQ("เหลื่อม", tokens[1]);
     ASSERT_EQ("ล้ํา", tokens[2]);
 }
+
+TEST(TokenizerTest, ASCIIFastPathMatchesGenericPath) {
+    ASSERT_TRUE(Tokenizer::is_ascii("", 0));
+    ASSERT_TRUE(Tokenizer::is_ascii("The quick brown fox jumps", 25));
+    ASSERT_FALSE(Tokenizer::is_ascii("The quick brown fox jumpé", 26));
+    ASSERT_FALSE(Tokenizer::is_ascii("é", 2));
+
+    // a non-ASCII character forces the generic path, so both paths must agree on the ASCII portion
+    const std::string ascii_text = "Hello,  World! c++ & C# are-great\n42nd St. ";
+    const std::string mixed_text = ascii_text + "é";
+
+    std::vector<char> symbols = {'+', '#'};
+    std::vector<char> separators = {'-'};
+
+    std::vector<std::string> ascii_tokens, mixed_tokens;
+    Tokenizer(ascii_text, true, false, "", symbols, separators).tokenize(ascii_tokens);
+
+    std::vector<std::string> expected_tokens = {"hello", "world", "c++", "c#", "are", "great", "42nd", "st"};
+    ASSERT_EQ(expected_tokens, ascii_tokens);
+
+    // without normalization, the unicode character is retained as is
+    ascii_tokens.clear();
+    Tokenizer(ascii_text, false, false, "", symbols, separators).tokenize(ascii_tokens);
+    Tokenizer(mixed_text, false, false, "", symbols, separators).tokenize(mixed_tokens);
+
+    ASSERT_EQ(ascii_tokens.size() + 1, mixed_tokens.size());
+    mixed_tokens.pop_back();
+    ASSERT_EQ(ascii_tokens, mixed_tokens);
+
+    // offsets
+    Tokenizer tokenizer(" Foo bar", true, false);
+    std::string token;
+    size_t token_index = 0, start_index = 0, end_index = 0;
+    ASSERT_TRUE(tokenizer.next(token, token_index, start_index, end_index));
+    ASSERT_EQ("foo", token);
+    ASSERT_EQ(0, token_index);
+    ASSERT_EQ(1, start_index);
+    ASSERT_EQ(3, end_index);
+    ASSERT_TRUE(tokenizer.next(token, token_index, start_index, end_index));
+    ASSERT_EQ("bar", token);
+    ASSERT_EQ(1, token_index);
+    ASSERT_EQ(5, start_index);
+    ASSERT_EQ(7, end_index);
+    ASSERT_FALSE(tokenizer.next(token, token_index, start_index, end_index));
+}
+
+TEST(TokenizerTest, PooledTokenizerIsResetOntoNewText) {
+    std::vector<std::string> tokens;
+    Tokenizer* first_tokenizer = nullptr;
+
+    {
+        std::string text = "first text here";
+        auto tokenizer = Tokenizer::acquire(text, true, false, "", {}, {'-'});
+        first_tokenizer = tokenizer.get();
+        tokenizer->tokenize(tokens);
+        ASSERT_EQ(std::vector<std::string>({"first", "text", "here"}), tokens);
+    }
+
+    // same configuration reuses the released tokenizer, with a fresh token counter
+    tokens.clear();
+    std::string text = "Second-text";
+    auto tokenizer = Tokenizer::acquire(text, true, false, "", {}, {'-'});
+    ASSERT_EQ(first_tokenizer, tokenizer.get());
+
+    std::string token;
+    size_t token_index = 0;
+    ASSERT_TRUE(tokenizer->next(token, token_index));
+    ASSERT_EQ("second", token);
+    ASSERT_EQ(0, token_index);
+
+    // a different configuration, or a tokenizer acquired while another one is in use, is a separate instance
+    auto other_tokenizer = Tokenizer::acquire(text, true, false, "", {}, {});
+    ASSERT_NE(tokenizer.get(), other_tokenizer.get());
+    other_tokenizer->tokenize(tokens);
+    ASSERT_EQ(std::vector<std::string>({"secondtext"}), tokens);
+
+    auto nested_tokenizer = Tokenizer::acquire(text, true, false, "", {}, {'-'});
+    ASSERT_NE(tokenizer.get(), nested_tokenizer.get());
+
+    ASSERT_TRUE(tokenizer->next(token, token_index));
+    ASSERT_EQ("text", token);
+    ASSERT_EQ(1, token_index);
+
+    // locale specific tokenizers retain their break iterator across resets
+    tokens.clear();
+    std::string th_text = "ความเหลื่อมล้ำ";
+    {
+        auto th_tokenizer = Tokenizer::acquire(th_text, true, false, "th");
+        th_tokenizer->tokenize(tokens);
+    }
+
+    std::vector<std::string> th_tokens;
+    auto th_tokenizer = Tokenizer::acquire(th_text, true, false, "th");
+    th_tokenizer->tokenize(th_tokens);
+    ASSERT_EQ(tokens, th_tokens);
+}
+
+TEST(TokenizerTest, SeekResumesFromTokenOffset) {
+    const std::string text = "The quick, brown fox jumps over the lazy dog.";
+
+    std::vector<std::pair<std::string, size_t>> tokens;
+    std::vector<size_t> start_offsets;
+
+    Tokenizer tokenizer(text, true, false);
+    std::string token;
+    size_t token_index = 0, start_index = 0, end_index = 0;
+
+    while(tokenizer.next(token, token_index, start_index, end_index)) {
+        tokens.emplace_back(token, token_index);
+        start_offsets.push_back(start_index);
+    }
+
+    ASSERT_EQ(9, tokens.size());
+
+    Tokenizer seek_tokenizer(text, true, false);
+    seek_tokenizer.seek(start_offsets[4], 4);
+
+    for(size_t i = 4; i < tokens.size(); i++) {
+        ASSERT_TRUE(seek_tokenizer.next(token, token_index, start_index, end_index));
+        ASSERT_EQ(tokens[i].first, token);
+        ASSERT_EQ(tokens[i].second, token_index);
+        ASSERT_EQ(start_offsets[i], start_index);
+    }
+
+    ASSERT_FALSE(seek_tokenizer.next(token, token_index, start_index, end_index));
+}
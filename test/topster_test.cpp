@@ -235,4 +235,61 @@ TEST(TopsterTest, DistinctIntValues) {
             EXPECT_EQ(9, dist_topster.group_kv_map[dist_topster.getDistinctKeyAt(i)]->getKV(1)->scores[0]);
         }
     }
-}
\ No newline at end of file
+}
+
+TEST(TopsterTest, PagesAfterCursor) {
+    // keys 1..20 with descending scores: key 1 ranks first
+    auto add_all = [](Topster& topster, const std::vector<std::pair<uint64_t, int64_t>>& key_scores) {
+        for(const auto& key_score: key_scores) {
+            int64_t scores[3] = {key_score.second, 0, 0};
+            KV kv(0, key_score.first, key_score.first, 0, scores);
+            topster.add(&kv);
+        }
+    };
+
+    std::vector<std::pair<uint64_t, int64_t>> key_scores;
+    for(uint64_t key = 1; key <= 20; key++) {
+        key_scores.emplace_back(key, 100 - key);
+    }
+
+    // ties are broken on the key, so the cursor is the full sort key tuple
+    key_scores.emplace_back(21, 95);
+
+    Topster first_page(5);
+    add_all(first_page, key_scores);
+    first_page.sort();
+
+    std::vector<uint64_t> keys;
+    for(uint32_t i = 0; i < first_page.size; i++) {
+        keys.push_back(first_page.getKeyAt(i));
+    }
+
+    ASSERT_EQ(std::vector<uint64_t>({1, 2, 3, 4, 21}), keys);
+
+    Topster next_page(5);
+    KV* last_kv = first_page.getKV(first_page.size - 1);
+    next_page.set_cursor(last_kv->scores, last_kv->key);
+    add_all(next_page, key_scores);
+    next_page.sort();
+
+    keys.clear();
+    for(uint32_t i = 0; i < next_page.size; i++) {
+        keys.push_back(next_page.getKeyAt(i));
+    }
+
+    ASSERT_EQ(std::vector<uint64_t>({5, 6, 7, 8, 9}), keys);
+
+    // a key that ranks before the cursor is not kept for its lesser scores, in whatever order they are added
+    Topster tracked_page(5);
+    tracked_page.set_cursor(last_kv->scores, last_kv->key);
+    tracked_page.track_cursor_keys = true;
+    add_all(tracked_page, {{30, 10}, {2, 20}, {31, 50}, {2, 98}, {3, 40}, {3, 97}, {32, 30}, {3, 10}});
+    tracked_page.sort();
+
+    keys.clear();
+    for(uint32_t i = 0; i < tracked_page.size; i++) {
+        keys.push_back(tracked_page.getKeyAt(i));
+    }
+
+    ASSERT_EQ(std::vector<uint64_t>({31, 32, 30}), keys);
+}
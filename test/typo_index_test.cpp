@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <art.h>
+#include <posting.h>
+#include "typo_index.h"
+
+class TypoIndexTest : public ::testing::Test {
+protected:
+    art_tree t;
+    typo_index_t* typo_index;
+
+    void insert(const std::string& token, uint32_t id) {
+        art_document document(id, id, {0});
+        art_insert(&t, (const unsigned char*) token.c_str(), token.size() + 1, &document);
+        typo_index->insert(token);
+    }
+
+    static std::vector<std::string> leaf_tokens(const std::vector<art_leaf*>& leaves) {
+        std::vector<std::string> tokens;
+        for(auto leaf: leaves) {
+            tokens.emplace_back((const char*) leaf->key, leaf->key_len - 1);
+        }
+
+        std::sort(tokens.begin(), tokens.end());
+        return tokens;
+    }
+
+    virtual void SetUp() {
+        art_tree_init(&t);
+        typo_index = new typo_index_t(6);
+    }
+
+    virtual void TearDown() {
+        art_tree_destroy(&t);
+        delete typo_index;
+    }
+};
+
+TEST_F(TypoIndexTest, OSADistance) {
+    ASSERT_EQ(0, typo_index_t::osa_distance("shoe", "shoe"));
+    ASSERT_EQ(1, typo_index_t::osa_distance("shoe", "shoes"));
+    ASSERT_EQ(1, typo_index_t::osa_distance("shoe", "shoo"));
+    ASSERT_EQ(1, typo_index_t::osa_distance("shoe", "hsoe"));
+    ASSERT_EQ(2, typo_index_t::osa_distance("shoe", "hsoo"));
+    ASSERT_EQ(4, typo_index_t::osa_distance("", "shoe"));
+}
+
+TEST_F(TypoIndexTest, SearchResolvesExactCostCandidates) {
+    insert("shoe", 0);
+    insert("shoes", 1);
+    insert("show", 2);
+    insert("snow", 3);
+    insert("shopper", 4);
+    insert("sh", 5);
+
+    std::vector<art_leaf*> leaves;
+    typo_index->search(&t, "shoe", 1, 100, MAX_SCORE, nullptr, 0, leaves, {});
+    ASSERT_EQ(std::vector<std::string>({"shoes", "show"}), leaf_tokens(leaves));
+
+    leaves.clear();
+    typo_index->search(&t, "shoe", 2, 100, MAX_SCORE, nullptr, 0, leaves, {});
+    ASSERT_EQ(std::vector<std::string>({"sh", "snow"}), leaf_tokens(leaves));
+
+    // transposition
+    leaves.clear();
+    typo_index->search(&t, "hsoe", 1, 100, MAX_SCORE, nullptr, 0, leaves, {});
+    ASSERT_EQ(std::vector<std::string>({"shoe"}), leaf_tokens(leaves));
+
+    // tokens longer than the max length are not searchable
+    leaves.clear();
+    typo_index->search(&t, "shoppers", 1, 100, MAX_SCORE, nullptr, 0, leaves, {});
+    ASSERT_TRUE(leaves.empty());
+
+    // excluded leaves and filter ids
+    leaves.clear();
+    typo_index->search(&t, "shoe", 1, 100, MAX_SCORE, nullptr, 0, leaves, {"shoes"});
+    ASSERT_EQ(std::vector<std::string>({"show"}), leaf_tokens(leaves));
+
+    leaves.clear();
+    std::vector<uint32_t> filter_ids = {1};
+    typo_index->search(&t, "shoe", 1, 100, MAX_SCORE, filter_ids.data(), filter_ids.size(), leaves, {});
+    ASSERT_EQ(std::vector<std::string>({"shoes"}), leaf_tokens(leaves));
+}
+
+TEST_F(TypoIndexTest, RemoveAndSize) {
+    insert("shoe", 0);
+    insert("shoes", 1);
+
+    ASSERT_EQ(2, typo_index->num_tokens());
+    ASSERT_LT(0, typo_index->num_variants());
+    ASSERT_LT(0, typo_index->memory_used());
+
+    // duplicate insert is a no-op
+    size_t num_variants = typo_index->num_variants();
+    typo_index->insert("shoe");
+    ASSERT_EQ(2, typo_index->num_tokens());
+    ASSERT_EQ(num_variants, typo_index->num_variants());
+
+    void* values = art_delete(&t, (const unsigned char*) "shoes", 6);
+    posting_t::destroy_list(values);
+    typo_index->remove("shoes");
+    ASSERT_EQ(1, typo_index->num_tokens());
+
+    std::vector<art_leaf*> leaves;
+    typo_index->search(&t, "shoe", 1, 100, MAX_SCORE, nullptr, 0, leaves, {});
+    ASSERT_TRUE(leaves.empty());
+
+    // the id of the removed token is reused
+    insert("shop", 2);
+    ASSERT_EQ(2, typo_index->num_tokens());
+    typo_index->search(&t, "shoe", 1, 100, MAX_SCORE, nullptr, 0, leaves, {});
+    ASSERT_EQ(std::vector<std::string>({"shop"}), leaf_tokens(leaves));
+
+    values = art_delete(&t, (const unsigned char*) "shop", 5);
+    posting_t::destroy_list(values);
+    typo_index->remove("shop");
+
+    typo_index->remove("shoe");
+    ASSERT_EQ(0, typo_index->num_tokens());
+    ASSERT_EQ(0, typo_index->num_variants());
+    ASSERT_EQ(0, typo_index->memory_used());
+}
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <cmath>
+#include "vector_quantizer.h"
+#include "vector_scan.h"
+
+class VectorQuantizerTest : public ::testing::Test {
+protected:
+    std::mt19937 rng{47};
+    std::uniform_real_distribution<float> distrib{-1.0f, 1.0f};
+
+    std::vector<float> random_vector(size_t num_dim) {
+        std::vector<float> values(num_dim);
+        for(auto& value: values) {
+            value = distrib(rng);
+        }
+
+        return values;
+    }
+
+    static void normalize(std::vector<float>& values) {
+        float norm = 0;
+        for(float value: values) {
+            norm += value * value;
+        }
+
+        norm = std::sqrt(norm);
+        for(float& value: values) {
+            value /= norm;
+        }
+    }
+};
+
+TEST_F(VectorQuantizerTest, Int8InnerProductMatchesInt32Sum) {
+    // exercises the vector kernels along with their tails
+    for(size_t num_dim: {1, 15, 16, 17, 31, 32, 33, 384}) {
+        std::vector<int8_t> a(num_dim), b(num_dim);
+        int32_t expected = 0;
+
+        for(size_t i = 0; i < num_dim; i++) {
+            a[i] = int8_t(int(rng() % 255) - 127);
+            b[i] = int8_t(int(rng() % 255) - 127);
+            expected += int32_t(a[i]) * b[i];
+        }
+
+        ASSERT_EQ(expected, vector_scan_t::int8_inner_product(a.data(), b.data(), num_dim)) << num_dim;
+    }
+}
+
+TEST_F(VectorQuantizerTest, ScalarQuantizedInnerProductIsClose) {
+    const size_t num_dim = 128;
+    std::vector<char> code_a(scalar_quantizer_t::code_size(num_dim));
+    std::vector<char> code_b(scalar_quantizer_t::code_size(num_dim));
+    ASSERT_EQ(sizeof(float) + num_dim, code_a.size());
+
+    for(size_t i = 0; i < 50; i++) {
+        auto a = random_vector(num_dim);
+        auto b = random_vector(num_dim);
+        normalize(a);
+        normalize(b);
+
+        scalar_quantizer_t::encode(a.data(), num_dim, code_a.data());
+        scalar_quantizer_t::encode(b.data(), num_dim, code_b.data());
+
+        const float exact = vector_scan_t::inner_product(a.data(), b.data(), num_dim);
+        ASSERT_NEAR(exact, scalar_quantizer_t::inner_product(code_a.data(), code_b.data(), num_dim), 0.01);
+    }
+
+    // zero vector must not produce NaNs
+    std::vector<float> zeros(num_dim, 0);
+    scalar_quantizer_t::encode(zeros.data(), num_dim, code_a.data());
+    ASSERT_EQ(0, scalar_quantizer_t::inner_product(code_a.data(), code_b.data(), num_dim));
+}
+
+TEST_F(VectorQuantizerTest, ProductQuantizationApproximatesInnerProduct) {
+    const size_t num_dim = 32;
+    const size_t num_vectors = 2000;
+
+    pq_codebook_t codebook(num_dim);
+    ASSERT_FALSE(codebook.trained());
+    ASSERT_EQ(4, codebook.get_num_subspaces());
+
+    std::vector<float> vectors;
+    for(size_t i = 0; i < num_vectors; i++) {
+        auto values = random_vector(num_dim);
+        normalize(values);
+        vectors.insert(vectors.end(), values.begin(), values.end());
+    }
+
+    codebook.train(vectors.data(), num_vectors);
+    ASSERT_TRUE(codebook.trained());
+    ASSERT_EQ(4 * pq_codebook_t::MAX_CENTROIDS * 8 * sizeof(float), codebook.memory_used());
+
+    std::vector<uint8_t> codes(num_vectors * codebook.get_num_subspaces());
+    for(size_t i = 0; i < num_vectors; i++) {
+        codebook.encode(vectors.data() + i * num_dim, codes.data() + i * codebook.get_num_subspaces());
+    }
+
+    auto query = random_vector(num_dim);
+    normalize(query);
+
+    std::vector<uint8_t> query_codes(codebook.get_num_subspaces());
+    codebook.encode(query.data(), query_codes.data());
+
+    std::vector<float> table(codebook.table_size());
+    codebook.compute_inner_product_table(query.data(), table.data());
+
+    double asymmetric_error = 0, symmetric_error = 0;
+    for(size_t i = 0; i < num_vectors; i++) {
+        const float exact = vector_scan_t::inner_product(query.data(), vectors.data() + i * num_dim, num_dim);
+        const uint8_t* vector_codes = codes.data() + i * codebook.get_num_subspaces();
+
+        asymmetric_error += std::abs(exact - codebook.table_inner_product(table.data(), vector_codes));
+        symmetric_error += std::abs(exact - codebook.code_inner_product(query_codes.data(), vector_codes));
+    }
+
+    asymmetric_error /= num_vectors;
+    symmetric_error /= num_vectors;
+
+    // comparing against the query itself instead of its code is more accurate
+    ASSERT_LT(asymmetric_error, 0.15);
+    ASSERT_LT(asymmetric_error, symmetric_error);
+}
+
+TEST_F(VectorQuantizerTest, ProductQuantizationSubspacesDivideDimensions) {
+    ASSERT_EQ(48, pq_codebook_t(384).get_num_subspaces());
+    ASSERT_EQ(5, pq_codebook_t(10).get_num_subspaces());
+    ASSERT_EQ(7, pq_codebook_t(7).get_num_subspaces());
+
+    // fewer vectors than centroids
+    pq_codebook_t codebook(4);
+    std::vector<float> vectors = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0};
+    codebook.train(vectors.data(), 3);
+    ASSERT_TRUE(codebook.trained());
+
+    std::vector<uint8_t> codes(codebook.get_num_subspaces());
+    codebook.encode(vectors.data() + 4, codes.data());
+    ASSERT_FLOAT_EQ(1.0f, codebook.code_inner_product(codes.data(), codes.data()));
+}
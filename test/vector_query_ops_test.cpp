@@ -70,4 +70,26 @@ TEST_F(VectorQueryOpsTest, ParseVectorQueryString) {
     parsed = VectorQueryOps::parse_vector_query_str("vec([0.34, 0.66, 0.12, 0.68])", vector_query, nullptr);
     ASSERT_FALSE(parsed.ok());
     ASSERT_EQ("Malformed vector query string.", parsed.error());
+
+    vector_query._reset();
+    parsed = VectorQueryOps::parse_vector_query_str("vec:([0.34, 0.66, 0.12, 0.68], measure_recall: true)",
+                                                    vector_query, nullptr);
+    ASSERT_TRUE(parsed.ok());
+    ASSERT_TRUE(vector_query.measure_recall);
+
+    vector_query._reset();
+    parsed = VectorQueryOps::parse_vector_query_str("vec:([0.34, 0.66, 0.12, 0.68], measure_recall: 1)",
+                                                    vector_query, nullptr);
+    ASSERT_FALSE(parsed.ok());
+    ASSERT_EQ("Malformed vector query string: `measure_recall` parameter must be a boolean.", parsed.error());
+
+    vector_query._reset();
+    parsed = VectorQueryOps::parse_vector_query_str("vec:([0.34, 0.66, 0.12, 0.68], ef: 64)", vector_query, nullptr);
+    ASSERT_TRUE(parsed.ok());
+    ASSERT_EQ(64, vector_query.ef);
+
+    vector_query._reset();
+    parsed = VectorQueryOps::parse_vector_query_str("vec:([0.34, 0.66, 0.12, 0.68], ef: high)", vector_query, nullptr);
+    ASSERT_FALSE(parsed.ok());
+    ASSERT_EQ("Malformed vector query string: `ef` parameter must be an integer.", parsed.error());
 }
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <algorithm>
+#include "vector_scan.h"
+
+class VectorScanTest : public ::testing::Test {
+protected:
+    std::mt19937 rng{47};
+    std::uniform_real_distribution<float> distrib{-1.0f, 1.0f};
+
+    std::vector<float> random_vector(size_t num_dim) {
+        std::vector<float> values(num_dim);
+        for(auto& value: values) {
+            value = distrib(rng);
+        }
+
+        return values;
+    }
+
+    static float naive_inner_product(const std::vector<float>& a, const std::vector<float>& b) {
+        double sum = 0;
+        for(size_t i = 0; i < a.size(); i++) {
+            sum += double(a[i]) * b[i];
+        }
+
+        return float(sum);
+    }
+};
+
+TEST_F(VectorScanTest, InnerProductsMatchNaive) {
+    // exercises the batched kernels along with their tails, both in the vectors and in the dimensions
+    for(size_t num_dim: {1, 3, 4, 7, 8, 15, 16, 17, 33, 384, 385}) {
+        auto query = random_vector(num_dim);
+
+        std::vector<std::vector<float>> values;
+        std::vector<const float*> vectors;
+        for(size_t i = 0; i < 11; i++) {
+            values.push_back(random_vector(num_dim));
+        }
+
+        for(const auto& value: values) {
+            vectors.push_back(value.data());
+        }
+
+        std::vector<float> products(vectors.size());
+        vector_scan_t::inner_products(query.data(), vectors.data(), vectors.size(), num_dim, products.data());
+
+        for(size_t i = 0; i < values.size(); i++) {
+            const float expected = naive_inner_product(query, values[i]);
+            ASSERT_NEAR(expected, products[i], 1e-3) << "num_dim: " << num_dim << ", i: " << i;
+            ASSERT_NEAR(expected, vector_scan_t::inner_product(query.data(), values[i].data(), num_dim), 1e-3);
+        }
+    }
+}
+
+TEST_F(VectorScanTest, TopKReturnsClosestFirst) {
+    const size_t num_dim = 24;
+    const size_t num_vectors = 1000;
+    auto query = random_vector(num_dim);
+
+    std::vector<std::vector<float>> values;
+    std::vector<const float*> vectors;
+    std::vector<uint32_t> labels;
+
+    for(size_t i = 0; i < num_vectors; i++) {
+        values.push_back(random_vector(num_dim));
+        labels.push_back(i * 2);
+    }
+
+    for(const auto& value: values) {
+        vectors.push_back(value.data());
+    }
+
+    std::vector<std::pair<float, size_t>> expected;
+    for(size_t i = 0; i < num_vectors; i++) {
+        expected.emplace_back(1.0f - naive_inner_product(query, values[i]), labels[i]);
+    }
+
+    std::sort(expected.begin(), expected.end());
+
+    std::vector<std::pair<float, size_t>> dist_labels;
+    vector_scan_t::top_k(query.data(), vectors.data(), labels.data(), num_vectors, num_dim, 10, dist_labels);
+
+    ASSERT_EQ(10, dist_labels.size());
+    for(size_t i = 0; i < dist_labels.size(); i++) {
+        ASSERT_EQ(expected[i].second, dist_labels[i].second);
+        ASSERT_NEAR(expected[i].first, dist_labels[i].first, 1e-4);
+    }
+
+    // fewer candidates than k
+    vector_scan_t::top_k(query.data(), vectors.data(), labels.data(), 3, num_dim, 10, dist_labels);
+    ASSERT_EQ(3, dist_labels.size());
+    ASSERT_LE(dist_labels[0].first, dist_labels[1].first);
+    ASSERT_LE(dist_labels[1].first, dist_labels[2].first);
+
+    vector_scan_t::top_k(query.data(), vectors.data(), labels.data(), num_vectors, num_dim, 0, dist_labels);
+    ASSERT_TRUE(dist_labels.empty());
+
+    // splitting the candidates and merging the partial results gives the same top k
+    std::vector<std::vector<std::pair<float, size_t>>> partial_dist_labels(3);
+    vector_scan_t::top_k(query.data(), vectors.data(), labels.data(), 400, num_dim, 10, partial_dist_labels[0]);
+    vector_scan_t::top_k(query.data(), vectors.data() + 400, labels.data() + 400, 400, num_dim, 10,
+                         partial_dist_labels[1]);
+    vector_scan_t::top_k(query.data(), vectors.data() + 800, labels.data() + 800, 200, num_dim, 10,
+                         partial_dist_labels[2]);
+
+    vector_scan_t::merge_top_k(partial_dist_labels, 10, dist_labels);
+
+    ASSERT_EQ(10, dist_labels.size());
+    for(size_t i = 0; i < dist_labels.size(); i++) {
+        ASSERT_EQ(expected[i].second, dist_labels[i].second);
+    }
+}
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include "vector_search_planner.h"
+
+TEST(VectorSearchPlannerTest, UnfilteredQueriesUseTheGraph) {
+    auto plan = vector_search_planner_t::plan(false, 1000000, 1000000, 10, 16, 0);
+    ASSERT_EQ(vector_search_strategy_t::hnsw, plan.strategy);
+    ASSERT_EQ(10, plan.num_candidates);
+    ASSERT_FLOAT_EQ(1.0f, plan.selectivity);
+
+    // cutoff applies only to filtered queries
+    plan = vector_search_planner_t::plan(false, 100, 100, 10, 16, 1000);
+    ASSERT_EQ(vector_search_strategy_t::hnsw, plan.strategy);
+}
+
+TEST(VectorSearchPlannerTest, SelectiveFiltersUseFlatScan) {
+    // 0.1% of a million vectors
+    auto plan = vector_search_planner_t::plan(true, 1000, 1000000, 10, 16, 0);
+    ASSERT_EQ(vector_search_strategy_t::flat, plan.strategy);
+    ASSERT_EQ(10, plan.num_candidates);
+    ASSERT_FLOAT_EQ(0.001f, plan.selectivity);
+
+    // fewer filtered ids than results
+    plan = vector_search_planner_t::plan(true, 5, 100, 10, 16, 0);
+    ASSERT_EQ(vector_search_strategy_t::flat, plan.strategy);
+
+    // explicit cutoff wins over the costs
+    plan = vector_search_planner_t::plan(true, 200000, 1000000, 10, 16, 500000);
+    ASSERT_EQ(vector_search_strategy_t::flat, plan.strategy);
+
+    // a sparser graph computes fewer distances per expanded node
+    plan = vector_search_planner_t::plan(true, 10000, 1000000, 10, 16, 0);
+    ASSERT_EQ(vector_search_strategy_t::flat, plan.strategy);
+
+    plan = vector_search_planner_t::plan(true, 10000, 1000000, 10, 4, 0);
+    ASSERT_EQ(vector_search_strategy_t::filtered_hnsw, plan.strategy);
+}
+
+TEST(VectorSearchPlannerTest, ModerateFiltersRaiseEf) {
+    // 5% of a million vectors
+    auto plan = vector_search_planner_t::plan(true, 50000, 1000000, 10, 16, 0);
+    ASSERT_EQ(vector_search_strategy_t::filtered_hnsw, plan.strategy);
+    ASSERT_EQ(100, plan.num_candidates);
+
+    // 20%
+    plan = vector_search_planner_t::plan(true, 200000, 1000000, 10, 16, 0);
+    ASSERT_EQ(vector_search_strategy_t::filtered_hnsw, plan.strategy);
+    ASSERT_EQ(50, plan.num_candidates);
+}
+
+TEST(VectorSearchPlannerTest, BroadFiltersArePostFiltered) {
+    auto plan = vector_search_planner_t::plan(true, 800000, 1000000, 10, 16, 0);
+    ASSERT_EQ(vector_search_strategy_t::post_filtered_hnsw, plan.strategy);
+    ASSERT_EQ(19, plan.num_candidates);
+
+    vector_search_info_t info;
+    info.plan = plan;
+    info.num_filtered = 800000;
+    info.num_elements = 1000000;
+
+    auto info_json = info.to_json();
+    ASSERT_EQ("post_filtered_hnsw", info_json["strategy"].get<std::string>());
+    ASSERT_EQ(19, info_json["num_candidates"].get<size_t>());
+    ASSERT_EQ(0, info_json.count("recall"));
+
+    info.recall_measured = true;
+    info.recall = 0.9;
+    ASSERT_FLOAT_EQ(0.9, info.to_json()["recall"].get<float>());
+}